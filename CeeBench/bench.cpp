@@ -0,0 +1,267 @@
+#include "bench.h"
+
+#include <CeeEngine/debugMessenger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+
+// Iteration counts grow until a run takes this long, then repetitions are measured.
+#define BENCH_DEFAULT_MIN_TIME 0.1
+#define BENCH_DEFAULT_REPETITIONS 5
+#define BENCH_MAX_ITERATIONS 1000000000ull
+
+struct BenchEntry {
+	std::string name;
+	BenchFunction function;
+	int64_t arg;
+};
+
+struct BenchResult {
+	std::string name;
+	uint64_t iterations;
+	// Nanoseconds per iteration.
+	double median;
+	double min;
+	double max;
+	double itemsPerSecond;
+	std::string skipMessage;
+};
+
+// Function local so registration from other translation units' statics is safe.
+static std::vector<BenchEntry>& GetBenchmarks() {
+	static std::vector<BenchEntry> benchmarks;
+	return benchmarks;
+}
+
+static std::filesystem::path s_AssetRoot;
+static bool s_DiscardMessages = false;
+
+BenchState::BenchState(uint64_t iterations, int64_t arg)
+: m_Iterations(iterations), m_Arg(arg), m_ItemsPerIteration(0)
+{
+}
+
+int RegisterBenchmark(const char* name, BenchFunction function, std::vector<int64_t> args) {
+	if (args.empty()) {
+		GetBenchmarks().push_back({ name, function, 0 });
+		return 0;
+	}
+	for (int64_t arg : args) {
+		GetBenchmarks().push_back({ std::string(name) + "/" + std::to_string(arg), function, arg });
+	}
+	return 0;
+}
+
+const std::filesystem::path& GetBenchAssetRoot() {
+	return s_AssetRoot;
+}
+
+void SetDiscardMessages(bool discard) {
+	s_DiscardMessages = discard;
+}
+
+static void MessageSink(cee::CeeErrorSeverity severity, const char* message, void*) {
+	if (s_DiscardMessages) {
+		return;
+	}
+	fprintf(stderr, "[%s] %s\n", severity == cee::ERROR_SEVERITY_ERROR ? "ERROR" : "WARN", message);
+}
+
+// Returns the run time in nanoseconds.
+static double RunOnce(const BenchEntry& entry, BenchState& state) {
+	auto start = std::chrono::steady_clock::now();
+	entry.function(state);
+	auto end = std::chrono::steady_clock::now();
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+static BenchResult RunBenchmark(const BenchEntry& entry, double minTime, uint32_t repetitions) {
+	BenchResult result = {};
+	result.name = entry.name;
+
+	double minNanoseconds = minTime * 1000000000.0;
+	uint64_t iterations = 1;
+	while (true) {
+		BenchState state(iterations, entry.arg);
+		double elapsed = RunOnce(entry, state);
+		if (!state.GetSkipMessage().empty()) {
+			result.skipMessage = state.GetSkipMessage();
+			return result;
+		}
+		if (elapsed >= minNanoseconds || iterations >= BENCH_MAX_ITERATIONS) {
+			break;
+		}
+		// Aim a little past the minimum so the next run is likely the last.
+		double scale = elapsed > 0.0 ? minNanoseconds * 1.4 / elapsed : 10.0;
+		scale = std::clamp(scale, 2.0, 10.0);
+		iterations = std::min((uint64_t)(iterations * scale), (uint64_t)BENCH_MAX_ITERATIONS);
+	}
+
+	std::vector<double> times;
+	uint64_t items = 0;
+	for (uint32_t i = 0; i < repetitions; i++) {
+		BenchState state(iterations, entry.arg);
+		times.push_back(RunOnce(entry, state) / iterations);
+		items = state.GetItemsPerIteration();
+	}
+	std::sort(times.begin(), times.end());
+
+	result.iterations = iterations;
+	result.median = times[times.size() / 2];
+	result.min = times.front();
+	result.max = times.back();
+	result.itemsPerSecond = result.median > 0.0 ? items * 1000000000.0 / result.median : 0.0;
+	return result;
+}
+
+static void WriteJson(std::FILE* file, const std::vector<BenchResult>& results, double minTime, uint32_t repetitions) {
+	fprintf(file, "{\n");
+	fprintf(file, "  \"min_time\": %.3f,\n", minTime);
+	fprintf(file, "  \"repetitions\": %u,\n", repetitions);
+	fprintf(file, "  \"benchmarks\": [");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& result = results[i];
+		fprintf(file, "%s\n    { \"name\": \"%s\", ", i == 0 ? "" : ",", result.name.c_str());
+		if (!result.skipMessage.empty()) {
+			fprintf(file, "\"skipped\": \"%s\" }", result.skipMessage.c_str());
+			continue;
+		}
+		fprintf(file, "\"iterations\": %" PRIu64 ", \"ns_per_iteration\": %.3f, \"min\": %.3f, \"max\": %.3f, "
+				"\"items_per_second\": %.1f }", result.iterations, result.median, result.min, result.max,
+				result.itemsPerSecond);
+	}
+	fprintf(file, "\n  ]\n");
+	fprintf(file, "}\n");
+}
+
+static void PrintUsage(const char* command) {
+	fprintf(stdout, "Usage: %s [OPTION]...\n"
+		 "\n"
+		 "-h, --help       help\n"
+		 "-l, --list       list the benchmarks and exit\n"
+		 "    --filter=TEXT only run benchmarks whose name contains TEXT\n"
+		 "    --min-time=SECONDS shortest measured run (default 0.1)\n"
+		 "    --repetitions=N runs measured per benchmark, the median is reported (default 5)\n"
+		 "    --json=FILE  also write the results to FILE as JSON\n"
+		 "    --assets=DIR asset root for the AssetManager benchmarks, e.g. CeeEditor/res\n",
+		 command);
+}
+
+enum {
+	OPT_FILTER = 1,
+	OPT_MIN_TIME,
+	OPT_REPETITIONS,
+	OPT_JSON,
+	OPT_ASSETS
+};
+
+static const char shortOptions[] = "hl";
+static const option longOptions[] = {
+	{ "help", 0, 0, 'h' },
+	{ "list", 0, 0, 'l' },
+	{ "filter", 1, 0, OPT_FILTER },
+	{ "min-time", 1, 0, OPT_MIN_TIME },
+	{ "repetitions", 1, 0, OPT_REPETITIONS },
+	{ "json", 1, 0, OPT_JSON },
+	{ "assets", 1, 0, OPT_ASSETS },
+	{ 0, 0, 0, 0 }
+};
+
+int main(int argc, char** argv) {
+	std::string filter;
+	double minTime = BENCH_DEFAULT_MIN_TIME;
+	uint32_t repetitions = BENCH_DEFAULT_REPETITIONS;
+	std::string jsonOutput;
+	bool list = false;
+
+	int c;
+	int32_t optionIndex;
+	while ((c = getopt_long(argc, argv, shortOptions, longOptions, &optionIndex)) != -1) {
+		switch (c) {
+		case 'h':
+			PrintUsage(argv[0]);
+			exit(EXIT_SUCCESS);
+			break;
+
+		case 'l':
+			list = true;
+			break;
+
+		case OPT_FILTER:
+			filter = optarg;
+			break;
+
+		case OPT_MIN_TIME:
+			minTime = strtod(optarg, NULL);
+			if (minTime <= 0.0) {
+				fprintf(stderr, "%s: --min-time must be positive\n", argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+		case OPT_REPETITIONS:
+			repetitions = (uint32_t)strtoul(optarg, NULL, 10);
+			if (repetitions == 0) {
+				fprintf(stderr, "%s: --repetitions must be at least 1\n", argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+		case OPT_JSON:
+			jsonOutput = optarg;
+			break;
+
+		case OPT_ASSETS:
+			s_AssetRoot = optarg;
+			break;
+
+		default:
+			PrintUsage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// Only problems are reported, debug and info messages would end up in the measurements.
+	cee::DebugMessenger::RegisterDebugMessenger((cee::CeeErrorSeverity)(cee::ERROR_SEVERITY_WARNING | cee::ERROR_SEVERITY_ERROR),
+												NULL, MessageSink);
+
+	std::vector<BenchResult> results;
+	for (const BenchEntry& entry : GetBenchmarks()) {
+		if (!filter.empty() && entry.name.find(filter) == std::string::npos) {
+			continue;
+		}
+		if (list) {
+			fprintf(stdout, "%s\n", entry.name.c_str());
+			continue;
+		}
+		BenchResult result = RunBenchmark(entry, minTime, repetitions);
+		if (!result.skipMessage.empty()) {
+			fprintf(stdout, "%-48s skipped: %s\n", result.name.c_str(), result.skipMessage.c_str());
+		} else {
+			fprintf(stdout, "%-48s %12.1f ns %12" PRIu64 " iterations", result.name.c_str(), result.median,
+					result.iterations);
+			if (result.itemsPerSecond > 0.0) {
+				fprintf(stdout, " %10.2fM items/s", result.itemsPerSecond / 1000000.0);
+			}
+			fprintf(stdout, "\n");
+		}
+		fflush(stdout);
+		results.push_back(result);
+	}
+
+	if (!jsonOutput.empty() && !list) {
+		std::FILE* file = fopen(jsonOutput.c_str(), "w");
+		if (file == NULL) {
+			fprintf(stderr, "%s: failed to open \"%s\"\n", argv[0], jsonOutput.c_str());
+			exit(EXIT_FAILURE);
+		}
+		WriteJson(file, results, minTime, repetitions);
+		fclose(file);
+	}
+
+	return EXIT_SUCCESS;
+}
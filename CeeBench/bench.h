@@ -0,0 +1,66 @@
+#ifndef CEE_BENCH_BENCH_H
+#define CEE_BENCH_BENCH_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// A small self contained benchmark harness. Each benchmark runs its loop for
+// GetIterations() iterations, the harness picks the iteration count so a run lasts
+// at least --min-time and reports the median time per iteration over several runs.
+
+class BenchState {
+public:
+	BenchState(uint64_t iterations, int64_t arg);
+	BenchState(const BenchState&) = delete;
+	~BenchState() = default;
+
+	BenchState& operator=(const BenchState&) = delete;
+
+	uint64_t GetIterations() const { return m_Iterations; }
+	// The argument the benchmark was registered with, 0 if it has none.
+	int64_t GetArg() const { return m_Arg; }
+
+	// Work done per iteration, e.g. vertices written, reported as items per second.
+	void SetItemsPerIteration(uint64_t items) { m_ItemsPerIteration = items; }
+	uint64_t GetItemsPerIteration() const { return m_ItemsPerIteration; }
+
+	// Stops the benchmark, the message is reported instead of a time.
+	void Skip(const std::string& message) { m_SkipMessage = message; }
+	const std::string& GetSkipMessage() const { return m_SkipMessage; }
+
+private:
+	uint64_t m_Iterations;
+	int64_t m_Arg;
+	uint64_t m_ItemsPerIteration;
+	std::string m_SkipMessage;
+};
+
+typedef void(*BenchFunction)(BenchState&);
+
+// Returns a dummy value so it can initialise a static at namespace scope.
+int RegisterBenchmark(const char* name, BenchFunction function, std::vector<int64_t> args = {});
+
+// Registers function once, or once per argument if any are given.
+#define CEE_BENCHMARK(function, ...) \
+	static int s_Benchmark_##function = RegisterBenchmark(#function, function, { __VA_ARGS__ })
+
+// Root given with --assets, empty to use the AssetManager default.
+const std::filesystem::path& GetBenchAssetRoot();
+
+// While set, engine warnings and errors are dropped instead of printed to stderr.
+void SetDiscardMessages(bool discard);
+
+// Keeps the compiler from discarding a value, or the computation producing it.
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Forces writes to memory to be treated as observed.
+inline void ClobberMemory() {
+	asm volatile("" : : : "memory");
+}
+
+#endif
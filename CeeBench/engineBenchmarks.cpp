@@ -0,0 +1,257 @@
+#include "bench.h"
+
+#include <CeeEngine/assetManager.h>
+#include <CeeEngine/batchBuilder.h>
+#include <CeeEngine/debugMessenger.h>
+#include <CeeEngine/event.h>
+#include <CeeEngine/frustum.h>
+#include <CeeEngine/input.h>
+#include <CeeEngine/messageBus.h>
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Primitive counts match the default benchmark scenarios of CeeEditor.
+
+static void BM_ConstructTransformMatrix2D(BenchState& state) {
+	glm::vec3 translation = { 0.5f, -0.25f, 0.0f };
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		glm::mat4 transform = cee::ConstructTransformMatrix2D(translation, i * 0.001f, { 0.1f, 0.1f, 1.0f });
+		DoNotOptimize(transform);
+	}
+}
+CEE_BENCHMARK(BM_ConstructTransformMatrix2D);
+
+static void BM_ConstructTransformMatrix3D(BenchState& state) {
+	glm::vec3 translation = { 1.0f, 2.0f, -10.0f };
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		glm::mat4 transform = cee::ConstructTransformMatrix3D(translation, i * 0.001f, { 0.0f, 1.0f, 0.0f },
+															  { 1.0f, 1.0f, 1.0f });
+		DoNotOptimize(transform);
+	}
+}
+CEE_BENCHMARK(BM_ConstructTransformMatrix3D);
+
+// One Renderer2D::DrawQuad() per quad, without the batch upload.
+static void BM_BuildQuadVertices(BenchState& state) {
+	uint32_t quadCount = (uint32_t)state.GetArg();
+	std::vector<cee::Vertex2D> vertices(quadCount * CEE_QUAD_VERTEX_COUNT);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		for (uint32_t q = 0; q < quadCount; q++) {
+			cee::BuildQuadVertices({ q * 0.01f, 0.0f, 0.0f }, q * 0.1f, { 0.01f, 0.01f, 1.0f },
+								   { 1.0f, 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 1.0f }, 0,
+								   &vertices[q * CEE_QUAD_VERTEX_COUNT]);
+		}
+		ClobberMemory();
+	}
+	state.SetItemsPerIteration(quadCount);
+}
+CEE_BENCHMARK(BM_BuildQuadVertices, 1, 1024);
+
+// One Renderer2D::DrawQuads() of rotating particles, without the batch upload.
+static void BM_BuildQuadVertexBatch(BenchState& state) {
+	size_t quadCount = (size_t)state.GetArg();
+	std::vector<float> x(quadCount), y(quadCount), rotation(quadCount), scale(quadCount, 0.01f);
+	std::vector<glm::vec4> color(quadCount, { 1.0f, 1.0f, 1.0f, 1.0f });
+	for (size_t q = 0; q < quadCount; q++) {
+		x[q] = q * 0.01f;
+		rotation[q] = q * 0.1f;
+	}
+	cee::QuadInstances quads = { x.data(), y.data(), NULL, rotation.data(), scale.data(), scale.data(),
+								 color.data(), quadCount };
+	std::vector<cee::Vertex2D> vertices(quadCount * CEE_QUAD_VERTEX_COUNT);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		cee::BuildQuadVertexBatch(quads, 0, quadCount, { 0.0f, 0.0f }, { 1.0f, 1.0f }, 0, vertices.data());
+		ClobberMemory();
+	}
+	state.SetItemsPerIteration(quadCount);
+}
+CEE_BENCHMARK(BM_BuildQuadVertexBatch, 1024, 100000);
+
+static void BM_BuildQuadIndices(BenchState& state) {
+	uint32_t quadCount = (uint32_t)state.GetArg();
+	std::vector<uint32_t> indices(quadCount * CEE_QUAD_INDEX_COUNT);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		cee::BuildQuadIndices(quadCount, indices.data());
+		ClobberMemory();
+	}
+	state.SetItemsPerIteration(quadCount);
+}
+CEE_BENCHMARK(BM_BuildQuadIndices, 1666);
+
+// One Renderer3D::DrawCube() per cube, without the batch upload.
+static void BM_BuildCubeVertices(BenchState& state) {
+	uint32_t cubeCount = (uint32_t)state.GetArg();
+	std::vector<cee::Vertex3D> vertices(cubeCount * CEE_CUBE_VERTEX_COUNT);
+	std::vector<uint32_t> indices(cubeCount * CEE_CUBE_INDEX_COUNT);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		for (uint32_t c = 0; c < cubeCount; c++) {
+			cee::BuildCubeVertices({ c * 3.0f, 0.0f, -10.0f }, c * 0.1f, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 1.0f },
+								   { 1.0f, 1.0f, 1.0f, 1.0f }, 0, c * CEE_CUBE_VERTEX_COUNT,
+								   &vertices[c * CEE_CUBE_VERTEX_COUNT], &indices[c * CEE_CUBE_INDEX_COUNT]);
+		}
+		ClobberMemory();
+	}
+	state.SetItemsPerIteration(cubeCount);
+}
+CEE_BENCHMARK(BM_BuildCubeVertices, 1, 256);
+
+// The frustum test Renderer3D::DrawCube() makes before building the vertices, for a
+// ring of cubes around the camera of which about a sixth is visible.
+static void BM_FrustumCullSpheres(BenchState& state) {
+	uint32_t cubeCount = (uint32_t)state.GetArg();
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.778f, 0.001f, 256.0f);
+	cee::Frustum frustum(projection);
+	std::vector<glm::vec3> centers(cubeCount);
+	for (uint32_t c = 0; c < cubeCount; c++) {
+		float angle = c * 6.2831853f / cubeCount;
+		centers[c] = { sinf(angle) * 20.0f, 0.0f, -cosf(angle) * 20.0f };
+	}
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		uint32_t visible = 0;
+		for (uint32_t c = 0; c < cubeCount; c++) {
+			visible += frustum.IntersectsSphere(centers[c], 1.732f);
+		}
+		DoNotOptimize(visible);
+	}
+	state.SetItemsPerIteration(cubeCount);
+}
+CEE_BENCHMARK(BM_FrustumCullSpheres, 256, 16384);
+
+// The extra pass Renderer2D and Renderer3D make with RendererSpec::packedVertices.
+static void BM_PackVertices2D(BenchState& state) {
+	size_t vertexCount = (size_t)state.GetArg();
+	std::vector<cee::Vertex2D> vertices(vertexCount, { { 1.0f, 2.0f, 0.0f, 1.0f }, { 1.0f, 0.5f, 0.25f, 1.0f },
+													   { 0.5f, 0.5f }, 0 });
+	std::vector<cee::Vertex2DPacked> packed(vertexCount);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		cee::PackVertices(vertices.data(), vertexCount, packed.data());
+		ClobberMemory();
+	}
+	state.SetItemsPerIteration(vertexCount);
+}
+CEE_BENCHMARK(BM_PackVertices2D, 4096);
+
+static void BM_PackVertices3D(BenchState& state) {
+	size_t vertexCount = (size_t)state.GetArg();
+	std::vector<cee::Vertex3D> vertices(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		float angle = v * 0.1f;
+		vertices[v] = { { v * 0.01f, 0.0f, -10.0f, 1.0f }, { sinf(angle), 0.0f, -cosf(angle) },
+						{ 1.0f, 0.5f, 0.25f, 1.0f }, { 0.5f, 0.5f }, 0 };
+	}
+	std::vector<cee::Vertex3DPacked> packed(vertexCount);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		cee::PackVertices(vertices.data(), vertexCount, packed.data());
+		ClobberMemory();
+	}
+	state.SetItemsPerIteration(vertexCount);
+}
+CEE_BENCHMARK(BM_PackVertices3D, 4096);
+
+// Posts 16 events and dispatches them to GetArg() handlers, like a frame of window events.
+static void BM_MessageBusDispatch(BenchState& state) {
+	cee::MessageBus messageBus;
+	uint64_t handled = 0;
+	for (int64_t h = 0; h < state.GetArg(); h++) {
+		messageBus.RegisterMessageHandler([&handled](cee::Event& e) {
+			if (e.GetEventType() == cee::EventType::AppTick) {
+				handled++;
+			}
+		});
+	}
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		for (uint32_t e = 0; e < 16; e++) {
+			messageBus.PostMessage(new cee::AppTickEvent());
+		}
+		messageBus.DispatchEvents();
+	}
+	DoNotOptimize(handled);
+	state.SetItemsPerIteration(16);
+}
+CEE_BENCHMARK(BM_MessageBusDispatch, 1, 8, 64);
+
+static void BM_MessageBusImmediate(BenchState& state) {
+	cee::MessageBus messageBus;
+	uint64_t handled = 0;
+	for (int64_t h = 0; h < state.GetArg(); h++) {
+		messageBus.RegisterMessageHandler([&handled](cee::Event&) { handled++; });
+	}
+	cee::AppTickEvent event;
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		messageBus.PostMessageImmedate(&event);
+	}
+	DoNotOptimize(handled);
+}
+CEE_BENCHMARK(BM_MessageBusImmediate, 1, 8, 64);
+
+// The lookup Input does for every key event, over mapped and unmapped keysyms.
+static void BM_InputTranslateKeysym(BenchState& state) {
+	static const uint32_t keysyms[] = {
+		'a', 'w', 's', 'd', ' ', '1', 0xff1b /* Escape */, 0xff0d /* Return */, 0xffe1 /* Shift_L */,
+		0xff51 /* Left */, 0xffbe /* F1 */, 0x1008ff13 /* XF86AudioRaiseVolume, not mapped */
+	};
+	// Fills the key map outside the measurement.
+	cee::Input::TranslateKeysym(keysyms[0]);
+	uint32_t keysymCount = sizeof(keysyms) / sizeof(keysyms[0]);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		for (uint32_t k = 0; k < keysymCount; k++) {
+			cee::KeyCode keyCode = cee::Input::TranslateKeysym(keysyms[k]);
+			DoNotOptimize(keyCode);
+		}
+	}
+	state.SetItemsPerIteration(keysymCount);
+}
+CEE_BENCHMARK(BM_InputTranslateKeysym);
+
+// Formatting only, the sink discards the messages. 0 fits the stack buffer, 1 does not.
+static void BM_DebugMessengerFormat(BenchState& state) {
+	std::string longArgument(state.GetArg() == 0 ? 16 : 512, 'x');
+	SetDiscardMessages(true);
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		cee::DebugMessenger::PostDebugMessage(cee::ERROR_SEVERITY_WARNING, "Frame %llu took %.3fms in \"%s\".",
+											  (unsigned long long)i, i * 0.5, longArgument.c_str());
+	}
+	SetDiscardMessages(false);
+}
+CEE_BENCHMARK(BM_DebugMessengerFormat, 0, 1);
+
+// Severities that are not reported return before formatting.
+static void BM_DebugMessengerFiltered(BenchState& state) {
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		cee::DebugMessenger::PostDebugMessage(cee::ERROR_SEVERITY_DEBUG, "Frame %llu took %.3fms.",
+											  (unsigned long long)i, i * 0.5);
+	}
+}
+CEE_BENCHMARK(BM_DebugMessengerFiltered);
+
+// Decodes a 1024x1024 skybox face.
+static void BM_AssetManagerLoadImage(BenchState& state) {
+	cee::AssetManager assetManager(GetBenchAssetRoot());
+	const char* path = "textures/elyvisions/sh_ft.png";
+	if (!assetManager.Exists(assetManager.GetAssetRoot() / path)) {
+		state.Skip("asset not found, pass --assets");
+		return;
+	}
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		std::shared_ptr<cee::Image> image = assetManager.LoadAsset<cee::Image>(path);
+		DoNotOptimize(image->pixels);
+		free(image->pixels);
+	}
+}
+CEE_BENCHMARK(BM_AssetManagerLoadImage);
+
+static void BM_AssetManagerLoadShaderBinary(BenchState& state) {
+	cee::AssetManager assetManager(GetBenchAssetRoot());
+	const char* path = "shaders/renderer3DBasicVertex.spv";
+	if (!assetManager.Exists(assetManager.GetAssetRoot() / path)) {
+		state.Skip("asset not found, pass --assets");
+		return;
+	}
+	for (uint64_t i = 0; i < state.GetIterations(); i++) {
+		std::shared_ptr<cee::ShaderBinary> binary = assetManager.LoadAsset<cee::ShaderBinary>(path);
+		DoNotOptimize(binary->spvCode.data());
+	}
+}
+CEE_BENCHMARK(BM_AssetManagerLoadShaderBinary);
@@ -0,0 +1,299 @@
+#include "benchmark.h"
+
+#include <CeeEngine/renderer2D.h>
+#include <CeeEngine/renderer3D.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Frames between two resizes of the resize scenario.
+#define BENCHMARK_RESIZE_INTERVAL 8
+
+struct BenchmarkScenarioInfo {
+	const char* name;
+	cee::RendererMode rendererMode;
+	uint32_t defaultCount;
+	// Indices each primitive adds to the batch.
+	uint32_t indicesPerPrimitive;
+};
+
+static const BenchmarkScenarioInfo s_Scenarios[BENCHMARK_SCENARIO_COUNT] = {
+	{ "cubes", cee::RENDERER_MODE_3D, 256, CEE_CUBE_INDEX_COUNT },
+	{ "quads", cee::RENDERER_MODE_2D, 1024, CEE_QUAD_INDEX_COUNT },
+	{ "textures", cee::RENDERER_MODE_3D, 256, CEE_CUBE_INDEX_COUNT },
+	{ "resize", cee::RENDERER_MODE_3D, 256, CEE_CUBE_INDEX_COUNT },
+	{ "particles", cee::RENDERER_MODE_2D, 100000, CEE_QUAD_INDEX_COUNT }
+};
+
+static const char* s_TextureSets[] = {
+	"arch3", "cave3", "dark", "hot", "rainbow", "sh", "skyast", "skyhsky", "skype", "sp2", "sp3", "tron"
+};
+static const char* s_TextureFaces[] = {
+	"ft", "bk", "up", "dn", "rt", "lf"
+};
+
+static const VkExtent2D s_ResizeExtents[] = {
+	{ 1280, 720 },
+	{ 1920, 1080 },
+	{ 960, 540 },
+	{ 1600, 900 },
+	{ 640, 360 }
+};
+
+bool ParseBenchmarkScenario(const char* name, BenchmarkScenario* scenario) {
+	for (uint32_t i = 0; i < BENCHMARK_SCENARIO_COUNT; i++) {
+		if (strcmp(name, s_Scenarios[i].name) == 0) {
+			*scenario = (BenchmarkScenario)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* GetBenchmarkScenarioName(BenchmarkScenario scenario) {
+	return s_Scenarios[scenario].name;
+}
+
+cee::RendererMode GetBenchmarkRendererMode(BenchmarkScenario scenario) {
+	return s_Scenarios[scenario].rendererMode;
+}
+
+BenchmarkLayer::BenchmarkLayer(const BenchmarkSpec& spec)
+: m_Spec(spec), m_PerspectiveCamera(60.0f, 1.77778f, 0.1f, 256.0f),
+  m_OrthographicCamera(1.0f, 1.77778f, -1.0f, 1.0f), m_Frame(0), m_Time(0.0f),
+  m_LastGpuFrame(UINT64_MAX), m_StatisticsFrames(0), m_Statistics({}), m_Resizes(0)
+{
+	if (m_Spec.count == 0) {
+		m_Spec.count = s_Scenarios[m_Spec.scenario].defaultCount;
+	}
+}
+
+BenchmarkLayer::~BenchmarkLayer()
+{
+}
+
+uint32_t BenchmarkLayer::GetMaxIndices() const
+{
+	return m_Spec.count * s_Scenarios[m_Spec.scenario].indicesPerPrimitive;
+}
+
+void BenchmarkLayer::OnAttach()
+{
+	if (m_Spec.scenario == BENCHMARK_SCENARIO_PARTICLES) {
+		// Scattered over the orthographic view with a fixed seed.
+		srand(1);
+		for (uint32_t i = 0; i < m_Spec.count; i++) {
+			m_ParticleX.push_back((rand() / (float)RAND_MAX * 2.0f - 1.0f) * 1.77778f);
+			m_ParticleY.push_back(rand() / (float)RAND_MAX * 2.0f - 1.0f);
+			m_ParticleRotation.push_back(0.0f);
+			m_ParticleScale.push_back(0.005f + 0.01f * (rand() / (float)RAND_MAX));
+			m_ParticleColor.push_back({ rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, 1.0f, 1.0f });
+		}
+		return;
+	}
+	if (m_Spec.scenario != BENCHMARK_SCENARIO_TEXTURES) {
+		return;
+	}
+	cee::TextureStreamer& streamer = cee::Renderer3D::GetTextureStreamer();
+	for (const char* set : s_TextureSets) {
+		for (const char* face : s_TextureFaces) {
+			std::string path = std::string("textures/elyvisions/") + set + "_" + face + ".png";
+			m_Textures.push_back(streamer.Load(path));
+		}
+	}
+}
+
+void BenchmarkLayer::OnDetach()
+{
+	if (m_Textures.empty()) {
+		return;
+	}
+	cee::TextureStreamer& streamer = cee::Renderer3D::GetTextureStreamer();
+	for (auto handle : m_Textures) {
+		streamer.Release(handle);
+	}
+	m_Textures.clear();
+}
+
+void BenchmarkLayer::OnUpdate(cee::Timestep t)
+{
+	// t is the duration of the previous frame.
+	uint64_t frameTime = (uint64_t)t.sec * 1000000000 + t.nsec;
+	if (m_Frame > m_Spec.warmup && m_Frame <= m_Spec.warmup + m_Spec.frames) {
+		m_FrameTimes.Record(frameTime);
+	}
+	m_Time += frameTime / 1000000000.0f;
+
+	cee::Renderer* renderer = cee::Renderer::Get();
+	const cee::GpuFrameTimings& gpuTimings = renderer->GetGpuFrameTimings();
+	if (!gpuTimings.zones.empty() && gpuTimings.frameNumber != m_LastGpuFrame &&
+		gpuTimings.frameNumber >= m_Spec.warmup && gpuTimings.frameNumber < m_Spec.warmup + m_Spec.frames)
+	{
+		m_GpuFrameTimes.Record((uint64_t)(gpuTimings.GetMilliseconds("Frame") * 1000000.0));
+		m_LastGpuFrame = gpuTimings.frameNumber;
+	}
+
+	if (m_Spec.scenario == BENCHMARK_SCENARIO_RESIZE && m_Frame != 0 && m_Frame % BENCHMARK_RESIZE_INTERVAL == 0) {
+		const VkExtent2D& extent = s_ResizeExtents[m_Resizes % (sizeof(s_ResizeExtents) / sizeof(s_ResizeExtents[0]))];
+		renderer->Resize(extent.width, extent.height);
+		m_Resizes++;
+	}
+
+	if (GetBenchmarkRendererMode(m_Spec.scenario) == cee::RENDERER_MODE_2D) {
+		cee::Renderer2D::UpdateCamera(m_OrthographicCamera);
+	} else {
+		cee::Renderer3D::UpdateCamera(m_PerspectiveCamera);
+	}
+	m_Frame++;
+}
+
+void BenchmarkLayer::OnRender()
+{
+	switch (m_Spec.scenario) {
+	case BENCHMARK_SCENARIO_CUBES:
+	case BENCHMARK_SCENARIO_RESIZE:
+		DrawCubes(false);
+		break;
+	case BENCHMARK_SCENARIO_TEXTURES:
+		DrawCubes(true);
+		break;
+	case BENCHMARK_SCENARIO_QUADS:
+		DrawQuads();
+		break;
+	case BENCHMARK_SCENARIO_PARTICLES:
+		DrawParticles();
+		break;
+	default:
+		break;
+	}
+}
+
+void BenchmarkLayer::DrawCubes(bool textured)
+{
+	// A grid in front of the camera, one cube per cell.
+	uint32_t side = (uint32_t)std::ceil(std::cbrt((double)m_Spec.count));
+	float offset = (side - 1) * 1.5f;
+	cee::TextureStreamer* streamer = textured ? &cee::Renderer3D::GetTextureStreamer() : nullptr;
+	for (uint32_t i = 0; i < m_Spec.count; i++) {
+		uint32_t x = i % side;
+		uint32_t y = (i / side) % side;
+		uint32_t z = i / (side * side);
+		glm::vec3 translation = { x * 3.0f - offset, y * 3.0f - offset, -10.0f - 2.0f * offset - z * 3.0f };
+
+		cee::TextureHandle texture = CEE_INVALID_TEXTURE_HANDLE;
+		if (streamer != nullptr) {
+			texture = streamer->GetTextureIndex(m_Textures[i % m_Textures.size()]);
+		}
+		cee::Renderer3D::DrawCube(translation,
+								  m_Time + i * 0.1f,
+								  { 0.0f, 1.0f, 0.0f },
+								  { 1.0f, 1.0f, 1.0f },
+								  { 1.0f, 1.0f, 1.0f, 1.0f },
+								  texture);
+	}
+}
+
+void BenchmarkLayer::DrawQuads()
+{
+	// A grid covering the orthographic view, one quad per cell.
+	uint32_t side = (uint32_t)std::ceil(std::sqrt((double)m_Spec.count));
+	float width = 2.0f * 1.77778f / side;
+	float height = 2.0f / side;
+	for (uint32_t i = 0; i < m_Spec.count; i++) {
+		uint32_t x = i % side;
+		uint32_t y = i / side;
+		glm::vec3 translation = { -1.77778f + (x + 0.5f) * width, -1.0f + (y + 0.5f) * height, 0.0f };
+		glm::vec4 color = { (float)x / side, (float)y / side, 1.0f, 1.0f };
+		cee::Renderer2D::DrawQuad(translation, m_Time + i * 0.1f, { width * 0.8f, height * 0.8f, 1.0f }, color);
+	}
+}
+
+void BenchmarkLayer::DrawParticles()
+{
+	for (uint32_t i = 0; i < m_Spec.count; i++) {
+		m_ParticleRotation[i] = m_Time + i * 0.1f;
+	}
+	cee::QuadInstances quads = {};
+	quads.translationX = m_ParticleX.data();
+	quads.translationY = m_ParticleY.data();
+	quads.rotationAngle = m_ParticleRotation.data();
+	quads.scaleX = m_ParticleScale.data();
+	quads.scaleY = m_ParticleScale.data();
+	quads.color = m_ParticleColor.data();
+	quads.count = m_Spec.count;
+	cee::Renderer2D::DrawQuads(quads);
+}
+
+void BenchmarkLayer::OnGui()
+{
+}
+
+void BenchmarkLayer::OnEnable()
+{
+}
+
+void BenchmarkLayer::OnDisable()
+{
+}
+
+void BenchmarkLayer::MessageHandler(cee::Event& e)
+{
+	if (e.GetEventType() != cee::EventType::RendererStatistics) {
+		return;
+	}
+	const cee::RendererStatistics& statistics = static_cast<cee::RendererStatisticsEvent&>(e).GetStatistics();
+	if (statistics.frameNumber < m_Spec.warmup || statistics.frameNumber >= m_Spec.warmup + m_Spec.frames) {
+		return;
+	}
+	m_Statistics.drawCalls += statistics.drawCalls;
+	m_Statistics.instances += statistics.instances;
+	m_Statistics.triangles += statistics.triangles;
+	m_Statistics.vertices += statistics.vertices;
+	m_Statistics.uploadedBytes += statistics.uploadedBytes;
+	m_Statistics.commandBuffersAllocated += statistics.commandBuffersAllocated;
+	m_Statistics.descriptorWrites += statistics.descriptorWrites;
+	m_Statistics.pipelineBinds += statistics.pipelineBinds;
+	m_StatisticsFrames++;
+}
+
+static void WriteSummary(std::FILE* file, const char* name, const cee::FrameTimeHistogram& histogram) {
+	cee::FrameTimeSummary summary = histogram.Summarize();
+	fprintf(file, "  \"%s\": { \"count\": %" PRIu64 ", \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, "
+			"\"p99\": %.4f, \"max\": %.4f },\n", name, summary.count, summary.mean / 1000000.0,
+			summary.p50 / 1000000.0, summary.p95 / 1000000.0, summary.p99 / 1000000.0, summary.max / 1000000.0);
+}
+
+void BenchmarkLayer::WriteResults(std::FILE* file) const
+{
+	cee::Renderer* renderer = cee::Renderer::Get();
+	VkExtent2D extent = renderer->GetSwapchainExtent();
+	double frames = m_StatisticsFrames == 0 ? 1.0 : (double)m_StatisticsFrames;
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"scenario\": \"%s\",\n", GetBenchmarkScenarioName(m_Spec.scenario));
+	fprintf(file, "  \"count\": %u,\n", m_Spec.count);
+	fprintf(file, "  \"warmup\": %" PRIu64 ",\n", m_Spec.warmup);
+	fprintf(file, "  \"frames\": %" PRIu64 ",\n", m_Spec.frames);
+	fprintf(file, "  \"headless\": %s,\n", renderer->IsHeadless() ? "true" : "false");
+	fprintf(file, "  \"width\": %u,\n", extent.width);
+	fprintf(file, "  \"height\": %u,\n", extent.height);
+	fprintf(file, "  \"resizes\": %u,\n", m_Resizes);
+	WriteSummary(file, "frame_ms", m_FrameTimes);
+	// GPU timings resolve a few frames late, the last measured frames may be missing.
+	WriteSummary(file, "gpu_frame_ms", m_GpuFrameTimes);
+	fprintf(file, "  \"per_frame\": {\n");
+	fprintf(file, "    \"frames\": %" PRIu64 ",\n", m_StatisticsFrames);
+	fprintf(file, "    \"draw_calls\": %.2f,\n", m_Statistics.drawCalls / frames);
+	fprintf(file, "    \"instances\": %.2f,\n", m_Statistics.instances / frames);
+	fprintf(file, "    \"triangles\": %.2f,\n", m_Statistics.triangles / frames);
+	fprintf(file, "    \"vertices\": %.2f,\n", m_Statistics.vertices / frames);
+	fprintf(file, "    \"uploaded_bytes\": %.2f,\n", m_Statistics.uploadedBytes / frames);
+	fprintf(file, "    \"command_buffers_allocated\": %.2f,\n", m_Statistics.commandBuffersAllocated / frames);
+	fprintf(file, "    \"descriptor_writes\": %.2f,\n", m_Statistics.descriptorWrites / frames);
+	fprintf(file, "    \"pipeline_binds\": %.2f\n", m_Statistics.pipelineBinds / frames);
+	fprintf(file, "  }\n");
+	fprintf(file, "}\n");
+}
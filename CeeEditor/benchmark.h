@@ -0,0 +1,106 @@
+#ifndef CEE_EDITOR_BENCHMARK_H
+#define CEE_EDITOR_BENCHMARK_H
+
+#include <CeeEngine/application.h>
+#include <CeeEngine/camera.h>
+#include <CeeEngine/frameTimer.h>
+#include <CeeEngine/rendererStatistics.h>
+#include <CeeEngine/textureStreamer.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+enum BenchmarkScenario {
+	// count cubes through Renderer3D::DrawCube.
+	BENCHMARK_SCENARIO_CUBES = 0,
+	// count quads through Renderer2D::DrawQuad.
+	BENCHMARK_SCENARIO_QUADS,
+	// count cubes cycling through every streamed skybox face texture.
+	BENCHMARK_SCENARIO_TEXTURES,
+	// count cubes while the render targets change size every few frames.
+	BENCHMARK_SCENARIO_RESIZE,
+	// count rotating quads through a single Renderer2D::DrawQuads() call.
+	BENCHMARK_SCENARIO_PARTICLES,
+	BENCHMARK_SCENARIO_COUNT
+};
+
+struct BenchmarkSpec {
+	BenchmarkScenario scenario = BENCHMARK_SCENARIO_CUBES;
+	// Primitives drawn per frame, 0 picks the scenario default.
+	uint32_t count = 0;
+	// Frames measured after the warmup.
+	uint64_t frames = 1000;
+	// Frames rendered first and left out of the results, so pipelines, caches and
+	// streamed textures have settled.
+	uint64_t warmup = 100;
+};
+
+// Returns false if name is not a scenario.
+bool ParseBenchmarkScenario(const char* name, BenchmarkScenario* scenario);
+const char* GetBenchmarkScenarioName(BenchmarkScenario scenario);
+// The renderer the scenario draws with.
+cee::RendererMode GetBenchmarkRendererMode(BenchmarkScenario scenario);
+
+// Draws a scripted scene and measures the frames after the warmup. Application::Run
+// passes OnUpdate() the duration of the previous frame, so the application has to run
+// GetFrameLimit() frames for every measured frame to be seen.
+class BenchmarkLayer : public cee::Layer {
+public:
+	BenchmarkLayer(const BenchmarkSpec& spec);
+	BenchmarkLayer(const BenchmarkLayer&) = delete;
+	~BenchmarkLayer();
+
+	BenchmarkLayer& operator=(const BenchmarkLayer&) = delete;
+
+	void OnAttach() override;
+	void OnDetach() override;
+
+	void OnUpdate(cee::Timestep t) override;
+	void OnRender() override;
+	void OnGui() override;
+
+	void OnEnable() override;
+	void OnDisable() override;
+
+	void MessageHandler(cee::Event& e) override;
+
+	uint64_t GetFrameLimit() const { return m_Spec.warmup + m_Spec.frames + 1; }
+	// Batch size the scenario needs, see ApplicationSpec::MaxIndices.
+	uint32_t GetMaxIndices() const;
+	// Writes the results as a single JSON object.
+	void WriteResults(std::FILE* file) const;
+
+private:
+	void DrawCubes(bool textured);
+	void DrawQuads();
+	void DrawParticles();
+
+private:
+	BenchmarkSpec m_Spec;
+	cee::PerspectiveCamera m_PerspectiveCamera;
+	cee::OrthographicCamera m_OrthographicCamera;
+
+	// Frames started so far, including the warmup.
+	uint64_t m_Frame;
+	float m_Time;
+
+	cee::FrameTimeHistogram m_FrameTimes;
+	cee::FrameTimeHistogram m_GpuFrameTimes;
+	uint64_t m_LastGpuFrame;
+
+	// Summed over the measured frames.
+	uint64_t m_StatisticsFrames;
+	cee::RendererStatistics m_Statistics;
+
+	std::vector<cee::StreamedTextureHandle> m_Textures;
+	// Particle attributes, one array each for DrawQuads().
+	std::vector<float> m_ParticleX;
+	std::vector<float> m_ParticleY;
+	std::vector<float> m_ParticleRotation;
+	std::vector<float> m_ParticleScale;
+	std::vector<glm::vec4> m_ParticleColor;
+	uint32_t m_Resizes;
+};
+
+#endif
@@ -4,6 +4,9 @@
 #include <CeeEngine/application.h>
 #include <CeeEngine/renderer3D.h>
 #include <CeeEngine/camera.h>
+#include <CeeEngine/frameCapture.h>
+
+#include "benchmark.h"
 
 #include <cstdlib>
 #include <locale.h>
@@ -13,6 +16,8 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/transform.hpp>
 #include <chrono>
+#include <memory>
+#include <string>
 
 #ifndef NDEBUG
 #include "mcheck.h"
@@ -24,7 +29,24 @@ static void PrintUsage(const char* command) {
 		 "-h, --help       help\n"
 		 "    --version    print current version\n"
 		 "-v, --verbose    show all messages\n"
-		 "-V, --validation enable validation layers\n",
+		 "-V, --validation enable validation layers\n"
+		 "    --hot-reload rebuild pipelines when shader sources change\n"
+		 "    --headless   render offscreen without opening a window\n"
+		 "    --frames=N   exit after N frames\n"
+		 "    --capture=DIR write every frame to DIR as PNG\n"
+		 "    --pipeline-statistics collect pipeline statistics queries per pass\n"
+		 "    --frame-report=FILE write frame time percentiles to FILE as CSV\n"
+		 "    --packed-vertices batch quantized half size vertices\n"
+		 "    --gpu-culling cull meshes and select their detail in a compute pass\n"
+		 "    --occlusion-culling also cull meshes hidden in the last frame's depth,\n"
+		 "                 implies --gpu-culling\n"
+		 "\n"
+		 "    --benchmark=SCENARIO draw a scripted scene and print the results as JSON,\n"
+		 "                 one of cubes, quads, textures, resize or particles\n"
+		 "    --count=N    primitives drawn per frame by the benchmark\n"
+		 "    --warmup=N   frames rendered before the benchmark measures (default 100)\n"
+		 "                 --frames sets the frames measured (default 1000)\n"
+		 "    --benchmark-output=FILE write the benchmark results to FILE instead of stdout\n",
 		 command);
 }
 
@@ -33,7 +55,20 @@ static void PrintVersion(const char* command) {
 }
 
 enum {
-	OPT_VERSION = 1
+	OPT_VERSION = 1,
+	OPT_HOT_RELOAD,
+	OPT_HEADLESS,
+	OPT_FRAMES,
+	OPT_CAPTURE,
+	OPT_PIPELINE_STATISTICS,
+	OPT_FRAME_REPORT,
+	OPT_BENCHMARK,
+	OPT_COUNT,
+	OPT_WARMUP,
+	OPT_BENCHMARK_OUTPUT,
+	OPT_PACKED_VERTICES,
+	OPT_GPU_CULLING,
+	OPT_OCCLUSION_CULLING
 };
 
 static const char shortOptions[] = "hvV";
@@ -41,12 +76,26 @@ static const option longOptions[] = {
 	{ "help", 0, 0, 'h' },
 	{ "version", 0, 0, OPT_VERSION },
 	{ "verbose", 0, 0, 'v' },
-	{ "validation", 0, 0, 'V' }
+	{ "validation", 0, 0, 'V' },
+	{ "hot-reload", 0, 0, OPT_HOT_RELOAD },
+	{ "headless", 0, 0, OPT_HEADLESS },
+	{ "frames", 1, 0, OPT_FRAMES },
+	{ "capture", 1, 0, OPT_CAPTURE },
+	{ "pipeline-statistics", 0, 0, OPT_PIPELINE_STATISTICS },
+	{ "frame-report", 1, 0, OPT_FRAME_REPORT },
+	{ "benchmark", 1, 0, OPT_BENCHMARK },
+	{ "count", 1, 0, OPT_COUNT },
+	{ "warmup", 1, 0, OPT_WARMUP },
+	{ "benchmark-output", 1, 0, OPT_BENCHMARK_OUTPUT },
+	{ "packed-vertices", 0, 0, OPT_PACKED_VERTICES },
+	{ "gpu-culling", 0, 0, OPT_GPU_CULLING },
+	{ "occlusion-culling", 0, 0, OPT_OCCLUSION_CULLING },
+	{ 0, 0, 0, 0 }
 };
 
 class GameLayer : public cee::Layer {
 public:
-	GameLayer();
+	GameLayer(const std::string& captureDirectory);
 	~GameLayer();
 
 	void OnAttach() override;
@@ -63,11 +112,15 @@ public:
 
 private:
 	cee::PerspectiveCamera m_Camera;
+	std::unique_ptr<cee::FrameCapture> m_FrameCapture;
 };
 
-GameLayer::GameLayer::GameLayer()
+GameLayer::GameLayer::GameLayer(const std::string& captureDirectory)
 : m_Camera(60.0f, 1.77778, 0.001f, 256.0f)
 {
+	if (!captureDirectory.empty()) {
+		m_FrameCapture = std::make_unique<cee::FrameCapture>(captureDirectory, "frame-", cee::FRAME_CAPTURE_FORMAT_PNG);
+	}
 }
 
 GameLayer::~GameLayer()
@@ -108,6 +161,10 @@ void GameLayer::OnRender() {
 							  { -1.0, -1.0, 1.0f },
 							  { 0.5f, 0.5f, 0.5f },
 							  { 1.0f, 1.0f, 1.0f, 1.0f });
+
+	if (m_FrameCapture) {
+		m_FrameCapture->CaptureFrame();
+	}
 }
 
 void GameLayer::OnGui()
@@ -135,6 +192,10 @@ int main(int argc, char **argv) {
 	cee::ApplicationSpec appSpec;
 	appSpec.messageLevels = (cee::CeeErrorSeverity)(cee::ERROR_SEVERITY_WARNING | cee::ERROR_SEVERITY_ERROR);
 	appSpec.EnableValidation = false;
+	std::string captureDirectory;
+	bool benchmark = false;
+	BenchmarkSpec benchmarkSpec;
+	std::string benchmarkOutput;
 
 	char c;
 	int32_t optionIndex;
@@ -158,6 +219,65 @@ int main(int argc, char **argv) {
 			appSpec.EnableValidation = true;
 			break;
 
+		case OPT_HOT_RELOAD:
+			appSpec.EnableShaderHotReload = true;
+			break;
+
+		case OPT_HEADLESS:
+			appSpec.Headless = true;
+			break;
+
+		case OPT_FRAMES:
+			appSpec.FrameLimit = strtoull(optarg, NULL, 10);
+			benchmarkSpec.frames = appSpec.FrameLimit;
+			break;
+
+		case OPT_CAPTURE:
+			captureDirectory = optarg;
+			break;
+
+		case OPT_PIPELINE_STATISTICS:
+			appSpec.PipelineStatistics = true;
+			break;
+
+		case OPT_FRAME_REPORT:
+			appSpec.FrameTimingReportPath = optarg;
+			break;
+
+		case OPT_BENCHMARK:
+			if (!ParseBenchmarkScenario(optarg, &benchmarkSpec.scenario)) {
+				fprintf(stderr, "Unknown benchmark scenario \"%s\"\nTry \"%s --help\" for more information.\n",
+						optarg, argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			benchmark = true;
+			break;
+
+		case OPT_COUNT:
+			benchmarkSpec.count = strtoul(optarg, NULL, 10);
+			break;
+
+		case OPT_WARMUP:
+			benchmarkSpec.warmup = strtoull(optarg, NULL, 10);
+			break;
+
+		case OPT_BENCHMARK_OUTPUT:
+			benchmarkOutput = optarg;
+			break;
+
+		case OPT_PACKED_VERTICES:
+			appSpec.PackedVertices = true;
+			break;
+
+		case OPT_GPU_CULLING:
+			appSpec.GpuCulling = true;
+			break;
+
+		case OPT_OCCLUSION_CULLING:
+			appSpec.GpuCulling = true;
+			appSpec.OcclusionCulling = true;
+			break;
+
 			default:
 			fprintf(stderr, "Unknown option \"%c\"\nTry \"%s --help\" for more information.", c, argv[0]);
 			exit(EXIT_FAILURE);
@@ -166,9 +286,40 @@ int main(int argc, char **argv) {
 
 	cee::Application* app = nullptr;
 
+	if (benchmark) {
+		appSpec.Mode = GetBenchmarkRendererMode(benchmarkSpec.scenario);
+		BenchmarkLayer* benchmarkLayer = new BenchmarkLayer(benchmarkSpec);
+		appSpec.FrameLimit = benchmarkLayer->GetFrameLimit();
+		appSpec.MaxIndices = benchmarkLayer->GetMaxIndices();
+
+		app = new cee::Application(appSpec);
+		app->PushLayer(benchmarkLayer);
+		app->Run();
+
+		// Written before the application deletes its layers.
+		int ret = EXIT_SUCCESS;
+		FILE* output = stdout;
+		if (!benchmarkOutput.empty()) {
+			output = fopen(benchmarkOutput.c_str(), "w");
+			if (output == NULL) {
+				fprintf(stderr, "Failed to open \"%s\" for the benchmark results.\n", benchmarkOutput.c_str());
+				ret = EXIT_FAILURE;
+			}
+		}
+		if (output != NULL) {
+			benchmarkLayer->WriteResults(output);
+			if (output != stdout) {
+				fclose(output);
+			}
+		}
+
+		delete app;
+		return ret;
+	}
+
 	app = new cee::Application(appSpec);
 
-	GameLayer* gameLayer = new GameLayer;
+	GameLayer* gameLayer = new GameLayer(captureDirectory);
 	app->PushLayer(gameLayer);
 	app->Run();
 
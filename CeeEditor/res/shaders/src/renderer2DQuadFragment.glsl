@@ -1,15 +1,34 @@
 #version 450 core
 
+// The renderer defines CEE_DESCRIPTOR_INDEXING when the device supports non-uniform
+// indexing into a runtime texture array, otherwise the table has CEE_MAX_TEXTURES.
+#if defined(CEE_DESCRIPTOR_INDEXING)
+#extension GL_EXT_nonuniform_qualifier : require
+#define CEE_TEXTURE_INDEX(index) nonuniformEXT(index)
+#else
+#define CEE_TEXTURE_INDEX(index) (index)
+#endif
+
 layout(location = 0) in vec4 v_Color;
 layout(location = 1) in vec2 v_TexCoords;
+layout(location = 2) flat in uint v_TexIndex;
 
 layout(location = 0) out vec4 color;
 
 layout(set = 1, binding = 0) uniform sampler u_ImageSampler;
-layout(set = 1, binding = 1) uniform texture2D u_Image;
+#if defined(CEE_DESCRIPTOR_INDEXING)
+layout(set = 1, binding = 1) uniform texture2D u_Images[];
+#else
+layout(set = 1, binding = 1) uniform texture2D u_Images[CEE_MAX_TEXTURES];
+#endif
 
+// SHADER_CONSTANT_TEXTURED, untextured materials skip the texture fetch.
+layout(constant_id = 0) const bool TEXTURED = true;
 
 void main() {
-	vec4 outColor = v_Color * texture(sampler2D(u_Image, u_ImageSampler), v_TexCoords);
+	vec4 outColor = v_Color;
+	if (TEXTURED) {
+		outColor *= texture(sampler2D(u_Images[CEE_TEXTURE_INDEX(v_TexIndex)], u_ImageSampler), v_TexCoords);
+	}
 	color = outColor;
 }
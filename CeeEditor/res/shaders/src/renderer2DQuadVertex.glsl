@@ -3,9 +3,11 @@
 layout(location = 0) in vec4 a_Position;
 layout(location = 1) in vec4 a_Color;
 layout(location = 2) in vec2 a_TexCoords;
+layout(location = 3) in uint a_TexIndex;
 
 layout(location = 0) out vec4 v_Color;
 layout(location = 1) out vec2 v_TexCoords;
+layout(location = 2) flat out uint v_TexIndex;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
 	mat4 view;
@@ -15,5 +17,6 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 void main() {
 	v_Color = a_Color;
 	v_TexCoords = a_TexCoords;
+	v_TexIndex = a_TexIndex;
 	gl_Position = a_Position * u_Ubo.view * u_Ubo.projection;
 }
@@ -0,0 +1,178 @@
+#version 450 core
+
+// One thread per mesh instance. Instances outside the frustum, or with
+// OCCLUSION_CULLING behind the previous frame's depth, are dropped. The rest select a
+// level of detail and append one indirect draw per submesh to their mesh's commands,
+// see Renderer3D::FlushMeshes().
+layout(local_size_x = 64) in;
+
+// MeshInstance, 21 floats: transform, color and texture index.
+layout(set = 0, binding = 0) readonly buffer Instances {
+	float instances[];
+};
+
+struct CullGroup {
+	vec4 center;
+	vec4 extents;
+	float lodErrors[5];
+	uint lodCount;
+	uint submeshCount;
+	uint firstInstance;
+	uint instanceCount;
+	uint firstRange;
+	uint firstCommand;
+	uint padding;
+};
+
+layout(set = 0, binding = 1) readonly buffer CullGroups {
+	CullGroup groups[];
+};
+
+// Index ranges of every level of every submesh, submeshCount per level.
+layout(set = 0, binding = 2) readonly buffer IndexRanges {
+	uvec2 ranges[];
+};
+
+// VkDrawIndexedIndirectCommand.
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+layout(set = 0, binding = 3) writeonly buffer DrawCommands {
+	DrawCommand commands[];
+};
+
+// Commands written per group, cleared before the dispatch.
+layout(set = 0, binding = 4) buffer DrawCounts {
+	uint counts[];
+};
+
+layout(push_constant) uniform CullConstants {
+	// World space, points p with dot(plane.xyz, p) + plane.w >= 0 are inside.
+	vec4 planes[6];
+	// Row of projection * view giving the clip space w.
+	vec4 depthRow;
+	// Pixels per unit at a clip space w of 1.
+	float lodScale;
+	float lodThreshold;
+	uint instanceCount;
+	uint groupCount;
+} u_Cull;
+
+#ifdef OCCLUSION_CULLING
+// Projection * view of the frame the depth pyramid was built from.
+layout(set = 0, binding = 5) readonly buffer OcclusionView {
+	mat4 previousViewProjection;
+};
+
+layout(set = 0, binding = 6) uniform sampler2D u_DepthPyramid;
+
+// True if the box is behind the previous frame's depth everywhere it covers. Boxes
+// crossing the near plane or the edge of the previous frame are kept, nothing is
+// known about what was in front of them.
+bool IsOccluded(vec3 center, vec3 extents) {
+	vec2 minUv = vec2(1.0);
+	vec2 maxUv = vec2(0.0);
+	float nearestDepth = 1.0;
+	for (uint i = 0; i < 8; i++) {
+		vec3 corner = center + extents * vec3((i & 1u) != 0u ? 1.0 : -1.0,
+											  (i & 2u) != 0u ? 1.0 : -1.0,
+											  (i & 4u) != 0u ? 1.0 : -1.0);
+		vec4 clip = previousViewProjection * vec4(corner, 1.0);
+		if (clip.w <= 1e-4) {
+			return false;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		vec2 uv = ndc.xy * 0.5 + 0.5;
+		minUv = min(minUv, uv);
+		maxUv = max(maxUv, uv);
+		nearestDepth = min(nearestDepth, ndc.z);
+	}
+	if (any(lessThan(minUv, vec2(0.0))) || any(greaterThan(maxUv, vec2(1.0)))) {
+		return false;
+	}
+
+	// The level where the box spans at most 2x2 texels, each the farthest depth of
+	// everything below it.
+	vec2 extent = (maxUv - minUv) * vec2(textureSize(u_DepthPyramid, 0));
+	int level = int(ceil(log2(max(max(extent.x, extent.y), 1.0))));
+	level = min(level, textureQueryLevels(u_DepthPyramid) - 1);
+	ivec2 levelSize = textureSize(u_DepthPyramid, level);
+	ivec2 first = min(ivec2(minUv * vec2(levelSize)), levelSize - 1);
+	ivec2 last = min(ivec2(maxUv * vec2(levelSize)), levelSize - 1);
+	float depth = max(max(texelFetch(u_DepthPyramid, first, level).r,
+						  texelFetch(u_DepthPyramid, ivec2(last.x, first.y), level).r),
+					  max(texelFetch(u_DepthPyramid, ivec2(first.x, last.y), level).r,
+						  texelFetch(u_DepthPyramid, last, level).r));
+	return nearestDepth > depth;
+}
+#endif
+
+uint FindGroup(uint instance) {
+	uint low = 0;
+	uint high = u_Cull.groupCount - 1;
+	while (low < high) {
+		uint middle = (low + high + 1) / 2;
+		if (groups[middle].firstInstance <= instance) {
+			low = middle;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return low;
+}
+
+void main() {
+	uint instance = gl_GlobalInvocationID.x;
+	if (instance >= u_Cull.instanceCount) {
+		return;
+	}
+	uint g = FindGroup(instance);
+	CullGroup group = groups[g];
+
+	uint base = instance * 21;
+	mat4 transform = mat4(
+		instances[base + 0], instances[base + 1], instances[base + 2], instances[base + 3],
+		instances[base + 4], instances[base + 5], instances[base + 6], instances[base + 7],
+		instances[base + 8], instances[base + 9], instances[base + 10], instances[base + 11],
+		instances[base + 12], instances[base + 13], instances[base + 14], instances[base + 15]);
+
+	// World space box around the transformed bounds (Arvo).
+	vec3 center = (transform * vec4(group.center.xyz, 1.0)).xyz;
+	vec3 extents = abs(transform[0].xyz) * group.extents.x +
+				   abs(transform[1].xyz) * group.extents.y +
+				   abs(transform[2].xyz) * group.extents.z;
+	for (uint i = 0; i < 6; i++) {
+		vec4 plane = u_Cull.planes[i];
+		if (dot(plane.xyz, center) + plane.w + dot(abs(plane.xyz), extents) < 0.0) {
+			return;
+		}
+	}
+#ifdef OCCLUSION_CULLING
+	if (IsOccluded(center, extents)) {
+		return;
+	}
+#endif
+
+	// Coarsest level whose error projects to at most the threshold, measured at the
+	// center like Renderer3D::SelectLod().
+	float scale = max(length(transform[0].xyz), max(length(transform[1].xyz), length(transform[2].xyz)));
+	float pixelsPerUnit = scale * u_Cull.lodScale / max(dot(u_Cull.depthRow, vec4(center, 1.0)), 1e-4);
+	uint lod = 0;
+	while (lod + 1 < group.lodCount && group.lodErrors[lod + 1] * pixelsPerUnit <= u_Cull.lodThreshold) {
+		lod++;
+	}
+
+	for (uint submesh = 0; submesh < group.submeshCount; submesh++) {
+		uvec2 range = ranges[group.firstRange + lod * group.submeshCount + submesh];
+		if (range.y == 0) {
+			continue;
+		}
+		uint slot = atomicAdd(counts[g], 1u);
+		commands[group.firstCommand + slot] = DrawCommand(range.y, 1u, range.x, 0, instance);
+	}
+}
@@ -1,13 +1,18 @@
 #version 450 core
 
-layout(location = 0) in vec4 a_Position;
+// MeshVertex, per vertex.
+layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
-layout(location = 2) in vec4 a_Color;
-layout(location = 3) in vec2 a_TexCoords;
+layout(location = 2) in vec2 a_TexCoords;
+// MeshInstance, per instance from location 3.
+layout(location = 3) in mat4 a_Transform;
+layout(location = 7) in vec4 a_Color;
+layout(location = 8) in uint a_TexIndex;
 
 layout(location = 0) out vec3 v_Normal;
 layout(location = 1) out vec4 v_Color;
 layout(location = 2) out vec2 v_TexCoords;
+layout(location = 3) flat out uint v_TexIndex;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
 	mat4 view;
@@ -15,9 +20,9 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 } u_Ubo;
 
 void main() {
-	v_Normal = a_Normal;
+	v_Normal = mat3(a_Transform) * a_Normal;
 	v_Color = a_Color;
 	v_TexCoords = a_TexCoords;
-	gl_Position = a_Position * u_Ubo.view * u_Ubo.projection;
+	v_TexIndex = a_TexIndex;
+	gl_Position = u_Ubo.projection * u_Ubo.view * a_Transform * vec4(a_Position, 1.0);
 }
-
@@ -0,0 +1,34 @@
+#version 450 core
+
+// One thread per texel of a depth pyramid level, keeping the farthest depth of the
+// source texels it covers so a box behind it is behind everything there, see
+// Renderer::RecordDepthPyramid().
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// The depth buffer for level 0, otherwise the level before.
+layout(set = 0, binding = 0) uniform sampler2D u_Source;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D u_Destination;
+
+layout(push_constant) uniform PyramidConstants {
+	uvec2 sourceSize;
+	uvec2 destinationSize;
+} u_Pyramid;
+
+void main() {
+	uvec2 texel = gl_GlobalInvocationID.xy;
+	if (any(greaterThanEqual(texel, u_Pyramid.destinationSize))) {
+		return;
+	}
+
+	// Level 0 is the power of two below the depth buffer, so its texels cover up to
+	// 3x3 depth texels, the other levels exactly 2x2 until an axis reaches 1.
+	uvec2 first = texel * u_Pyramid.sourceSize / u_Pyramid.destinationSize;
+	uvec2 last = ((texel + 1) * u_Pyramid.sourceSize + u_Pyramid.destinationSize - 1) / u_Pyramid.destinationSize;
+	float depth = 0.0;
+	for (uint y = first.y; y < last.y; y++) {
+		for (uint x = first.x; x < last.x; x++) {
+			depth = max(depth, texelFetch(u_Source, ivec2(x, y), 0).r);
+		}
+	}
+	imageStore(u_Destination, ivec2(texel), vec4(depth));
+}
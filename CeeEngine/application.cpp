@@ -14,7 +14,8 @@ namespace cee {
 Application* Application::s_Instance = nullptr;
 
 Application::Application(const ApplicationSpec& spec)
- : m_LayerStack(&m_MessageBus) {
+ : m_LayerStack(&m_MessageBus), m_RendererMode(spec.Mode), m_FrameLimit(spec.FrameLimit), m_FrameTimingReport(NULL),
+   m_FrameTimingReportInterval(spec.FrameTimingReportInterval) {
 	if (s_Instance) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Application already exits...\tExiting...\t");
 		std::exit(EXIT_FAILURE);
@@ -29,25 +30,51 @@ Application::Application(const ApplicationSpec& spec)
 	m_LayerStack.PushLayer(m_DebugLayer);
 #endif
 
-	WindowSpec windowSpec = {};
-	windowSpec.width = 1280;
-	windowSpec.height = 720;
-	windowSpec.title = "CeeEngine Application";
-	windowSpec.msgBus = &m_MessageBus;
-	m_Window = std::make_shared<Window>(windowSpec);
-	
-	Input::Init(&m_MessageBus, m_Window);
+	if (!spec.Headless) {
+		WindowSpec windowSpec = {};
+		windowSpec.width = 1280;
+		windowSpec.height = 720;
+		windowSpec.title = "CeeEngine Application";
+		windowSpec.msgBus = &m_MessageBus;
+		m_Window = std::make_shared<Window>(windowSpec);
+
+		Input::Init(&m_MessageBus, m_Window);
+	}
 	
 	RendererSpec rendererSpec;
 	rendererSpec.window = m_Window;
 	rendererSpec.msgBus = &m_MessageBus;
 	rendererSpec.enableValidationLayers = spec.EnableValidation;
-	if (Renderer3D::Init(rendererSpec) != 0) {
+	rendererSpec.enableShaderHotReload = spec.EnableShaderHotReload;
+	rendererSpec.headless = spec.Headless;
+	rendererSpec.headlessWidth = spec.HeadlessWidth;
+	rendererSpec.headlessHeight = spec.HeadlessHeight;
+	rendererSpec.pipelineStatistics = spec.PipelineStatistics;
+	rendererSpec.maxIndices = spec.MaxIndices;
+	rendererSpec.packedVertices = spec.PackedVertices;
+	rendererSpec.maxMeshInstances = spec.MaxMeshInstances;
+	rendererSpec.gpuCulling = spec.GpuCulling;
+	rendererSpec.occlusionCulling = spec.OcclusionCulling;
+	if (m_RendererMode == RENDERER_MODE_2D) {
+		if (Renderer2D::Init(rendererSpec) != 0) {
+			CEE_ASSERT(false, "Failed to initialse Renderer2D");
+		}
+	} else if (Renderer3D::Init(rendererSpec) != 0) {
 		CEE_ASSERT(false, "Failed to initialse Renderer3D");
 	}
 	
 	m_MessageBus.RegisterMessageHandler([this](Event& e){ (void)(this->OnEvent(e)); });
 
+	if (!spec.FrameTimingReportPath.empty()) {
+		m_FrameTimingReport = fopen(spec.FrameTimingReportPath.c_str(), "w");
+		if (m_FrameTimingReport == NULL) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to open frame timing report \"%s\".",
+											 spec.FrameTimingReportPath.c_str());
+		} else {
+			FrameTimer::WriteReportHeader(m_FrameTimingReport);
+		}
+	}
+
 	auto end = std::chrono::high_resolution_clock::now();
 	float duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0f;
 	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_DEBUG, "Time to initialise engine: %.3fms", duration);
@@ -58,7 +85,14 @@ Application::~Application() {
 		layer->OnDetach();
 		delete layer;
 	}
-	Renderer3D::Shutdown();
+	if (m_RendererMode == RENDERER_MODE_2D) {
+		Renderer2D::Shutdown();
+	} else {
+		Renderer3D::Shutdown();
+	}
+	if (m_FrameTimingReport != NULL) {
+		fclose(m_FrameTimingReport);
+	}
 	s_Instance = nullptr;
 }
 
@@ -78,6 +112,11 @@ void Application::PushOverlay(Layer *overlay)
 	m_LayerStack.PushOverlay(overlay);
 }
 
+void Application::Close()
+{
+	m_Running = false;
+}
+
 void Application::Run()
 {
 	//m_RenderThread = std::thread(&Renderer::Run, m_Renderer);
@@ -91,25 +130,58 @@ void Application::Run()
 		GetTime(&end);
 		GetTimeStep(&start, &end, &ts);
 		GetTime(&start);
-		m_AverageFrameTime *= frameIndex++;
-		m_AverageFrameTime += ts.nsec + ts.sec * 1000000000;
-		m_AverageFrameTime /= frameIndex;
+		m_FrameTimer.BeginFrame();
 
 		for (auto& layer : m_LayerStack) {
 			layer->OnUpdate(ts);
 		};
-
-		Renderer3D::BeginFrame();
+		m_FrameTimer.EndPhase(FRAME_PHASE_UPDATE);
+
+		if (m_RendererMode == RENDERER_MODE_2D) {
+			Renderer2D::BeginFrame();
+		} else {
+			Renderer3D::BeginFrame();
+		}
+		m_FrameTimer.EndPhase(FRAME_PHASE_WAIT);
 		for (auto& layer : m_LayerStack) {
 			layer->OnRender();;
 		};
-		Renderer3D::EndFrame();
-
-
-		Window::PollEvents();
+		m_FrameTimer.EndPhase(FRAME_PHASE_RENDER);
+		if (m_RendererMode == RENDERER_MODE_2D) {
+			Renderer2D::EndFrame();
+		} else {
+			Renderer3D::EndFrame();
+		}
+		m_FrameTimer.EndPhase(FRAME_PHASE_END_FRAME);
+
+
+		if (m_Window) {
+			Window::PollEvents();
+		}
 		m_MessageBus.DispatchEvents();
-		m_Running = !m_Window->ShouldClose();
+		m_FrameTimer.EndPhase(FRAME_PHASE_EVENTS);
+		m_FrameTimer.EndFrame();
+
+		frameIndex++;
+		if (m_FrameTimingReportInterval != 0 && frameIndex % m_FrameTimingReportInterval == 0) {
+			m_FrameTimer.WriteReport(m_FrameTimingReport, frameIndex);
+		}
+		if (m_Window && m_Window->ShouldClose()) {
+			m_Running = false;
+		}
+		if (m_FrameLimit != 0 && frameIndex >= m_FrameLimit) {
+			m_Running = false;
+		}
+	}
+	if (frameIndex != 0 && (m_FrameTimingReportInterval == 0 || frameIndex % m_FrameTimingReportInterval != 0)) {
+		m_FrameTimer.WriteReport(m_FrameTimingReport, frameIndex);
 	}
+
+	FrameTimeSummary summary = m_FrameTimer.GetFrameHistogram().Summarize();
+	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO,
+									 "%llu frames, frame time p50 %.3fms p95 %.3fms p99 %.3fms max %.3fms",
+									 (unsigned long long)summary.count, summary.p50 / 1000000.0,
+									 summary.p95 / 1000000.0, summary.p99 / 1000000.0, summary.max / 1000000.0);
 	//m_RenderThread.join();
 }
 }
@@ -1,6 +1,8 @@
 #include <CeeEngine/util.h>
 #include <CeeEngine/debugMessenger.h>
 #include <CeeEngine/assetManager.h>
+#include <CeeEngine/mesh.h>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -52,9 +54,30 @@ void AssetManager::SaveAsset(std::filesystem::path filePath, std::shared_ptr<T>
 	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Attempting to save unsupported asset type.");
 }
 
+static ShaderStage InferShaderStage(const std::filesystem::path& filePath) {
+	std::string extension = filePath.extension().string();
+	std::string stem = filePath.stem().string();
+	auto endsWith = [&stem](const std::string& suffix) {
+		return stem.size() >= suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0;
+	};
+
+	if (extension == ".vert" || endsWith("Vertex")) {
+		return SHADER_STAGE_VERTEX;
+	}
+	if (extension == ".frag" || endsWith("Fragment")) {
+		return SHADER_STAGE_FRAGMENT;
+	}
+	if (extension == ".comp" || endsWith("Compute")) {
+		return SHADER_STAGE_COMPUTE;
+	}
+	return SHADER_STAGE_UNKNOWN;
+}
+
 template<>
 std::shared_ptr<ShaderBinary> AssetManager::LoadAsset<ShaderBinary>(std::filesystem::path filePath) {
 	auto shaderFile = OpenFileR(filePath);
+	if (!shaderFile)
+		return std::shared_ptr<ShaderBinary>(nullptr);
 
 	size_t fileSize = shaderFile->tellg();
 	shaderFile->seekg(0);
@@ -76,6 +99,8 @@ std::shared_ptr<ShaderBinary> AssetManager::LoadAsset<ShaderBinary>(std::filesys
 template<>
 std::shared_ptr<ShaderCode> AssetManager::LoadAsset<ShaderCode>(std::filesystem::path filePath) {
 	auto shaderFile = OpenFileR(filePath);
+	if (!shaderFile)
+		return std::shared_ptr<ShaderCode>(nullptr);
 
 	size_t fileSize = shaderFile->tellg();
 	shaderFile->seekg(0);
@@ -91,6 +116,12 @@ std::shared_ptr<ShaderCode> AssetManager::LoadAsset<ShaderCode>(std::filesystem:
 
 	shaderFile->close();
 
+	shaderCode->name = filePath.stem().string();
+	shaderCode->stage = InferShaderStage(filePath);
+	if (shaderCode->stage == SHADER_STAGE_UNKNOWN) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Unable to infer shader stage of \"%s\".", filePath.c_str());
+	}
+
 	return shaderCode;
 }
 
@@ -134,12 +165,134 @@ std::shared_ptr<Image> AssetManager::LoadAsset<Image>(std::filesystem::path file
 }
 
 template<>
-void AssetManager::SaveAsset<PipelineCache>(const std::filesystem::path filePath, std::shared_ptr<PipelineCache> asset) {
+std::shared_ptr<Mesh> AssetManager::LoadAsset<Mesh>(std::filesystem::path filePath) {
+	auto file = OpenFileR(filePath);
+	if (!file)
+		return std::shared_ptr<Mesh>(nullptr);
+	size_t fileSize = file->tellg();
+	file->seekg(0);
+
+	MeshFileHeader header = {};
+	file->read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file->good() || header.magic != CEE_MESH_MAGIC) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "\"%s\" is not a mesh.", filePath.c_str());
+		return std::shared_ptr<Mesh>(nullptr);
+	}
+	if (header.version != CEE_MESH_VERSION) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Mesh \"%s\" is version %u, expected %u. Convert it again.",
+										 filePath.c_str(), header.version, CEE_MESH_VERSION);
+		return std::shared_ptr<Mesh>(nullptr);
+	}
+	if (header.vertexSize != sizeof(MeshVertex)) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+										 "Mesh \"%s\" has %u byte vertices, expected %zu. Convert it again.",
+										 filePath.c_str(), header.vertexSize, sizeof(MeshVertex));
+		return std::shared_ptr<Mesh>(nullptr);
+	}
+	size_t indexBytes = ((size_t)header.indexCount * header.indexSize + 3) & ~(size_t)3;
+	size_t expectedSize = sizeof(header) + (size_t)header.vertexCount * sizeof(MeshVertex) + indexBytes +
+						  (size_t)header.submeshCount * sizeof(Submesh);
+	if (fileSize != expectedSize) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Mesh \"%s\" is %zu bytes, expected %zu.",
+										 filePath.c_str(), fileSize, expectedSize);
+		return std::shared_ptr<Mesh>(nullptr);
+	}
+
+	auto mesh = std::make_shared<Mesh>();
+	mesh->vertices.resize(header.vertexCount);
+	mesh->indexSize = header.indexSize;
+	mesh->indices.resize((size_t)header.indexCount * header.indexSize);
+	mesh->submeshes.resize(header.submeshCount);
+	mesh->bounds = header.bounds;
+	mesh->lodCount = header.lodCount;
+	memcpy(mesh->lodErrors, header.lodErrors, sizeof(mesh->lodErrors));
+
+	file->read(reinterpret_cast<char*>(mesh->vertices.data()), mesh->vertices.size() * sizeof(MeshVertex));
+	file->read(reinterpret_cast<char*>(mesh->indices.data()), mesh->indices.size());
+	file->seekg(indexBytes - mesh->indices.size(), std::ios::cur);
+	file->read(reinterpret_cast<char*>(mesh->submeshes.data()), mesh->submeshes.size() * sizeof(Submesh));
+	if (!file->good()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to read file \"%s\".", filePath.c_str());
+		return std::shared_ptr<Mesh>(nullptr);
+	}
+	file->close();
+
+	if (mesh->Validate() != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Mesh \"%s\" is corrupt.", filePath.c_str());
+		return std::shared_ptr<Mesh>(nullptr);
+	}
+	return mesh;
+}
+
+template<>
+void AssetManager::SaveAsset<ShaderBinary>(const std::filesystem::path filePath, std::shared_ptr<ShaderBinary> asset) {
 	auto file = OpenFileW(filePath);
 	if (!file)
 		return;
 
+	file->write(reinterpret_cast<char*>(asset->spvCode.data()), asset->spvCode.size());
+	if (!file->good()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to write to file \"%s\".", filePath.c_str());
+	}
+
+	file->close();
+}
+
+template<>
+void AssetManager::SaveAsset<PipelineCache>(const std::filesystem::path filePath, std::shared_ptr<PipelineCache> asset) {
+	// Written next to the destination and renamed over it, so an interrupted write
+	// leaves the previous cache intact instead of a truncated one.
+	std::filesystem::path tempPath = filePath;
+	tempPath += ".tmp";
+	auto file = OpenFileW(tempPath);
+	if (!file)
+		return;
+
 	file->write(reinterpret_cast<char*>(asset->data.data()), asset->data.size());
+	file->close();
+	if (!file->good()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to write to file \"%s\".", tempPath.c_str());
+		std::error_code error;
+		std::filesystem::remove(m_Path / tempPath, error);
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(m_Path / tempPath, m_Path / filePath, error);
+	if (error) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to replace file \"%s\": %s",
+										 filePath.c_str(), error.message().c_str());
+		std::filesystem::remove(m_Path / tempPath, error);
+	}
+}
+
+template<>
+void AssetManager::SaveAsset<Mesh>(const std::filesystem::path filePath, std::shared_ptr<Mesh> asset) {
+	auto file = OpenFileW(filePath);
+	if (!file)
+		return;
+
+	MeshFileHeader header = {};
+	header.magic = CEE_MESH_MAGIC;
+	header.version = CEE_MESH_VERSION;
+	header.vertexCount = asset->vertices.size();
+	header.vertexSize = sizeof(MeshVertex);
+	header.indexCount = asset->GetIndexCount();
+	header.indexSize = asset->indexSize;
+	header.submeshCount = asset->submeshes.size();
+	header.lodCount = asset->lodCount;
+	header.bounds = asset->bounds;
+	memcpy(header.lodErrors, asset->lodErrors, sizeof(header.lodErrors));
+
+	// Keeps the submeshes 4 byte aligned after 16 bit indices.
+	const uint8_t padding[4] = {};
+	size_t paddingSize = (4 - asset->indices.size() % 4) % 4;
+
+	file->write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file->write(reinterpret_cast<const char*>(asset->vertices.data()), asset->vertices.size() * sizeof(MeshVertex));
+	file->write(reinterpret_cast<const char*>(asset->indices.data()), asset->indices.size());
+	file->write(reinterpret_cast<const char*>(padding), paddingSize);
+	file->write(reinterpret_cast<const char*>(asset->submeshes.data()), asset->submeshes.size() * sizeof(Submesh));
 	if (!file->good()) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to write to file \"%s\".", filePath.c_str());
 	}
@@ -163,8 +316,11 @@ std::optional<std::ifstream> AssetManager::OpenFileR(std::filesystem::path fileP
 
 std::optional<std::ofstream> AssetManager::OpenFileW(std::filesystem::path filePath) {
 	filePath = m_Path / filePath;
-	if (!Exists(filePath)) {
-		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "File \"%s\" does not exist.", filePath.c_str());
+	std::error_code error;
+	std::filesystem::create_directories(filePath.parent_path(), error);
+	if (error) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to create directory \"%s\".",
+										 filePath.parent_path().c_str());
 		return std::nullopt;
 	}
 	std::ofstream file(filePath, std::ios::binary);
@@ -0,0 +1,451 @@
+#include <CeeEngine/batchBuilder.h>
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static constexpr glm::vec4 CubeVertexPositions[] = {
+	{ -1.0f,  1.0f, -1.0f, 1.0f },    /////////////////
+	{  1.0f,  1.0f, -1.0f, 1.0f },    /// Top face ////
+	{  1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
+	{ -1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
+
+	{ -1.0f,  1.0f, -1.0f, 1.0f },    /////////////////
+	{ -1.0f,  1.0f,  1.0f, 1.0f },    /// Left face ///
+	{ -1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
+	{ -1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
+
+	{ -1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
+	{  1.0f,  1.0f,  1.0f, 1.0f },    // Front face ///
+	{  1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
+	{ -1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
+
+	{  1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
+	{  1.0f,  1.0f, -1.0f, 1.0f },    // Right face ///
+	{  1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
+	{  1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
+
+	{  1.0f,  1.0f, -1.0f, 1.0f },    /////////////////
+	{ -1.0f,  1.0f, -1.0f, 1.0f },    /// Back face ///
+	{ -1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
+	{  1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
+
+	{  1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
+	{ -1.0f, -1.0f, -1.0f, 1.0f },    // Bottom face //
+	{ -1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
+	{  1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
+};
+
+static constexpr glm::vec3 CubeNormalVectors[] = {
+	{  0.0f,  1.0f,  0.0f },         /////////////////
+	{  0.0f,  1.0f,  0.0f },         //  Top face   //
+	{  0.0f,  1.0f,  0.0f },         /////////////////
+	{  0.0f,  1.0f,  0.0f },         /////////////////
+
+	{ -1.0f,  0.0f,  0.0f },         /////////////////
+	{ -1.0f,  0.0f,  0.0f },         //  Left face  //
+	{ -1.0f,  0.0f,  0.0f },         /////////////////
+	{ -1.0f,  0.0f,  0.0f },         /////////////////
+
+	{  0.0f,  0.0f,  1.0f },         /////////////////
+	{  0.0f,  0.0f,  1.0f },         // Front face  //
+	{  0.0f,  0.0f,  1.0f },         /////////////////
+	{  0.0f,  0.0f,  1.0f },         /////////////////
+
+	{  1.0f,  0.0f,  0.0f },         /////////////////
+	{  1.0f,  0.0f,  0.0f },         // Right face  //
+	{  1.0f,  0.0f,  0.0f },         /////////////////
+	{  1.0f,  0.0f,  0.0f },         /////////////////
+
+	{  0.0f,  0.0f, -1.0f },         /////////////////
+	{  0.0f,  0.0f, -1.0f },         //  Back face  //
+	{  0.0f,  0.0f, -1.0f },         /////////////////
+	{  0.0f,  0.0f, -1.0f },         /////////////////
+
+	{  0.0f, -1.0f,  0.0f },         /////////////////
+	{  0.0f, -1.0f,  0.0f },         // Bottom face //
+	{  0.0f, -1.0f,  0.0f },         /////////////////
+	{  0.0f, -1.0f,  0.0f }          /////////////////
+};
+
+static constexpr uint32_t CubeIndices[] = {
+	 0,  1,  2,  2,  3,  0,          //  Top Face   //
+	 4,  5,  6,  6,  7,  4,          //  Left Face  //
+	 8,  9, 10, 10, 11,  8,          // Front Face  //
+	12, 13, 14, 14, 15, 12,          // Right Face  //
+	16, 17, 18, 18, 19, 16,          //  Back Face  //
+	20, 21, 22, 22, 23, 20           // Bottom Face //
+};
+
+static constexpr glm::vec2 CubeTexCoords[] {
+	{ 0.0f, 0.0f },
+	{ 1.0f, 0.0f },
+	{ 1.0f, 1.0f },
+	{ 0.0f, 1.0f },
+
+	{ 0.0f, 0.0f },
+	{ 1.0f, 0.0f },
+	{ 1.0f, 1.0f },
+	{ 0.0f, 1.0f },
+
+	{ 0.0f, 0.0f },
+	{ 1.0f, 0.0f },
+	{ 1.0f, 1.0f },
+	{ 0.0f, 1.0f },
+
+	{ 0.0f, 0.0f },
+	{ 1.0f, 0.0f },
+	{ 1.0f, 1.0f },
+	{ 0.0f, 1.0f },
+
+	{ 0.0f, 0.0f },
+	{ 1.0f, 0.0f },
+	{ 1.0f, 1.0f },
+	{ 0.0f, 1.0f },
+
+	{ 0.0f, 0.0f },
+	{ 1.0f, 0.0f },
+	{ 1.0f, 1.0f },
+	{ 0.0f, 1.0f }
+};
+
+namespace cee {
+// Corners of the unit quad in vertex order and the texture coordinate weights of each,
+// bottom left is uvMin and top right uvMax.
+static const float QuadCornerX[] = { -0.5f,  0.5f,  0.5f, -0.5f };
+static const float QuadCornerY[] = {  0.5f,  0.5f, -0.5f, -0.5f };
+static const glm::vec2 QuadTexCoords[] = {
+	{ 0.0f, 1.0f },
+	{ 1.0f, 1.0f },
+	{ 1.0f, 0.0f },
+	{ 0.0f, 0.0f }
+};
+
+// Same result as ConstructTransformMatrix2D() applied to the corners, without building
+// the matrix. The columns of rotation * scale are (ax, ay) and (bx, by).
+static inline void WriteQuadPositions(float x, float y, float z, float sine, float cosine,
+									  float scaleX, float scaleY, Vertex2D* vertices) {
+	float ax = cosine * scaleX;
+	float ay = sine * scaleX;
+	float bx = -sine * scaleY;
+	float by = cosine * scaleY;
+	for (size_t i = 0; i < CEE_QUAD_VERTEX_COUNT; i++) {
+		vertices[i].position = {
+			x + ax * QuadCornerX[i] + bx * QuadCornerY[i],
+			y + ay * QuadCornerX[i] + by * QuadCornerY[i],
+			z,
+			1.0f
+		};
+	}
+}
+
+static inline void WriteQuadAttributes(const glm::vec4& color, const glm::vec2* texCoords,
+									   uint32_t texIndex, Vertex2D* vertices) {
+	for (size_t i = 0; i < CEE_QUAD_VERTEX_COUNT; i++) {
+		vertices[i].color = color;
+		vertices[i].texCoords = texCoords[i];
+		vertices[i].texIndex = texIndex;
+	}
+}
+
+void BuildQuadVertices(const glm::vec3& translation,
+					   float rotationAngle,
+					   const glm::vec3& scale,
+					   const glm::vec4& color,
+					   const glm::vec2& uvMin,
+					   const glm::vec2& uvMax,
+					   uint32_t texIndex,
+					   Vertex2D* vertices) {
+	float sine = 0.0f;
+	float cosine = 1.0f;
+	if (rotationAngle != 0.0f) {
+		sine = sinf(rotationAngle);
+		cosine = cosf(rotationAngle);
+	}
+	WriteQuadPositions(translation.x, translation.y, translation.z, sine, cosine, scale.x, scale.y, vertices);
+
+	glm::vec2 texCoords[CEE_QUAD_VERTEX_COUNT];
+	for (size_t i = 0; i < CEE_QUAD_VERTEX_COUNT; i++) {
+		texCoords[i] = glm::mix(uvMin, uvMax, QuadTexCoords[i]);
+	}
+	WriteQuadAttributes(color, texCoords, texIndex, vertices);
+}
+
+#if defined(__SSE2__)
+// Writes the position of one corner of four consecutive quads, transposing the lanes
+// into one (x, y, z, 1) vector per vertex.
+static inline void StoreCornerPositions4(Vertex2D* vertices, size_t corner, __m128 x, __m128 y, __m128 z) {
+	__m128 w = _mm_set1_ps(1.0f);
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_storeu_ps(&vertices[0 * CEE_QUAD_VERTEX_COUNT + corner].position.x, x);
+	_mm_storeu_ps(&vertices[1 * CEE_QUAD_VERTEX_COUNT + corner].position.x, y);
+	_mm_storeu_ps(&vertices[2 * CEE_QUAD_VERTEX_COUNT + corner].position.x, z);
+	_mm_storeu_ps(&vertices[3 * CEE_QUAD_VERTEX_COUNT + corner].position.x, w);
+}
+#endif
+
+// The batch kernel is written once against these, one quad per lane.
+#if defined(__AVX2__)
+#define CEE_QUAD_BATCH_LANES 8
+typedef __m256 FloatLanes;
+typedef __m256i IntLanes;
+
+static inline FloatLanes Load(const float* values) { return _mm256_loadu_ps(values); }
+static inline FloatLanes Splat(float value) { return _mm256_set1_ps(value); }
+static inline FloatLanes Add(FloatLanes a, FloatLanes b) { return _mm256_add_ps(a, b); }
+static inline FloatLanes Sub(FloatLanes a, FloatLanes b) { return _mm256_sub_ps(a, b); }
+static inline FloatLanes Mul(FloatLanes a, FloatLanes b) { return _mm256_mul_ps(a, b); }
+static inline FloatLanes And(FloatLanes a, FloatLanes b) { return _mm256_and_ps(a, b); }
+// ~a & b
+static inline FloatLanes AndNot(FloatLanes a, FloatLanes b) { return _mm256_andnot_ps(a, b); }
+static inline FloatLanes Or(FloatLanes a, FloatLanes b) { return _mm256_or_ps(a, b); }
+static inline FloatLanes Xor(FloatLanes a, FloatLanes b) { return _mm256_xor_ps(a, b); }
+
+static inline IntLanes SplatInt(int32_t value) { return _mm256_set1_epi32(value); }
+static inline IntLanes AddInt(IntLanes a, IntLanes b) { return _mm256_add_epi32(a, b); }
+static inline IntLanes SubInt(IntLanes a, IntLanes b) { return _mm256_sub_epi32(a, b); }
+static inline IntLanes AndInt(IntLanes a, IntLanes b) { return _mm256_and_si256(a, b); }
+static inline IntLanes AndNotInt(IntLanes a, IntLanes b) { return _mm256_andnot_si256(a, b); }
+static inline IntLanes EqualsZero(IntLanes a) { return _mm256_cmpeq_epi32(a, _mm256_setzero_si256()); }
+// Moves bit 2 into the sign bit.
+static inline IntLanes Bit2ToSign(IntLanes a) { return _mm256_slli_epi32(a, 29); }
+static inline IntLanes Truncate(FloatLanes a) { return _mm256_cvttps_epi32(a); }
+static inline FloatLanes ToFloat(IntLanes a) { return _mm256_cvtepi32_ps(a); }
+static inline FloatLanes AsFloat(IntLanes a) { return _mm256_castsi256_ps(a); }
+
+static inline void StoreCornerPositions(Vertex2D* vertices, size_t corner, FloatLanes x, FloatLanes y, FloatLanes z) {
+	StoreCornerPositions4(vertices, corner, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y),
+						  _mm256_castps256_ps128(z));
+	StoreCornerPositions4(vertices + 4 * CEE_QUAD_VERTEX_COUNT, corner, _mm256_extractf128_ps(x, 1),
+						  _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+}
+#elif defined(__SSE2__)
+#define CEE_QUAD_BATCH_LANES 4
+typedef __m128 FloatLanes;
+typedef __m128i IntLanes;
+
+static inline FloatLanes Load(const float* values) { return _mm_loadu_ps(values); }
+static inline FloatLanes Splat(float value) { return _mm_set1_ps(value); }
+static inline FloatLanes Add(FloatLanes a, FloatLanes b) { return _mm_add_ps(a, b); }
+static inline FloatLanes Sub(FloatLanes a, FloatLanes b) { return _mm_sub_ps(a, b); }
+static inline FloatLanes Mul(FloatLanes a, FloatLanes b) { return _mm_mul_ps(a, b); }
+static inline FloatLanes And(FloatLanes a, FloatLanes b) { return _mm_and_ps(a, b); }
+// ~a & b
+static inline FloatLanes AndNot(FloatLanes a, FloatLanes b) { return _mm_andnot_ps(a, b); }
+static inline FloatLanes Or(FloatLanes a, FloatLanes b) { return _mm_or_ps(a, b); }
+static inline FloatLanes Xor(FloatLanes a, FloatLanes b) { return _mm_xor_ps(a, b); }
+
+static inline IntLanes SplatInt(int32_t value) { return _mm_set1_epi32(value); }
+static inline IntLanes AddInt(IntLanes a, IntLanes b) { return _mm_add_epi32(a, b); }
+static inline IntLanes SubInt(IntLanes a, IntLanes b) { return _mm_sub_epi32(a, b); }
+static inline IntLanes AndInt(IntLanes a, IntLanes b) { return _mm_and_si128(a, b); }
+static inline IntLanes AndNotInt(IntLanes a, IntLanes b) { return _mm_andnot_si128(a, b); }
+static inline IntLanes EqualsZero(IntLanes a) { return _mm_cmpeq_epi32(a, _mm_setzero_si128()); }
+// Moves bit 2 into the sign bit.
+static inline IntLanes Bit2ToSign(IntLanes a) { return _mm_slli_epi32(a, 29); }
+static inline IntLanes Truncate(FloatLanes a) { return _mm_cvttps_epi32(a); }
+static inline FloatLanes ToFloat(IntLanes a) { return _mm_cvtepi32_ps(a); }
+static inline FloatLanes AsFloat(IntLanes a) { return _mm_castsi128_ps(a); }
+
+static inline void StoreCornerPositions(Vertex2D* vertices, size_t corner, FloatLanes x, FloatLanes y, FloatLanes z) {
+	StoreCornerPositions4(vertices, corner, x, y, z);
+}
+#endif
+
+#if defined(CEE_QUAD_BATCH_LANES)
+// Cephes single precision sine and cosine, within a few ulp of sinf/cosf for angles
+// up to a few thousand radians.
+static inline void SinCos(FloatLanes x, FloatLanes* sine, FloatLanes* cosine) {
+	const FloatLanes signMask = AsFloat(SplatInt(INT32_MIN));
+	FloatLanes signSine = And(x, signMask);
+	x = AndNot(signMask, x);
+
+	// Octant of x, rounded up to even, and x reduced to [-pi/4, pi/4] around it.
+	IntLanes octant = Truncate(Mul(x, Splat(1.27323954473516f)));
+	octant = AndInt(AddInt(octant, SplatInt(1)), SplatInt(~1));
+	FloatLanes y = ToFloat(octant);
+	x = Sub(x, Mul(y, Splat(0.78515625f)));
+	x = Sub(x, Mul(y, Splat(2.4187564849853515625e-4f)));
+	x = Sub(x, Mul(y, Splat(3.77489497744594108e-8f)));
+
+	signSine = Xor(signSine, AsFloat(Bit2ToSign(AndInt(octant, SplatInt(4)))));
+	FloatLanes signCosine = AsFloat(Bit2ToSign(AndNotInt(SubInt(octant, SplatInt(2)), SplatInt(4))));
+	// Lanes where sine uses the sine polynomial, the others swap with cosine.
+	FloatLanes sinePolynomial = AsFloat(EqualsZero(AndInt(octant, SplatInt(2))));
+
+	FloatLanes z = Mul(x, x);
+	FloatLanes cosineValue = Splat(2.443315711809948e-5f);
+	cosineValue = Add(Mul(cosineValue, z), Splat(-1.388731625493765e-3f));
+	cosineValue = Add(Mul(cosineValue, z), Splat(4.166664568298827e-2f));
+	cosineValue = Mul(Mul(cosineValue, z), z);
+	cosineValue = Sub(cosineValue, Mul(z, Splat(0.5f)));
+	cosineValue = Add(cosineValue, Splat(1.0f));
+
+	FloatLanes sineValue = Splat(-1.9515295891e-4f);
+	sineValue = Add(Mul(sineValue, z), Splat(8.3321608736e-3f));
+	sineValue = Add(Mul(sineValue, z), Splat(-1.6666654611e-1f));
+	sineValue = Add(Mul(Mul(sineValue, z), x), x);
+
+	*sine = Xor(Or(And(sinePolynomial, sineValue), AndNot(sinePolynomial, cosineValue)), signSine);
+	*cosine = Xor(Or(And(sinePolynomial, cosineValue), AndNot(sinePolynomial, sineValue)), signCosine);
+}
+#endif
+
+void BuildQuadVertexBatch(const QuadInstances& quads,
+						  size_t first,
+						  size_t count,
+						  const glm::vec2& uvMin,
+						  const glm::vec2& uvMax,
+						  uint32_t texIndex,
+						  Vertex2D* vertices) {
+	glm::vec2 texCoords[CEE_QUAD_VERTEX_COUNT];
+	for (size_t i = 0; i < CEE_QUAD_VERTEX_COUNT; i++) {
+		texCoords[i] = glm::mix(uvMin, uvMax, QuadTexCoords[i]);
+	}
+
+	size_t i = 0;
+#if defined(CEE_QUAD_BATCH_LANES)
+	const FloatLanes zero = Splat(0.0f);
+	const FloatLanes one = Splat(1.0f);
+	for (; i + CEE_QUAD_BATCH_LANES <= count; i += CEE_QUAD_BATCH_LANES) {
+		size_t quad = first + i;
+		FloatLanes x = Load(quads.translationX + quad);
+		FloatLanes y = Load(quads.translationY + quad);
+		FloatLanes z = quads.translationZ != NULL ? Load(quads.translationZ + quad) : zero;
+		FloatLanes scaleX = Load(quads.scaleX + quad);
+		FloatLanes scaleY = Load(quads.scaleY + quad);
+
+		FloatLanes sine = zero;
+		FloatLanes cosine = one;
+		if (quads.rotationAngle != NULL) {
+			SinCos(Load(quads.rotationAngle + quad), &sine, &cosine);
+		}
+		FloatLanes ax = Mul(cosine, scaleX);
+		FloatLanes ay = Mul(sine, scaleX);
+		FloatLanes bx = Sub(zero, Mul(sine, scaleY));
+		FloatLanes by = Mul(cosine, scaleY);
+
+		Vertex2D* out = vertices + i * CEE_QUAD_VERTEX_COUNT;
+		for (size_t corner = 0; corner < CEE_QUAD_VERTEX_COUNT; corner++) {
+			FloatLanes cornerX = Splat(QuadCornerX[corner]);
+			FloatLanes cornerY = Splat(QuadCornerY[corner]);
+			FloatLanes px = Add(x, Add(Mul(ax, cornerX), Mul(bx, cornerY)));
+			FloatLanes py = Add(y, Add(Mul(ay, cornerX), Mul(by, cornerY)));
+			StoreCornerPositions(out, corner, px, py, z);
+		}
+		for (size_t lane = 0; lane < CEE_QUAD_BATCH_LANES; lane++) {
+			WriteQuadAttributes(quads.color[quad + lane], texCoords, texIndex, out + lane * CEE_QUAD_VERTEX_COUNT);
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		size_t quad = first + i;
+		float sine = 0.0f;
+		float cosine = 1.0f;
+		if (quads.rotationAngle != NULL && quads.rotationAngle[quad] != 0.0f) {
+			sine = sinf(quads.rotationAngle[quad]);
+			cosine = cosf(quads.rotationAngle[quad]);
+		}
+		float z = quads.translationZ != NULL ? quads.translationZ[quad] : 0.0f;
+		Vertex2D* out = vertices + i * CEE_QUAD_VERTEX_COUNT;
+		WriteQuadPositions(quads.translationX[quad], quads.translationY[quad], z, sine, cosine,
+						   quads.scaleX[quad], quads.scaleY[quad], out);
+		WriteQuadAttributes(quads.color[quad], texCoords, texIndex, out);
+	}
+}
+
+void StreamCopy(void* dst, const void* src, size_t size) {
+	uint8_t* out = static_cast<uint8_t*>(dst);
+	const uint8_t* in = static_cast<const uint8_t*>(src);
+#if defined(__SSE2__)
+	// Streaming stores need 16 byte aligned destinations.
+	size_t head = std::min<size_t>((16 - (reinterpret_cast<uintptr_t>(out) & 15)) & 15, size);
+	memcpy(out, in, head);
+	size_t i = head;
+	for (; i + 16 <= size; i += 16) {
+		_mm_stream_si128(reinterpret_cast<__m128i*>(out + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+	}
+	_mm_sfence();
+	memcpy(out + i, in + i, size - i);
+#else
+	memcpy(out, in, size);
+#endif
+}
+
+glm::vec2 EncodeOctahedral(const glm::vec3& normal) {
+	glm::vec3 n = normal / (fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z));
+	if (n.z >= 0.0f) {
+		return glm::vec2(n.x, n.y);
+	}
+	// The lower half folds over the diagonals into the corners.
+	return glm::vec2((1.0f - fabsf(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+					 (1.0f - fabsf(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+void PackVertices(const Vertex2D* vertices, size_t count, Vertex2DPacked* packed) {
+	for (size_t i = 0; i < count; i++) {
+		packed[i].position = glm::vec3(vertices[i].position);
+		packed[i].color = glm::packUnorm4x8(vertices[i].color);
+		packed[i].texCoords = glm::packUnorm2x16(vertices[i].texCoords);
+		packed[i].texIndex = vertices[i].texIndex;
+	}
+}
+
+void PackVertices(const Vertex3D* vertices, size_t count, Vertex3DPacked* packed) {
+	for (size_t i = 0; i < count; i++) {
+		packed[i].position = glm::vec3(vertices[i].position);
+		packed[i].normal = glm::packSnorm2x16(EncodeOctahedral(vertices[i].normal));
+		packed[i].color = glm::packUnorm4x8(vertices[i].color);
+		packed[i].texCoords = glm::packHalf2x16(vertices[i].texCoords);
+		packed[i].texIndex = vertices[i].texIndex;
+	}
+}
+
+void BuildQuadIndices(uint32_t quadCount, uint32_t* indices) {
+	for (uint32_t quad = 0; quad < quadCount; quad++) {
+		uint32_t index = quad * CEE_QUAD_VERTEX_COUNT;
+		indices[0] = index + 0;
+		indices[1] = index + 1;
+		indices[2] = index + 2;
+		indices[3] = index + 2;
+		indices[4] = index + 3;
+		indices[5] = index + 0;
+		indices += CEE_QUAD_INDEX_COUNT;
+	}
+}
+
+void BuildCubeVertices(const glm::vec3& translation,
+					   float rotationAngle,
+					   const glm::vec3& rotationAxis,
+					   const glm::vec3& scale,
+					   const glm::vec4& color,
+					   uint32_t texIndex,
+					   uint32_t baseVertex,
+					   Vertex3D* vertices,
+					   uint32_t* indices) {
+	glm::mat4 transform = ConstructTransformMatrix3D(translation, rotationAngle, rotationAxis, scale);
+	// Normals only follow the rotation, the scale is applied to the positions alone.
+	glm::mat3 normalMatrix = glm::identity<glm::mat3>();
+	if (rotationAngle != 0.0f) {
+		normalMatrix = glm::mat3(glm::rotate(glm::identity<glm::mat4>(), rotationAngle, rotationAxis));
+	}
+
+	for (size_t i = 0; i < CEE_CUBE_VERTEX_COUNT; i++) {
+		vertices[i].position = transform * CubeVertexPositions[i];
+		vertices[i].normal = normalMatrix * CubeNormalVectors[i];
+		vertices[i].color = color;
+		vertices[i].texCoords = CubeTexCoords[i];
+		vertices[i].texIndex = texIndex;
+	}
+	for (size_t i = 0; i < CEE_CUBE_INDEX_COUNT; i++) {
+		indices[i] = CubeIndices[i] + baseVertex;
+	}
+}
+}
@@ -0,0 +1,92 @@
+#include <CeeEngine/fileWatcher.h>
+#include <CeeEngine/debugMessenger.h>
+#include <CeeEngine/platform.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(CEE_PLATFORM_LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <Tracy.hpp>
+
+namespace cee {
+FileWatcher::FileWatcher()
+: m_Fd(-1)
+{
+}
+
+FileWatcher::~FileWatcher() {
+#if defined(CEE_PLATFORM_LINUX)
+	if (m_Fd >= 0) {
+		close(m_Fd);
+	}
+#endif
+}
+
+int FileWatcher::Watch(const std::filesystem::path& directory) {
+#if defined(CEE_PLATFORM_LINUX)
+	if (m_Fd < 0) {
+		m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_Fd < 0) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to initialize inotify: %s", strerror(errno));
+			return -1;
+		}
+	}
+
+	// Editors that save through a temporary file rename it over the original,
+	// which is reported as IN_MOVED_TO rather than IN_CLOSE_WRITE.
+	int wd = inotify_add_watch(m_Fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd < 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to watch \"%s\": %s",
+										 directory.c_str(), strerror(errno));
+		return -1;
+	}
+	m_Directories[wd] = directory;
+	return 0;
+#else
+	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+									 "File watching is not supported on this platform, \"%s\" will not be watched.",
+									 directory.string().c_str());
+	return -1;
+#endif
+}
+
+void FileWatcher::Poll(std::vector<std::filesystem::path>& changedFiles) {
+#if defined(CEE_PLATFORM_LINUX)
+	ZoneScoped;
+	if (m_Fd < 0) {
+		return;
+	}
+
+	size_t firstChange = changedFiles.size();
+	alignas(struct inotify_event) char buffer[4096];
+	for (;;) {
+		ssize_t length = read(m_Fd, buffer, sizeof(buffer));
+		if (length <= 0) {
+			// EAGAIN once the queue is drained.
+			break;
+		}
+
+		for (char* ptr = buffer; ptr < buffer + length;) {
+			const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+			ptr += sizeof(struct inotify_event) + event->len;
+
+			auto it = m_Directories.find(event->wd);
+			if (event->len == 0 || it == m_Directories.end()) {
+				continue;
+			}
+			std::filesystem::path filePath = it->second / event->name;
+			if (std::find(changedFiles.begin() + firstChange, changedFiles.end(), filePath) == changedFiles.end()) {
+				changedFiles.push_back(filePath);
+			}
+		}
+	}
+#else
+	(void)changedFiles;
+#endif
+}
+}
@@ -0,0 +1,156 @@
+#include <CeeEngine/frameCapture.h>
+#include <CeeEngine/debugMessenger.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+
+#include <stb/stb_image_write.h>
+
+#include <Tracy.hpp>
+
+namespace cee {
+// Returns the frame as RGBA8, swizzling into storage when needed. NULL if the format
+// is not 8 bits per channel.
+static const uint8_t* GetRGBAPixels(const FrameReadback& frame, std::vector<uint8_t>& storage) {
+	switch (frame.format) {
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return frame.pixels;
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			storage.resize(frame.size);
+			for (size_t i = 0; i + 3 < frame.size; i += 4) {
+				storage[i + 0] = frame.pixels[i + 2];
+				storage[i + 1] = frame.pixels[i + 1];
+				storage[i + 2] = frame.pixels[i + 0];
+				storage[i + 3] = frame.pixels[i + 3];
+			}
+			return storage.data();
+		default:
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Cannot write frame of format %d.", (int)frame.format);
+			return NULL;
+	}
+}
+
+int WriteFramePNG(const std::filesystem::path& filePath, const FrameReadback& frame) {
+	ZoneScoped;
+	std::vector<uint8_t> storage;
+	const uint8_t* pixels = GetRGBAPixels(frame, storage);
+	if (pixels == NULL) {
+		return -1;
+	}
+
+	if (stbi_write_png(filePath.c_str(), frame.extent.width, frame.extent.height, 4,
+					   pixels, frame.extent.width * 4) == 0)
+	{
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to write \"%s\".", filePath.c_str());
+		return -1;
+	}
+	return 0;
+}
+
+int WriteFrameRaw(const std::filesystem::path& filePath, const FrameReadback& frame) {
+	ZoneScoped;
+	std::vector<uint8_t> storage;
+	const uint8_t* pixels = GetRGBAPixels(frame, storage);
+	if (pixels == NULL) {
+		return -1;
+	}
+
+	std::ofstream file(filePath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(pixels), frame.size);
+	file.close();
+	if (!file.good()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to write \"%s\".", filePath.c_str());
+		return -1;
+	}
+	return 0;
+}
+
+FrameCapture::FrameCapture(std::filesystem::path directory, std::string prefix, FrameCaptureFormat format)
+: m_Directory(directory), m_Prefix(prefix), m_Format(format), m_State(std::make_shared<State>())
+{
+	std::error_code error;
+	std::filesystem::create_directories(m_Directory, error);
+	if (error) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to create directory \"%s\".",
+										 m_Directory.c_str());
+	}
+	m_Thread = std::thread(&FrameCapture::WriterThread, this);
+}
+
+FrameCapture::~FrameCapture() {
+	{
+		std::lock_guard<std::mutex> lock(m_State->mutex);
+		m_State->stop = true;
+	}
+	m_State->condition.notify_one();
+	m_Thread.join();
+}
+
+int FrameCapture::CaptureFrame() {
+	std::shared_ptr<State> state = m_State;
+	int result = Renderer::Get()->RequestFrameReadback([state](const FrameReadback& frame) {
+		ZoneScoped;
+		CapturedFrame captured;
+		captured.frameNumber = frame.frameNumber;
+		captured.extent = frame.extent;
+		captured.format = frame.format;
+		captured.pixels.assign(frame.pixels, frame.pixels + frame.size);
+
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->requested--;
+		if (state->stop) {
+			return;
+		}
+		state->queue.push_back(std::move(captured));
+		state->condition.notify_one();
+	});
+	if (result != 0) {
+		return -1;
+	}
+
+	std::lock_guard<std::mutex> lock(m_State->mutex);
+	m_State->requested++;
+	return 0;
+}
+
+size_t FrameCapture::GetPendingCount() {
+	std::lock_guard<std::mutex> lock(m_State->mutex);
+	return m_State->requested + m_State->queue.size();
+}
+
+void FrameCapture::WriterThread() {
+	std::unique_lock<std::mutex> lock(m_State->mutex);
+	for (;;) {
+		m_State->condition.wait(lock, [this]{ return m_State->stop || !m_State->queue.empty(); });
+		if (m_State->queue.empty()) {
+			// Stopped with everything written.
+			break;
+		}
+		CapturedFrame captured = std::move(m_State->queue.front());
+		m_State->queue.pop_front();
+		lock.unlock();
+
+		char name[32];
+		snprintf(name, sizeof(name), "%06" PRIu64 ".%s", captured.frameNumber,
+				 m_Format == FRAME_CAPTURE_FORMAT_PNG ? "png" : "rgba");
+		std::filesystem::path filePath = m_Directory / (m_Prefix + name);
+
+		FrameReadback frame = {};
+		frame.frameNumber = captured.frameNumber;
+		frame.extent = captured.extent;
+		frame.format = captured.format;
+		frame.pixels = captured.pixels.data();
+		frame.size = captured.pixels.size();
+		if (m_Format == FRAME_CAPTURE_FORMAT_PNG) {
+			WriteFramePNG(filePath, frame);
+		} else {
+			WriteFrameRaw(filePath, frame);
+		}
+
+		lock.lock();
+	}
+}
+}
@@ -0,0 +1,174 @@
+#include <CeeEngine/frameTimer.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+
+#include <Tracy.hpp>
+
+namespace cee {
+#define CEE_FRAME_HISTOGRAM_SUB_BUCKET_COUNT (1u << CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS)
+#define CEE_FRAME_HISTOGRAM_MAX_VALUE ((UINT64_C(1) << CEE_FRAME_HISTOGRAM_MAX_EXPONENT) - 1)
+
+FrameTimeHistogram::FrameTimeHistogram() {
+	Reset();
+}
+
+void FrameTimeHistogram::Record(uint64_t nanoseconds) {
+	nanoseconds = std::min(nanoseconds, CEE_FRAME_HISTOGRAM_MAX_VALUE);
+	m_Buckets[GetBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	m_Count.fetch_add(1, std::memory_order_relaxed);
+	m_Sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	uint64_t max = m_Max.load(std::memory_order_relaxed);
+	while (nanoseconds > max && !m_Max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+	}
+}
+
+void FrameTimeHistogram::Reset() {
+	for (auto& bucket : m_Buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_Count.store(0, std::memory_order_relaxed);
+	m_Sum.store(0, std::memory_order_relaxed);
+	m_Max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t FrameTimeHistogram::GetPercentile(double percentile) const {
+	uint64_t count = GetCount();
+	if (count == 0) {
+		return 0;
+	}
+	uint64_t target = (uint64_t)std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count);
+	target = std::max<uint64_t>(target, 1);
+
+	uint64_t max = GetMax();
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < CEE_FRAME_HISTOGRAM_BUCKET_COUNT; i++) {
+		seen += m_Buckets[i].load(std::memory_order_relaxed);
+		if (seen >= target) {
+			return std::min(GetBucketUpperBound(i), max);
+		}
+	}
+	// Records landed between reading the count and the buckets.
+	return max;
+}
+
+FrameTimeSummary FrameTimeHistogram::Summarize() const {
+	FrameTimeSummary summary = {};
+	summary.count = GetCount();
+	summary.mean = summary.count == 0 ? 0 : m_Sum.load(std::memory_order_relaxed) / summary.count;
+	summary.p50 = GetPercentile(50.0);
+	summary.p95 = GetPercentile(95.0);
+	summary.p99 = GetPercentile(99.0);
+	summary.max = GetMax();
+	return summary;
+}
+
+uint32_t FrameTimeHistogram::GetBucketIndex(uint64_t value) {
+	// The first two groups of sub buckets are exact.
+	if (value < 2 * CEE_FRAME_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return value;
+	}
+	uint32_t exponent = 0;
+	while ((value >> (exponent + 1)) != 0) {
+		exponent++;
+	}
+	uint32_t shift = exponent - CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS;
+	return (shift << CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS) + (uint32_t)(value >> shift);
+}
+
+uint64_t FrameTimeHistogram::GetBucketUpperBound(uint32_t index) {
+	if (index < 2 * CEE_FRAME_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return index;
+	}
+	uint32_t shift = (index >> CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+	uint64_t subBucket = (index & (CEE_FRAME_HISTOGRAM_SUB_BUCKET_COUNT - 1)) + CEE_FRAME_HISTOGRAM_SUB_BUCKET_COUNT;
+	return ((subBucket + 1) << shift) - 1;
+}
+
+static const char* s_FramePhaseNames[FRAME_PHASE_COUNT] = {
+	"Update",
+	"Wait",
+	"Render",
+	"EndFrame",
+	"Events"
+};
+
+// Tracy compares plot names by pointer, so these have to be fixed strings.
+static const char* s_FramePhasePlotNames[FRAME_PHASE_COUNT] = {
+	"Update p99 (ms)",
+	"Wait p99 (ms)",
+	"Render p99 (ms)",
+	"EndFrame p99 (ms)",
+	"Events p99 (ms)"
+};
+
+FrameTimer::FrameTimer()
+: m_FrameStart(0), m_PhaseStart(0)
+{
+}
+
+void FrameTimer::BeginFrame() {
+	m_FrameStart = GetNanoseconds();
+	m_PhaseStart = m_FrameStart;
+}
+
+void FrameTimer::EndPhase(FramePhase phase) {
+	uint64_t now = GetNanoseconds();
+	m_Phases[phase].Record(now - m_PhaseStart);
+	m_WindowPhases[phase].Record(now - m_PhaseStart);
+	m_PhaseStart = now;
+}
+
+void FrameTimer::EndFrame() {
+	uint64_t now = GetNanoseconds();
+	m_Frame.Record(now - m_FrameStart);
+	m_WindowFrame.Record(now - m_FrameStart);
+}
+
+const char* FrameTimer::GetPhaseName(FramePhase phase) {
+	return s_FramePhaseNames[phase];
+}
+
+void FrameTimer::WriteReportHeader(std::FILE* file) {
+	fprintf(file, "frame,histogram,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+}
+
+static void WriteSummary(std::FILE* file, uint64_t frameNumber, const char* name, const FrameTimeSummary& summary) {
+	fprintf(file, "%" PRIu64 ",%s,%" PRIu64 ",%.3f,%.3f,%.3f,%.3f,%.3f\n", frameNumber, name, summary.count,
+			summary.mean / 1000000.0, summary.p50 / 1000000.0, summary.p95 / 1000000.0,
+			summary.p99 / 1000000.0, summary.max / 1000000.0);
+}
+
+void FrameTimer::WriteReport(std::FILE* file, uint64_t frameNumber) {
+	ZoneScoped;
+	FrameTimeSummary frame = m_WindowFrame.Summarize();
+	if (file != NULL) {
+		WriteSummary(file, frameNumber, "Frame", frame);
+	}
+	TracyPlot("Frame p50 (ms)", frame.p50 / 1000000.0);
+	TracyPlot("Frame p95 (ms)", frame.p95 / 1000000.0);
+	TracyPlot("Frame p99 (ms)", frame.p99 / 1000000.0);
+	TracyPlot("Frame max (ms)", frame.max / 1000000.0);
+	m_WindowFrame.Reset();
+
+	for (uint32_t i = 0; i < FRAME_PHASE_COUNT; i++) {
+		FrameTimeSummary phase = m_WindowPhases[i].Summarize();
+		if (file != NULL) {
+			WriteSummary(file, frameNumber, s_FramePhaseNames[i], phase);
+		}
+		TracyPlot(s_FramePhasePlotNames[i], phase.p99 / 1000000.0);
+		m_WindowPhases[i].Reset();
+	}
+	if (file != NULL) {
+		fflush(file);
+	}
+}
+
+uint64_t FrameTimer::GetNanoseconds() {
+	Timestep t;
+	GetTime(&t);
+	return (uint64_t)t.sec * 1000000000 + t.nsec;
+}
+}
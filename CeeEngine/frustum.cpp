@@ -0,0 +1,109 @@
+#include <CeeEngine/frustum.h>
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cee {
+Frustum::Frustum() {
+	for (uint32_t i = 0; i < 8; i++) {
+		m_X[i] = m_Y[i] = m_Z[i] = 0.0f;
+		m_AbsX[i] = m_AbsY[i] = m_AbsZ[i] = 0.0f;
+		m_W[i] = 1.0f;
+	}
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+: Frustum()
+{
+	// glm is column major, m[column][row].
+	glm::vec4 rows[4];
+	for (uint32_t i = 0; i < 4; i++) {
+		rows[i] = { viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+	}
+	glm::vec4 planes[FRUSTUM_PLANE_COUNT] = {
+		rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[2],
+		rows[3] - rows[2],
+	};
+
+	for (uint32_t i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+		glm::vec4 plane = planes[i];
+		float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.0f) {
+			plane /= length;
+		}
+		m_X[i] = plane.x;
+		m_Y[i] = plane.y;
+		m_Z[i] = plane.z;
+		m_W[i] = plane.w;
+		m_AbsX[i] = fabsf(plane.x);
+		m_AbsY[i] = fabsf(plane.y);
+		m_AbsZ[i] = fabsf(plane.z);
+	}
+}
+
+glm::vec4 Frustum::GetPlane(FrustumPlane plane) const {
+	return { m_X[plane], m_Y[plane], m_Z[plane], m_W[plane] };
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+	return Intersects(center, glm::vec3(0.0f), radius);
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& center, const glm::vec3& extents) const {
+	return Intersects(center, extents, 0.0f);
+}
+
+bool Frustum::Intersects(const glm::vec3& center, const glm::vec3& extents, float radius) const {
+	// Outside once the signed distance of the center plus the reach of the volume
+	// towards the plane is negative for any plane. NaNs compare as inside.
+#if defined(__AVX2__)
+	__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(m_X), _mm256_set1_ps(center.x)),
+												  _mm256_mul_ps(_mm256_load_ps(m_Y), _mm256_set1_ps(center.y))),
+									_mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(m_Z), _mm256_set1_ps(center.z)),
+												  _mm256_load_ps(m_W)));
+	__m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(m_AbsX), _mm256_set1_ps(extents.x)),
+											   _mm256_mul_ps(_mm256_load_ps(m_AbsY), _mm256_set1_ps(extents.y))),
+								 _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(m_AbsZ), _mm256_set1_ps(extents.z)),
+											   _mm256_set1_ps(radius)));
+	__m256 outside = _mm256_cmp_ps(_mm256_add_ps(distance, reach), _mm256_setzero_ps(), _CMP_LT_OQ);
+	return _mm256_movemask_ps(outside) == 0;
+#elif defined(__SSE2__)
+	__m128 centerX = _mm_set1_ps(center.x);
+	__m128 centerY = _mm_set1_ps(center.y);
+	__m128 centerZ = _mm_set1_ps(center.z);
+	__m128 extentsX = _mm_set1_ps(extents.x);
+	__m128 extentsY = _mm_set1_ps(extents.y);
+	__m128 extentsZ = _mm_set1_ps(extents.z);
+	__m128 radiusV = _mm_set1_ps(radius);
+	int outside = 0;
+	for (uint32_t i = 0; i < 8; i += 4) {
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(m_X + i), centerX),
+												_mm_mul_ps(_mm_load_ps(m_Y + i), centerY)),
+									 _mm_add_ps(_mm_mul_ps(_mm_load_ps(m_Z + i), centerZ), _mm_load_ps(m_W + i)));
+		__m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(m_AbsX + i), extentsX),
+											 _mm_mul_ps(_mm_load_ps(m_AbsY + i), extentsY)),
+								  _mm_add_ps(_mm_mul_ps(_mm_load_ps(m_AbsZ + i), extentsZ), radiusV));
+		outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+	}
+	return outside == 0;
+#else
+	for (uint32_t i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+		float distance = m_X[i] * center.x + m_Y[i] * center.y + m_Z[i] * center.z + m_W[i];
+		float reach = m_AbsX[i] * extents.x + m_AbsY[i] * extents.y + m_AbsZ[i] * extents.z + radius;
+		if (distance + reach < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+#endif
+}
+}
@@ -0,0 +1,410 @@
+#include <CeeEngine/gpuProfiler.h>
+#include <CeeEngine/debugMessenger.h>
+#include <CeeEngine/platform.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <Tracy.hpp>
+#include <TracyVulkan.hpp>
+
+namespace cee {
+// Queries per queue per frame, a begin and an end query per zone.
+#define CEE_GPU_PROFILER_QUERY_COUNT 128
+// A slot whose queries never become available, e.g. because its command buffers were
+// recorded but never submitted, is dropped after this many frames.
+#define CEE_GPU_PROFILER_MAX_RETRIES 8
+
+double GpuFrameTimings::GetMilliseconds(const char* name) const {
+	uint64_t duration = 0;
+	for (const auto& zone : zones) {
+		if (strcmp(zone.name, name) == 0) {
+			duration += zone.duration;
+		}
+	}
+	return duration / 1000000.0;
+}
+
+GpuProfiler::GpuProfiler()
+: m_Enabled(false), m_Recording(false), m_Device(VK_NULL_HANDLE), m_TimestampPeriod(0.0),
+  m_TimestampMasks{}, m_CommandPools{}, m_Calibrated(false), m_GetCalibratedTimestamps(NULL),
+  m_FrameIndex(0), m_TracyContext(NULL)
+{
+}
+
+GpuProfiler::~GpuProfiler() {
+}
+
+int GpuProfiler::Init(const GpuProfilerSpec& spec) {
+	ZoneScoped;
+	VkResult result;
+	m_Device = spec.device;
+
+	VkPhysicalDeviceProperties properties = {};
+	vkGetPhysicalDeviceProperties(spec.physicalDevice, &properties);
+	m_TimestampPeriod = properties.limits.timestampPeriod;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(spec.physicalDevice, &queueFamilyCount, NULL);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(spec.physicalDevice, &queueFamilyCount, queueFamilies.data());
+	for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+		uint32_t validBits = queueFamilies[spec.queueFamilyIndices[i]].timestampValidBits;
+		m_TimestampMasks[i] = validBits >= 64 ? UINT64_MAX : ((uint64_t)1 << validBits) - 1;
+	}
+	if (m_TimestampMasks[GPU_QUEUE_GRAPHICS] == 0 || !spec.hostQueryReset) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "GPU timestamps unsupported, GPU profiling disabled.");
+		return 0;
+	}
+	if (m_TimestampMasks[GPU_QUEUE_TRANSFER] == 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO,
+										 "Transfer queue has no timestamps, transfers will not be timed.");
+	}
+
+	for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+		if (m_TimestampMasks[i] == 0) {
+			continue;
+		}
+		VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.pNext = NULL;
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		commandPoolCreateInfo.queueFamilyIndex = spec.queueFamilyIndices[i];
+
+		result = vkCreateCommandPool(m_Device, &commandPoolCreateInfo, NULL, &m_CommandPools[i]);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create GPU profiler command pool.");
+			Shutdown();
+			return -1;
+		}
+	}
+
+	m_FrameSlots.resize(spec.framesInFlight, FrameSlot{});
+	for (auto& slot : m_FrameSlots) {
+		for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+			if (m_TimestampMasks[i] == 0) {
+				continue;
+			}
+			VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+			queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolCreateInfo.pNext = NULL;
+			queryPoolCreateInfo.flags = 0;
+			queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolCreateInfo.queryCount = CEE_GPU_PROFILER_QUERY_COUNT;
+			queryPoolCreateInfo.pipelineStatistics = 0;
+
+			result = vkCreateQueryPool(m_Device, &queryPoolCreateInfo, NULL, &slot.queryPools[i]);
+			if (result != VK_SUCCESS) {
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create timestamp query pool.");
+				Shutdown();
+				return -1;
+			}
+			// Queries start out undefined and have to be reset before the first write.
+			vkResetQueryPool(m_Device, slot.queryPools[i], 0, CEE_GPU_PROFILER_QUERY_COUNT);
+
+			VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+			commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferAllocateInfo.pNext = NULL;
+			commandBufferAllocateInfo.commandPool = m_CommandPools[i];
+			commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferAllocateInfo.commandBufferCount = 2;
+
+			result = vkAllocateCommandBuffers(m_Device, &commandBufferAllocateInfo, slot.submissionCommandBuffers[i]);
+			if (result != VK_SUCCESS) {
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to allocate GPU profiler command buffers.");
+				Shutdown();
+				return -1;
+			}
+		}
+	}
+
+	PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT getCalibrateableTimeDomains = NULL;
+	if (spec.calibratedTimestamps) {
+		getCalibrateableTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+			vkGetInstanceProcAddr(spec.instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+		m_GetCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)
+			vkGetDeviceProcAddr(m_Device, "vkGetCalibratedTimestampsEXT");
+	}
+	if (getCalibrateableTimeDomains != NULL && m_GetCalibratedTimestamps != NULL) {
+		uint32_t timeDomainCount = 0;
+		getCalibrateableTimeDomains(spec.physicalDevice, &timeDomainCount, NULL);
+		std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+		getCalibrateableTimeDomains(spec.physicalDevice, &timeDomainCount, timeDomains.data());
+
+		bool deviceDomain = false;
+		bool hostDomain = false;
+		for (auto timeDomain : timeDomains) {
+			deviceDomain |= timeDomain == VK_TIME_DOMAIN_DEVICE_EXT;
+#if defined(CEE_PLATFORM_LINUX)
+			// The clock GetTime() reads.
+			hostDomain |= timeDomain == VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+		}
+		m_Calibrated = deviceDomain && hostDomain;
+	}
+	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "GPU profiling enabled, timestamps %s.",
+									 m_Calibrated ? "calibrated" : "not calibrated");
+
+	{
+		// Tracy submits its own calibration commands through this.
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.pNext = NULL;
+		commandBufferAllocateInfo.commandPool = m_CommandPools[GPU_QUEUE_GRAPHICS];
+		commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		result = vkAllocateCommandBuffers(m_Device, &commandBufferAllocateInfo, &commandBuffer);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to allocate GPU profiler command buffers.");
+			Shutdown();
+			return -1;
+		}
+		if (getCalibrateableTimeDomains != NULL && m_GetCalibratedTimestamps != NULL) {
+			m_TracyContext = TracyVkContextCalibrated(spec.physicalDevice, m_Device, spec.queues[GPU_QUEUE_GRAPHICS],
+													  commandBuffer, getCalibrateableTimeDomains,
+													  m_GetCalibratedTimestamps);
+		} else {
+			m_TracyContext = TracyVkContext(spec.physicalDevice, m_Device, spec.queues[GPU_QUEUE_GRAPHICS],
+											commandBuffer);
+		}
+		TracyVkContextName(m_TracyContext, "Graphics", 8);
+		vkFreeCommandBuffers(m_Device, m_CommandPools[GPU_QUEUE_GRAPHICS], 1, &commandBuffer);
+	}
+
+	m_Enabled = true;
+	return 0;
+}
+
+void GpuProfiler::Shutdown() {
+	if (m_TracyContext != NULL) {
+		TracyVkDestroy(m_TracyContext);
+		m_TracyContext = NULL;
+	}
+	for (auto& slot : m_FrameSlots) {
+		for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+			if (slot.queryPools[i] != VK_NULL_HANDLE) {
+				vkDestroyQueryPool(m_Device, slot.queryPools[i], NULL);
+			}
+		}
+	}
+	m_FrameSlots.clear();
+	for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+		if (m_CommandPools[i] != VK_NULL_HANDLE) {
+			// Frees the submission command buffers.
+			vkDestroyCommandPool(m_Device, m_CommandPools[i], NULL);
+			m_CommandPools[i] = VK_NULL_HANDLE;
+		}
+	}
+	m_Enabled = false;
+	m_Recording = false;
+}
+
+void GpuProfiler::BeginFrame(uint32_t frameIndex, uint64_t frameNumber) {
+	m_Recording = false;
+	if (!m_Enabled) {
+		return;
+	}
+	ZoneScoped;
+	m_FrameIndex = frameIndex;
+	FrameSlot& slot = m_FrameSlots[frameIndex];
+	if (!slot.zones.empty() && ResolveFrameSlot(slot) != 0) {
+		if (++slot.retries < CEE_GPU_PROFILER_MAX_RETRIES) {
+			return;
+		}
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+										 "Dropping GPU timings of frame %llu, its queries were never written.",
+										 (unsigned long long)slot.frameNumber);
+	}
+	ResetFrameSlot(slot);
+	slot.frameNumber = frameNumber;
+	m_Recording = true;
+}
+
+void GpuProfiler::CollectTracyZones(VkCommandBuffer commandBuffer) {
+	if (!m_Enabled) {
+		return;
+	}
+	TracyVkCollect(m_TracyContext, commandBuffer);
+}
+
+GpuZone GpuProfiler::BeginZone(VkCommandBuffer commandBuffer, GpuQueue queue, const char* name) {
+	uint32_t query = AllocateQueries(queue);
+	if (query == CEE_INVALID_GPU_ZONE) {
+		return CEE_INVALID_GPU_ZONE;
+	}
+	FrameSlot& slot = m_FrameSlots[m_FrameIndex];
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.queryPools[queue], query);
+
+	Zone zone = {};
+	zone.name = name;
+	zone.queue = queue;
+	zone.query = query;
+	zone.commandBuffer = commandBuffer;
+	zone.tracyScope = NULL;
+#ifdef TRACY_ENABLE
+	if (queue == GPU_QUEUE_GRAPHICS) {
+		// Heap allocated since the zone usually ends in another function.
+		zone.tracyScope = new tracy::VkCtxScope(m_TracyContext, __LINE__, __FILE__, strlen(__FILE__),
+												__FUNCTION__, strlen(__FUNCTION__), name, strlen(name),
+												commandBuffer, true);
+	}
+#endif
+	slot.zones.push_back(zone);
+	return slot.zones.size() - 1;
+}
+
+void GpuProfiler::EndZone(GpuZone zone) {
+	if (zone == CEE_INVALID_GPU_ZONE || !m_Recording) {
+		return;
+	}
+	FrameSlot& slot = m_FrameSlots[m_FrameIndex];
+	Zone& ended = slot.zones[zone];
+#ifdef TRACY_ENABLE
+	// Writes Tracy's end timestamp.
+	delete ended.tracyScope;
+	ended.tracyScope = NULL;
+#endif
+	vkCmdWriteTimestamp(ended.commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+						slot.queryPools[ended.queue], ended.query + 1);
+}
+
+void GpuProfiler::WrapSubmission(GpuQueue queue, const char* name, std::vector<VkCommandBuffer>& commandBuffers) {
+	if (!m_Recording || m_FrameSlots[m_FrameIndex].submissionWrapped[queue]) {
+		return;
+	}
+	uint32_t query = AllocateQueries(queue);
+	if (query == CEE_INVALID_GPU_ZONE) {
+		return;
+	}
+	ZoneScoped;
+	FrameSlot& slot = m_FrameSlots[m_FrameIndex];
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.pNext = NULL;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = NULL;
+	for (uint32_t i = 0; i < 2; i++) {
+		VkCommandBuffer commandBuffer = slot.submissionCommandBuffers[queue][i];
+		vkResetCommandBuffer(commandBuffer, 0);
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		// The end timestamp is written once every earlier command of the submission has
+		// completed.
+		vkCmdWriteTimestamp(commandBuffer,
+							i == 0 ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+							slot.queryPools[queue], query + i);
+		vkEndCommandBuffer(commandBuffer);
+	}
+	commandBuffers.insert(commandBuffers.begin(), slot.submissionCommandBuffers[queue][0]);
+	commandBuffers.push_back(slot.submissionCommandBuffers[queue][1]);
+	slot.submissionWrapped[queue] = true;
+
+	Zone zone = {};
+	zone.name = name;
+	zone.queue = queue;
+	zone.query = query;
+	zone.commandBuffer = VK_NULL_HANDLE;
+	zone.tracyScope = NULL;
+	slot.zones.push_back(zone);
+}
+
+int GpuProfiler::ResolveFrameSlot(FrameSlot& slot) {
+	ZoneScoped;
+	// Value and availability of each query.
+	std::vector<uint64_t> results[GPU_QUEUE_COUNT];
+	for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+		uint32_t queryCount = slot.queryCounts[i];
+		if (queryCount == 0) {
+			continue;
+		}
+		results[i].resize(queryCount * 2);
+		VkResult result = vkGetQueryPoolResults(m_Device, slot.queryPools[i], 0, queryCount,
+												results[i].size() * sizeof(uint64_t), results[i].data(),
+												2 * sizeof(uint64_t),
+												VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (result != VK_SUCCESS && result != VK_NOT_READY) {
+			return -1;
+		}
+		for (uint32_t query = 0; query < queryCount; query++) {
+			if (results[i][query * 2 + 1] == 0) {
+				return -1;
+			}
+		}
+	}
+
+	uint64_t gpuTime = 0;
+	uint64_t cpuTime = 0;
+	bool calibrated = false;
+	if (m_Calibrated) {
+		VkCalibratedTimestampInfoEXT timestampInfos[2] = {};
+		timestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		timestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		timestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		timestampInfos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+		uint64_t timestamps[2];
+		uint64_t maxDeviation;
+		if (m_GetCalibratedTimestamps(m_Device, 2, timestampInfos, timestamps, &maxDeviation) == VK_SUCCESS) {
+			gpuTime = timestamps[0];
+			cpuTime = timestamps[1];
+			calibrated = true;
+		}
+	}
+
+	uint64_t earliest = UINT64_MAX;
+	for (const auto& zone : slot.zones) {
+		earliest = std::min(earliest, results[zone.queue][zone.query * 2] & m_TimestampMasks[zone.queue]);
+	}
+
+	m_FrameTimings.frameNumber = slot.frameNumber;
+	m_FrameTimings.calibrated = calibrated;
+	m_FrameTimings.zones.clear();
+	for (const auto& zone : slot.zones) {
+		uint64_t mask = m_TimestampMasks[zone.queue];
+		uint64_t begin = results[zone.queue][zone.query * 2] & mask;
+		uint64_t end = results[zone.queue][zone.query * 2 + 2] & mask;
+
+		GpuZoneTiming timing = {};
+		timing.name = zone.name;
+		timing.queue = zone.queue;
+		timing.duration = (uint64_t)(((end - begin) & mask) * m_TimestampPeriod);
+		if (calibrated) {
+			timing.start = cpuTime - (uint64_t)(((gpuTime - begin) & mask) * m_TimestampPeriod);
+		} else {
+			timing.start = (uint64_t)(((begin - earliest) & mask) * m_TimestampPeriod);
+		}
+		m_FrameTimings.zones.push_back(timing);
+
+		if (zone.commandBuffer == VK_NULL_HANDLE) {
+			TracyPlot(zone.name, timing.duration / 1000000.0);
+		}
+	}
+	return 0;
+}
+
+void GpuProfiler::ResetFrameSlot(FrameSlot& slot) {
+	for (uint32_t i = 0; i < GPU_QUEUE_COUNT; i++) {
+		if (slot.queryCounts[i] != 0) {
+			vkResetQueryPool(m_Device, slot.queryPools[i], 0, slot.queryCounts[i]);
+		}
+		slot.queryCounts[i] = 0;
+		slot.submissionWrapped[i] = false;
+	}
+	slot.zones.clear();
+	slot.retries = 0;
+}
+
+uint32_t GpuProfiler::AllocateQueries(GpuQueue queue) {
+	if (!m_Recording) {
+		return CEE_INVALID_GPU_ZONE;
+	}
+	FrameSlot& slot = m_FrameSlots[m_FrameIndex];
+	if (slot.queryPools[queue] == VK_NULL_HANDLE || slot.queryCounts[queue] + 2 > CEE_GPU_PROFILER_QUERY_COUNT) {
+		return CEE_INVALID_GPU_ZONE;
+	}
+	uint32_t query = slot.queryCounts[queue];
+	slot.queryCounts[queue] += 2;
+	return query;
+}
+}
@@ -10,14 +10,45 @@
 #include <CeeEngine/window.h>
 #include <CeeEngine/renderer.h>
 #include <CeeEngine/debugMessenger.h>
+#include <CeeEngine/frameTimer.h>
 
+#include <cstdio>
 #include <memory>
+#include <string>
 #include <thread>
 namespace cee {
 
 struct CEEAPI ApplicationSpec {
 	CeeErrorSeverity messageLevels = (CeeErrorSeverity)(ERROR_SEVERITY_WARNING | ERROR_SEVERITY_ERROR);
 	bool EnableValidation = false;
+	bool EnableShaderHotReload = false;
+	// Renderer2D or Renderer3D, the one layers draw with.
+	RendererMode Mode = RENDERER_MODE_3D;
+	// Renders offscreen without creating a window, e.g. on CI machines with no display.
+	bool Headless = false;
+	uint32_t HeadlessWidth = 1280;
+	uint32_t HeadlessHeight = 720;
+	// Closes the application after this many frames, 0 runs until closed.
+	uint64_t FrameLimit = 0;
+	// Collects pipeline statistics queries per pass, see RendererStatistics.
+	bool PipelineStatistics = false;
+	// Size of the renderer's per frame batch, 0 for the default. Scenes with more
+	// primitives, e.g. DrawQuads() of many particles, need to raise it.
+	uint32_t MaxIndices = 0;
+	// Batches half size vertices with quantized attributes, see RendererSpec::packedVertices.
+	bool PackedVertices = false;
+	// Mesh instances drawn per frame, 0 for the default, see RendererSpec::maxMeshInstances.
+	uint32_t MaxMeshInstances = 0;
+	// Culls meshes on the device, see RendererSpec::gpuCulling.
+	bool GpuCulling = false;
+	// Also culls meshes hidden behind the previous frame's depth, see
+	// RendererSpec::occlusionCulling.
+	bool OcclusionCulling = false;
+	// Frame time percentiles of each window of FrameTimingReportInterval frames are
+	// plotted to Tracy and, if a path is given, appended to it as CSV. The last
+	// partial window is reported on exit. 0 only reports on exit.
+	std::string FrameTimingReportPath;
+	uint64_t FrameTimingReportInterval = 600;
 };
 
 class CEEAPI Application {
@@ -34,6 +65,8 @@ public:
 
 	void CEECALL Close();
 
+	const FrameTimer& CEECALL GetFrameTimer() const { return m_FrameTimer; }
+
 private:
 	MessageBus m_MessageBus;
 	bool m_Running;
@@ -49,7 +82,12 @@ private:
 
 	std::thread m_RenderThread;
 
-	uint64_t m_AverageFrameTime;
+	RendererMode m_RendererMode;
+	uint64_t m_FrameLimit;
+
+	FrameTimer m_FrameTimer;
+	std::FILE* m_FrameTimingReport;
+	uint64_t m_FrameTimingReportInterval;
 
 private:
 	static Application* s_Instance;
@@ -3,6 +3,7 @@
 
 #include <filesystem>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace cee {
@@ -11,8 +12,20 @@ struct ShaderBinary {
 	std::vector<uint8_t> spvCode;
 };
 
+enum ShaderStage {
+	SHADER_STAGE_UNKNOWN  = 0,
+	SHADER_STAGE_VERTEX   = 1,
+	SHADER_STAGE_FRAGMENT = 2,
+	SHADER_STAGE_COMPUTE  = 3
+};
+
 struct ShaderCode {
 	std::string glslCode;
+	// File stem, used to name compiled cache entries.
+	std::string name;
+	// Inferred from the file name, either a .vert/.frag/.comp extension or a
+	// Vertex/Fragment/Compute suffix such as renderer2DQuadVertex.glsl.
+	ShaderStage stage = SHADER_STAGE_UNKNOWN;
 };
 
 struct PipelineCache {
@@ -0,0 +1,156 @@
+#ifndef CEE_ENGINE_BATCH_BUILDER_H
+#define CEE_ENGINE_BATCH_BUILDER_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace cee {
+struct Vertex2D {
+	glm::vec4 position;
+	glm::vec4 color;
+	glm::vec2 texCoords;
+	uint32_t texIndex;
+};
+
+struct Vertex3D {
+	glm::vec4 position;
+	glm::vec3 normal;
+	glm::vec4 color;
+	glm::vec2 texCoords;
+	uint32_t texIndex;
+};
+
+// Packed layouts of the same vertices for RendererSpec::packedVertices, about half the
+// upload and fetch size. Positions stay 32 bit floats since batches are built in world
+// space, the renderer feeds the rest through normalized and half float formats.
+struct Vertex2DPacked {
+	glm::vec3 position;
+	// R8G8B8A8_UNORM.
+	uint32_t color;
+	// R16G16_UNORM, texture atlas coordinates are always within 0 to 1.
+	uint32_t texCoords;
+	uint32_t texIndex;
+};
+
+struct Vertex3DPacked {
+	glm::vec3 position;
+	// Octahedral encoded unit vector, R16G16_SNORM.
+	uint32_t normal;
+	// R8G8B8A8_UNORM.
+	uint32_t color;
+	// R16G16_SFLOAT, so textures can repeat.
+	uint32_t texCoords;
+	uint32_t texIndex;
+};
+
+#define CEE_QUAD_VERTEX_COUNT 4
+#define CEE_QUAD_INDEX_COUNT 6
+#define CEE_CUBE_VERTEX_COUNT 24
+#define CEE_CUBE_INDEX_COUNT 36
+
+inline glm::mat4 ConstructTransformMatrix2D(const glm::vec3& translation,
+											float rotationAngle,
+											const glm::vec3& scale)
+{
+	glm::mat4 transform = glm::identity<glm::mat4>();
+	transform = glm::translate(transform, translation);
+	if (rotationAngle != 0.0f) {
+		float rs = sinf(rotationAngle);
+		float rc = cosf(rotationAngle);
+
+		glm::mat4 rm = {
+			{ rc,   rs,   0.0f, 0.0f },
+			{ -rs,  rc,   0.0f, 0.0f },
+			{ 0.0f, 0.0f, 1.0f, 0.0f },
+			{ 0.0f, 0.0f, 0.0f, 1.0f }
+		};
+		transform = transform * rm;
+	}
+	transform = glm::scale(transform, scale);
+
+	return transform;
+}
+
+inline glm::mat4 ConstructTransformMatrix3D(const glm::vec3& translation,
+											float rotationAngle,
+											const glm::vec3& rotationAxis,
+											const glm::vec3& scale)
+{
+	glm::mat4 transform = glm::identity<glm::mat4>();
+	transform = glm::translate(transform, translation);
+	if (rotationAngle != 0.0f)
+		transform = glm::rotate(transform, rotationAngle, rotationAxis);
+	transform = glm::scale(transform, scale);
+
+	return transform;
+}
+
+// Quads for Renderer2D::DrawQuads() as one array per attribute, so the batch kernel
+// loads several quads with each instruction. Every array holds count values,
+// translationZ and rotationAngle may be NULL for quads at z 0 or without rotation.
+struct QuadInstances {
+	const float* translationX;
+	const float* translationY;
+	const float* translationZ;
+	const float* rotationAngle;
+	const float* scaleX;
+	const float* scaleY;
+	const glm::vec4* color;
+	size_t count;
+};
+
+// The CPU side of the Renderer2D and Renderer3D batches. These only write to the memory
+// they are given, so they run without a device, e.g. in CeeBench.
+
+// Writes CEE_QUAD_VERTEX_COUNT vertices of a unit quad centred on translation. uvMin and
+// uvMax are the texture coordinates of the bottom left and top right corners.
+void BuildQuadVertices(const glm::vec3& translation,
+					   float rotationAngle,
+					   const glm::vec3& scale,
+					   const glm::vec4& color,
+					   const glm::vec2& uvMin,
+					   const glm::vec2& uvMax,
+					   uint32_t texIndex,
+					   Vertex2D* vertices);
+// Same as BuildQuadVertices() for quads first to first + count - 1 of quads, all
+// sampling the same texture region. Works on four quads at a time with SSE2 and
+// eight with AVX2 when compiled for them, the remainder is done one by one.
+void BuildQuadVertexBatch(const QuadInstances& quads,
+						  size_t first,
+						  size_t count,
+						  const glm::vec2& uvMin,
+						  const glm::vec2& uvMax,
+						  uint32_t texIndex,
+						  Vertex2D* vertices);
+// memcpy with non-temporal stores, which skip the cache and write whole lines to
+// write combined memory. For large batches built in a small cached buffer and copied
+// to mapped staging memory that is never read back.
+void StreamCopy(void* dst, const void* src, size_t size);
+// Converts count vertices to the packed layouts. Colors are clamped to 0 to 1, normals
+// have to be unit length.
+void PackVertices(const Vertex2D* vertices, size_t count, Vertex2DPacked* packed);
+void PackVertices(const Vertex3D* vertices, size_t count, Vertex3DPacked* packed);
+// Maps a unit vector onto the octahedron unfolded into -1 to 1 on both axes. Decoded
+// by the packed vertex shaders, the error after snorm16 quantization is below 0.05 degrees.
+glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+// Writes the indices of quadCount consecutive quads starting at vertex 0.
+void BuildQuadIndices(uint32_t quadCount, uint32_t* indices);
+
+// Writes CEE_CUBE_VERTEX_COUNT vertices of a cube spanning -1 to 1 before scaling, and
+// CEE_CUBE_INDEX_COUNT indices referring to them as vertices baseVertex onwards.
+void BuildCubeVertices(const glm::vec3& translation,
+					   float rotationAngle,
+					   const glm::vec3& rotationAxis,
+					   const glm::vec3& scale,
+					   const glm::vec4& color,
+					   uint32_t texIndex,
+					   uint32_t baseVertex,
+					   Vertex3D* vertices,
+					   uint32_t* indices);
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef _CEE_ENGINE_CAMERA_H
 #define _CEE_ENGINE_CAMERA_H
 
+#include <CeeEngine/frustum.h>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -17,6 +19,9 @@ public:
 	glm::mat4 GetTransform() { return m_Transform; }
 	const glm::mat4& GetTransform() const { return m_Transform; }
 
+	// World space planes of the volume the camera sees.
+	Frustum GetFrustum() const { return Frustum(m_Projection * m_Transform); }
+
 	void SetPosition(const glm::vec3& position);
 	void Translate(const glm::vec3& translateBy);
 	void SetRotation(const glm::vec3& vector);
@@ -44,10 +44,21 @@ public:
 	static void PostDebugMessage(CeeErrorSeverity serverity, const char* fmt, Args&&... args)
 	{
 		if (serverity & s_ReportErrorLevels) {
-			size_t messageLen = snprintf(nullptr, 0, fmt, std::forward<Args>(args)...);
+			// Most messages fit on the stack, longer ones are formatted a second time
+			// into the heap. The message is only valid during the callback.
+			char buffer[256];
+			int messageLen = snprintf(buffer, sizeof(buffer), fmt, args...);
+			if (messageLen < 0) {
+				return;
+			}
+			if ((size_t)messageLen < sizeof(buffer)) {
+				s_Messenger(serverity, buffer, s_UserData);
+				return;
+			}
 			char* message = reinterpret_cast<char*>(malloc(messageLen + 1));
-			snprintf(message, messageLen + 1, fmt, std::forward<Args>(args)...);
+			snprintf(message, messageLen + 1, fmt, args...);
 			s_Messenger(serverity, message, s_UserData);
+			free(message);
 		}
 	}
 };
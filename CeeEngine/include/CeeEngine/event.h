@@ -12,7 +12,7 @@ namespace cee {
 enum class EventType {
 	none = 0,
 	WindowClose, WindowResize, WindowFocus, WindowLostFocus, WindowMove,
-	AppTick, AppUpdate, AppRender,
+	AppTick, AppUpdate, AppRender, RendererStatistics,
 	KeyPressed, KeyReleased, KeyTyped,
 	MouseButtonPressed, MouseButtonReleased, MouseMove, MouseScroll
 };
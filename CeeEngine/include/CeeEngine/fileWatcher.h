@@ -0,0 +1,35 @@
+#ifndef CEE_ENGINE_FILE_WATCHER_H
+#define CEE_ENGINE_FILE_WATCHER_H
+
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace cee {
+// Reports files written to or moved into watched directories. Polling never
+// blocks, so it is cheap enough to call once per frame. Only implemented with
+// inotify, on other platforms Watch() fails and nothing is reported.
+class FileWatcher {
+public:
+	FileWatcher();
+	FileWatcher(const FileWatcher&) = delete;
+	~FileWatcher();
+
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Not recursive, subdirectories have to be watched separately.
+	int Watch(const std::filesystem::path& directory);
+	// Appends files changed since the last call. A file saved several times in
+	// between is reported once.
+	void Poll(std::vector<std::filesystem::path>& changedFiles);
+
+	bool IsWatching() const { return !m_Directories.empty(); }
+
+private:
+	int m_Fd;
+	// Indexed by watch descriptor.
+	std::unordered_map<int, std::filesystem::path> m_Directories;
+};
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef CEE_ENGINE_FRAME_CAPTURE_H
+#define CEE_ENGINE_FRAME_CAPTURE_H
+
+#include <CeeEngine/renderer.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cee {
+enum FrameCaptureFormat {
+	FRAME_CAPTURE_FORMAT_PNG = 0,
+	// Headerless RGBA8 rows, top to bottom.
+	FRAME_CAPTURE_FORMAT_RAW = 1
+};
+
+// Both write RGBA8, BGRA readbacks are swizzled. Returns -1 if the format is not
+// 8 bits per channel or the file cannot be written.
+int WriteFramePNG(const std::filesystem::path& filePath, const FrameReadback& frame);
+int WriteFrameRaw(const std::filesystem::path& filePath, const FrameReadback& frame);
+
+// Writes read back frames to <directory>/<prefix><frame number>.png (or .rgba) on a
+// background thread, so encoding never lands in the frames being measured. The
+// render thread only pays for copying the pixels out of the readback buffer.
+class FrameCapture {
+public:
+	FrameCapture(std::filesystem::path directory, std::string prefix, FrameCaptureFormat format);
+	FrameCapture(const FrameCapture&) = delete;
+	// Waits for queued frames to be written. Frames still in flight on the GPU are
+	// dropped.
+	~FrameCapture();
+
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	// Captures the next frame ended. Render thread only.
+	int CaptureFrame();
+
+	// Frames requested or queued but not yet written.
+	size_t GetPendingCount();
+
+private:
+	struct CapturedFrame {
+		uint64_t frameNumber;
+		VkExtent2D extent;
+		VkFormat format;
+		std::vector<uint8_t> pixels;
+	};
+
+	// Shared with the readback callbacks, which may outlive the capture.
+	struct State {
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<CapturedFrame> queue;
+		size_t requested = 0;
+		bool stop = false;
+	};
+
+	void WriterThread();
+
+private:
+	std::filesystem::path m_Directory;
+	std::string m_Prefix;
+	FrameCaptureFormat m_Format;
+
+	std::shared_ptr<State> m_State;
+	std::thread m_Thread;
+};
+}
+
+#endif
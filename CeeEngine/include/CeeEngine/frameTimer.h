@@ -0,0 +1,118 @@
+#ifndef CEE_ENGINE_FRAME_TIMER_H
+#define CEE_ENGINE_FRAME_TIMER_H
+
+#include <CeeEngine/platform.h>
+#include <CeeEngine/timestep.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+namespace cee {
+// Buckets are exact below 64ns, above that each power of two is split into 32
+// buckets, so a recorded time is within ~3% of its bucket. Times are clamped to
+// 2^40ns, about 18 minutes.
+#define CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS 5
+#define CEE_FRAME_HISTOGRAM_MAX_EXPONENT 40
+#define CEE_FRAME_HISTOGRAM_BUCKET_COUNT \
+	((CEE_FRAME_HISTOGRAM_MAX_EXPONENT - CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS + 1) << CEE_FRAME_HISTOGRAM_SUB_BUCKET_BITS)
+
+// Nanoseconds.
+struct FrameTimeSummary {
+	uint64_t count;
+	uint64_t mean;
+	uint64_t p50;
+	uint64_t p95;
+	uint64_t p99;
+	uint64_t max;
+};
+
+// Fixed size log-linear histogram. Recording is lock free and may happen on any
+// thread, reads see each bucket atomically but not the histogram as a whole.
+class CEEAPI FrameTimeHistogram {
+public:
+	FrameTimeHistogram();
+	FrameTimeHistogram(const FrameTimeHistogram&) = delete;
+	~FrameTimeHistogram() = default;
+
+	FrameTimeHistogram& operator=(const FrameTimeHistogram&) = delete;
+
+	void Record(uint64_t nanoseconds);
+	// Not atomic with respect to concurrent Record() calls.
+	void Reset();
+
+	uint64_t GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+	uint64_t GetMax() const { return m_Max.load(std::memory_order_relaxed); }
+	// Upper bound of the bucket holding the percentile (0-100), never above the max.
+	uint64_t GetPercentile(double percentile) const;
+	FrameTimeSummary Summarize() const;
+
+private:
+	static uint32_t GetBucketIndex(uint64_t value);
+	static uint64_t GetBucketUpperBound(uint32_t index);
+
+private:
+	std::array<std::atomic<uint64_t>, CEE_FRAME_HISTOGRAM_BUCKET_COUNT> m_Buckets;
+	std::atomic<uint64_t> m_Count;
+	std::atomic<uint64_t> m_Sum;
+	std::atomic<uint64_t> m_Max;
+};
+
+enum FramePhase {
+	// Layer::OnUpdate().
+	FRAME_PHASE_UPDATE = 0,
+	// StartFrame(), mostly waiting on the frame's fence and acquiring the image.
+	FRAME_PHASE_WAIT,
+	// Layer::OnRender(), recording draws.
+	FRAME_PHASE_RENDER,
+	// EndFrame(), submission and present.
+	FRAME_PHASE_END_FRAME,
+	// Window polling and message bus dispatch.
+	FRAME_PHASE_EVENTS,
+	FRAME_PHASE_COUNT
+};
+
+// Times each frame and its phases into histograms. Each histogram is kept twice,
+// once since the start and once for the window since the last report, so stutters
+// show up in the report of the interval they happened in.
+class CEEAPI FrameTimer {
+public:
+	FrameTimer();
+	FrameTimer(const FrameTimer&) = delete;
+	~FrameTimer() = default;
+
+	FrameTimer& operator=(const FrameTimer&) = delete;
+
+	// Starts the frame and its first phase.
+	void BeginFrame();
+	// Ends the phase started by BeginFrame() or the previous EndPhase().
+	void EndPhase(FramePhase phase);
+	void EndFrame();
+
+	// Since the start.
+	const FrameTimeHistogram& GetFrameHistogram() const { return m_Frame; }
+	const FrameTimeHistogram& GetPhaseHistogram(FramePhase phase) const { return m_Phases[phase]; }
+	static const char* GetPhaseName(FramePhase phase);
+
+	// Writes a CSV header matching WriteReport().
+	static void WriteReportHeader(std::FILE* file);
+	// Appends one line per histogram for the current window to file if given, plots
+	// the window percentiles to Tracy and starts a new window.
+	void WriteReport(std::FILE* file, uint64_t frameNumber);
+
+private:
+	static uint64_t GetNanoseconds();
+
+private:
+	uint64_t m_FrameStart;
+	uint64_t m_PhaseStart;
+
+	FrameTimeHistogram m_Frame;
+	std::array<FrameTimeHistogram, FRAME_PHASE_COUNT> m_Phases;
+	FrameTimeHistogram m_WindowFrame;
+	std::array<FrameTimeHistogram, FRAME_PHASE_COUNT> m_WindowPhases;
+};
+}
+
+#endif
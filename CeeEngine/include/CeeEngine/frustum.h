@@ -0,0 +1,55 @@
+#ifndef CEE_ENGINE_FRUSTUM_H
+#define CEE_ENGINE_FRUSTUM_H
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace cee {
+enum FrustumPlane {
+	FRUSTUM_PLANE_LEFT = 0,
+	FRUSTUM_PLANE_RIGHT,
+	FRUSTUM_PLANE_BOTTOM,
+	FRUSTUM_PLANE_TOP,
+	FRUSTUM_PLANE_NEAR,
+	FRUSTUM_PLANE_FAR,
+	FRUSTUM_PLANE_COUNT
+};
+
+// Planes of the volume a view projection matrix maps into clip space, in the space
+// the matrix maps from. The tests are conservative, a volume crossing two planes
+// outside a corner of the frustum is reported as intersecting.
+class Frustum {
+public:
+	// Contains everything.
+	Frustum();
+	// Extracted from the rows of the matrix (Gribb and Hartmann) for a 0 to 1 clip
+	// space depth, world space planes for projection * view.
+	Frustum(const glm::mat4& viewProjection);
+
+	// Normalized, points p with dot(plane.xyz, p) + plane.w >= 0 are inside.
+	glm::vec4 GetPlane(FrustumPlane plane) const;
+
+	// Tests against all planes at once with SSE2, or AVX2 when compiled for it.
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	// An axis aligned box given by its center and half size.
+	bool IntersectsBox(const glm::vec3& center, const glm::vec3& extents) const;
+
+private:
+	bool Intersects(const glm::vec3& center, const glm::vec3& extents, float radius) const;
+
+private:
+	// One array per plane component, padded to eight planes with ones every point is
+	// inside, so each test is one or two full vector operations. The absolute normal
+	// components give the reach of a box towards each plane.
+	alignas(32) float m_X[8];
+	alignas(32) float m_Y[8];
+	alignas(32) float m_Z[8];
+	alignas(32) float m_W[8];
+	alignas(32) float m_AbsX[8];
+	alignas(32) float m_AbsY[8];
+	alignas(32) float m_AbsZ[8];
+};
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef CEE_ENGINE_GPU_PROFILER_H
+#define CEE_ENGINE_GPU_PROFILER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace tracy {
+class VkCtx;
+class VkCtxScope;
+}
+
+namespace cee {
+enum GpuQueue {
+	GPU_QUEUE_GRAPHICS = 0,
+	GPU_QUEUE_TRANSFER = 1,
+	GPU_QUEUE_COUNT
+};
+
+typedef uint32_t GpuZone;
+#define CEE_INVALID_GPU_ZONE UINT32_MAX
+
+struct GpuZoneTiming {
+	// The name passed to BeginZone().
+	const char* name;
+	GpuQueue queue;
+	// Nanoseconds. With calibrated timestamps start is on the CLOCK_MONOTONIC timeline
+	// of GetTime(), otherwise it is relative to the earliest zone of the frame.
+	uint64_t start;
+	uint64_t duration;
+};
+
+struct GpuFrameTimings {
+	uint64_t frameNumber = 0;
+	bool calibrated = false;
+	// In the order the zones were begun.
+	std::vector<GpuZoneTiming> zones;
+
+	// Summed over the zones of that name, 0 if there are none.
+	double GetMilliseconds(const char* name) const;
+};
+
+struct GpuProfilerSpec {
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	uint32_t framesInFlight;
+	// Indexed by GpuQueue.
+	uint32_t queueFamilyIndices[GPU_QUEUE_COUNT];
+	VkQueue queues[GPU_QUEUE_COUNT];
+	// Query pools are reset from the host, since transfer queues cannot reset them.
+	bool hostQueryReset;
+	// VK_EXT_calibrated_timestamps is enabled on the device.
+	bool calibratedTimestamps;
+};
+
+// Timestamp queries around passes and submission batches. Each frame in flight has its
+// own query pools, which are read back once the frame's fence has been waited on
+// anyway, so results arrive maxFramesInFlight frames late but never stall the GPU.
+// Graphics zones are also reported to Tracy as GPU zones, batches as plots.
+class GpuProfiler {
+public:
+	GpuProfiler();
+	GpuProfiler(const GpuProfiler&) = delete;
+	~GpuProfiler();
+
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// Leaves the profiler disabled if the device cannot write timestamps on the
+	// graphics queue or reset queries from the host. Cleans up after itself on failure.
+	int Init(const GpuProfilerSpec& spec);
+	// The device has to be idle. Destroys whatever Init() created, even if it failed.
+	void Shutdown();
+
+	// Call once the frame slot's fence has been waited on. Resolves the zones last
+	// recorded in the slot and resets its queries. If the slot is still busy, e.g. the
+	// transfer queue is behind, its results are kept for later and nothing is recorded
+	// this frame.
+	void BeginFrame(uint32_t frameIndex, uint64_t frameNumber);
+	// Reads back Tracy's queries. Has to be recorded outside a render pass on the
+	// graphics queue.
+	void CollectTracyZones(VkCommandBuffer commandBuffer);
+
+	// Both timestamps are written to commandBuffer, EndZone() has to be recorded into
+	// the same command buffer. name has to outlive the profiler, use string literals.
+	// Returns CEE_INVALID_GPU_ZONE when not recording, which EndZone() ignores.
+	GpuZone BeginZone(VkCommandBuffer commandBuffer, GpuQueue queue, const char* name);
+	void EndZone(GpuZone zone);
+	// Times a whole submission by adding command buffers writing the timestamps before
+	// and after the others. Once per queue per frame, after the previous submission of
+	// this slot has been waited on.
+	void WrapSubmission(GpuQueue queue, const char* name, std::vector<VkCommandBuffer>& commandBuffers);
+
+	bool IsEnabled() const { return m_Enabled; }
+	// The most recently resolved frame.
+	const GpuFrameTimings& GetFrameTimings() const { return m_FrameTimings; }
+
+private:
+	struct Zone {
+		const char* name;
+		GpuQueue queue;
+		// Begin query, the end query follows it.
+		uint32_t query;
+		// VK_NULL_HANDLE for wrapped submissions, which are plotted instead.
+		VkCommandBuffer commandBuffer;
+		tracy::VkCtxScope* tracyScope;
+	};
+
+	struct FrameSlot {
+		VkQueryPool queryPools[GPU_QUEUE_COUNT];
+		uint32_t queryCounts[GPU_QUEUE_COUNT];
+		// Two per queue, written before and after a wrapped submission.
+		VkCommandBuffer submissionCommandBuffers[GPU_QUEUE_COUNT][2];
+		bool submissionWrapped[GPU_QUEUE_COUNT];
+		std::vector<Zone> zones;
+		uint64_t frameNumber;
+		// Frames the slot was skipped because its queries were not available.
+		uint32_t retries;
+	};
+
+	// Returns -1 if a query of the slot is not available yet.
+	int ResolveFrameSlot(FrameSlot& slot);
+	void ResetFrameSlot(FrameSlot& slot);
+	uint32_t AllocateQueries(GpuQueue queue);
+
+private:
+	bool m_Enabled;
+	// Set by BeginFrame() when the current slot was reset.
+	bool m_Recording;
+	VkDevice m_Device;
+	double m_TimestampPeriod;
+	// Per queue, the valid bits of the timestamps written on it.
+	uint64_t m_TimestampMasks[GPU_QUEUE_COUNT];
+	VkCommandPool m_CommandPools[GPU_QUEUE_COUNT];
+
+	bool m_Calibrated;
+	PFN_vkGetCalibratedTimestampsEXT m_GetCalibratedTimestamps;
+
+	std::vector<FrameSlot> m_FrameSlots;
+	uint32_t m_FrameIndex;
+
+	GpuFrameTimings m_FrameTimings;
+
+	tracy::VkCtx* m_TracyContext;
+};
+}
+
+#endif
@@ -13,6 +13,8 @@ namespace Input {
 	void Init(MessageBus* messageBus, std::shared_ptr<Window> window);
 	void Shutdown();
 	int GetKeyState(KeyCode keycode);
+	// Key code of an X keysym, 0 if the key is not mapped. Works without Init().
+	KeyCode TranslateKeysym(uint32_t keysym);
 }
 }
 
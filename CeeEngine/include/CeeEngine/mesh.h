@@ -0,0 +1,105 @@
+#ifndef CEE_ENGINE_MESH_H
+#define CEE_ENGINE_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace cee {
+// Static meshes are stored as .cmesh files, little endian:
+//   MeshFileHeader
+//   MeshVertex[vertexCount]
+//   indexCount indices of indexSize bytes, padded to 4 bytes
+//   Submesh[submeshCount]
+// They are loaded with AssetManager::LoadAsset<Mesh>() and written by CeeMeshConverter.
+// Version 2 added the levels of detail.
+#define CEE_MESH_MAGIC 0x48534d43u // "CMSH"
+#define CEE_MESH_VERSION 2u
+// The full mesh and up to four simplified levels.
+#define CEE_MESH_MAX_LODS 5
+
+struct BoundingBox {
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+// A single interleaved stream, read by renderer3DMeshVertex.
+struct MeshVertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texCoords;
+};
+
+struct IndexRange {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+};
+
+// Range of the index buffer drawn with one material.
+struct Submesh {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	BoundingBox bounds;
+	// Ranges of levels 1 to Mesh::lodCount - 1, using the same vertices.
+	IndexRange lods[CEE_MESH_MAX_LODS - 1];
+
+	IndexRange GetLod(uint32_t lod) const {
+		return lod == 0 ? IndexRange{ firstIndex, indexCount } : lods[lod - 1];
+	}
+};
+
+struct MeshFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexCount;
+	// sizeof(MeshVertex), so files of another layout are rejected.
+	uint32_t vertexSize;
+	uint32_t indexCount;
+	// 2 or 4.
+	uint32_t indexSize;
+	uint32_t submeshCount;
+	uint32_t lodCount;
+	BoundingBox bounds;
+	// Mesh::lodErrors.
+	float lodErrors[CEE_MESH_MAX_LODS];
+};
+
+// Per instance input of renderer3DMeshVertex, see Renderer3D::DrawMesh().
+struct MeshInstance {
+	glm::mat4 transform;
+	glm::vec4 color;
+	uint32_t texIndex;
+};
+
+struct Mesh {
+	std::vector<MeshVertex> vertices;
+	// Raw index buffer of indexSize bytes per index. 16 bit whenever every vertex can
+	// be addressed with them, halving the index fetch.
+	std::vector<uint8_t> indices;
+	uint32_t indexSize = sizeof(uint32_t);
+	std::vector<Submesh> submeshes;
+	BoundingBox bounds = {};
+	// Levels of detail, 1 for just the full mesh. Each level's error is the typical
+	// distance of its surface from the full mesh in object space units, the root mean
+	// square of the area weighted plane distances summed over the simplification
+	// steps. Single features may move further, 0 for level 0.
+	uint32_t lodCount = 1;
+	float lodErrors[CEE_MESH_MAX_LODS] = {};
+
+	uint32_t GetIndexCount() const { return indices.size() / indexSize; }
+	uint32_t GetIndex(size_t i) const;
+	// Widened to 32 bit, for processing.
+	std::vector<uint32_t> GetIndices() const;
+	// Stores the indices with the smallest index size that fits the vertices.
+	void SetIndices(const std::vector<uint32_t>& indices32);
+	// Recomputes the bounds of the mesh and of every submesh from the vertices.
+	void ComputeBounds();
+	// Checks the submesh and level of detail ranges and that every index refers to a
+	// vertex. Returns -1 and posts an error naming the first problem found.
+	int Validate() const;
+};
+}
+
+#endif
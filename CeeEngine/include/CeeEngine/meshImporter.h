@@ -0,0 +1,17 @@
+#ifndef CEE_ENGINE_MESH_IMPORTER_H
+#define CEE_ENGINE_MESH_IMPORTER_H
+
+#include <CeeEngine/mesh.h>
+
+#include <filesystem>
+
+namespace cee {
+// Reads a Wavefront OBJ into a mesh. Polygons are triangulated as fans and vertices
+// sharing position, texture coordinates and normal are merged. Faces are grouped into
+// one submesh per material in the order the materials first appear, materials
+// themselves are not read. Missing normals are generated by averaging the faces
+// around each vertex. Returns -1 if the file cannot be read or has no faces.
+int ImportObj(const std::filesystem::path& filePath, Mesh* mesh);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef CEE_ENGINE_MESH_OPTIMIZER_H
+#define CEE_ENGINE_MESH_OPTIMIZER_H
+
+#include <CeeEngine/mesh.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cee {
+// Post transform cache modelled by the statistics, a FIFO of this many vertices is
+// close to what current GPUs reuse within a draw.
+#define CEE_MESH_STATS_CACHE_SIZE 16
+// LRU cache the vertex cache optimization scores against, larger than the hardware
+// cache so the order stays good on any cache size.
+#define CEE_MESH_OPTIMIZER_CACHE_SIZE 32
+// Meshlet limits matching the common mesh shader output limits.
+#define CEE_MESHLET_MAX_VERTICES 64
+#define CEE_MESHLET_MAX_TRIANGLES 124
+
+struct VertexCacheStats {
+	// Average cache misses per triangle, 0.5 is ideal for large regular meshes and 3
+	// the worst case.
+	float acmr;
+	// Average transforms per vertex, 1 means every vertex is shaded exactly once.
+	float atvr;
+};
+
+struct MeshOptimizationStats {
+	VertexCacheStats before;
+	VertexCacheStats after;
+	// Vertices dropped because no triangle referenced them.
+	uint32_t unusedVertices;
+};
+
+struct MeshOptimizationSpec {
+	bool vertexCache = true;
+	// Reorders clusters of triangles so faces likely to occlude others are drawn first,
+	// keeping the ACMR within overdrawThreshold times the cache optimized one.
+	bool overdraw = true;
+	float overdrawThreshold = 1.05f;
+	bool vertexFetch = true;
+};
+
+// Runs of at most CEE_MESHLET_MAX_TRIANGLES triangles of one submesh using at most
+// CEE_MESHLET_MAX_VERTICES vertices, with a bounding sphere for culling.
+struct Meshlet {
+	uint32_t vertexOffset;
+	uint32_t triangleOffset;
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+	glm::vec3 center;
+	float radius;
+};
+
+struct MeshletData {
+	std::vector<Meshlet> meshlets;
+	// Mesh vertex indices, vertexCount per meshlet from vertexOffset.
+	std::vector<uint32_t> vertices;
+	// Three indices into the meshlet's vertices per triangle, from triangleOffset * 3.
+	std::vector<uint8_t> triangles;
+};
+
+// Simulates a FIFO post transform cache of cacheSize vertices over the index buffer.
+VertexCacheStats ComputeVertexCacheStats(const uint32_t* indices, size_t indexCount,
+										 uint32_t vertexCount, uint32_t cacheSize);
+// Reorders the triangles for post transform cache reuse, after Tom Forsyth's "Linear
+// Speed Vertex Cache Optimisation". Triangles are only moved, never changed.
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+// Splits cache optimized indices into clusters where the cache is cold anyway and
+// sorts the clusters outermost and outward facing first, after Sander et al. "Fast
+// Triangle Reordering for Vertex Locality and Reduced Overdraw". Keeps the original
+// order if the ACMR would grow by more than threshold.
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const MeshVertex* vertices,
+					  uint32_t vertexCount, float threshold);
+// Reorders the vertices in the order the indices first use them, so vertex fetches
+// walk memory linearly, and drops unused vertices. Returns the vertices dropped.
+uint32_t OptimizeVertexFetch(Mesh* mesh);
+// Runs the enabled passes on every submesh and level of detail, then recomputes the
+// bounds. The statistics cover level 0, stats may be NULL.
+void OptimizeMesh(Mesh* mesh, const MeshOptimizationSpec& spec, MeshOptimizationStats* stats);
+// Splits every submesh into meshlets, in index order. Run after OptimizeMesh() so
+// the meshlets follow the cache friendly order.
+void BuildMeshlets(const Mesh& mesh, MeshletData* meshlets);
+}
+
+#endif
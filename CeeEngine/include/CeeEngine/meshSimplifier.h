@@ -0,0 +1,40 @@
+#ifndef CEE_ENGINE_MESH_SIMPLIFIER_H
+#define CEE_ENGINE_MESH_SIMPLIFIER_H
+
+#include <CeeEngine/mesh.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cee {
+struct MeshLodSpec {
+	// Levels including the full mesh, at most CEE_MESH_MAX_LODS.
+	uint32_t maxLods = CEE_MESH_MAX_LODS;
+	// Triangles of each level relative to the one before it.
+	float reduction = 0.5f;
+	// Largest error of any level, see Mesh::lodErrors, relative to the diagonal of the
+	// mesh bounds.
+	float maxError = 0.05f;
+};
+
+// Simplifies the triangles in indices by collapsing edges onto one of their vertices,
+// cheapest first by quadric error (Garland and Heckbert), until at most
+// targetIndexCount indices remain or the next collapse would move the surface by
+// more than maxError, as the root mean square of the area weighted distances to the
+// planes it had before. Vertices on open borders, attribute seams and non manifold
+// edges are kept so the silhouette and texture mapping hold, and collapses that
+// would flip a triangle are skipped. Only vertices already referenced are used.
+// Writes the remaining indices to destination, which may be indices, and returns
+// their count. error receives the largest of these errors over the collapses made.
+size_t SimplifyIndices(const uint32_t* indices, size_t indexCount,
+					   const MeshVertex* vertices, uint32_t vertexCount,
+					   size_t targetIndexCount, float maxError,
+					   uint32_t* destination, float* error);
+// Replaces the levels of detail of the mesh with a chain, each level of each submesh
+// simplified from the one before it and appended after level 0 in the index buffer.
+// Stops early once a level no longer removes a tenth of the triangles of the one
+// before it.
+void GenerateLods(Mesh* mesh, const MeshLodSpec& spec);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef CEE_ENGINE_MIPMAP_H
+#define CEE_ENGINE_MIPMAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cee {
+// Number of levels in a full mip chain, down to 1x1.
+uint32_t CalculateMipLevels(uint32_t width, uint32_t height);
+
+// Mip chains are stored tightly packed as RGBA8, largest level first, with
+// every layer of a level stored contiguously. This matches the buffer layout
+// vkCmdCopyBufferToImage expects for one copy region per level.
+size_t CalculateMipLevelOffset(uint32_t width, uint32_t height, uint32_t level, uint32_t layers);
+size_t CalculateMipChainSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers);
+
+// 2x2 box filter of an sRGB RGBA8 image into the next level. Odd edges are clamped.
+// The color channels are averaged in linear space so minified textures keep their
+// brightness, alpha is linear.
+void DownsampleSRGBA8(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst);
+}
+
+#endif
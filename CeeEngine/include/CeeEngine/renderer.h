@@ -5,6 +5,12 @@
 #include <CeeEngine/messageBus.h>
 #include <CeeEngine/camera.h>
 #include <CeeEngine/assetManager.h>
+#include <CeeEngine/shaderCompiler.h>
+#include <CeeEngine/fileWatcher.h>
+#include <CeeEngine/shaderReflection.h>
+#include <CeeEngine/gpuProfiler.h>
+#include <CeeEngine/rendererStatistics.h>
+#include <CeeEngine/batchBuilder.h>
 
 #include <CeeEngine/platform.h>
 
@@ -15,10 +21,16 @@
 #endif
 #include <vulkan/vulkan.h>
 
+#include <array>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -78,25 +90,13 @@ enum RendererMode {
 	RENDERER_MODE_3D      = 2
 };
 
-struct Vertex2D {
-	glm::vec4 position;
-	glm::vec4 color;
-	glm::vec2 texCoords;
-};
-
-struct Vertex3D {
-	glm::vec4 position;
-	glm::vec3 normal;
-	glm::vec4 color;
-	glm::vec2 texCoords;
-	uint32_t texIndex;
-};
-
 struct RendererCapabilities {
 	const char* applicationName;
 	uint32_t applicationVersion;
 	uint32_t maxIndices;
 	uint32_t maxFramesInFlight;
+	// Requested bindless texture table size, clamped to what the device supports.
+	uint32_t maxTextures;
 
 	RendererMode rendererMode;
 };
@@ -110,6 +110,10 @@ enum CommandQueueTypeBits
 };
 typedef uint8_t CommandQueueType;
 
+// Index into the bindless texture table, used as Vertex3D::texIndex.
+typedef uint32_t TextureHandle;
+#define CEE_INVALID_TEXTURE_HANDLE UINT32_MAX
+
 struct RawCommandBuffer {
 	VkCommandBuffer commandBuffer;
 	CommandQueueType queueType;
@@ -130,6 +134,7 @@ struct UsedCommandBuffer {
 
 class Renderer;
 class StagingBuffer;
+class TextureStreamer;
 
 class VertexBuffer {
 public:
@@ -199,6 +204,33 @@ private:
 	friend StagingBuffer;
 };
 
+// Read and written by compute shaders, and depending on its usage consumed as
+// indirect draw commands or vertex input by the draws after the dispatch.
+class StorageBuffer {
+public:
+	StorageBuffer();
+	StorageBuffer(const StorageBuffer&) = delete;
+	StorageBuffer(StorageBuffer&& other);
+	~StorageBuffer();
+
+	StorageBuffer& operator=(const StorageBuffer&) = delete;
+	StorageBuffer& operator=(StorageBuffer&& other);
+
+	size_t GetSize() const { return m_Size; }
+
+private:
+	bool m_Initialized;
+
+	VkDevice m_Device;
+
+	size_t m_Size;
+	VkBuffer m_Buffer;
+	VkDeviceMemory m_DeviceMemory;
+
+	friend Renderer;
+	friend StagingBuffer;
+};
+
 class ImageBuffer {
 public:
 	ImageBuffer();
@@ -211,6 +243,8 @@ public:
 
 	void Clear(glm::vec4 clearColor);
 
+	uint32_t GetMipLevels() const { return m_MipLevels; }
+
 private:
 	void TransitionLayout(RawCommandBuffer& cmdBuffer, VkImageLayout newLayout);
 
@@ -222,6 +256,11 @@ private:
 	VkQueue m_TransferQueue;
 
 	size_t m_Size;
+	VkFormat m_Format;
+	VkExtent3D m_Extent;
+	uint32_t m_MipLevels;
+	// Mip levels are filtered on the CPU and uploaded with level 0 rather than blitted.
+	bool m_HostMipmaps;
 	VkImage m_Image;
 	VkImageView m_ImageView;
 	VkDeviceMemory m_DeviceMemory;
@@ -236,7 +275,7 @@ class CubeMapBuffer {
 public:
 	CubeMapBuffer();
 	CubeMapBuffer(uint32_t width, uint32_t height);
-	CubeMapBuffer(std::vector<std::shared_ptr<Image>> images);
+	CubeMapBuffer(std::vector<std::shared_ptr<Image>> images, bool generateMipmaps = true);
 	CubeMapBuffer(const CubeMapBuffer&) = delete;
 	CubeMapBuffer(CubeMapBuffer&& other);
 	~CubeMapBuffer();
@@ -246,6 +285,8 @@ public:
 
 	void Clear(glm::vec4 clearColor);
 
+	uint32_t GetMipLevels() const { return m_MipLevels; }
+
 private:
 	void TransitionLayout(RawCommandBuffer& cmdBuffer, VkImageLayout newLayout);
 
@@ -254,6 +295,8 @@ private:
 
 	size_t m_Size;
 	VkExtent3D m_Extent;
+	uint32_t m_MipLevels;
+	bool m_HostMipmaps;
 	VkImage m_Image;
 	VkDeviceMemory m_DeviceMemory;
 	VkImageView m_ImageView;
@@ -275,6 +318,22 @@ public:
 	StagingBuffer& operator=(StagingBuffer&& other);
 
 	int SetData(size_t size, size_t offset, const void* data);
+	// Returns count elements of T starting offset bytes into the mapped memory, for the
+	// caller to write in place, or NULL if they do not fit. The memory stays mapped for
+	// the lifetime of the buffer, so a batch can be reserved once and filled without
+	// further checks. It may be uncached, write it sequentially and never read it.
+	template<typename T>
+	T* Reserve(size_t offset, size_t count) {
+		return static_cast<T*>(ReserveBytes(offset, count * sizeof(T)));
+	}
+	void* ReserveBytes(size_t offset, size_t size);
+	// Ends the writes to reserved memory before the transfers reading it. The memory is
+	// host coherent so nothing is flushed, but non-temporal stores have to be fenced.
+	void Commit();
+	// Writes level 0 of an RGBA8 image. If the destination filters its mip chain on the
+	// CPU the remaining levels are generated and written after it.
+	int SetImageData(const ImageBuffer& imageBuffer, size_t offset, const void* pixels);
+	int SetImageData(const CubeMapBuffer& imageBuffer, size_t offset, uint32_t face, const void* pixels);
 
 private:
 	int BoundsCheck(size_t size, size_t srcSize, size_t dstSize, size_t srcOffset, size_t dstOddset);
@@ -286,16 +345,24 @@ private:
 									  VkBuffer dst,
 									  VkBufferCopy copyRegion);
 
+	int WriteHostMipChain(size_t offset, VkExtent3D extent, uint32_t mipLevels,
+						  uint32_t layers, uint32_t layer, const void* pixels);
+	template<typename T>
+	void RecordImageUpload(RawCommandBuffer& cmdBuffer, size_t srcOffset, T& imageBuffer,
+						   VkExtent3D extent, uint32_t layers);
+
 public:
 	int TransferData(VertexBuffer& vertexBuffer, size_t srcOffset, size_t dstOffset, size_t size);
 	int TransferData(IndexBuffer& indexBuffer, size_t srcOffset, size_t dstOffset, size_t size);
 	int TransferData(UniformBuffer& uniformBuffer, size_t srcOffset, size_t dstOffset, size_t size);
+	int TransferData(StorageBuffer& storageBuffer, size_t srcOffset, size_t dstOffset, size_t size);
 	int TransferData(ImageBuffer& imageBuffer, size_t srcOffset, size_t dstOffset, uint32_t width, uint32_t height);
 	int TransferData(CubeMapBuffer& imageBuffer, size_t srcOffset);
 
 	int TransferDataImmediate(VertexBuffer& vertexBuffer, size_t srcOffset, size_t dstOffset, size_t size);
 	int TransferDataImmediate(IndexBuffer& indexBuffer, size_t srcOffset, size_t dstOffset, size_t size);
 	int TransferDataImmediate(UniformBuffer& uniformBuffer, size_t srcOffset, size_t dstOffset, size_t size);
+	int TransferDataImmediate(StorageBuffer& storageBuffer, size_t srcOffset, size_t dstOffset, size_t size);
 	int TransferDataImmediate(ImageBuffer& imageBuffer, size_t srcOffset, size_t dstOffset, uint32_t width, uint32_t height);
 	int TransferDataImmediate(CubeMapBuffer& imageBuffer, size_t srcOffset);
 
@@ -313,12 +380,166 @@ private:
 	void* m_MappedMemoryAddress;
 
 	friend Renderer;
+	friend TextureStreamer;
+};
+
+struct SamplerSpec {
+	VkFilter magFilter = VK_FILTER_LINEAR;
+	VkFilter minFilter = VK_FILTER_LINEAR;
+	VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	// Values of 1.0 or less disable anisotropic filtering. Clamped to the device limit.
+	float maxAnisotropy = 16.0f;
+	float maxLod = VK_LOD_CLAMP_NONE;
+
+	bool operator==(const SamplerSpec& other) const {
+		return magFilter == other.magFilter && minFilter == other.minFilter &&
+			   mipmapMode == other.mipmapMode && addressModeU == other.addressModeU &&
+			   addressModeV == other.addressModeV && addressModeW == other.addressModeW &&
+			   maxAnisotropy == other.maxAnisotropy && maxLod == other.maxLod;
+	}
+};
+
+struct SamplerSpecHash {
+	size_t operator()(const SamplerSpec& spec) const {
+		size_t hash = (size_t)spec.magFilter | ((size_t)spec.minFilter << 4) | ((size_t)spec.mipmapMode << 8) |
+					  ((size_t)spec.addressModeU << 12) | ((size_t)spec.addressModeV << 16) |
+					  ((size_t)spec.addressModeW << 20);
+		hash ^= std::hash<float>()(spec.maxAnisotropy) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(spec.maxLod) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
 };
 
+// Hashes the bindings of a single descriptor set, the set index is not part of the key.
+struct ShaderResourceBindingsHash {
+	size_t operator()(const std::vector<ShaderResourceBinding>& bindings) const {
+		size_t hash = bindings.size();
+		for (auto& binding : bindings) {
+			size_t value = (size_t)binding.binding | ((size_t)binding.type << 16) | ((size_t)binding.stages << 32);
+			hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			hash ^= std::hash<uint32_t>()(binding.count) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+		return hash;
+	}
+};
+
+// constant_id of the specialization constants declared by the built-in shaders.
+enum ShaderConstantId {
+	// bool, false skips the texture fetch for untextured materials.
+	SHADER_CONSTANT_TEXTURED = 0
+};
+
+struct PipelineSpecializationConstant {
+	uint32_t id;
+	// Bit pattern of a 32 bit bool, int, uint or float constant.
+	uint32_t value;
+
+	bool operator==(const PipelineSpecializationConstant& other) const {
+		return id == other.id && value == other.value;
+	}
+};
+
+// Everything a graphics pipeline is built from. The vertex input layout and the
+// descriptor sets are reflected from the shaders, so the shader names key them.
+struct PipelineDescription {
+	std::string vertexShader;
+	std::string fragmentShader;
+	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+	bool depthTest = true;
+	bool depthWrite = true;
+	VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+	// Straight alpha blending when enabled.
+	bool blend = false;
+	// Applied to every stage, constants a stage does not declare are ignored. Keep them
+	// sorted by id, the order is part of the key.
+	std::vector<PipelineSpecializationConstant> specializationConstants;
+	// Buffer format of each vertex input in location order, empty for the reflected 32
+	// bit formats. Lets packed vertices feed the same shader inputs, each format has
+	// to match the numeric type of its input.
+	std::vector<VkFormat> vertexFormats;
+	// Vertex inputs at this location and above are read per instance from the buffer
+	// bound to binding 1. UINT32_MAX reads every input per vertex.
+	uint32_t instanceLocation = UINT32_MAX;
+
+	bool operator==(const PipelineDescription& other) const {
+		return vertexShader == other.vertexShader && fragmentShader == other.fragmentShader &&
+			   topology == other.topology && polygonMode == other.polygonMode &&
+			   cullMode == other.cullMode && frontFace == other.frontFace &&
+			   depthTest == other.depthTest && depthWrite == other.depthWrite &&
+			   depthCompareOp == other.depthCompareOp && blend == other.blend &&
+			   specializationConstants == other.specializationConstants &&
+			   vertexFormats == other.vertexFormats && instanceLocation == other.instanceLocation;
+	}
+};
+
+struct PipelineDescriptionHash {
+	size_t operator()(const PipelineDescription& description) const {
+		size_t hash = std::hash<std::string>()(description.vertexShader);
+		hash ^= std::hash<std::string>()(description.fragmentShader) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		size_t state = (size_t)description.topology | ((size_t)description.polygonMode << 4) |
+					   ((size_t)description.cullMode << 8) | ((size_t)description.frontFace << 12) |
+					   ((size_t)description.depthTest << 13) | ((size_t)description.depthWrite << 14) |
+					   ((size_t)description.depthCompareOp << 16) | ((size_t)description.blend << 20);
+		hash ^= state + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		for (auto& constant : description.specializationConstants) {
+			hash ^= ((size_t)constant.id << 32 | constant.value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+		for (auto& format : description.vertexFormats) {
+			hash ^= (size_t)format + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+		hash ^= (size_t)description.instanceLocation + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
+// Pixels of a frame delivered by Renderer::RequestFrameReadback(). Rows are tightly
+// packed, 4 bytes per pixel in the order of format (RGBA offscreen, usually BGRA for a
+// swapchain). Only valid for the duration of the callback.
+struct FrameReadback {
+	uint64_t frameNumber;
+	VkExtent2D extent;
+	VkFormat format;
+	const uint8_t* pixels;
+	size_t size;
+};
+typedef std::function<void(const FrameReadback&)> FrameReadbackCallback;
+
 struct RendererSpec {
 	MessageBus* msgBus;
 	std::shared_ptr<Window> window;
 	bool enableValidationLayers;
+	// Watches shaders/src and rebuilds the pipelines using a shader when it is saved.
+	bool enableShaderHotReload;
+	// Renders into offscreen targets of headlessWidth x headlessHeight instead of a
+	// swapchain. No window, surface or present queue is needed, so this runs on
+	// machines without a display such as CI with lavapipe.
+	bool headless;
+	uint32_t headlessWidth;
+	uint32_t headlessHeight;
+	// Fills the per pass pipeline statistics of RendererStatistics, if the device
+	// supports pipeline statistics queries.
+	bool pipelineStatistics;
+	// Indices in the per frame batch of Renderer2D or Renderer3D, 0 for the default of
+	// 10000. Primitives past it are dropped.
+	uint32_t maxIndices;
+	// Batches Vertex2DPacked or Vertex3DPacked instead of Vertex2D or Vertex3D, through
+	// the packed shader variants.
+	bool packedVertices;
+	// Mesh instances Renderer3D draws per frame, 0 for the default of
+	// CEE_MAX_MESH_INSTANCES. Instances past it are dropped.
+	uint32_t maxMeshInstances;
+	// Culls and selects the level of detail of Renderer3D meshes in a compute pass
+	// writing indirect draws, if the device supports Renderer::SupportsDrawIndirectCount().
+	bool gpuCulling;
+	// Keeps the depth of every frame and reduces it to a depth pyramid after the render
+	// pass, which the gpuCulling pass of the next frame tests mesh bounds against.
+	bool occlusionCulling;
 };
 
 class Renderer {
@@ -331,16 +552,69 @@ public:
 
 	// Sets member variable. Should be called before StartFrame().
 	void Clear(const glm::vec4& clearColor);
-	// Begins Command buffer, render pass, sets viewport and scissor and binds pipeline.
+	// Begins the command buffers, sets viewport and scissor and binds the pipeline. The
+	// render pass only begins in EndFrame(), so compute work recorded during the frame
+	// runs ahead of it.
 	int StartFrame();
-	// Ends command buffer, submits commands, then submits present.
+	// Records the render pass and the depth pyramid, ends the command buffer, submits
+	// it, then presents.
 	int EndFrame();
 
 	// Binds the vertex buffer and index buffer and called vulkans DrawIndexedInstanced().
 	int Draw(const IndexBuffer& indexBuffer, const VertexBuffer& vertexBuffer, uint32_t indexCount);
+	// Draws instanceCount instances of the index range. Inputs of the bound pipeline at
+	// its instanceLocation and above are read from instanceBuffer, starting at firstInstance.
+	int DrawInstanced(const IndexBuffer& indexBuffer, VkIndexType indexType,
+					  const VertexBuffer& vertexBuffer, const StorageBuffer& instanceBuffer,
+					  uint32_t firstIndex, uint32_t indexCount,
+					  uint32_t firstInstance, uint32_t instanceCount);
+	// Binds a pipeline sharing the main pipeline layout for the draws recorded after it.
+	// Returns -1 if the pipeline failed to build, leaving the bound pipeline unchanged.
+	int BindPipeline(const PipelineDescription& description);
+	// Binds the 2D or 3D batch pipeline again, StartFrame() binds it for every frame.
+	// If a rebuild of the batch pipeline fails, the last valid one stays in use.
+	void BindMainPipeline();
+
+	// Vulkan 1.2 drawIndirectCount with multiDrawIndirect and drawIndirectFirstInstance,
+	// everything GPU driven draws need.
+	bool SupportsDrawIndirectCount() const { return m_DrawIndirectCount; }
+	// Records a fill of size bytes of the buffer ahead of the frame's dispatches.
+	int FillBuffer(StorageBuffer& buffer, size_t offset, size_t size, uint32_t value);
+	// Records a copy on the frame's graphics command buffer ahead of its dispatches,
+	// unlike StagingBuffer::TransferData(). The frame's dispatches and draws see the
+	// copy, so src must not be written again until this frame has completed.
+	int CopyBuffer(const StagingBuffer& src, size_t srcOffset, StorageBuffer& dst, size_t dstOffset, size_t size);
+	// Builds the pipeline Dispatch() uses for the shader ahead of the first frame.
+	int PrecompileComputePipeline(const std::string& shader, const ShaderDefines& defines = {});
+	// Records a dispatch of shaders/src/<shader>.glsl ahead of the frame's render pass.
+	// The buffers are bound whole to bindings 0 onwards of set 0 and pushConstants to
+	// the push constant block. The writes are visible to the draws of the frame as
+	// indirect commands and vertex input, and to later dispatches. With
+	// bindDepthPyramid the depth pyramid follows the buffers as a sampler2D, which
+	// requires HasDepthPyramid(). Returns -1 if the pipeline failed to build.
+	int Dispatch(const std::string& shader, const std::vector<const StorageBuffer*>& buffers,
+				 const void* pushConstants, uint32_t pushConstantSize, uint32_t groupCountX,
+				 const ShaderDefines& defines = {}, bool bindDepthPyramid = false);
+	// RendererSpec::occlusionCulling was requested and the device can build the pyramid.
+	bool BuildsDepthPyramid() const { return m_BuildDepthPyramid; }
+	// The pyramid holds the previous frame's depth, false until the first frame after
+	// the depth buffer was (re)created. Every level is the farthest depth of the level
+	// before it, level 0 covers the depth buffer at the power of two below its size.
+	bool HasDepthPyramid() const { return m_BuildDepthPyramid && m_DepthPyramidValid; }
+	// Draws the VkDrawIndexedIndirectCommands at commandOffset, as many as the uint32_t
+	// at countOffset holds but at most maxDrawCount. Inputs of the bound pipeline at its
+	// instanceLocation and above are read from instanceBuffer.
+	int DrawIndexedIndirectCount(const IndexBuffer& indexBuffer, VkIndexType indexType,
+								 const VertexBuffer& vertexBuffer, const StorageBuffer& instanceBuffer,
+								 const StorageBuffer& commandBuffer, size_t commandOffset,
+								 const StorageBuffer& countBuffer, size_t countOffset,
+								 uint32_t maxDrawCount);
 
 	int UpdateCamera(Camera& camera);
 	void UpdateSkybox(CubeMapBuffer& newSkybox);
+	// Resizes the render targets before the next frame. Headless targets are recreated
+	// at the new size, a window is resized and the swapchain follows it.
+	void Resize(uint32_t width, uint32_t height);
 
 	static Renderer* Get() { return s_Instance; }
 
@@ -351,12 +625,125 @@ public:
 	VkFormat GetDepthFormat() const { return m_DepthFormat; }
 	VkFormat GetSwapchainFormat() const { return m_SwapchainImageFormat; }
 	VkExtent2D GetSwapchainExtent() const { return m_SwapchainExtent; }
+	uint32_t GetMaxFramesInFlight() const { return m_Capabilites.maxFramesInFlight; }
+	// The frame being recorded, below GetMaxFramesInFlight(). Its previous use has
+	// completed once StartFrame() returns.
+	uint32_t GetFrameIndex() const { return m_FrameIndex; }
+	uint32_t GetMaxIndices() const { return m_Capabilites.maxIndices; }
+	bool IsHeadless() const { return m_Headless; }
+
+	// Copies the color target of the last frame ended into pixels as tightly packed
+	// sRGB RGBA8, waiting for that frame to finish. Call between EndFrame() and the
+	// next StartFrame(). Headless only, swapchain images are not transfer sources.
+	int ReadbackFrame(std::vector<uint8_t>& pixels, VkExtent2D* extent);
+	// Copies the color target of the next frame ended into a host visible ring buffer.
+	// The callback runs on the render thread in the StartFrame() that waits on that
+	// frame's fence anyway, maxFramesInFlight frames later, so the GPU is never stalled.
+	// Pending readbacks are delivered on shutdown. Returns -1 if the swapchain cannot
+	// be copied from or a readback of this frame was already requested.
+	int RequestFrameReadback(FrameReadbackCallback callback);
+	// Number of frames ended so far, the frameNumber of the next readback.
+	uint64_t GetFrameNumber() const { return m_FrameNumber; }
+	// GPU time of the frame, its skybox and geometry passes and its transfer batches.
+	// Resolved maxFramesInFlight frames late, check frameNumber. Empty if the device
+	// has no timestamps.
+	const GpuFrameTimings& GetGpuFrameTimings() const { return m_GpuProfiler.GetFrameTimings(); }
+	// Counters of the last frame ended, also posted as a RendererStatisticsEvent.
+	const RendererStatistics& GetStatistics() const { return m_LastStatistics; }
+	// Adds to the culling counters of the frame being recorded.
+	void CountCulledObjects(uint32_t visible, uint32_t culled) {
+		m_Statistics.visibleObjects += visible;
+		m_Statistics.culledObjects += culled;
+	}
 
 	uint32_t GetQueueFamilyIndex(CommandQueueType queueType) const;
 
+	// Pipelines are created on first use through the pipeline cache and owned by the
+	// renderer, with a warning since building one stalls the frame. Returns
+	// VK_NULL_HANDLE if the pipeline failed to build, the next call retries it. Render
+	// thread only.
+	VkPipeline GetPipeline(const PipelineDescription& description);
+	// Builds the pipelines up front in parallel, so first use does not stall a frame.
+	int PrecompilePipelines(const std::vector<PipelineDescription>& descriptions);
+
+	// Samplers are cached and owned by the renderer, do not destroy the returned handle.
+	VkSampler GetSampler(const SamplerSpec& spec);
+	// Layouts are cached and owned by the renderer, shaders declaring the same bindings
+	// share a layout. Runtime sized arrays are sized to the texture table.
+	VkDescriptorSetLayout GetDescriptorSetLayout(const std::vector<ShaderResourceBinding>& bindings);
+	// One layout per set up to the highest set used, unused sets get an empty layout.
+	int GetDescriptorSetLayouts(const ShaderReflection& reflection, std::vector<VkDescriptorSetLayout>& setLayouts);
+	// True if mip chains of this format should be generated with vkCmdBlitImage.
+	bool SupportsBlitMipmaps(VkFormat format) const;
+	// Expects every level in TRANSFER_DST_OPTIMAL with level 0 filled. Leaves every
+	// level in SHADER_READ_ONLY_OPTIMAL.
+	void RecordMipmapBlits(VkCommandBuffer commandBuffer, VkImage image, VkExtent3D extent,
+						   uint32_t mipLevels, uint32_t layers);
+
+	// Bindless texture table. Writes are deferred and applied to each frame's descriptor
+	// set once that frame is no longer in flight, so views must stay alive until then.
+	// A null view makes the slot sample the default texture.
+	TextureHandle RegisterTexture(VkImageView imageView);
+	TextureHandle RegisterTexture(const ImageBuffer& imageBuffer);
+	void UpdateTexture(TextureHandle handle, VkImageView imageView);
+	// The handle is not reused until every frame in flight has completed.
+	void ReleaseTexture(TextureHandle handle);
+	uint32_t GetTextureTableSize() const { return m_TextureTableSize; }
+	TextureHandle GetDefaultTexture() const { return m_DefaultTexture; }
+
+	// Compiles shaders/src/<name>.glsl through the shader cache, falling back to the
+	// precompiled shaders/<name>.spv when the source is missing or fails to compile.
+	// Permutations with defines have no precompiled binary.
+	std::shared_ptr<ShaderBinary> LoadShader(const std::string& name, const ShaderDefines& defines = {});
+
 private:
 	void InvalidateSwapchain();
+	// Creates m_SwapchainImageCount headless targets of m_SwapchainExtent.
+	int CreateOffscreenTargets();
+	int CreateFramebuffers();
+	// Rebuilds the pipelines using the shaders changed since the last rebuild, or every
+	// pipeline if none changed, on a background thread. The new pipelines are swapped in
+	// at the start of a later frame.
 	void InvalidatePipeline();
+	void UpdateShaderHotReload();
+	void DestroyRetiredPipelines();
+	void PipelineRebuildThread(std::vector<std::string> shaders, VkExtent2D extent);
+	// Records the copy of the requested readback into the frame's command buffer.
+	void RecordFrameReadback(VkCommandBuffer commandBuffer);
+	// Hands the readback of a completed frame slot to its callback.
+	void DeliverFrameReadback(uint32_t frameIndex);
+	// Reads the pipeline statistics queries of a completed frame slot into m_Statistics.
+	void ResolvePipelineStatistics(uint32_t frameIndex);
+	// Hands the counters of the frame being ended to Tracy and the message bus.
+	void PublishStatistics();
+	// Pipelines are created with m_PipelineCache, which is internally synchronized, so
+	// these can run on any thread once the layouts and render pass exist. Every pipeline
+	// in the batch is created, failed ones are left as VK_NULL_HANDLE.
+	int CreatePipelines(VkExtent2D extent, const std::vector<PipelineDescription>& descriptions,
+						std::vector<VkPipeline>& pipelines);
+	int CreateSkyboxPipeline(VkExtent2D extent, VkPipeline* pipeline);
+	// Creates the pipelines on worker threads sharing m_PipelineCache. On failure the
+	// pipelines that were created are still returned and have to be destroyed.
+	VkResult CreateGraphicsPipelines(uint32_t count, const VkGraphicsPipelineCreateInfo* createInfos,
+									 VkPipeline* pipelines);
+	// Checks the VkPipelineCacheHeaderVersionOne header against the physical device.
+	bool IsPipelineCacheCompatible(const std::vector<uint8_t>& cacheData) const;
+	// Written through a temporary file so a crash never leaves a truncated cache behind.
+	void SavePipelineCache();
+	// Built on first use with its own layout, VK_NULL_HANDLE if it failed to build.
+	// Every set of defines is its own pipeline.
+	VkPipeline GetComputePipeline(const std::string& shader, const ShaderDefines& defines,
+								  VkPipelineLayout* layout, VkDescriptorSetLayout* setLayout);
+	// Recreates the pyramid for the current depth buffer, invalidating its contents.
+	int CreateDepthPyramid();
+	void DestroyDepthPyramid();
+	// Reduces m_DepthImage into the pyramid one level per dispatch, after the render pass.
+	void RecordDepthPyramid(VkCommandBuffer commandBuffer);
+	// Reflects the shaders sharing m_PipelineLayout. The texture table binding is
+	// always treated as a runtime array so it matches m_TextureTableSize, whether the
+	// shaders declared it unsized or with CEE_MAX_TEXTURES elements.
+	int ReflectMainShaders(const std::vector<std::shared_ptr<ShaderBinary>>& shaders, ShaderReflection* reflection);
+	void FlushTextureTableWrites();
 
 public:
 
@@ -375,6 +762,9 @@ public:
 	static uint32_t ChooseMemoryType(uint32_t typeFilter,
 									 const VkPhysicalDeviceMemoryProperties& deviceMemoryProperties,
 									 VkMemoryPropertyFlags properties);
+	// Compiles shaders/src/<name>.glsl with the renderer defines (CEE_MAX_TEXTURES and,
+	// when supported, CEE_DESCRIPTOR_INDEXING) ahead of the given ones. No fallback.
+	std::shared_ptr<ShaderBinary> CompileShader(const std::string& name, const ShaderDefines& defines = {});
 	static VkShaderModule CreateShaderModule(VkDevice device, std::shared_ptr<ShaderBinary> code);
 	static VkShaderModule CreateShaderModule(VkDevice device, std::shared_ptr<ShaderCode> code);
 	static std::vector<uint8_t> AttemptPipelineCacheRead(const std::string& filePath);
@@ -401,14 +791,21 @@ private:
 	// ** BEGIN Buffer Implementations **
 	// **********************************
 private:
-	int CreateCommonBuffer(VkBuffer& buffer, VkDeviceMemory& memory, VkBufferUsageFlags usage, size_t size);
+	// Memory is host visible for transfer sources and device local otherwise, unless
+	// memoryPropertyFlags is given.
+	int CreateCommonBuffer(VkBuffer& buffer, VkDeviceMemory& memory, VkBufferUsageFlags usage, size_t size,
+						   VkMemoryPropertyFlags memoryPropertyFlags = 0);
+	// Color attachment that can be copied from, used in place of swapchain images.
+	ImageBuffer CreateRenderTarget(uint32_t width, uint32_t height, VkFormat format);
 
 public:
 	VertexBuffer CreateVertexBuffer(size_t size);
 	IndexBuffer CreateIndexBuffer(size_t size);
 	UniformBuffer CreateUniformBuffer(size_t size);
-	ImageBuffer CreateImageBuffer(size_t width, size_t height, ImageFormat format);
+	ImageBuffer CreateImageBuffer(size_t width, size_t height, ImageFormat format, bool generateMipmaps = false);
 	StagingBuffer CreateStagingBuffer(size_t size);
+	// Storage and transfer destination, plus usage such as VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT.
+	StorageBuffer CreateStorageBuffer(size_t size, VkBufferUsageFlags usage = 0);
 	// **********************************
 	// ** END   Buffer Implementations **
 	// **********************************
@@ -421,13 +818,57 @@ private:
 	bool m_InFrame;
 
 	std::shared_ptr<Window> m_Window;
+	bool m_Headless;
+	// Stand in for the swapchain images in headless mode, one per frame in flight.
+	std::vector<ImageBuffer> m_OffscreenTargets;
+	// Size requested for the offscreen targets, applied by InvalidateSwapchain().
+	VkExtent2D m_HeadlessExtent;
+	// Image index of the last frame ended, read back by ReadbackFrame().
+	std::optional<uint32_t> m_LastImageIndex;
+
+	// Swapchain images were created with VK_IMAGE_USAGE_TRANSFER_SRC_BIT.
+	bool m_SwapchainTransferSrc;
+	uint64_t m_FrameNumber;
+	struct FrameReadbackSlot {
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		void* mappedMemory;
+		VkDeviceSize size;
+		bool hostCoherent;
+		// Set while a copy is in flight.
+		FrameReadbackCallback callback;
+		uint64_t frameNumber;
+		VkExtent2D extent;
+		VkFormat format;
+	};
+	// One slot per frame in flight, buffers are created on first use.
+	std::vector<FrameReadbackSlot> m_FrameReadbackSlots;
+	FrameReadbackCallback m_RequestedFrameReadback;
+
+	GpuProfiler m_GpuProfiler;
+	bool m_HostQueryReset;
+	bool m_CalibratedTimestamps;
+	GpuZone m_FrameGpuZone;
+	GpuZone m_GeometryGpuZone;
+
+	MessageBus* m_MessageBus;
+	// Counted while recording, moved to m_LastStatistics at the end of the frame.
+	RendererStatistics m_Statistics;
+	RendererStatistics m_LastStatistics;
+	bool m_PipelineStatistics;
+	// One query per RendererPass, one pool per frame in flight.
+	std::vector<VkQueryPool> m_PipelineStatisticsQueryPools;
+	// Frame number whose queries a slot holds, empty until the slot is first used.
+	std::vector<std::optional<uint64_t>> m_PipelineStatisticsFrames;
 
 	AssetManager m_AssetManager;
+	ShaderCompiler m_ShaderCompiler;
 
 	VkInstance m_Instance;
 	VkPhysicalDevice m_PhysicalDevice;
 	VkPhysicalDeviceProperties m_PhysicalDeviceProperties;
 	VkPhysicalDeviceMemoryProperties m_PhysicalDeviceMemoryProperties;
+	VkPhysicalDeviceFeatures m_EnabledDeviceFeatures;
 	VkDevice m_Device;
 
 	VkSurfaceKHR m_Surface;
@@ -463,17 +904,75 @@ private:
 	StagingBuffer m_UniformStagingBuffer;
 	std::vector<VkDescriptorSet> m_ImageDescriptorSets;
 
+	bool m_DescriptorIndexing;
+	uint32_t m_TextureTableSize;
+	TextureHandle m_DefaultTexture;
+	TextureHandle m_NextTextureHandle;
+	std::vector<TextureHandle> m_FreeTextureHandles;
+	// Indexed by frame index.
+	std::vector<std::vector<TextureHandle>> m_ReleasedTextureHandles;
+	std::vector<std::vector<std::pair<TextureHandle, VkImageView>>> m_TextureTableWrites;
+
 	VkSampler m_Sampler;
+	std::unordered_map<SamplerSpec, VkSampler, SamplerSpecHash> m_SamplerCache;
+	// Pipelines rebuilt on the hot reload thread look up their layouts here too.
+	std::mutex m_DescriptorSetLayoutMutex;
+	std::unordered_map<std::vector<ShaderResourceBinding>, VkDescriptorSetLayout,
+					   ShaderResourceBindingsHash> m_DescriptorSetLayoutCache;
 
 	VkRenderPass m_RenderPass;
 
 	VkPipelineLayout m_PipelineLayout;
 	VkPipelineCache m_PipelineCache;
 
-	VkPipeline m_MainPipeline;
-	VkPipeline m_LinePipeline;
-	std::unordered_map<uint32_t, VkPipeline> m_PipelineMap;
-	VkPipeline& m_ActivePipeline;
+	// Bindings and push constants of m_PipelineLayout, shaders have to use a subset.
+	ShaderReflection m_PipelineLayoutReflection;
+	std::unordered_map<PipelineDescription, VkPipeline, PipelineDescriptionHash> m_Pipelines;
+	// 2D or 3D depending on the renderer mode, bound at the start of every frame.
+	PipelineDescription m_MainPipelineDescription;
+	bool m_PackedVertices;
+	VkPipeline m_ActivePipeline;
+
+	bool m_DrawIndirectCount;
+	struct ComputePipeline {
+		VkPipeline pipeline;
+		VkPipelineLayout layout;
+		VkDescriptorSetLayout setLayout;
+	};
+	// Keyed by shader name followed by its defines.
+	std::unordered_map<std::string, ComputePipeline> m_ComputePipelines;
+	// One per frame in flight, reset once the frame's fence has been waited on.
+	std::vector<VkDescriptorPool> m_ComputeDescriptorPools;
+
+	bool m_BuildDepthPyramid;
+	bool m_DepthPyramidValid;
+	// R32_SFLOAT with a full mip chain, kept in GENERAL. The view covers every level,
+	// the level views are written by RecordDepthPyramid().
+	ImageBuffer m_DepthPyramid;
+	std::vector<VkImageView> m_DepthPyramidLevelViews;
+	VkSampler m_DepthPyramidSampler;
+
+	struct PipelineRebuild {
+		std::vector<PipelineDescription> descriptions;
+		bool skybox;
+		bool failed;
+		std::vector<VkPipeline> pipelines;
+		VkPipeline skyboxPipeline;
+	};
+	struct RetiredPipeline {
+		VkPipeline pipeline;
+		uint32_t framesLeft;
+	};
+
+	bool m_EnableShaderHotReload;
+	FileWatcher m_ShaderWatcher;
+	// Shaders saved since the last rebuild was started.
+	std::set<std::string> m_ChangedShaders;
+	std::thread m_PipelineRebuildThread;
+	std::atomic<bool> m_PipelineRebuildDone;
+	PipelineRebuild m_PipelineRebuild;
+	// Replaced pipelines, destroyed once no frame in flight can reference them.
+	std::vector<RetiredPipeline> m_RetiredPipelines;
 
 	std::vector<VkFramebuffer> m_Framebuffers;
 
@@ -528,46 +1027,6 @@ private:
 private:
 	friend StagingBuffer;
 };
-
-inline glm::mat4 ConstructTransformMatrix2D(const glm::vec3& translation,
-											float rotationAngle,
-											const glm::vec3& scale)
-{
-	glm::mat4 transform = glm::identity<glm::mat4>();
-	transform = glm::translate(transform, translation);
-	if (rotationAngle != 0.0f) {
-		float rs = sinf(rotationAngle);
-		float rc = cosf(rotationAngle);
-
-		glm::mat4 rm = {
-			{ rc,   rs,   0.0f, 0.0f },
-			{ -rs,  rc,   0.0f, 0.0f },
-			{ 0.0f, 0.0f, 1.0f, 0.0f },
-			{ 0.0f, 0.0f, 0.0f, 1.0f }
-		};
-		transform = transform * rm;
-	}
-	transform = glm::scale(transform, scale);
-
-	return transform;
-}
-
-inline glm::mat4 ConstructTransformMatrix3D(const glm::vec3& translation,
-											float rotationAngle,
-											const glm::vec3& rotationAxis,
-											const glm::vec3& scale)
-{
-	glm::mat4 transform = glm::identity<glm::mat4>();
-	transform = glm::translate(transform, translation);
-	if (rotationAngle != 0.0f)
-		transform = glm::rotate(transform, rotationAngle, rotationAxis);
-	transform = glm::scale(transform, scale);
-
-
-
-
-	return transform;
-}
 }
 
 #endif
@@ -3,6 +3,7 @@
 
 #include <CeeEngine/renderer.h>
 #include <CeeEngine/camera.h>
+#include <CeeEngine/textureAtlas.h>
 
 #include <memory>
 
@@ -12,7 +13,7 @@ public:
 	Renderer2D() = default;
 	virtual ~Renderer2D() = default;
 
-	static void Init(const RendererSpec& spec);
+	static int32_t Init(const RendererSpec& spec);
 	static void Shutdown();
 
 	static void BeginFrame();
@@ -23,9 +24,21 @@ public:
 						 float rotationAngle,
 						 const glm::vec3& scale,
 						 const glm::vec4& color);
+	// Samples the sub texture from the atlas, tinted by color.
+	static void DrawQuad(const glm::vec3& translation,
+						 float rotationAngle,
+						 const glm::vec3& scale,
+						 const glm::vec4& color,
+						 SubTextureHandle subTexture);
+	// Draws every quad of quads sampling the same sub texture, tinted by its color.
+	// Far cheaper per quad than DrawQuad() for particle like workloads.
+	static void DrawQuads(const QuadInstances& quads,
+						  SubTextureHandle subTexture = CEE_INVALID_SUB_TEXTURE);
 
 	static int UpdateCamera(Camera& camera);
 
+	static TextureAtlas& GetTextureAtlas() { return *s_TextureAtlas; }
+
 private:
 	static bool MessageHandler(Event& e);
 
@@ -36,14 +49,22 @@ private:
 	static IndexBuffer s_IndexBuffer;
 
 	static StagingBuffer s_StagingBuffer;
+	// The whole batch, reserved in s_StagingBuffer. Only one of them is set, depending
+	// on RendererSpec::packedVertices.
+	static Vertex2D* s_Vertices;
+	static Vertex2DPacked* s_PackedVertices;
+	static size_t s_VertexSize;
 
 	static size_t s_VertexOffset;
 	static size_t s_Index;
+	// Quads that did not fit in this frame's batch.
+	static uint32_t s_DroppedQuads;
 
 private:
 	static bool s_Initialized;
 	static MessageBus* s_MessageBus;
 	static std::shared_ptr<Renderer> s_Renderer;
+	static std::unique_ptr<TextureAtlas> s_TextureAtlas;
 };
 }
 #endif
@@ -3,9 +3,27 @@
 
 #include <CeeEngine/renderer.h>
 #include <CeeEngine/camera.h>
+#include <CeeEngine/mesh.h>
+#include <CeeEngine/textureStreamer.h>
 
+#include <filesystem>
 #include <memory>
 namespace cee {
+// Index of a mesh resident on the device, see Renderer3D::CreateMesh().
+typedef uint32_t MeshHandle;
+#define CEE_INVALID_MESH_HANDLE UINT32_MAX
+
+// Default mesh instances drawn per frame, DrawMesh() calls past
+// RendererSpec::maxMeshInstances are dropped.
+#define CEE_MAX_MESH_INSTANCES 16384
+
+// Level of detail of one object drawn with DrawMesh(), kept by the caller between
+// frames. The level only changes once the projected error is clearly past the
+// threshold, so objects near it do not pop back and forth.
+struct MeshLodState {
+	uint32_t lod = 0;
+};
+
 class Renderer3D {
 public:
 	Renderer3D() = default;
@@ -18,16 +36,56 @@ public:
 	static void Flush();
 	static void EndFrame();
 
+	// Cubes and meshes outside the frustum of the last UpdateCamera() are skipped before
+	// they reach the batch, counted in RendererStatistics.
 	static void DrawCube(const glm::vec3& translation,
 						 float rotationAngle,
 						 const glm::vec3& rotationAxis,
 						 const glm::vec3& scale,
-						 const glm::vec4& color);
+						 const glm::vec4& color,
+						 TextureHandle texture = CEE_INVALID_TEXTURE_HANDLE);
+
+	// Uploads the mesh into device local buffers, where it stays until DestroyMesh().
+	// Returns CEE_INVALID_MESH_HANDLE if the upload failed.
+	static MeshHandle CreateMesh(const Mesh& mesh);
+	// Loads a .cmesh through the AssetManager and uploads it.
+	static MeshHandle LoadMesh(const std::filesystem::path& filePath);
+	// The buffers are destroyed once no frame in flight can draw them.
+	static void DestroyMesh(MeshHandle mesh);
+	// Only the transform, color and texture are uploaded per frame. Instances of the
+	// same mesh and level of detail are drawn together with one instanced draw per
+	// submesh. The level is the coarsest whose error projects to at most the LOD
+	// threshold on screen, from the camera of the last UpdateCamera(). With
+	// RendererSpec::gpuCulling the culling and level selection run on the device
+	// instead, without lodState, and the instances are not counted in
+	// RendererStatistics. RendererSpec::occlusionCulling then also drops instances
+	// behind the previous frame's depth.
+	static void DrawMesh(MeshHandle mesh,
+						 const glm::mat4& transform,
+						 const glm::vec4& color,
+						 TextureHandle texture = CEE_INVALID_TEXTURE_HANDLE,
+						 MeshLodState* lodState = NULL);
+	// Screen space error in pixels accepted for a coarser level of detail, 1 by default.
+	static void SetLodThreshold(float pixels) { s_LodThreshold = pixels; }
+	// On by default, also turns occlusion culling on and off.
+	static void SetFrustumCulling(bool enabled) { s_FrustumCulling = enabled; }
 
 	static int UpdateCamera(Camera& camera);
 
+	static TextureStreamer& GetTextureStreamer() { return *s_TextureStreamer; }
+
 private:
 	static bool MessageHandler(Event& e);
+	// Draws the instances collected by DrawMesh() after the batch.
+	static void FlushMeshes();
+	// The RendererSpec::gpuCulling path of FlushMeshes(), uploads the instances with a
+	// table of their meshes for renderer3DCullCompute and draws each mesh with one
+	// indirect count draw.
+	static void FlushMeshesIndirect();
+	// Recreates buffer with at least size bytes if it is smaller, doubling so it
+	// rarely grows. The old buffer is retired like a destroyed mesh.
+	static int ReserveStorageBuffer(StorageBuffer& buffer, size_t size, VkBufferUsageFlags usage);
+	static void DestroyRetiredBuffers(bool force);
 
 private:
 	static RendererCapabilities s_RendererCapabilities;
@@ -37,14 +95,90 @@ private:
 
 	static StagingBuffer s_VertexStagingBuffer;
 	static StagingBuffer s_IndexStagingBuffer;
+	// The whole batch, reserved in the staging buffers. Only one of the vertex pointers
+	// is set, depending on RendererSpec::packedVertices.
+	static Vertex3D* s_Vertices;
+	static Vertex3DPacked* s_PackedVertices;
+	static size_t s_VertexSize;
+	static uint32_t* s_Indices;
 
 	static size_t s_VertexOffset;
 	static size_t s_IndexOffset;
+	// Cubes that did not fit in this frame's batch.
+	static uint32_t s_DroppedCubes;
+
+	struct ResidentMesh {
+		VertexBuffer vertexBuffer;
+		IndexBuffer indexBuffer;
+		VkIndexType indexType;
+		std::vector<Submesh> submeshes;
+		uint32_t lodCount;
+		float lodErrors[CEE_MESH_MAX_LODS];
+		// Bounds, the level of detail is measured at the center.
+		glm::vec3 center;
+		glm::vec3 extents;
+		bool resident;
+		// Collected by DrawMesh() per level of detail until the next flush.
+		std::vector<MeshInstance> instances[CEE_MESH_MAX_LODS];
+	};
+	// With a current level, returns it unless the projected error left the band
+	// around the threshold.
+	static uint32_t SelectLod(const ResidentMesh& mesh, const glm::mat4& transform, const MeshLodState* lodState);
+	struct RetiredMesh {
+		VertexBuffer vertexBuffer;
+		IndexBuffer indexBuffer;
+		uint32_t framesLeft;
+	};
+	// Indexed by MeshHandle, destroyed slots are reused.
+	static std::vector<ResidentMesh> s_Meshes;
+	static std::vector<MeshHandle> s_FreeMeshHandles;
+	static std::vector<RetiredMesh> s_RetiredMeshes;
+	static PipelineDescription s_MeshPipelineDescription;
+	static StorageBuffer s_InstanceBuffer;
+	// One region of s_MaxInstances per frame in flight, indexed by the frame index.
+	static StagingBuffer s_InstanceStagingBuffer;
+	static MeshInstance* s_Instances;
+	static uint32_t s_InstanceCount;
+	static uint32_t s_MaxInstances;
+	static uint32_t s_DroppedInstances;
+	static glm::mat4 s_View;
+	static glm::mat4 s_Projection;
+	static float s_LodThreshold;
+	static Frustum s_Frustum;
+	static bool s_FrustumCulling;
+	// Submissions since the last flush.
+	static uint32_t s_VisibleObjects;
+	static uint32_t s_CulledObjects;
+	// Only set if the device supports indirect count draws. The instances are then
+	// collected at level 0 and uploaded to s_CullInstanceBuffer instead.
+	static bool s_GpuCulling;
+	static StorageBuffer s_CullInstanceBuffer;
+	static StorageBuffer s_CullGroupBuffer;
+	static StorageBuffer s_IndexRangeBuffer;
+	static StorageBuffer s_DrawCommandBuffer;
+	static StorageBuffer s_DrawCountBuffer;
+	// The group table followed by the index range table, once per frame in flight.
+	static StagingBuffer s_CullStagingBuffer;
+	// Cull buffers replaced by larger ones, either one of the two is set.
+	struct RetiredCullBuffer {
+		StorageBuffer storageBuffer;
+		StagingBuffer stagingBuffer;
+		uint32_t framesLeft;
+	};
+	static std::vector<RetiredCullBuffer> s_RetiredCullBuffers;
+	// Only set with s_GpuCulling if the renderer builds a depth pyramid. Instances are
+	// tested against it with the camera of the frame it was built from.
+	static bool s_OcclusionCulling;
+	static glm::mat4 s_PreviousViewProjection;
+	static StorageBuffer s_OcclusionViewBuffer;
+	// One s_PreviousViewProjection per frame in flight, copied like the cull tables.
+	static StagingBuffer s_OcclusionStagingBuffer;
 
 private:
 	static bool s_Initialized;
 	static MessageBus* s_MessageBus;
 	static std::shared_ptr<Renderer> s_Renderer;
+	static std::unique_ptr<TextureStreamer> s_TextureStreamer;
 };
 }
 #endif
@@ -0,0 +1,92 @@
+#ifndef CEE_ENGINE_RENDERER_STATISTICS_H
+#define CEE_ENGINE_RENDERER_STATISTICS_H
+
+#include <CeeEngine/event.h>
+#include <CeeEngine/platform.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace cee {
+enum RendererPass {
+	RENDERER_PASS_SKYBOX = 0,
+	RENDERER_PASS_GEOMETRY = 1,
+	RENDERER_PASS_COUNT
+};
+
+// VK_QUERY_TYPE_PIPELINE_STATISTICS results of one pass.
+struct PipelineStatistics {
+	uint64_t inputAssemblyVertices;
+	uint64_t inputAssemblyPrimitives;
+	uint64_t vertexShaderInvocations;
+	uint64_t clippingInvocations;
+	uint64_t clippingPrimitives;
+	uint64_t fragmentShaderInvocations;
+};
+
+// Work recorded by the renderer in one frame.
+struct RendererStatistics {
+	uint64_t frameNumber;
+	uint32_t drawCalls;
+	uint32_t instances;
+	uint64_t triangles;
+	uint64_t vertices;
+	// Copied out of staging buffers into buffers and images.
+	uint64_t uploadedBytes;
+	uint32_t commandBuffersAllocated;
+	uint32_t descriptorWrites;
+	uint32_t pipelineBinds;
+	// Objects submitted to Renderer3D that were inside the camera frustum, and those
+	// skipped before reaching the batch.
+	uint32_t visibleObjects;
+	uint32_t culledObjects;
+
+	// Only with RendererSpec::pipelineStatistics. Queries are read back without
+	// waiting, so these belong to the earlier frame pipelineStatisticsFrameNumber.
+	bool hasPipelineStatistics;
+	uint64_t pipelineStatisticsFrameNumber;
+	PipelineStatistics passes[RENDERER_PASS_COUNT];
+};
+
+// Posted to the message bus at the end of every frame.
+class CEEAPI RendererStatisticsEvent : public Event {
+public:
+	RendererStatisticsEvent(const RendererStatistics& statistics)
+	 : m_Statistics(statistics)
+	{
+	}
+	~RendererStatisticsEvent() = default;
+
+	const RendererStatistics& CEECALL GetStatistics() const { return m_Statistics; }
+
+	EventType CEECALL GetEventType() const override {
+		return EventType::RendererStatistics;
+	}
+
+	const char* CEECALL GetName() const override {
+		return "RendererStatistics";
+	}
+
+	int CEECALL GetCategoryFlags() const override {
+		return EventCategoryApplication;
+	}
+
+	std::string CEECALL ToString() const override {
+		std::stringstream ss;
+		ss << "Renderer statistics event: frame " << m_Statistics.frameNumber
+		   << ", " << m_Statistics.drawCalls << " draw calls, "
+		   << m_Statistics.triangles << " triangles";
+		return ss.str();
+	}
+
+	static EventType GetStaticEventType() {
+		return EventType::RendererStatistics;
+	}
+
+private:
+	RendererStatistics m_Statistics;
+};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef CEE_ENGINE_SHADER_COMPILER_H
+#define CEE_ENGINE_SHADER_COMPILER_H
+
+#include <CeeEngine/assetManager.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cee {
+// Preprocessor definitions passed to the compiler, used to build shader permutations.
+typedef std::vector<std::pair<std::string, std::string>> ShaderDefines;
+
+// Compiles GLSL to SPIR-V and caches the result under cache/shaders in the asset
+// root. Entries are keyed by a hash of the compiler version and options, stage,
+// defines and source, so only changed shaders and new permutations are compiled.
+// Without shaderc (CEE_HAS_SHADERC) nothing is compiled and Compile returns nullptr.
+class ShaderCompiler {
+public:
+	ShaderCompiler(std::filesystem::path assetRoot = {});
+	ShaderCompiler(const ShaderCompiler&) = delete;
+	~ShaderCompiler();
+
+	ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+	// Returns nullptr if the shader fails to compile and no cached binary exists.
+	std::shared_ptr<ShaderBinary> Compile(const ShaderCode& code, const ShaderDefines& defines = {});
+
+	static bool IsAvailable();
+	static uint64_t Hash(const ShaderCode& code, const ShaderDefines& defines);
+
+private:
+	std::shared_ptr<ShaderBinary> CompileInternal(const ShaderCode& code, const ShaderDefines& defines);
+
+private:
+	AssetManager m_AssetManager;
+	std::mutex m_CompilerMutex;
+	void* m_Compiler;
+};
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef CEE_ENGINE_SHADER_REFLECTION_H
+#define CEE_ENGINE_SHADER_REFLECTION_H
+
+#include <CeeEngine/assetManager.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace cee {
+// Descriptor count of a runtime sized array such as `uniform texture2D u_Images[]`.
+// The renderer sizes these to the texture table.
+#define CEE_RUNTIME_DESCRIPTOR_COUNT 0u
+
+struct ShaderResourceBinding {
+	uint32_t set;
+	uint32_t binding;
+	VkDescriptorType type;
+	uint32_t count;
+	VkShaderStageFlags stages;
+
+	bool operator==(const ShaderResourceBinding& other) const {
+		return set == other.set && binding == other.binding && type == other.type &&
+			   count == other.count && stages == other.stages;
+	}
+};
+
+struct ShaderVertexInput {
+	uint32_t location;
+	VkFormat format;
+};
+
+struct ShaderReflection {
+	VkShaderStageFlags stages = 0;
+	// Sorted by set, then binding.
+	std::vector<ShaderResourceBinding> bindings;
+	std::vector<VkPushConstantRange> pushConstants;
+	// Vertex stage only, sorted by location.
+	std::vector<ShaderVertexInput> vertexInputs;
+
+	// Highest set used plus one.
+	uint32_t GetSetCount() const;
+	std::vector<ShaderResourceBinding> GetSetBindings(uint32_t set) const;
+};
+
+// Reads the entry point, resource variables and vertex inputs of a SPIR-V module.
+// Only what is needed to build layouts is parsed, function bodies are skipped.
+// Returns -1 if the module is malformed.
+int ReflectShader(const ShaderBinary& binary, ShaderReflection* reflection);
+// Adds the resources of another stage, or of another pipeline sharing the layout.
+// Bindings used by both must agree on type, the larger array is kept. Vertex inputs
+// are not merged, use the vertex stage reflection for those.
+int MergeShaderReflection(ShaderReflection& dst, const ShaderReflection& src);
+// Reflects and merges every shader, e.g. all stages of the pipelines sharing a layout.
+int ReflectShaders(const std::vector<std::shared_ptr<ShaderBinary>>& shaders, ShaderReflection* reflection);
+
+// Packs the vertex inputs in location order into binding 0 with no padding and
+// returns the stride. The vertex struct has to declare its members the same way.
+// formats replaces the reflected 32 bit format of each input in location order, e.g.
+// to feed a vec4 from R8G8B8A8_UNORM, and is either empty or one per input.
+uint32_t BuildVertexInputLayout(const ShaderReflection& reflection,
+								const std::vector<VkFormat>& formats,
+								std::vector<VkVertexInputAttributeDescription>& attributes);
+// Same, except that inputs at instanceLocation and above are packed into binding 1
+// and read per instance. Fills a description for each binding that has inputs.
+void BuildVertexInputLayout(const ShaderReflection& reflection,
+							const std::vector<VkFormat>& formats,
+							uint32_t instanceLocation,
+							std::vector<VkVertexInputAttributeDescription>& attributes,
+							std::vector<VkVertexInputBindingDescription>& bindings);
+}
+
+#endif
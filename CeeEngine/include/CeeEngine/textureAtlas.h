@@ -0,0 +1,90 @@
+#ifndef CEE_ENGINE_TEXTURE_ATLAS_H
+#define CEE_ENGINE_TEXTURE_ATLAS_H
+
+#include <CeeEngine/renderer.h>
+#include <CeeEngine/assetManager.h>
+
+#include <filesystem>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace cee {
+typedef uint32_t SubTextureHandle;
+#define CEE_INVALID_SUB_TEXTURE UINT32_MAX
+
+// Region of an atlas page, resolved by Renderer2D::DrawQuad.
+struct SubTexture {
+	TextureHandle texIndex = CEE_INVALID_TEXTURE_HANDLE;
+	glm::vec2 uvMin = { 0.0f, 0.0f };
+	glm::vec2 uvMax = { 1.0f, 1.0f };
+	uint32_t page = 0;
+};
+
+struct TextureAtlasSpec {
+	uint32_t pageSize = 2048;
+	// Border around every sub texture, filled by extending its edge pixels so
+	// bilinear filtering never reads a neighbour.
+	uint32_t padding = 2;
+	uint32_t maxPages = 8;
+};
+
+// Packs RGBA8 images into pages using the skyline bottom-left heuristic. Each
+// page is a single texture table entry, so sprites sharing an atlas batch
+// into the same draw call.
+class TextureAtlas {
+public:
+	TextureAtlas(const TextureAtlasSpec& spec = {});
+	TextureAtlas(const TextureAtlas&) = delete;
+	~TextureAtlas();
+
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	// Returns CEE_INVALID_SUB_TEXTURE if the image is larger than a page or every
+	// page is full.
+	SubTextureHandle Add(const uint8_t* pixels, uint32_t width, uint32_t height);
+	SubTextureHandle Load(const std::filesystem::path& filePath);
+
+	const SubTexture& Get(SubTextureHandle handle) const;
+	uint32_t GetPageCount() const { return m_Pages.size(); }
+
+	// Uploads pages modified since the last call. Pages are uploaded whole with an
+	// immediate submit, so add sprites at load time rather than every frame.
+	int Upload();
+
+private:
+	struct SkylineNode {
+		uint32_t x, y, width;
+	};
+
+	struct Page {
+		std::vector<SkylineNode> skyline;
+		std::vector<uint8_t> pixels;
+		ImageBuffer image;
+		TextureHandle texIndex;
+		bool dirty;
+	};
+
+private:
+	int AddPage();
+	// Lowest position the rectangle fits at, preferring the narrowest node on ties.
+	bool FindPosition(const Page& page, uint32_t width, uint32_t height,
+					  uint32_t* x, uint32_t* y, size_t* nodeIndex) const;
+	void InsertSkylineNode(Page& page, size_t nodeIndex, uint32_t x, uint32_t y,
+						   uint32_t width, uint32_t height);
+	void CopyPadded(Page& page, const uint8_t* pixels, uint32_t x, uint32_t y,
+					uint32_t width, uint32_t height);
+
+private:
+	TextureAtlasSpec m_Spec;
+	AssetManager m_AssetManager;
+
+	std::vector<Page> m_Pages;
+	std::vector<SubTexture> m_SubTextures;
+	SubTexture m_InvalidSubTexture;
+
+	StagingBuffer m_StagingBuffer;
+};
+}
+
+#endif
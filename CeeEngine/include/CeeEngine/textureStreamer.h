@@ -0,0 +1,185 @@
+#ifndef CEE_ENGINE_TEXTURE_STREAMER_H
+#define CEE_ENGINE_TEXTURE_STREAMER_H
+
+#include <CeeEngine/renderer.h>
+#include <CeeEngine/assetManager.h>
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cee {
+typedef uint32_t StreamedTextureHandle;
+#define CEE_INVALID_STREAMED_TEXTURE UINT32_MAX
+
+struct TextureStreamerSpec {
+	// Device memory streamed textures may occupy. Evicted images are freed once the
+	// frames using them retire, so usage can briefly run over.
+	size_t residencyBudget = 256ull << 20;
+	// Staging bytes written per frame. Large mip levels are uploaded over several frames.
+	size_t uploadBudgetPerFrame = 4ull << 20;
+	// Every level no larger than this is uploaded as soon as the texture is decoded.
+	uint32_t tailSize = 128;
+	// Number of textures decoded on the host at once. Decoded chains are dropped once
+	// a texture reaches its requested level, which keeps host memory bounded.
+	uint32_t maxHostChains = 2;
+};
+
+// Streams RGBA8 textures and cube maps in one mip level at a time. The low mip tail is
+// made resident first, more detailed levels are promoted by requested screen size and
+// priority, and the least important textures are evicted back towards their tail when
+// the residency budget is exceeded.
+class TextureStreamer {
+public:
+	TextureStreamer(const TextureStreamerSpec& spec = {});
+	TextureStreamer(const TextureStreamer&) = delete;
+	~TextureStreamer();
+
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	StreamedTextureHandle Load(const std::filesystem::path& filePath);
+	// Faces ordered +X, -X, +Y, -Y, +Z, -Z.
+	StreamedTextureHandle LoadCubeMap(const std::array<std::filesystem::path, 6>& facePaths);
+	void Release(StreamedTextureHandle handle);
+
+	// Largest on screen dimension in pixels. Textures promote until a level covers it.
+	void RequestScreenSize(StreamedTextureHandle handle, uint32_t pixels);
+	// Higher priorities are promoted first and evicted last. Defaults to 1.0.
+	void SetPriority(StreamedTextureHandle handle, float priority);
+
+	// Schedules uploads and evictions. Call once per frame between Renderer::StartFrame()
+	// and Renderer::EndFrame().
+	void Update();
+
+	// VK_NULL_HANDLE until the mip tail is resident. The view changes whenever the texture
+	// is promoted or evicted, so fetch it every frame.
+	VkImageView GetImageView(StreamedTextureHandle handle) const;
+	// Texture table slot kept pointing at the resident image, usable as Vertex3D::texIndex.
+	TextureHandle GetTextureIndex(StreamedTextureHandle handle) const;
+	// Most detailed resident level, or UINT32_MAX if nothing is resident yet.
+	uint32_t GetResidentLevel(StreamedTextureHandle handle) const;
+	size_t GetResidentSize() const { return m_ResidentSize; }
+
+private:
+	struct ResidentImage {
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		size_t size = 0;
+		// Source level stored in level 0 of the image.
+		uint32_t baseLevel = 0;
+	};
+
+	struct HostMipChain {
+		uint32_t width, height, layers, mipLevels;
+		// Layout described in mipmap.h.
+		std::vector<uint8_t> pixels;
+	};
+
+	struct StreamedTexture {
+		std::vector<std::filesystem::path> filePaths;
+		TextureHandle tableIndex = CEE_INVALID_TEXTURE_HANDLE;
+		bool inUse = false;
+		bool failed = false;
+		uint32_t generation = 0;
+
+		// Unknown until the first decode completes.
+		uint32_t width = 0, height = 0, layers = 1, mipLevels = 0;
+		// Zero requests every level.
+		uint32_t requestedSize = 0;
+		float priority = 1.0f;
+
+		ResidentImage image;
+		// Promotion being uploaded, swapped with image once its top level is complete.
+		ResidentImage pending;
+		uint32_t pendingLayer = 0;
+		uint32_t pendingRow = 0;
+
+		std::shared_ptr<HostMipChain> hostChain;
+		bool decodeQueued = false;
+		// Promotions blocked by the residency budget decode again from this frame on.
+		uint64_t budgetRetryFrame = 0;
+		uint32_t budgetBackoff = 0;
+	};
+
+	struct RetiredImage {
+		ResidentImage image;
+		uint64_t retireFrame;
+	};
+
+	struct DecodeRequest {
+		StreamedTextureHandle handle;
+		uint32_t generation;
+		std::vector<std::filesystem::path> filePaths;
+	};
+
+	struct DecodeResult {
+		StreamedTextureHandle handle;
+		uint32_t generation;
+		std::shared_ptr<HostMipChain> chain;
+	};
+
+private:
+	StreamedTextureHandle AllocateTexture(std::vector<std::filesystem::path> filePaths);
+	uint32_t ResidentLevel(const StreamedTexture& texture) const;
+	uint32_t TailLevel(const StreamedTexture& texture) const;
+	uint32_t DesiredLevel(const StreamedTexture& texture) const;
+	// Priority weighted by how many levels the texture is missing. Negative when it
+	// holds more detail than requested.
+	float Score(const StreamedTexture& texture) const;
+
+	void CollectDecodedTextures();
+	void QueueDecode(StreamedTextureHandle handle);
+	void DecodeThread();
+	std::shared_ptr<HostMipChain> DecodeTexture(const std::vector<std::filesystem::path>& filePaths);
+
+	ResidentImage CreateResidentImage(const StreamedTexture& texture, uint32_t baseLevel);
+	void RetireImage(ResidentImage& image);
+	void DestroyRetiredImages(bool force);
+
+	// Copies from the staging ring, returns false if this frame's region is full.
+	bool StageUpload(const void* data, size_t size, size_t* bufferOffset);
+
+	bool LoadTail(StreamedTexture& texture);
+	bool ContinuePromotion(StreamedTexture& texture);
+	void FinishPromotion(StreamedTexture& texture);
+	void Demote(StreamedTexture& texture, uint32_t newLevel);
+	// Demotes textures scoring below belowScore until at most targetSize is resident.
+	bool Evict(size_t targetSize, float belowScore, StreamedTextureHandle exclude);
+
+private:
+	TextureStreamerSpec m_Spec;
+	AssetManager m_AssetManager;
+
+	std::vector<StreamedTexture> m_Textures;
+	std::vector<StreamedTextureHandle> m_FreeHandles;
+
+	size_t m_ResidentSize;
+	uint64_t m_FrameCounter;
+	std::vector<RetiredImage> m_RetiredImages;
+
+	// One region per frame that can be in flight plus the one being written.
+	StagingBuffer m_StagingBuffer;
+	uint32_t m_StagingRegionCount;
+	size_t m_StagingRegionOffset;
+	size_t m_StagingRegionUsed;
+
+	std::vector<std::function<void(VkCommandBuffer)>> m_FrameCommands;
+
+	std::thread m_DecodeThread;
+	std::mutex m_DecodeMutex;
+	std::condition_variable m_DecodeCondition;
+	std::deque<DecodeRequest> m_DecodeRequests;
+	std::vector<DecodeResult> m_DecodeResults;
+	bool m_StopDecoding;
+	uint32_t m_HostChainCount;
+};
+}
+
+#endif
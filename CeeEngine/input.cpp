@@ -142,110 +142,110 @@ static void FillKeyMap() {
 }
 
 static void FillKeyStates() {
-	g_KeyMap[key::Escape] = false;    // esc
-	g_KeyMap[key::F1] = false;    // F1
-	g_KeyMap[key::F2] = false;    // F2
-	g_KeyMap[key::F3] = false;    // F3
-	g_KeyMap[key::F4] = false;    // F4
-	g_KeyMap[key::F5] = false;    // F5
-	g_KeyMap[key::F6] = false;    // F6
-	g_KeyMap[key::F7] = false;    // F7
-	g_KeyMap[key::F8] = false;    // F8
-	g_KeyMap[key::F9] = false;    // F9
-	g_KeyMap[key::F10] = false;    // F10
-	g_KeyMap[key::F11] = false;    // F12
-	g_KeyMap[key::F12] = false;    // F12
-	g_KeyMap[key::PrintScreen] = false;    // prt scr
-	g_KeyMap[key::ScrollLock] = false;    // scroll lock
-	g_KeyMap[key::Pause] = false;    // pause
-	g_KeyMap[key::GraveAccent] = false;    // grave
-	g_KeyMap[key::D1] = false;    // 1
-	g_KeyMap[key::D2] = false;    // 2
-	g_KeyMap[key::D3] = false;    // 3
-	g_KeyMap[key::D4] = false;    // 4
-	g_KeyMap[key::D5] = false;    // 5
-	g_KeyMap[key::D6] = false;    // 6
-	g_KeyMap[key::D7] = false;    // 7
-	g_KeyMap[key::D8] = false;    // 8
-	g_KeyMap[key::D9] = false;    // 9
-	g_KeyMap[key::D0] = false;    // 0
-	g_KeyMap[key::Minus] = false;    // -
-	g_KeyMap[key::Equal] = false;    // =
-	g_KeyMap[key::Backspace] = false;    // backspace
-	g_KeyMap[key::Insert] = false;    // insert
-	g_KeyMap[key::Home] = false;    // home
-	g_KeyMap[key::PageUp] = false;    // page up
-	g_KeyMap[key::NumLock] = false;    // numlock
-	g_KeyMap[key::KPDevide] = false;    // kp div
-	g_KeyMap[key::KPMultiply] = false;    // kp mul
-	g_KeyMap[key::KPSubtract] = false;    // kp sub
-	g_KeyMap[key::Tab] = false;    // tab
-	g_KeyMap[key::Q] = false;    // q
-	g_KeyMap[key::W] = false;    // w
-	g_KeyMap[key::E] = false;    // e
-	g_KeyMap[key::R] = false;    // r
-	g_KeyMap[key::T] = false;    // t
-	g_KeyMap[key::Y] = false;    // y
-	g_KeyMap[key::U] = false;    // u
-	g_KeyMap[key::I] = false;    // i
-	g_KeyMap[key::O] = false;    // o
-	g_KeyMap[key::P] = false;    // p
-	g_KeyMap[key::LeftBracekt] = false;    // left bracket
-	g_KeyMap[key::RightBracket] = false;    // right bracket
-	g_KeyMap[key::BackSlash] = false;    // backslash
-	g_KeyMap[key::Delete] = false;    // delete
-	g_KeyMap[key::End] = false;    // end
-	g_KeyMap[key::PageDown] = false;    // pg dn
-	g_KeyMap[key::KP7] = false;    // kp 7
-	g_KeyMap[key::KP8] = false;    // kp 8
-	g_KeyMap[key::KP9] = false;    // kp 9
-	g_KeyMap[key::KPAdd] = false;    // kp add
-	g_KeyMap[key::CapsLock] = false;    // caps lock
-	g_KeyMap[key::A] = false;    // a
-	g_KeyMap[key::S] = false;    // s
-	g_KeyMap[key::D] = false;    // d
-	g_KeyMap[key::F] = false;    // f
-	g_KeyMap[key::G] = false;    // g
-	g_KeyMap[key::H] = false;    // h
-	g_KeyMap[key::J] = false;    // j
-	g_KeyMap[key::K] = false;    // k
-	g_KeyMap[key::L] = false;    // l
-	g_KeyMap[key::Semicolon] = false;    // semicolon
-	g_KeyMap[key::Apostrophe] = false;    // apostrophe
-	g_KeyMap[key::Enter] = false;    // return
-	g_KeyMap[key::KP4] = false;    // kp 4
-	g_KeyMap[key::KP5] = false;    // kp 5
-	g_KeyMap[key::KP6] = false;    // kp 6
-	g_KeyMap[key::LeftShift] = false;    // l shift
-	g_KeyMap[key::Z] = false;    // z
-	g_KeyMap[key::X] = false;    // x
-	g_KeyMap[key::C] = false;    // c
-	g_KeyMap[key::V] = false;    // v
-	g_KeyMap[key::B] = false;    // b
-	g_KeyMap[key::N] = false;    // n
-	g_KeyMap[key::M] = false;    // m
-	g_KeyMap[key::Comma] = false;    // comma
-	g_KeyMap[key::Period] = false;    // period
-	g_KeyMap[key::Slash] = false;    // forward slash
-	g_KeyMap[key::RigthShift] = false;    // r shift
-	g_KeyMap[key::Up] = false;    // up
-	g_KeyMap[key::KP1] = false;    // kp 1
-	g_KeyMap[key::KP2] = false;    // kp 2
-	g_KeyMap[key::KP3] = false;    // kp 3
-	g_KeyMap[key::KPEnter] = false;    // kp enter
-	g_KeyMap[key::LeftControl] = false;    // l ctrl
-	g_KeyMap[key::LeftSuper] = false;    // l super
-	g_KeyMap[key::LeftAlt] = false;    // l alt
-	g_KeyMap[key::Space] = false;    // space
-	g_KeyMap[key::RightAlt] = false;    // r alt
-	g_KeyMap[key::RightSuper] = false;    // r super
-	g_KeyMap[key::Menu] = false;    // menu
-	g_KeyMap[key::RigthControl] = false;    // r ctrl
-	g_KeyMap[key::Left] = false;    // left
-	g_KeyMap[key::Down] = false;    // down
-	g_KeyMap[key::Right] = false;    // right
-	g_KeyMap[key::KP0] = false;    // kp 0
-	g_KeyMap[key::KPDecimal] = false;    // kp decimal
+	g_KeyStates[key::Escape] = false;    // esc
+	g_KeyStates[key::F1] = false;    // F1
+	g_KeyStates[key::F2] = false;    // F2
+	g_KeyStates[key::F3] = false;    // F3
+	g_KeyStates[key::F4] = false;    // F4
+	g_KeyStates[key::F5] = false;    // F5
+	g_KeyStates[key::F6] = false;    // F6
+	g_KeyStates[key::F7] = false;    // F7
+	g_KeyStates[key::F8] = false;    // F8
+	g_KeyStates[key::F9] = false;    // F9
+	g_KeyStates[key::F10] = false;    // F10
+	g_KeyStates[key::F11] = false;    // F12
+	g_KeyStates[key::F12] = false;    // F12
+	g_KeyStates[key::PrintScreen] = false;    // prt scr
+	g_KeyStates[key::ScrollLock] = false;    // scroll lock
+	g_KeyStates[key::Pause] = false;    // pause
+	g_KeyStates[key::GraveAccent] = false;    // grave
+	g_KeyStates[key::D1] = false;    // 1
+	g_KeyStates[key::D2] = false;    // 2
+	g_KeyStates[key::D3] = false;    // 3
+	g_KeyStates[key::D4] = false;    // 4
+	g_KeyStates[key::D5] = false;    // 5
+	g_KeyStates[key::D6] = false;    // 6
+	g_KeyStates[key::D7] = false;    // 7
+	g_KeyStates[key::D8] = false;    // 8
+	g_KeyStates[key::D9] = false;    // 9
+	g_KeyStates[key::D0] = false;    // 0
+	g_KeyStates[key::Minus] = false;    // -
+	g_KeyStates[key::Equal] = false;    // =
+	g_KeyStates[key::Backspace] = false;    // backspace
+	g_KeyStates[key::Insert] = false;    // insert
+	g_KeyStates[key::Home] = false;    // home
+	g_KeyStates[key::PageUp] = false;    // page up
+	g_KeyStates[key::NumLock] = false;    // numlock
+	g_KeyStates[key::KPDevide] = false;    // kp div
+	g_KeyStates[key::KPMultiply] = false;    // kp mul
+	g_KeyStates[key::KPSubtract] = false;    // kp sub
+	g_KeyStates[key::Tab] = false;    // tab
+	g_KeyStates[key::Q] = false;    // q
+	g_KeyStates[key::W] = false;    // w
+	g_KeyStates[key::E] = false;    // e
+	g_KeyStates[key::R] = false;    // r
+	g_KeyStates[key::T] = false;    // t
+	g_KeyStates[key::Y] = false;    // y
+	g_KeyStates[key::U] = false;    // u
+	g_KeyStates[key::I] = false;    // i
+	g_KeyStates[key::O] = false;    // o
+	g_KeyStates[key::P] = false;    // p
+	g_KeyStates[key::LeftBracekt] = false;    // left bracket
+	g_KeyStates[key::RightBracket] = false;    // right bracket
+	g_KeyStates[key::BackSlash] = false;    // backslash
+	g_KeyStates[key::Delete] = false;    // delete
+	g_KeyStates[key::End] = false;    // end
+	g_KeyStates[key::PageDown] = false;    // pg dn
+	g_KeyStates[key::KP7] = false;    // kp 7
+	g_KeyStates[key::KP8] = false;    // kp 8
+	g_KeyStates[key::KP9] = false;    // kp 9
+	g_KeyStates[key::KPAdd] = false;    // kp add
+	g_KeyStates[key::CapsLock] = false;    // caps lock
+	g_KeyStates[key::A] = false;    // a
+	g_KeyStates[key::S] = false;    // s
+	g_KeyStates[key::D] = false;    // d
+	g_KeyStates[key::F] = false;    // f
+	g_KeyStates[key::G] = false;    // g
+	g_KeyStates[key::H] = false;    // h
+	g_KeyStates[key::J] = false;    // j
+	g_KeyStates[key::K] = false;    // k
+	g_KeyStates[key::L] = false;    // l
+	g_KeyStates[key::Semicolon] = false;    // semicolon
+	g_KeyStates[key::Apostrophe] = false;    // apostrophe
+	g_KeyStates[key::Enter] = false;    // return
+	g_KeyStates[key::KP4] = false;    // kp 4
+	g_KeyStates[key::KP5] = false;    // kp 5
+	g_KeyStates[key::KP6] = false;    // kp 6
+	g_KeyStates[key::LeftShift] = false;    // l shift
+	g_KeyStates[key::Z] = false;    // z
+	g_KeyStates[key::X] = false;    // x
+	g_KeyStates[key::C] = false;    // c
+	g_KeyStates[key::V] = false;    // v
+	g_KeyStates[key::B] = false;    // b
+	g_KeyStates[key::N] = false;    // n
+	g_KeyStates[key::M] = false;    // m
+	g_KeyStates[key::Comma] = false;    // comma
+	g_KeyStates[key::Period] = false;    // period
+	g_KeyStates[key::Slash] = false;    // forward slash
+	g_KeyStates[key::RigthShift] = false;    // r shift
+	g_KeyStates[key::Up] = false;    // up
+	g_KeyStates[key::KP1] = false;    // kp 1
+	g_KeyStates[key::KP2] = false;    // kp 2
+	g_KeyStates[key::KP3] = false;    // kp 3
+	g_KeyStates[key::KPEnter] = false;    // kp enter
+	g_KeyStates[key::LeftControl] = false;    // l ctrl
+	g_KeyStates[key::LeftSuper] = false;    // l super
+	g_KeyStates[key::LeftAlt] = false;    // l alt
+	g_KeyStates[key::Space] = false;    // space
+	g_KeyStates[key::RightAlt] = false;    // r alt
+	g_KeyStates[key::RightSuper] = false;    // r super
+	g_KeyStates[key::Menu] = false;    // menu
+	g_KeyStates[key::RigthControl] = false;    // r ctrl
+	g_KeyStates[key::Left] = false;    // left
+	g_KeyStates[key::Down] = false;    // down
+	g_KeyStates[key::Right] = false;    // right
+	g_KeyStates[key::KP0] = false;    // kp 0
+	g_KeyStates[key::KPDecimal] = false;    // kp decimal
 	// g_KeyStates[mouse::Button0] = false;    // Mouse button 0 (l click)
 	// g_KeyStates[mouse::Button1] = false;    // Mouse button 1 (r click)
 	// g_KeyStates[mouse::Button2] = false;    // Mouse button 2 (mmb)
@@ -317,10 +317,19 @@ void Shutdown() {
 	g_Initialized = false;
 }
 
+KeyCode TranslateKeysym(uint32_t keysym) {
+	if (g_KeyMap.empty()) {
+		FillKeyMap();
+	}
+	auto keyCode = g_KeyMap.find(keysym);
+	return keyCode != g_KeyMap.end() ? keyCode->second : 0;
+}
+
 int GetKeyState(KeyCode keycode) {
-	if (g_Initialized)
-		return g_KeyStates[keycode];
-	else {
+	if (g_Initialized) {
+		auto state = g_KeyStates.find(keycode);
+		return state != g_KeyStates.end() ? state->second : false;
+	} else {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
 										 "Requesting key state without calling `Input::Init()`");
 		return false;
@@ -333,11 +342,11 @@ bool MessageHandler(Event& e) {
 			if (e.GetEventType() == EventType::KeyPressed) {
 				KeyPressedEvent& event = dynamic_cast<KeyPressedEvent&>(e);
 				xkb_keysym_t keysym = xkb_state_key_get_one_sym(g_XkbState, event.GetKeyCode());
-				g_KeyStates[g_KeyMap[keysym]] = true;
+				g_KeyStates[TranslateKeysym(keysym)] = true;
 			} else if (e.GetEventType() == EventType::KeyReleased) {
 				KeyReleasedEvent& event = dynamic_cast<KeyReleasedEvent&>(e);
 				xkb_keysym_t keysym = xkb_state_key_get_one_sym(g_XkbState, event.GetKeyCode());
-				g_KeyStates[g_KeyMap[keysym]] = false;
+				g_KeyStates[TranslateKeysym(keysym)] = false;
 			}
 			return true;
 		}
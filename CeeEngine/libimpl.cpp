@@ -1,4 +1,6 @@
 #define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
 
 #include <stb/stb_image.h>
+#include <stb/stb_image_write.h>
 
@@ -0,0 +1,89 @@
+#include <CeeEngine/mesh.h>
+
+#include <CeeEngine/debugMessenger.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+namespace cee {
+uint32_t Mesh::GetIndex(size_t i) const {
+	if (indexSize == sizeof(uint16_t)) {
+		uint16_t index;
+		memcpy(&index, indices.data() + i * sizeof(uint16_t), sizeof(uint16_t));
+		return index;
+	}
+	uint32_t index;
+	memcpy(&index, indices.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+	return index;
+}
+
+std::vector<uint32_t> Mesh::GetIndices() const {
+	std::vector<uint32_t> indices32(GetIndexCount());
+	for (size_t i = 0; i < indices32.size(); i++) {
+		indices32[i] = GetIndex(i);
+	}
+	return indices32;
+}
+
+void Mesh::SetIndices(const std::vector<uint32_t>& indices32) {
+	indexSize = vertices.size() <= (UINT16_MAX + 1u) ? sizeof(uint16_t) : sizeof(uint32_t);
+	indices.resize(indices32.size() * indexSize);
+	if (indexSize == sizeof(uint32_t)) {
+		memcpy(indices.data(), indices32.data(), indices.size());
+		return;
+	}
+	for (size_t i = 0; i < indices32.size(); i++) {
+		uint16_t index = (uint16_t)indices32[i];
+		memcpy(indices.data() + i * sizeof(uint16_t), &index, sizeof(uint16_t));
+	}
+}
+
+void Mesh::ComputeBounds() {
+	bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	for (auto& submesh : submeshes) {
+		submesh.bounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+		for (uint32_t i = submesh.firstIndex; i < submesh.firstIndex + submesh.indexCount; i++) {
+			const glm::vec3& position = vertices[GetIndex(i)].position;
+			submesh.bounds.min = glm::min(submesh.bounds.min, position);
+			submesh.bounds.max = glm::max(submesh.bounds.max, position);
+		}
+		bounds.min = glm::min(bounds.min, submesh.bounds.min);
+		bounds.max = glm::max(bounds.max, submesh.bounds.max);
+	}
+}
+
+int Mesh::Validate() const {
+	if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Mesh index size %u is not 2 or 4.", indexSize);
+		return -1;
+	}
+	if (lodCount == 0 || lodCount > CEE_MESH_MAX_LODS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Mesh has %u levels of detail, expected 1 to %u.",
+										 lodCount, CEE_MESH_MAX_LODS);
+		return -1;
+	}
+	uint32_t indexCount = GetIndexCount();
+	for (size_t i = 0; i < submeshes.size(); i++) {
+		for (uint32_t lod = 0; lod < lodCount; lod++) {
+			IndexRange range = submeshes[i].GetLod(lod);
+			if (range.firstIndex > indexCount || range.indexCount > indexCount - range.firstIndex ||
+				range.indexCount % 3 != 0)
+			{
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+												 "Submesh %zu LOD %u (indices %u to %u) is not whole triangles within the %u indices of the mesh.",
+												 i, lod, range.firstIndex, range.firstIndex + range.indexCount, indexCount);
+				return -1;
+			}
+		}
+	}
+	for (uint32_t i = 0; i < indexCount; i++) {
+		if (GetIndex(i) >= vertices.size()) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "Mesh index %u refers to vertex %u of %zu.", i, GetIndex(i), vertices.size());
+			return -1;
+		}
+	}
+	return 0;
+}
+}
@@ -0,0 +1,236 @@
+#include <CeeEngine/meshImporter.h>
+
+#include <CeeEngine/debugMessenger.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include <Tracy.hpp>
+
+namespace cee {
+struct ObjVertexKey {
+	int32_t position;
+	int32_t texCoords;
+	int32_t normal;
+
+	bool operator==(const ObjVertexKey& other) const {
+		return position == other.position && texCoords == other.texCoords && normal == other.normal;
+	}
+};
+
+struct ObjVertexKeyHash {
+	size_t operator()(const ObjVertexKey& key) const {
+		size_t hash = std::hash<int32_t>()(key.position);
+		hash ^= std::hash<int32_t>()(key.texCoords) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<int32_t>()(key.normal) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
+// True if the line starts with keyword followed by whitespace.
+static bool IsObjKeyword(const char* line, const char* keyword) {
+	size_t length = strlen(keyword);
+	return strncmp(line, keyword, length) == 0 && isspace((unsigned char)line[length]);
+}
+
+// OBJ indices start at 1, negative ones count back from the last element read.
+// Returns -1 if the index is absent or out of range.
+static int32_t ResolveObjIndex(long index, size_t count) {
+	if (index > 0 && (size_t)index <= count) {
+		return (int32_t)(index - 1);
+	}
+	if (index < 0 && (size_t)-index <= count) {
+		return (int32_t)(count + index);
+	}
+	return -1;
+}
+
+// Parses one of "v", "v/vt", "v//vn" or "v/vt/vn".
+static bool ParseObjFaceVertex(const char** cursor, size_t positionCount, size_t texCoordCount,
+							   size_t normalCount, ObjVertexKey* key)
+{
+	char* end;
+	long position = strtol(*cursor, &end, 10);
+	if (end == *cursor) {
+		return false;
+	}
+	*cursor = end;
+	key->position = ResolveObjIndex(position, positionCount);
+	key->texCoords = -1;
+	key->normal = -1;
+	if (**cursor == '/') {
+		(*cursor)++;
+		long texCoords = strtol(*cursor, &end, 10);
+		if (end != *cursor) {
+			key->texCoords = ResolveObjIndex(texCoords, texCoordCount);
+			*cursor = end;
+		}
+		if (**cursor == '/') {
+			(*cursor)++;
+			long normal = strtol(*cursor, &end, 10);
+			if (end != *cursor) {
+				key->normal = ResolveObjIndex(normal, normalCount);
+				*cursor = end;
+			}
+		}
+	}
+	return key->position >= 0;
+}
+
+int ImportObj(const std::filesystem::path& filePath, Mesh* mesh) {
+	ZoneScoped;
+	std::ifstream file(filePath);
+	if (!file.is_open()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to open file \"%s\".", filePath.c_str());
+		return -1;
+	}
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertexIndices;
+	// Position each vertex was made from, for generating missing normals.
+	std::vector<int32_t> vertexPositions;
+	std::vector<bool> generateNormal;
+
+	// Triangles of each material, in the order the materials first appear. Faces before
+	// the first usemtl use the unnamed material.
+	std::vector<std::string> materials = { "" };
+	std::vector<std::vector<uint32_t>> materialIndices(1);
+	size_t material = 0;
+
+	*mesh = Mesh();
+	std::string line;
+	size_t lineNumber = 0;
+	std::vector<ObjVertexKey> faceKeys;
+	std::vector<uint32_t> polygon;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		const char* cursor = line.c_str();
+		while (isspace((unsigned char)*cursor)) {
+			cursor++;
+		}
+
+		if (IsObjKeyword(cursor, "v")) {
+			glm::vec3 position(0.0f);
+			sscanf(cursor + 1, "%f %f %f", &position.x, &position.y, &position.z);
+			positions.push_back(position);
+		} else if (IsObjKeyword(cursor, "vt")) {
+			glm::vec2 uv(0.0f);
+			sscanf(cursor + 2, "%f %f", &uv.x, &uv.y);
+			// OBJ puts the origin at the bottom left of the image, Vulkan at the top left.
+			texCoords.push_back(glm::vec2(uv.x, 1.0f - uv.y));
+		} else if (IsObjKeyword(cursor, "vn")) {
+			glm::vec3 normal(0.0f);
+			sscanf(cursor + 2, "%f %f %f", &normal.x, &normal.y, &normal.z);
+			normals.push_back(normal);
+		} else if (IsObjKeyword(cursor, "usemtl")) {
+			std::string name = cursor + 6;
+			name.erase(0, name.find_first_not_of(" \t"));
+			name.erase(name.find_last_not_of(" \t\r") + 1);
+			material = 0;
+			while (material < materials.size() && materials[material] != name) {
+				material++;
+			}
+			if (material == materials.size()) {
+				materials.push_back(name);
+				materialIndices.emplace_back();
+			}
+		} else if (IsObjKeyword(cursor, "f")) {
+			cursor++;
+			faceKeys.clear();
+			bool valid = true;
+			while (true) {
+				while (isspace((unsigned char)*cursor)) {
+					cursor++;
+				}
+				if (*cursor == '\0') {
+					break;
+				}
+				ObjVertexKey key;
+				if (!ParseObjFaceVertex(&cursor, positions.size(), texCoords.size(), normals.size(), &key)) {
+					valid = false;
+					break;
+				}
+				faceKeys.push_back(key);
+			}
+			if (!valid || faceKeys.size() < 3) {
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "%s:%zu: Skipping malformed face.",
+												 filePath.c_str(), lineNumber);
+				continue;
+			}
+
+			polygon.clear();
+			for (const ObjVertexKey& key : faceKeys) {
+				auto inserted = vertexIndices.emplace(key, (uint32_t)mesh->vertices.size());
+				if (inserted.second) {
+					MeshVertex vertex;
+					vertex.position = positions[key.position];
+					vertex.normal = key.normal >= 0 ? normals[key.normal] : glm::vec3(0.0f);
+					vertex.texCoords = key.texCoords >= 0 ? texCoords[key.texCoords] : glm::vec2(0.0f);
+					mesh->vertices.push_back(vertex);
+					vertexPositions.push_back(key.position);
+					generateNormal.push_back(key.normal < 0);
+				}
+				polygon.push_back(inserted.first->second);
+			}
+			// OBJ winds faces counter-clockwise, the engine clockwise like the built-in cube.
+			for (size_t i = 2; i < polygon.size(); i++) {
+				materialIndices[material].push_back(polygon[0]);
+				materialIndices[material].push_back(polygon[i]);
+				materialIndices[material].push_back(polygon[i - 1]);
+			}
+		}
+	}
+
+	std::vector<uint32_t> indices;
+	for (auto& triangles : materialIndices) {
+		if (triangles.empty()) {
+			continue;
+		}
+		Submesh submesh = {};
+		submesh.firstIndex = indices.size();
+		submesh.indexCount = triangles.size();
+		mesh->submeshes.push_back(submesh);
+		indices.insert(indices.end(), triangles.begin(), triangles.end());
+	}
+	if (indices.empty()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "\"%s\" has no faces.", filePath.c_str());
+		return -1;
+	}
+
+	// Area weighted average of the faces around each position, so vertices split by
+	// texture seams still share a normal.
+	if (std::find(generateNormal.begin(), generateNormal.end(), true) != generateNormal.end()) {
+		std::vector<glm::vec3> positionNormals(positions.size(), glm::vec3(0.0f));
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			const glm::vec3& a = mesh->vertices[indices[i + 0]].position;
+			const glm::vec3& b = mesh->vertices[indices[i + 1]].position;
+			const glm::vec3& c = mesh->vertices[indices[i + 2]].position;
+			// Clockwise, so the cross product is reversed to point outwards.
+			glm::vec3 faceNormal = glm::cross(c - a, b - a);
+			for (size_t corner = 0; corner < 3; corner++) {
+				positionNormals[vertexPositions[indices[i + corner]]] += faceNormal;
+			}
+		}
+		for (size_t i = 0; i < mesh->vertices.size(); i++) {
+			if (!generateNormal[i]) {
+				continue;
+			}
+			glm::vec3 normal = positionNormals[vertexPositions[i]];
+			float length = glm::length(normal);
+			mesh->vertices[i].normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+	}
+
+	mesh->SetIndices(indices);
+	mesh->ComputeBounds();
+	return 0;
+}
+}
@@ -0,0 +1,423 @@
+#include <CeeEngine/meshOptimizer.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include <Tracy.hpp>
+
+namespace cee {
+// Forsyth's weights: the three vertices of the last triangle score a fixed amount,
+// older cache entries decay with their position and vertices with few triangles left
+// are boosted so they are finished off instead of being left behind.
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+static float ForsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles) {
+	if (remainingTriangles == 0) {
+		// No triangle left to pull in.
+		return -1.0f;
+	}
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		} else {
+			const float scale = 1.0f / (CEE_MESH_OPTIMIZER_CACHE_SIZE - 3);
+			score = powf(1.0f - (cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)remainingTriangles, -FORSYTH_VALENCE_BOOST_POWER);
+	return score;
+}
+
+VertexCacheStats ComputeVertexCacheStats(const uint32_t* indices, size_t indexCount,
+										 uint32_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats = {};
+	if (indexCount < 3) {
+		return stats;
+	}
+	// A vertex is cached while fewer than cacheSize misses happened since its own.
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+	uint32_t misses = 0;
+	uint32_t usedVertices = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32_t vertex = indices[i];
+		if (timestamp - cacheTimestamps[vertex] > cacheSize) {
+			usedVertices += cacheTimestamps[vertex] == 0;
+			cacheTimestamps[vertex] = timestamp++;
+			misses++;
+		}
+	}
+	stats.acmr = (float)misses / (float)(indexCount / 3);
+	stats.atvr = (float)misses / (float)usedVertices;
+	return stats;
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount) {
+	ZoneScoped;
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2) {
+		return;
+	}
+
+	// Triangles using each vertex, as one array sliced by adjacencyOffsets. Emitted
+	// triangles are swapped out of the live part of each slice.
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < indexCount; i++) {
+		adjacencyOffsets[indices[i] + 1]++;
+	}
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+		adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+	}
+	std::vector<uint32_t> adjacency(indexCount);
+	std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32_t vertex = indices[i];
+		adjacency[adjacencyOffsets[vertex] + remainingTriangles[vertex]++] = i / 3;
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+		vertexScores[vertex] = ForsythVertexScore(-1, remainingTriangles[vertex]);
+	}
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		const uint32_t* corners = indices + triangle * 3;
+		triangleScores[triangle] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> output(indexCount);
+	// The new cache holds the emitted triangle in front of the old cache, the entries
+	// pushed past CEE_MESH_OPTIMIZER_CACHE_SIZE are evicted.
+	uint32_t cache[CEE_MESH_OPTIMIZER_CACHE_SIZE + 3];
+	uint32_t newCache[CEE_MESH_OPTIMIZER_CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+	int64_t bestTriangle = -1;
+	size_t scanCursor = 0;
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+		if (bestTriangle < 0) {
+			// Nothing in the cache has triangles left, continue with the next unemitted
+			// triangle in input order rather than searching every triangle.
+			while (emitted[scanCursor]) {
+				scanCursor++;
+			}
+			bestTriangle = scanCursor;
+		}
+		uint32_t triangle = (uint32_t)bestTriangle;
+		const uint32_t* corners = indices + triangle * 3;
+		memcpy(output.data() + emittedCount * 3, corners, 3 * sizeof(uint32_t));
+		emitted[triangle] = true;
+
+		uint32_t newCacheCount = 0;
+		for (uint32_t corner = 0; corner < 3; corner++) {
+			uint32_t vertex = corners[corner];
+			uint32_t* triangles = adjacency.data() + adjacencyOffsets[vertex];
+			uint32_t* last = triangles + --remainingTriangles[vertex];
+			*std::find(triangles, last, triangle) = *last;
+
+			if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount) {
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+		for (uint32_t i = 0; i < cacheCount; i++) {
+			uint32_t vertex = cache[i];
+			if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+		for (uint32_t i = 0; i < newCacheCount; i++) {
+			cachePositions[newCache[i]] = i < CEE_MESH_OPTIMIZER_CACHE_SIZE ? (int32_t)i : -1;
+		}
+
+		// Only vertices whose cache position or valence changed need rescoring, and
+		// the next triangle is taken from the ones they still touch.
+		for (uint32_t i = 0; i < newCacheCount; i++) {
+			uint32_t vertex = newCache[i];
+			float score = ForsythVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+			const uint32_t* triangles = adjacency.data() + adjacencyOffsets[vertex];
+			for (uint32_t j = 0; j < remainingTriangles[vertex]; j++) {
+				triangleScores[triangles[j]] += delta;
+			}
+		}
+		cacheCount = std::min(newCacheCount, (uint32_t)CEE_MESH_OPTIMIZER_CACHE_SIZE);
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+		bestTriangle = -1;
+		float bestScore = 0.0f;
+		for (uint32_t i = 0; i < cacheCount; i++) {
+			uint32_t vertex = cache[i];
+			const uint32_t* triangles = adjacency.data() + adjacencyOffsets[vertex];
+			for (uint32_t j = 0; j < remainingTriangles[vertex]; j++) {
+				if (bestTriangle < 0 || triangleScores[triangles[j]] > bestScore) {
+					bestTriangle = triangles[j];
+					bestScore = triangleScores[triangles[j]];
+				}
+			}
+		}
+	}
+
+	memcpy(indices, output.data(), indexCount * sizeof(uint32_t));
+}
+
+struct TriangleCluster {
+	uint32_t firstTriangle;
+	uint32_t triangleCount;
+	float sortKey;
+};
+
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const MeshVertex* vertices,
+					  uint32_t vertexCount, float threshold)
+{
+	ZoneScoped;
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2) {
+		return;
+	}
+	float originalAcmr = ComputeVertexCacheStats(indices, indexCount, vertexCount, CEE_MESH_STATS_CACHE_SIZE).acmr;
+
+	// Hard boundaries are triangles missing the cache on every vertex, the order does
+	// not rely on the triangles before them. Each run between them is split further
+	// wherever the run so far, started from a cold cache, is within threshold of the
+	// whole run's ACMR, so reordering the pieces costs little reuse.
+	std::vector<uint32_t> hardBoundaries;
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	uint32_t timestamp = CEE_MESH_STATS_CACHE_SIZE + 1;
+	auto countMisses = [&](size_t triangle) {
+		uint32_t misses = 0;
+		for (size_t corner = 0; corner < 3; corner++) {
+			uint32_t vertex = indices[triangle * 3 + corner];
+			if (timestamp - cacheTimestamps[vertex] > CEE_MESH_STATS_CACHE_SIZE) {
+				cacheTimestamps[vertex] = timestamp++;
+				misses++;
+			}
+		}
+		return misses;
+	};
+	auto resetCache = [&]() {
+		timestamp += CEE_MESH_STATS_CACHE_SIZE + 1;
+	};
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		if (countMisses(triangle) == 3) {
+			hardBoundaries.push_back(triangle);
+		}
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	std::vector<TriangleCluster> clusters;
+	for (size_t i = 0; i + 1 < hardBoundaries.size(); i++) {
+		uint32_t start = hardBoundaries[i];
+		uint32_t end = hardBoundaries[i + 1];
+		resetCache();
+		uint32_t runMisses = 0;
+		for (uint32_t triangle = start; triangle < end; triangle++) {
+			runMisses += countMisses(triangle);
+		}
+		float runAcmr = (float)runMisses / (float)(end - start);
+
+		resetCache();
+		uint32_t clusterStart = start;
+		uint32_t clusterMisses = 0;
+		for (uint32_t triangle = start; triangle < end; triangle++) {
+			clusterMisses += countMisses(triangle);
+			float clusterAcmr = (float)clusterMisses / (float)(triangle + 1 - clusterStart);
+			if (triangle + 1 < end && clusterAcmr <= runAcmr * threshold) {
+				clusters.push_back({ clusterStart, triangle + 1 - clusterStart, 0.0f });
+				clusterStart = triangle + 1;
+				clusterMisses = 0;
+				resetCache();
+			}
+		}
+		clusters.push_back({ clusterStart, end - clusterStart, 0.0f });
+	}
+	if (clusters.size() < 2) {
+		return;
+	}
+
+	// Area weighted centroid and normal of each cluster. Clusters far out along their
+	// normal are on the outside of the mesh and tend to occlude the rest.
+	std::vector<glm::vec3> centroids(clusters.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> normals(clusters.size(), glm::vec3(0.0f));
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (size_t i = 0; i < clusters.size(); i++) {
+		float clusterArea = 0.0f;
+		for (uint32_t triangle = clusters[i].firstTriangle;
+			 triangle < clusters[i].firstTriangle + clusters[i].triangleCount; triangle++)
+		{
+			const glm::vec3& a = vertices[indices[triangle * 3 + 0]].position;
+			const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+			const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+			// Clockwise winding, see ImportObj().
+			glm::vec3 normal = glm::cross(c - a, b - a);
+			float area = glm::length(normal) * 0.5f;
+			centroids[i] += (a + b + c) * (area / 3.0f);
+			normals[i] += normal;
+			clusterArea += area;
+		}
+		meshCentroid += centroids[i];
+		meshArea += clusterArea;
+		if (clusterArea > 0.0f) {
+			centroids[i] /= clusterArea;
+		}
+	}
+	if (meshArea <= 0.0f) {
+		return;
+	}
+	meshCentroid /= meshArea;
+	for (size_t i = 0; i < clusters.size(); i++) {
+		float length = glm::length(normals[i]);
+		clusters[i].sortKey = length > 0.0f ? glm::dot(centroids[i] - meshCentroid, normals[i] / length) : 0.0f;
+	}
+	std::stable_sort(clusters.begin(), clusters.end(), [](const TriangleCluster& a, const TriangleCluster& b) {
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> reordered;
+	reordered.reserve(indexCount);
+	for (const TriangleCluster& cluster : clusters) {
+		const uint32_t* first = indices + cluster.firstTriangle * 3;
+		reordered.insert(reordered.end(), first, first + cluster.triangleCount * 3);
+	}
+	float reorderedAcmr = ComputeVertexCacheStats(reordered.data(), reordered.size(), vertexCount,
+												  CEE_MESH_STATS_CACHE_SIZE).acmr;
+	if (reorderedAcmr <= originalAcmr * threshold) {
+		memcpy(indices, reordered.data(), indexCount * sizeof(uint32_t));
+	}
+}
+
+uint32_t OptimizeVertexFetch(Mesh* mesh) {
+	ZoneScoped;
+	std::vector<uint32_t> indices = mesh->GetIndices();
+	std::vector<uint32_t> remap(mesh->vertices.size(), UINT32_MAX);
+	std::vector<MeshVertex> vertices;
+	vertices.reserve(mesh->vertices.size());
+	for (uint32_t& index : indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = vertices.size();
+			vertices.push_back(mesh->vertices[index]);
+		}
+		index = remap[index];
+	}
+	uint32_t unusedVertices = mesh->vertices.size() - vertices.size();
+	mesh->vertices = std::move(vertices);
+	mesh->SetIndices(indices);
+	return unusedVertices;
+}
+
+// Statistics of the full detail submeshes drawn one after another.
+static VertexCacheStats ComputeLevel0Stats(const Mesh& mesh, const std::vector<uint32_t>& indices) {
+	std::vector<uint32_t> level0;
+	for (const Submesh& submesh : mesh.submeshes) {
+		level0.insert(level0.end(), indices.begin() + submesh.firstIndex,
+					  indices.begin() + submesh.firstIndex + submesh.indexCount);
+	}
+	return ComputeVertexCacheStats(level0.data(), level0.size(), mesh.vertices.size(), CEE_MESH_STATS_CACHE_SIZE);
+}
+
+void OptimizeMesh(Mesh* mesh, const MeshOptimizationSpec& spec, MeshOptimizationStats* stats) {
+	ZoneScoped;
+	MeshOptimizationStats result = {};
+	std::vector<uint32_t> indices = mesh->GetIndices();
+	uint32_t vertexCount = mesh->vertices.size();
+	result.before = ComputeLevel0Stats(*mesh, indices);
+
+	// Submeshes and their levels of detail are separate draws, triangles never move
+	// between them.
+	for (const Submesh& submesh : mesh->submeshes) {
+		for (uint32_t lod = 0; lod < mesh->lodCount; lod++) {
+			IndexRange range = submesh.GetLod(lod);
+			uint32_t* rangeIndices = indices.data() + range.firstIndex;
+			if (spec.vertexCache) {
+				OptimizeVertexCache(rangeIndices, range.indexCount, vertexCount);
+			}
+			if (spec.overdraw) {
+				OptimizeOverdraw(rangeIndices, range.indexCount, mesh->vertices.data(), vertexCount,
+								 spec.overdrawThreshold);
+			}
+		}
+	}
+	mesh->SetIndices(indices);
+	if (spec.vertexFetch) {
+		result.unusedVertices = OptimizeVertexFetch(mesh);
+		indices = mesh->GetIndices();
+	}
+
+	result.after = ComputeLevel0Stats(*mesh, indices);
+	mesh->ComputeBounds();
+	if (stats != NULL) {
+		*stats = result;
+	}
+}
+
+static void FinishMeshlet(const Mesh& mesh, Meshlet& meshlet, MeshletData* meshlets,
+						  std::vector<uint32_t>& localIndices)
+{
+	glm::vec3 min(FLT_MAX);
+	glm::vec3 max(-FLT_MAX);
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		uint32_t vertex = meshlets->vertices[meshlet.vertexOffset + i];
+		min = glm::min(min, mesh.vertices[vertex].position);
+		max = glm::max(max, mesh.vertices[vertex].position);
+		localIndices[vertex] = UINT32_MAX;
+	}
+	meshlet.center = (min + max) * 0.5f;
+	meshlet.radius = 0.0f;
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		uint32_t vertex = meshlets->vertices[meshlet.vertexOffset + i];
+		meshlet.radius = std::max(meshlet.radius, glm::length(mesh.vertices[vertex].position - meshlet.center));
+	}
+	meshlets->meshlets.push_back(meshlet);
+}
+
+void BuildMeshlets(const Mesh& mesh, MeshletData* meshlets) {
+	ZoneScoped;
+	*meshlets = MeshletData();
+	std::vector<uint32_t> indices = mesh.GetIndices();
+	// Index of each mesh vertex within the meshlet being built.
+	std::vector<uint32_t> localIndices(mesh.vertices.size(), UINT32_MAX);
+
+	for (const Submesh& submesh : mesh.submeshes) {
+		Meshlet meshlet = {};
+		meshlet.vertexOffset = meshlets->vertices.size();
+		meshlet.triangleOffset = meshlets->triangles.size() / 3;
+		for (uint32_t i = submesh.firstIndex; i < submesh.firstIndex + submesh.indexCount; i += 3) {
+			uint32_t newVertices = 0;
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[i + corner];
+				newVertices += localIndices[vertex] == UINT32_MAX &&
+							   (corner < 1 || vertex != indices[i]) && (corner < 2 || vertex != indices[i + 1]);
+			}
+			if (meshlet.vertexCount + newVertices > CEE_MESHLET_MAX_VERTICES ||
+				meshlet.triangleCount == CEE_MESHLET_MAX_TRIANGLES)
+			{
+				FinishMeshlet(mesh, meshlet, meshlets, localIndices);
+				meshlet = {};
+				meshlet.vertexOffset = meshlets->vertices.size();
+				meshlet.triangleOffset = meshlets->triangles.size() / 3;
+			}
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[i + corner];
+				if (localIndices[vertex] == UINT32_MAX) {
+					localIndices[vertex] = meshlet.vertexCount++;
+					meshlets->vertices.push_back(vertex);
+				}
+				meshlets->triangles.push_back((uint8_t)localIndices[vertex]);
+			}
+			meshlet.triangleCount++;
+		}
+		if (meshlet.triangleCount != 0) {
+			FinishMeshlet(mesh, meshlet, meshlets, localIndices);
+		}
+	}
+}
+}
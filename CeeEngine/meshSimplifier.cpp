@@ -0,0 +1,321 @@
+#include <CeeEngine/meshSimplifier.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <Tracy.hpp>
+
+namespace cee {
+// Collapses folding a triangle further than this, as the cosine between its normal
+// before and after, are rejected.
+#define SIMPLIFY_MIN_NORMAL_COSINE 0.25f
+// A level has to remove at least this share of the triangles of the one before it.
+#define LOD_MIN_REDUCTION 0.1f
+
+// Sum of the squared distances to the planes of the triangles around a vertex,
+// weighted by their area, as the symmetric 4x4 matrix of Garland and Heckbert.
+struct Quadric {
+	double a00, a01, a02, a03;
+	double a11, a12, a13;
+	double a22, a23;
+	double a33;
+	double weight;
+
+	void AddPlane(const glm::vec3& normal, float distance, float area) {
+		double x = normal.x, y = normal.y, z = normal.z, w = distance;
+		a00 += area * x * x; a01 += area * x * y; a02 += area * x * z; a03 += area * x * w;
+		a11 += area * y * y; a12 += area * y * z; a13 += area * y * w;
+		a22 += area * z * z; a23 += area * z * w;
+		a33 += area * w * w;
+		weight += area;
+	}
+
+	void Add(const Quadric& other) {
+		a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+		a11 += other.a11; a12 += other.a12; a13 += other.a13;
+		a22 += other.a22; a23 += other.a23;
+		a33 += other.a33;
+		weight += other.weight;
+	}
+
+	// Mean squared distance of point to the planes weighted by their area, an average
+	// over the surface rather than the largest distance.
+	float Evaluate(const glm::vec3& point) const {
+		double x = point.x, y = point.y, z = point.z;
+		double sum = a00 * x * x + a11 * y * y + a22 * z * z +
+					 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+					 2.0 * (a03 * x + a13 * y + a23 * z) + a33;
+		return weight > 0.0 ? (float)std::max(sum / weight, 0.0) : 0.0f;
+	}
+};
+
+struct EdgeCollapse {
+	float cost;
+	uint32_t from;
+	uint32_t to;
+};
+
+static glm::vec3 TriangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+	// Clockwise winding, see ImportObj().
+	return glm::cross(c - a, b - a);
+}
+
+// Locks vertices sharing their position with another vertex, which are split by a
+// normal or texture seam, and vertices of edges not shared by exactly two triangles.
+static void FindLockedVertices(const uint32_t* indices, size_t indexCount, const MeshVertex* vertices,
+							   uint32_t vertexCount, std::vector<bool>& locked)
+{
+	locked.assign(vertexCount, false);
+
+	std::vector<uint32_t> used;
+	std::vector<bool> seen(vertexCount, false);
+	for (size_t i = 0; i < indexCount; i++) {
+		if (!seen[indices[i]]) {
+			seen[indices[i]] = true;
+			used.push_back(indices[i]);
+		}
+	}
+	auto positionLess = [vertices](uint32_t a, uint32_t b) {
+		const glm::vec3& pa = vertices[a].position;
+		const glm::vec3& pb = vertices[b].position;
+		if (pa.x != pb.x) return pa.x < pb.x;
+		if (pa.y != pb.y) return pa.y < pb.y;
+		return pa.z < pb.z;
+	};
+	std::sort(used.begin(), used.end(), positionLess);
+	for (size_t i = 1; i < used.size(); i++) {
+		if (vertices[used[i]].position == vertices[used[i - 1]].position) {
+			locked[used[i]] = true;
+			locked[used[i - 1]] = true;
+		}
+	}
+
+	// Both directions of an edge sort together, then the run length is its triangle count.
+	std::vector<std::pair<uint32_t, uint32_t>> edges;
+	edges.reserve(indexCount);
+	for (size_t i = 0; i < indexCount; i += 3) {
+		for (size_t corner = 0; corner < 3; corner++) {
+			uint32_t a = indices[i + corner];
+			uint32_t b = indices[i + (corner + 1) % 3];
+			edges.push_back({ std::min(a, b), std::max(a, b) });
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	for (size_t i = 0; i < edges.size();) {
+		size_t run = 1;
+		while (i + run < edges.size() && edges[i + run] == edges[i]) {
+			run++;
+		}
+		if (run != 2) {
+			locked[edges[i].first] = true;
+			locked[edges[i].second] = true;
+		}
+		i += run;
+	}
+}
+
+size_t SimplifyIndices(const uint32_t* indices, size_t indexCount,
+					   const MeshVertex* vertices, uint32_t vertexCount,
+					   size_t targetIndexCount, float maxError,
+					   uint32_t* destination, float* error)
+{
+	ZoneScoped;
+	std::vector<uint32_t> result(indices, indices + indexCount);
+	*error = 0.0f;
+
+	std::vector<bool> locked;
+	FindLockedVertices(indices, indexCount, vertices, vertexCount, locked);
+
+	std::vector<Quadric> quadrics(vertexCount, Quadric{});
+	for (size_t i = 0; i < indexCount; i += 3) {
+		const glm::vec3& a = vertices[indices[i + 0]].position;
+		const glm::vec3& b = vertices[indices[i + 1]].position;
+		const glm::vec3& c = vertices[indices[i + 2]].position;
+		glm::vec3 normal = TriangleNormal(a, b, c);
+		float length = glm::length(normal);
+		if (length == 0.0f) {
+			continue;
+		}
+		normal /= length;
+		for (size_t corner = 0; corner < 3; corner++) {
+			quadrics[indices[i + corner]].AddPlane(normal, -glm::dot(normal, a), length * 0.5f);
+		}
+	}
+
+	// Collapses are made in passes. Each pass sorts every candidate by cost and takes
+	// the cheapest ones that touch no triangle changed earlier in the pass, so the
+	// flip checks see the current triangles.
+	float maxCost = maxError * maxError;
+	std::vector<uint32_t> adjacencyOffsets;
+	std::vector<uint32_t> adjacency;
+	std::vector<EdgeCollapse> collapses;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	while (result.size() > targetIndexCount) {
+		adjacencyOffsets.assign(vertexCount + 1, 0);
+		for (uint32_t index : result) {
+			adjacencyOffsets[index + 1]++;
+		}
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+			adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+		}
+		adjacency.resize(result.size());
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < result.size(); i++) {
+			adjacency[fill[result[i]]++] = i / 3;
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (size_t corner = 0; corner < 3; corner++) {
+				uint32_t a = result[i + corner];
+				uint32_t b = result[i + (corner + 1) % 3];
+				Quadric quadric = quadrics[a];
+				quadric.Add(quadrics[b]);
+				if (!locked[a]) {
+					collapses.push_back({ quadric.Evaluate(vertices[b].position), a, b });
+				}
+				if (!locked[b]) {
+					collapses.push_back({ quadric.Evaluate(vertices[a].position), b, a });
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& a, const EdgeCollapse& b) {
+			return a.cost < b.cost;
+		});
+
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+			remap[vertex] = vertex;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+		size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+		size_t trianglesRemoved = 0;
+		for (const EdgeCollapse& collapse : collapses) {
+			if (collapse.cost > maxCost || trianglesRemoved >= trianglesToRemove) {
+				break;
+			}
+			uint32_t from = collapse.from;
+			uint32_t to = collapse.to;
+			if (touched[from] || touched[to]) {
+				continue;
+			}
+
+			bool valid = true;
+			uint32_t removed = 0;
+			for (uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1] && valid; j++) {
+				const uint32_t* triangle = result.data() + adjacency[j] * 3;
+				glm::vec3 corners[3];
+				glm::vec3 moved[3];
+				bool degenerate = false;
+				for (size_t corner = 0; corner < 3; corner++) {
+					valid = valid && !touched[triangle[corner]];
+					degenerate = degenerate || triangle[corner] == to;
+					corners[corner] = vertices[triangle[corner]].position;
+					moved[corner] = vertices[triangle[corner] == from ? to : triangle[corner]].position;
+				}
+				if (degenerate) {
+					removed++;
+					continue;
+				}
+				glm::vec3 before = TriangleNormal(corners[0], corners[1], corners[2]);
+				glm::vec3 after = TriangleNormal(moved[0], moved[1], moved[2]);
+				float lengths = glm::length(before) * glm::length(after);
+				valid = valid && glm::dot(before, after) > SIMPLIFY_MIN_NORMAL_COSINE * lengths;
+			}
+			if (!valid) {
+				continue;
+			}
+
+			remap[from] = to;
+			quadrics[to].Add(quadrics[from]);
+			for (uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1]; j++) {
+				const uint32_t* triangle = result.data() + adjacency[j] * 3;
+				touched[triangle[0]] = true;
+				touched[triangle[1]] = true;
+				touched[triangle[2]] = true;
+			}
+			trianglesRemoved += removed;
+			*error = std::max(*error, collapse.cost);
+		}
+		if (trianglesRemoved == 0) {
+			break;
+		}
+
+		size_t written = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			uint32_t a = remap[result[i + 0]];
+			uint32_t b = remap[result[i + 1]];
+			uint32_t c = remap[result[i + 2]];
+			if (a != b && b != c && a != c) {
+				result[written++] = a;
+				result[written++] = b;
+				result[written++] = c;
+			}
+		}
+		result.resize(written);
+	}
+
+	*error = sqrtf(*error);
+	memcpy(destination, result.data(), result.size() * sizeof(uint32_t));
+	return result.size();
+}
+
+void GenerateLods(Mesh* mesh, const MeshLodSpec& spec) {
+	ZoneScoped;
+	std::vector<uint32_t> meshIndices = mesh->GetIndices();
+	uint32_t vertexCount = mesh->vertices.size();
+
+	// Level 0 of every submesh goes first, so vertex fetch optimization orders the
+	// vertices for it, and the levels follow one after another.
+	std::vector<uint32_t> indices;
+	for (Submesh& submesh : mesh->submeshes) {
+		uint32_t firstIndex = indices.size();
+		indices.insert(indices.end(), meshIndices.begin() + submesh.firstIndex,
+					   meshIndices.begin() + submesh.firstIndex + submesh.indexCount);
+		submesh.firstIndex = firstIndex;
+		memset(submesh.lods, 0, sizeof(submesh.lods));
+	}
+	mesh->lodCount = 1;
+	memset(mesh->lodErrors, 0, sizeof(mesh->lodErrors));
+
+	// Each level is simplified from the one before it, which is far cheaper than
+	// starting over from level 0. The errors add up, so the sum estimates a level's
+	// distance from level 0.
+	float maxError = spec.maxError * glm::length(mesh->bounds.max - mesh->bounds.min);
+	uint32_t maxLods = std::min(spec.maxLods, (uint32_t)CEE_MESH_MAX_LODS);
+	size_t previousIndexCount = indices.size();
+	std::vector<uint32_t> simplified;
+	for (uint32_t lod = 1; lod < maxLods; lod++) {
+		std::vector<uint32_t> level;
+		std::vector<IndexRange> ranges;
+		float stepError = 0.0f;
+		for (const Submesh& submesh : mesh->submeshes) {
+			IndexRange source = submesh.GetLod(lod - 1);
+			size_t target = (size_t)(source.indexCount / 3 * spec.reduction) * 3;
+			simplified.resize(source.indexCount);
+			float error;
+			size_t count = SimplifyIndices(indices.data() + source.firstIndex, source.indexCount,
+										   mesh->vertices.data(), vertexCount, target,
+										   maxError - mesh->lodErrors[lod - 1], simplified.data(), &error);
+			ranges.push_back({ (uint32_t)(indices.size() + level.size()), (uint32_t)count });
+			level.insert(level.end(), simplified.begin(), simplified.begin() + count);
+			stepError = std::max(stepError, error);
+		}
+		if (level.size() > previousIndexCount * (1.0f - LOD_MIN_REDUCTION)) {
+			break;
+		}
+
+		indices.insert(indices.end(), level.begin(), level.end());
+		for (size_t i = 0; i < mesh->submeshes.size(); i++) {
+			mesh->submeshes[i].lods[lod - 1] = ranges[i];
+		}
+		mesh->lodErrors[lod] = mesh->lodErrors[lod - 1] + stepError;
+		mesh->lodCount = lod + 1;
+		previousIndexCount = level.size();
+	}
+
+	mesh->SetIndices(indices);
+}
+}
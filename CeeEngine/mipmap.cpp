@@ -0,0 +1,122 @@
+#include <CeeEngine/mipmap.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cee {
+// Linear values are 24 bit fixed point, the sum over a 2x2 footprint fits in 26 bits.
+#define CEE_SRGB_LINEAR_ONE (1u << 24)
+// Sums are bucketed by their top 12 bits for encoding. Neighbouring encode thresholds
+// are over 20000 apart, so a bucket of 16384 contains at most one.
+#define CEE_SRGB_ENCODE_SHIFT 14
+#define CEE_SRGB_ENCODE_BUCKETS ((4 * CEE_SRGB_LINEAR_ONE >> CEE_SRGB_ENCODE_SHIFT) + 1)
+
+// Decoded value of every sRGB byte, and the footprint sums halfway between two
+// encodings. A sum is encoded by looking up its bucket and stepping past the one
+// threshold the bucket may contain.
+struct SrgbTables {
+	uint32_t decode[256];
+	uint8_t encode[CEE_SRGB_ENCODE_BUCKETS];
+	uint32_t encodeThresholds[256];
+};
+
+static float SrgbToLinear(float value) {
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static const SrgbTables& GetSrgbTables() {
+	static const SrgbTables tables = []() {
+		SrgbTables result;
+		for (uint32_t i = 0; i < 256; i++) {
+			result.decode[i] = (uint32_t)std::lround(SrgbToLinear(i / 255.0f) * CEE_SRGB_LINEAR_ONE);
+		}
+		for (uint32_t i = 0; i < 255; i++) {
+			result.encodeThresholds[i] = (uint32_t)std::lround(SrgbToLinear((i + 0.5f) / 255.0f) *
+															   (4 * CEE_SRGB_LINEAR_ONE));
+		}
+		result.encodeThresholds[255] = UINT32_MAX;
+		uint32_t encoded = 0;
+		for (uint32_t bucket = 0; bucket < CEE_SRGB_ENCODE_BUCKETS; bucket++) {
+			while (result.encodeThresholds[encoded] <= bucket << CEE_SRGB_ENCODE_SHIFT) {
+				encoded++;
+			}
+			result.encode[bucket] = encoded;
+		}
+		return result;
+	}();
+	return tables;
+}
+
+static uint8_t EncodeSrgb(const SrgbTables& tables, uint32_t sum) {
+	uint32_t encoded = tables.encode[sum >> CEE_SRGB_ENCODE_SHIFT];
+	return encoded + (sum >= tables.encodeThresholds[encoded]);
+}
+
+uint32_t CalculateMipLevels(uint32_t width, uint32_t height) {
+	uint32_t largest = std::max(width, height);
+	uint32_t levels = 1;
+	while (largest > 1) {
+		largest >>= 1;
+		levels++;
+	}
+	return levels;
+}
+
+size_t CalculateMipLevelOffset(uint32_t width, uint32_t height, uint32_t level, uint32_t layers) {
+	size_t offset = 0;
+	for (uint32_t i = 0; i < level; i++) {
+		offset += (size_t)std::max(width >> i, 1u) * std::max(height >> i, 1u) * 4 * layers;
+	}
+	return offset;
+}
+
+size_t CalculateMipChainSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers) {
+	return CalculateMipLevelOffset(width, height, mipLevels, layers);
+}
+
+void DownsampleSRGBA8(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst) {
+	const SrgbTables& tables = GetSrgbTables();
+	uint32_t dstWidth = std::max(srcWidth >> 1, 1u);
+	uint32_t dstHeight = std::max(srcHeight >> 1, 1u);
+	size_t srcStride = (size_t)srcWidth * 4;
+
+	for (uint32_t y = 0; y < dstHeight; y++) {
+		const uint8_t* row0 = src + std::min(y * 2, srcHeight - 1) * srcStride;
+		const uint8_t* row1 = src + std::min(y * 2 + 1, srcHeight - 1) * srcStride;
+		uint8_t* out = dst + (size_t)y * dstWidth * 4;
+
+		for (uint32_t x = 0; x < dstWidth; x++) {
+			const uint8_t* texels[4] = {
+				row0 + std::min(x * 2, srcWidth - 1) * 4, row0 + std::min(x * 2 + 1, srcWidth - 1) * 4,
+				row1 + std::min(x * 2, srcWidth - 1) * 4, row1 + std::min(x * 2 + 1, srcWidth - 1) * 4
+			};
+			// Footprint sums of the decoded color channels and the raw alpha.
+			alignas(16) uint32_t sums[4];
+#if defined(__SSE2__)
+			// SSE2 has no gather, the table lookups fill the lanes one by one.
+			__m128i sum = _mm_setzero_si128();
+			for (const uint8_t* texel : texels) {
+				sum = _mm_add_epi32(sum, _mm_setr_epi32(tables.decode[texel[0]], tables.decode[texel[1]],
+														tables.decode[texel[2]], texel[3]));
+			}
+			_mm_store_si128((__m128i*)sums, sum);
+#else
+			for (uint32_t c = 0; c < 4; c++) {
+				sums[c] = 0;
+				for (const uint8_t* texel : texels) {
+					sums[c] += c < 3 ? tables.decode[texel[c]] : texel[c];
+				}
+			}
+#endif
+			out[x * 4 + 0] = EncodeSrgb(tables, sums[0]);
+			out[x * 4 + 1] = EncodeSrgb(tables, sums[1]);
+			out[x * 4 + 2] = EncodeSrgb(tables, sums[2]);
+			out[x * 4 + 3] = (uint8_t)((sums[3] + 2) >> 2);
+		}
+	}
+}
+}
@@ -2,6 +2,7 @@
 #include <CeeEngine/renderer.h>
 #include <CeeEngine/debugMessenger.h>
 #include <CeeEngine/assert.h>
+#include <CeeEngine/mipmap.h>
 
 #include <csignal>
 #include <cstdint>
@@ -22,26 +23,123 @@
 #include <Tracy.hpp>
 #include <vulkan/vulkan_core.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define RENDERER_MAX_FRAME_IN_FLIGHT 5u
 
-#define RENDERER_MAX_INDICES 20000u
+#define RENDERER_MAX_INDICES (1u << 20)
 #define RENDERER_MIN_INDICES 500u
 
-#define BIT(x) (1 << x)
-enum PipelineFlagsBits
-{
-	RENDERER_PIPELINE_FLAG_3D = BIT(0),
-	RENDERER_PIPELINE_FLAG_QUAD = BIT(1),
-	RENDERER_PIPELINE_BASIC = BIT(2),
-	RENDERER_PIPELINE_FILL = BIT(3),
-	RENDERER_PIPELINE_RESERVED1 = BIT(4),
-	RENDERER_PIPELINE_RESERVED2 = BIT(5),
-	RENDERER_PIPELINE_RESERVED3 = BIT(6),
-	RENDERER_PIPELINE_RESERVED4 = BIT(7),
-};
-typedef uint32_t PipelineFlags;
+// Per frame in flight, each Dispatch() and depth pyramid level takes one set of up to
+// the buffer limit and one image.
+#define RENDERER_MAX_DISPATCHES 64u
+#define RENDERER_MAX_DISPATCH_BUFFERS 8u
+// Invocations per axis of rendererDepthPyramidCompute's groups.
+#define RENDERER_DEPTH_PYRAMID_GROUP_SIZE 8u
 
 namespace cee {
+// Every shader of the 2D and 3D pipelines, they share m_PipelineLayout.
+static const std::array<const char*, 4> s_MainShaderNames = {
+	"renderer2DQuadVertex",
+	"renderer2DQuadFragment",
+	"renderer3DBasicVertex",
+	"renderer3DBasicFragment"
+};
+// Vertex2DPacked and Vertex3DPacked. The 2D quad shader reads them unchanged, missing
+// position components default to w = 1. The 3D variant decodes the octahedral normal.
+static const std::vector<VkFormat> s_Packed2DVertexFormats = {
+	VK_FORMAT_R32G32B32_SFLOAT,
+	VK_FORMAT_R8G8B8A8_UNORM,
+	VK_FORMAT_R16G16_UNORM,
+	VK_FORMAT_R32_UINT
+};
+static const std::vector<VkFormat> s_Packed3DVertexFormats = {
+	VK_FORMAT_R32G32B32_SFLOAT,
+	VK_FORMAT_R16G16_SNORM,
+	VK_FORMAT_R8G8B8A8_UNORM,
+	VK_FORMAT_R16G16_SFLOAT,
+	VK_FORMAT_R32_UINT
+};
+static const std::array<const char*, 2> s_SkyboxShaderNames = {
+	"renderer3DSkyboxVertex",
+	"renderer3DSkyboxFragment"
+};
+
+// Enough descriptors for setCount copies of every set declared by the bindings.
+static void AddDescriptorPoolSizes(std::vector<VkDescriptorPoolSize>& poolSizes,
+								   const std::vector<ShaderResourceBinding>& bindings,
+								   uint32_t runtimeArraySize, uint32_t setCount)
+{
+	for (auto& binding : bindings) {
+		uint32_t count = binding.count == CEE_RUNTIME_DESCRIPTOR_COUNT ? runtimeArraySize : binding.count;
+		auto poolSize = std::find_if(poolSizes.begin(), poolSizes.end(), [&](const VkDescriptorPoolSize& size) {
+			return size.type == binding.type;
+		});
+		if (poolSize == poolSizes.end()) {
+			poolSizes.push_back({ binding.type, count * setCount });
+		} else {
+			poolSize->descriptorCount += count * setCount;
+		}
+	}
+}
+
+// Also names the dispatch's GPU zone, e.g. "renderer3DCullCompute OCCLUSION_CULLING=1".
+static std::string ComputePipelineKey(const std::string& shader, const ShaderDefines& defines) {
+	std::string key = shader;
+	for (auto& define : defines) {
+		key += " " + define.first + "=" + define.second;
+	}
+	return key;
+}
+
+static uint32_t PreviousPowerOfTwo(uint32_t value) {
+	uint32_t power = 1;
+	while (power * 2 <= value) {
+		power *= 2;
+	}
+	return power;
+}
+
+static bool HasRuntimeArray(const std::vector<ShaderResourceBinding>& bindings) {
+	return std::any_of(bindings.begin(), bindings.end(), [](const ShaderResourceBinding& binding) {
+		return binding.count == CEE_RUNTIME_DESCRIPTOR_COUNT;
+	});
+}
+
+// True if a pipeline using these shaders can be created with the given layout, i.e.
+// every resource the shaders declare is present with the same type in the layout.
+static bool IsLayoutCompatible(const ShaderReflection& layout, const ShaderReflection& shaders) {
+	for (auto& binding : shaders.bindings) {
+		auto layoutBinding = std::find_if(layout.bindings.begin(), layout.bindings.end(),
+										  [&](const ShaderResourceBinding& other) {
+			return other.set == binding.set && other.binding == binding.binding;
+		});
+		if (layoutBinding == layout.bindings.end() || layoutBinding->type != binding.type ||
+			(binding.stages & ~layoutBinding->stages) != 0)
+		{
+			return false;
+		}
+		if (layoutBinding->count != CEE_RUNTIME_DESCRIPTOR_COUNT &&
+			(binding.count == CEE_RUNTIME_DESCRIPTOR_COUNT || binding.count > layoutBinding->count))
+		{
+			return false;
+		}
+	}
+	for (auto& range : shaders.pushConstants) {
+		bool covered = std::any_of(layout.pushConstants.begin(), layout.pushConstants.end(),
+								   [&](const VkPushConstantRange& other) {
+			return (range.stageFlags & ~other.stageFlags) == 0 && range.offset >= other.offset &&
+				   range.offset + range.size <= other.offset + other.size;
+		});
+		if (!covered) {
+			return false;
+		}
+	}
+	return true;
+}
+
 VkFormat CeeFormatToVkFormat(::cee::ImageFormat foramt) {
 	switch (foramt) {
 		case IMAGE_FORMAT_R8_SRGB:
@@ -281,9 +379,51 @@ UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) {
 	return *this;
 }
 
+StorageBuffer::StorageBuffer()
+: m_Initialized(false), m_Device(VK_NULL_HANDLE), m_Size(0),
+  m_Buffer(VK_NULL_HANDLE), m_DeviceMemory(VK_NULL_HANDLE)
+{
+}
+
+StorageBuffer::StorageBuffer(StorageBuffer&& other)
+: StorageBuffer()
+{
+	*this = std::move(other);
+}
+
+StorageBuffer::~StorageBuffer() {
+	if (m_Initialized) {
+		vkDeviceWaitIdle(m_Device);
+		vkDestroyBuffer(m_Device, m_Buffer, NULL);
+		vkFreeMemory(m_Device, m_DeviceMemory, NULL);
+	}
+}
+
+StorageBuffer& StorageBuffer::operator=(StorageBuffer&& other) {
+	if (this->m_Initialized) {
+		this->~StorageBuffer();
+	}
+
+	this->m_Device = other.m_Device;
+	this->m_Size = other.m_Size;
+	this->m_Buffer = other.m_Buffer;
+	this->m_DeviceMemory = other.m_DeviceMemory;
+
+	this->m_Initialized = other.m_Initialized;
+	other.m_Initialized = false;
+
+	other.m_Device = VK_NULL_HANDLE;
+	other.m_Buffer = VK_NULL_HANDLE;
+	other.m_DeviceMemory = VK_NULL_HANDLE;
+	other.m_Size = 0;
+
+	return *this;
+}
+
 ImageBuffer::ImageBuffer()
 : m_Initialized(false), m_Device(VK_NULL_HANDLE), m_CommandPool(VK_NULL_HANDLE),
-  m_TransferQueue(VK_NULL_HANDLE), m_Size(0), m_Image(VK_NULL_HANDLE),
+  m_TransferQueue(VK_NULL_HANDLE), m_Size(0), m_Format(VK_FORMAT_UNDEFINED), m_Extent({ 0u, 0u, 0u }),
+  m_MipLevels(1), m_HostMipmaps(false), m_Image(VK_NULL_HANDLE),
   m_ImageView(VK_NULL_HANDLE), m_DeviceMemory(VK_NULL_HANDLE), m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
 {
 }
@@ -312,6 +452,10 @@ ImageBuffer& ImageBuffer::operator=(ImageBuffer&& other) {
 	this->m_CommandPool = other.m_CommandPool;
 	this->m_TransferQueue = other.m_TransferQueue;
 	this->m_Size = other.m_Size;
+	this->m_Format = other.m_Format;
+	this->m_Extent = other.m_Extent;
+	this->m_MipLevels = other.m_MipLevels;
+	this->m_HostMipmaps = other.m_HostMipmaps;
 	this->m_Image = other.m_Image;
 	this->m_ImageView = other.m_ImageView;
 	this->m_DeviceMemory = other.m_DeviceMemory;
@@ -328,6 +472,10 @@ ImageBuffer& ImageBuffer::operator=(ImageBuffer&& other) {
 	other.m_DeviceMemory = VK_NULL_HANDLE;
 	other.m_Layout = VK_IMAGE_LAYOUT_UNDEFINED;
 	other.m_Size = 0;
+	other.m_Format = VK_FORMAT_UNDEFINED;
+	other.m_Extent = { 0u, 0u, 0u };
+	other.m_MipLevels = 1;
+	other.m_HostMipmaps = false;
 
 	return *this;
 }
@@ -342,7 +490,7 @@ void ImageBuffer::Clear(glm::vec4 clearColor) {
 		VkImageSubresourceRange range = {
 			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 			.baseMipLevel = 0,
-			.levelCount = 1,
+			.levelCount = m_MipLevels,
 			.baseArrayLayer = 0,
 			.layerCount = 1
 		};
@@ -367,7 +515,7 @@ void ImageBuffer::TransitionLayout(RawCommandBuffer& commandBuffer, VkImageLayou
 	imageMemoryBarrier.subresourceRange = {
 		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 		.baseMipLevel = 0,
-		.levelCount = 1,
+		.levelCount = m_MipLevels,
 		.baseArrayLayer = 0,
 		.layerCount = 1
 	};
@@ -415,14 +563,16 @@ void ImageBuffer::TransitionLayout(RawCommandBuffer& commandBuffer, VkImageLayou
 }
 
 CubeMapBuffer::CubeMapBuffer()
-: m_Initialized(false), m_Size(0u), m_Extent({ 0u, 0u, 0u }), m_Image(VK_NULL_HANDLE),
-  m_DeviceMemory(VK_NULL_HANDLE), m_ImageView(VK_NULL_HANDLE), m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
+: m_Initialized(false), m_Size(0u), m_Extent({ 0u, 0u, 0u }), m_MipLevels(1), m_HostMipmaps(false),
+  m_Image(VK_NULL_HANDLE), m_DeviceMemory(VK_NULL_HANDLE), m_ImageView(VK_NULL_HANDLE),
+  m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
 {
 }
 
 CubeMapBuffer::CubeMapBuffer(uint32_t width, uint32_t height)
-: m_Initialized(false), m_Size(0u), m_Extent({ width, height, 1u }), m_Image(VK_NULL_HANDLE),
-  m_DeviceMemory(VK_NULL_HANDLE), m_ImageView(VK_NULL_HANDLE), m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
+: m_Initialized(false), m_Size(0u), m_Extent({ width, height, 1u }), m_MipLevels(1), m_HostMipmaps(false),
+  m_Image(VK_NULL_HANDLE), m_DeviceMemory(VK_NULL_HANDLE), m_ImageView(VK_NULL_HANDLE),
+  m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
 {
 	Renderer::Get()->CreateImageObjects(&m_Image, &m_DeviceMemory, &m_ImageView,
 										VK_FORMAT_R8G8B8A8_SRGB,
@@ -434,34 +584,44 @@ CubeMapBuffer::CubeMapBuffer(uint32_t width, uint32_t height)
 	m_Initialized = true;
 }
 
-CubeMapBuffer::CubeMapBuffer(std::vector<std::shared_ptr<Image>> images)
-: m_Initialized(false), m_Size(0u), m_Extent({ 0u, 0u, 1u }), m_Image(VK_NULL_HANDLE),
-  m_DeviceMemory(VK_NULL_HANDLE), m_ImageView(VK_NULL_HANDLE), m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
+CubeMapBuffer::CubeMapBuffer(std::vector<std::shared_ptr<Image>> images, bool generateMipmaps)
+: m_Initialized(false), m_Size(0u), m_Extent({ 0u, 0u, 1u }), m_MipLevels(1), m_HostMipmaps(false),
+  m_Image(VK_NULL_HANDLE), m_DeviceMemory(VK_NULL_HANDLE), m_ImageView(VK_NULL_HANDLE),
+  m_Layout(VK_IMAGE_LAYOUT_UNDEFINED)
 {
 	if (images[0]->width != images[0]->height || images[0]->width == 0) {
-		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Image must be square and non-zero size. size: %ix%i");
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Image must be square and non-zero size. size: %ix%i",
+										 images[0]->width, images[0]->height);
 	}
 	m_Extent.height = m_Extent.width = images[0]->width;
+	if (generateMipmaps) {
+		m_MipLevels = CalculateMipLevels(m_Extent.width, m_Extent.height);
+		m_HostMipmaps = !Renderer::Get()->SupportsBlitMipmaps(VK_FORMAT_R8G8B8A8_SRGB);
+	}
 	Renderer::Get()->CreateImageObjects(&m_Image, &m_DeviceMemory, &m_ImageView,
 										VK_FORMAT_R8G8B8A8_SRGB,
+										VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
 										VK_IMAGE_USAGE_TRANSFER_DST_BIT |
 										VK_IMAGE_USAGE_SAMPLED_BIT,
 										&m_Extent.width, &m_Extent.height, &m_Size,
-										1, 6);
+										m_MipLevels, 6);
 	m_Initialized = true;
 
-	size_t singleImageSize = m_Extent.width * m_Extent.height * 4;
-	StagingBuffer sb = Renderer::Get()->CreateStagingBuffer(m_Size);
+	size_t stagingSize = m_HostMipmaps ? CalculateMipChainSize(m_Extent.width, m_Extent.height, m_MipLevels, 6)
+									   : CalculateMipChainSize(m_Extent.width, m_Extent.height, 1, 6);
+	StagingBuffer sb = Renderer::Get()->CreateStagingBuffer(stagingSize);
 	for (uint32_t i = 0; i < 6; i++) {
 		CEE_ASSERT(images[i]->width == static_cast<int>(m_Extent.width) &&
 				   images[i]->height == static_cast<int>(m_Extent.height),
 				   "Image sizes do not match");
-		sb.SetData(singleImageSize, i * singleImageSize, images[i]->pixels);
+		sb.SetImageData(*this, 0, i, images[i]->pixels);
 	}
 	sb.TransferData(*this, 0);
 }
 
-CubeMapBuffer::CubeMapBuffer(CubeMapBuffer&& other) {
+CubeMapBuffer::CubeMapBuffer(CubeMapBuffer&& other)
+: CubeMapBuffer()
+{
 	*this = std::move(other);
 }
 
@@ -483,6 +643,8 @@ CubeMapBuffer& CubeMapBuffer::operator=(CubeMapBuffer&& other) {
 
 	this->m_Size = other.m_Size;
 	this->m_Extent = other.m_Extent;
+	this->m_MipLevels = other.m_MipLevels;
+	this->m_HostMipmaps = other.m_HostMipmaps;
 	this->m_Image = other.m_Image;
 	this->m_DeviceMemory = other.m_DeviceMemory;
 	this->m_ImageView = other.m_ImageView;
@@ -490,6 +652,8 @@ CubeMapBuffer& CubeMapBuffer::operator=(CubeMapBuffer&& other) {
 
 	other.m_Size = 0;
 	other.m_Extent = { 0u, 0u, 0u };
+	other.m_MipLevels = 1;
+	other.m_HostMipmaps = false;
 	other.m_Image = VK_NULL_HANDLE;
 	other.m_DeviceMemory = VK_NULL_HANDLE;
 	other.m_ImageView = VK_NULL_HANDLE;
@@ -509,7 +673,7 @@ void CubeMapBuffer::Clear(glm::vec4 clearColor) {
 		VkImageSubresourceRange range = {
 			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 			.baseMipLevel = 0,
-			.levelCount = 1,
+			.levelCount = m_MipLevels,
 			.baseArrayLayer = 0,
 			.layerCount = 6
 		};
@@ -535,7 +699,7 @@ void CubeMapBuffer::TransitionLayout(RawCommandBuffer& cmdBuffer, VkImageLayout
 	imageMemoryBarrier.subresourceRange = {
 		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 		.baseMipLevel = 0,
-		.levelCount = 1,
+		.levelCount = m_MipLevels,
 		.baseArrayLayer = 0,
 		.layerCount = 6
 	};
@@ -655,6 +819,82 @@ int StagingBuffer::SetData(size_t size, size_t offset, const void* data) {
 	return 0;
 }
 
+void* StagingBuffer::ReserveBytes(size_t offset, size_t size) {
+	if (!m_Initialized) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Trying to reserve memory of an uninitialized buffer.");
+		return NULL;
+	}
+	if (size + offset > m_Size) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Overflow! Trying to reserve more memory than buffer has capacity for.");
+		return NULL;
+	}
+	return static_cast<uint8_t*>(m_MappedMemoryAddress) + offset;
+}
+
+void StagingBuffer::Commit() {
+#if defined(__SSE2__)
+	_mm_sfence();
+#else
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+int StagingBuffer::SetImageData(const ImageBuffer& imageBuffer, size_t offset, const void* pixels) {
+	VkExtent3D extent = imageBuffer.m_Extent;
+	if (SetData((size_t)extent.width * extent.height * 4, offset, pixels) != 0) {
+		return -1;
+	}
+	if (imageBuffer.m_MipLevels == 1 || !imageBuffer.m_HostMipmaps) {
+		return 0;
+	}
+
+	return WriteHostMipChain(offset, extent, imageBuffer.m_MipLevels, 1, 0, pixels);
+}
+
+int StagingBuffer::SetImageData(const CubeMapBuffer& imageBuffer, size_t offset, uint32_t face, const void* pixels) {
+	VkExtent3D extent = imageBuffer.m_Extent;
+	size_t faceSize = (size_t)extent.width * extent.height * 4;
+	if (SetData(faceSize, offset + face * faceSize, pixels) != 0) {
+		return -1;
+	}
+	if (imageBuffer.m_MipLevels == 1 || !imageBuffer.m_HostMipmaps) {
+		return 0;
+	}
+
+	return WriteHostMipChain(offset, extent, imageBuffer.m_MipLevels, 6, face, pixels);
+}
+
+int StagingBuffer::WriteHostMipChain(size_t offset, VkExtent3D extent, uint32_t mipLevels,
+									 uint32_t layers, uint32_t layer, const void* pixels)
+{
+	ZoneScoped;
+	// Filter in cached host memory, reading back from the mapped buffer would be slow.
+	size_t levelZeroSize = (size_t)extent.width * extent.height * 4;
+	std::vector<uint8_t> levels(CalculateMipChainSize(extent.width, extent.height, mipLevels, 1) - levelZeroSize);
+
+	const uint8_t* src = static_cast<const uint8_t*>(pixels);
+	uint8_t* dst = levels.data();
+	uint32_t width = extent.width;
+	uint32_t height = extent.height;
+	for (uint32_t level = 1; level < mipLevels; level++) {
+		DownsampleSRGBA8(src, width, height, dst);
+		width = std::max(width >> 1, 1u);
+		height = std::max(height >> 1, 1u);
+
+		size_t levelSize = (size_t)width * height * 4;
+		size_t levelOffset = offset + CalculateMipLevelOffset(extent.width, extent.height, level, layers);
+		if (SetData(levelSize, levelOffset + layer * levelSize, dst) != 0) {
+			return -1;
+		}
+		src = dst;
+		dst += levelSize;
+	}
+
+	return 0;
+}
+
 int StagingBuffer::BoundsCheck(size_t size, size_t srcSize, size_t dstSize, size_t srcOffset, size_t dstOffset) {
 	if (size + srcOffset > srcSize) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
@@ -676,6 +916,7 @@ int StagingBuffer::TransferDataInternal(VkBuffer src,
 	Renderer::Get()->QueueSubmit([src, dst, copyRegion](RawCommandBuffer& cmdBuffer){
 		vkCmdCopyBuffer(cmdBuffer.commandBuffer, src, dst, 1, &copyRegion);
 	}, QUEUE_TRANSFER);
+	Renderer::Get()->m_Statistics.uploadedBytes += copyRegion.size;
 
 	return 0;
 }
@@ -687,6 +928,7 @@ int StagingBuffer::TransferDataInternalImmediate(VkBuffer src,
 	Renderer::Get()->ImmediateSubmit([src, dst, copyRegion](RawCommandBuffer& cmdBuffer) {
 		vkCmdCopyBuffer(cmdBuffer.commandBuffer, src, dst, 1, &copyRegion);
 	}, QUEUE_TRANSFER);
+	Renderer::Get()->m_Statistics.uploadedBytes += copyRegion.size;
 
 	return 0;
 }
@@ -739,42 +981,79 @@ int StagingBuffer::TransferData(UniformBuffer& uniformBuffer, size_t srcOffset,
 								{ srcOffset, dstOffset, size });
 }
 
-int StagingBuffer::TransferData(ImageBuffer& imageBuffer, size_t srcOffset, size_t dstOffset, uint32_t width, uint32_t height) {
-	if (!m_Initialized || !imageBuffer.m_Initialized) {
+int StagingBuffer::TransferData(StorageBuffer& storageBuffer, size_t srcOffset, size_t dstOffset, size_t size) {
+	if (!m_Initialized || !storageBuffer.m_Initialized) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
 										 "Trying to copy data using an uninitialized buffer.");
 		return -1;
 	}
-	if (BoundsCheck(width * height * 4, m_Size, imageBuffer.m_Size, srcOffset, dstOffset) != 0) {
+	if (BoundsCheck(size, m_Size, storageBuffer.m_Size, srcOffset, dstOffset) != 0) {
 		return -1;
 	}
 
-	VkResult result;
-
-	VkBuffer src = this->m_Buffer;
-	VkImage dst = imageBuffer.m_Image;
-	result = Renderer::Get()->QueueSubmit([src, dst, width, height, &imageBuffer](RawCommandBuffer& cmdBuffer) {
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	return TransferDataInternal(m_Buffer,
+								storageBuffer.m_Buffer,
+								{ srcOffset, dstOffset, size });
+}
 
-		VkBufferImageCopy imageCopy;
-		imageCopy.bufferOffset = 0;
+template<typename T>
+void StagingBuffer::RecordImageUpload(RawCommandBuffer& cmdBuffer, size_t srcOffset, T& imageBuffer,
+									  VkExtent3D extent, uint32_t layers)
+{
+	imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	// Host filtered chains are already in the buffer, otherwise only level 0 is copied.
+	uint32_t copyLevels = imageBuffer.m_HostMipmaps ? imageBuffer.m_MipLevels : 1;
+	std::vector<VkBufferImageCopy> imageCopies(copyLevels);
+	for (uint32_t level = 0; level < copyLevels; level++) {
+		VkBufferImageCopy& imageCopy = imageCopies[level];
+		imageCopy.bufferOffset = srcOffset + CalculateMipLevelOffset(extent.width, extent.height, level, layers);
 		imageCopy.bufferImageHeight = 0;
 		imageCopy.bufferRowLength = 0;
-		imageCopy.imageExtent = { width, height, 1 };
+		imageCopy.imageExtent = { std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1 };
 		imageCopy.imageOffset = { 0, 0, 0 };
 		imageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		imageCopy.imageSubresource.baseArrayLayer = 0;
-		imageCopy.imageSubresource.mipLevel = 0;
-		imageCopy.imageSubresource.layerCount = 1;
+		imageCopy.imageSubresource.mipLevel = level;
+		imageCopy.imageSubresource.layerCount = layers;
+	}
 
-		vkCmdCopyBufferToImage(cmdBuffer.commandBuffer,
-							src,
-							dst,
-							VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-							1,
-							&imageCopy);
+	vkCmdCopyBufferToImage(cmdBuffer.commandBuffer,
+						   m_Buffer,
+						   imageBuffer.m_Image,
+						   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						   imageCopies.size(),
+						   imageCopies.data());
+	for (const auto& imageCopy : imageCopies) {
+		Renderer::Get()->m_Statistics.uploadedBytes +=
+			(uint64_t)imageCopy.imageExtent.width * imageCopy.imageExtent.height * 4 * layers;
+	}
 
+	if (imageBuffer.m_MipLevels > 1 && !imageBuffer.m_HostMipmaps) {
+		Renderer::Get()->RecordMipmapBlits(cmdBuffer.commandBuffer, imageBuffer.m_Image, extent,
+										   imageBuffer.m_MipLevels, layers);
+		imageBuffer.m_Layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	} else {
 		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+}
+
+int StagingBuffer::TransferData(ImageBuffer& imageBuffer, size_t srcOffset, size_t dstOffset, uint32_t width, uint32_t height) {
+	if (!m_Initialized || !imageBuffer.m_Initialized) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Trying to copy data using an uninitialized buffer.");
+		return -1;
+	}
+	uint32_t copyLevels = imageBuffer.m_HostMipmaps ? imageBuffer.m_MipLevels : 1;
+	if (BoundsCheck(CalculateMipChainSize(width, height, copyLevels, 1), m_Size, imageBuffer.m_Size, srcOffset, dstOffset) != 0) {
+		return -1;
+	}
+
+	VkResult result;
+
+	VkExtent3D extent = { width, height, 1 };
+	result = Renderer::Get()->QueueSubmit([this, srcOffset, extent, &imageBuffer](RawCommandBuffer& cmdBuffer) {
+		this->RecordImageUpload(cmdBuffer, srcOffset, imageBuffer, extent, 1);
 	}, QUEUE_GRAPHICS); // TODO: Deal with layout transitions VUID-vkCmdPipelineBarrier-dstStageMask-06462 and switch back to QUEUE_TRANSFER
 
 
@@ -786,32 +1065,13 @@ int StagingBuffer::TransferData(CubeMapBuffer& imageBuffer, size_t srcOffset) {
 										 "Trying to copy data using an uninitialized buffer.");
 		return -1;
 	}
+	uint32_t copyLevels = imageBuffer.m_HostMipmaps ? imageBuffer.m_MipLevels : 1;
+	if (BoundsCheck(CalculateMipChainSize(imageBuffer.m_Extent.width, imageBuffer.m_Extent.height, copyLevels, 6),
+					m_Size, imageBuffer.m_Size, srcOffset, 0) != 0) {
+		return -1;
+	}
 	VkResult result = Renderer::Get()->ImmediateSubmit([this, &imageBuffer, srcOffset](RawCommandBuffer& cmdBuffer){
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-		std::array<VkBufferImageCopy, 6> imageCopyRanges;
-		for (uint32_t i = 0; i < 6; i++) {
-			VkImageSubresourceLayers subresourceLayers = {
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.mipLevel = 0,
-				.baseArrayLayer = i,
-				.layerCount = 1
-			};
-			VkBufferImageCopy range = {
-				.bufferOffset = (imageBuffer.m_Extent.width * imageBuffer.m_Extent.height * 4 * i) + srcOffset,
-				.bufferRowLength = 0,
-				.bufferImageHeight = 0,
-				.imageSubresource = subresourceLayers,
-				.imageOffset = { 0u, 0u, 0u },
-				.imageExtent = imageBuffer.m_Extent
-			};
-			imageCopyRanges[i] = range;
-		}
-		vkCmdCopyBufferToImage(cmdBuffer.commandBuffer, m_Buffer,
-							   imageBuffer.m_Image, imageBuffer.m_Layout,
-							   6, imageCopyRanges.data());
-
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		this->RecordImageUpload(cmdBuffer, srcOffset, imageBuffer, imageBuffer.m_Extent, 6);
 	}, QUEUE_GRAPHICS); // TODO: Deal with layout transitions VUID-vkCmdPipelineBarrier-dstStageMask-06462 and switch back to QUEUE_TRANSFER
 
 
@@ -866,41 +1126,37 @@ int StagingBuffer::TransferDataImmediate(UniformBuffer& uniformBuffer, size_t sr
 										 { srcOffset, dstOffset, size });
 }
 
+int StagingBuffer::TransferDataImmediate(StorageBuffer& storageBuffer, size_t srcOffset, size_t dstOffset, size_t size) {
+	if (!m_Initialized || !storageBuffer.m_Initialized) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Trying to copy data using an uninitialized buffer.");
+		return -1;
+	}
+	if (BoundsCheck(size, m_Size, storageBuffer.m_Size, srcOffset, dstOffset) != 0) {
+		return -1;
+	}
+
+	return TransferDataInternalImmediate(m_Buffer,
+										 storageBuffer.m_Buffer,
+										 { srcOffset, dstOffset, size });
+}
+
 int StagingBuffer::TransferDataImmediate(ImageBuffer& imageBuffer, size_t srcOffset, size_t dstOffset, uint32_t width, uint32_t height) {
 	if (!m_Initialized || !imageBuffer.m_Initialized) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
 										 "Trying to copy data using an uninitialized buffer.");
 		return -1;
 	}
-	if (BoundsCheck(width * height * 4, m_Size, imageBuffer.m_Size, srcOffset, dstOffset) != 0) {
+	uint32_t copyLevels = imageBuffer.m_HostMipmaps ? imageBuffer.m_MipLevels : 1;
+	if (BoundsCheck(CalculateMipChainSize(width, height, copyLevels, 1), m_Size, imageBuffer.m_Size, srcOffset, dstOffset) != 0) {
 		return -1;
 	}
 
 	VkResult result;
 
-	VkBuffer src = this->m_Buffer;
-	VkImage dst = imageBuffer.m_Image;
-	result = Renderer::Get()->ImmediateSubmit([src, dst, width, height, &imageBuffer](RawCommandBuffer& cmdBuffer) {
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-		VkBufferImageCopy imageCopy;
-		imageCopy.bufferOffset = 0;
-		imageCopy.bufferImageHeight = 0;
-		imageCopy.bufferRowLength = 0;
-		imageCopy.imageExtent = { width, height, 1 };
-		imageCopy.imageOffset = { 0, 0, 0 };
-		imageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageCopy.imageSubresource.baseArrayLayer = 0;
-		imageCopy.imageSubresource.mipLevel = 0;
-		imageCopy.imageSubresource.layerCount = 1;
-
-		vkCmdCopyBufferToImage(cmdBuffer.commandBuffer,
-							src,
-							dst,
-							VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-							1,
-							&imageCopy);
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	VkExtent3D extent = { width, height, 1 };
+	result = Renderer::Get()->ImmediateSubmit([this, srcOffset, extent, &imageBuffer](RawCommandBuffer& cmdBuffer) {
+		this->RecordImageUpload(cmdBuffer, srcOffset, imageBuffer, extent, 1);
 	}, QUEUE_GRAPHICS); // TODO: Deal with layout transitions VUID-vkCmdPipelineBarrier-dstStageMask-06462 and switch back to QUEUE_TRANSFER
 
 
@@ -913,32 +1169,13 @@ int StagingBuffer::TransferDataImmediate(CubeMapBuffer& imageBuffer, size_t srcO
 										 "Trying to copy data using an uninitialized buffer.");
 		return -1;
 	}
+	uint32_t copyLevels = imageBuffer.m_HostMipmaps ? imageBuffer.m_MipLevels : 1;
+	if (BoundsCheck(CalculateMipChainSize(imageBuffer.m_Extent.width, imageBuffer.m_Extent.height, copyLevels, 6),
+					m_Size, imageBuffer.m_Size, srcOffset, 0) != 0) {
+		return -1;
+	}
 	VkResult result = Renderer::Get()->ImmediateSubmit([this, &imageBuffer, srcOffset](RawCommandBuffer& cmdBuffer){
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-		std::array<VkBufferImageCopy, 6> imageCopyRanges;
-		for (uint32_t i = 0; i < 6; i++) {
-			VkImageSubresourceLayers subresourceLayers = {
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.mipLevel = 0,
-				.baseArrayLayer = i,
-				.layerCount = 1
-			};
-			VkBufferImageCopy range = {
-				.bufferOffset = (imageBuffer.m_Extent.width * imageBuffer.m_Extent.height * 4) + srcOffset,
-				.bufferRowLength = 0,
-				.bufferImageHeight = 0,
-				.imageSubresource = subresourceLayers,
-				.imageOffset = { 0u, 0u, 0u },
-				.imageExtent = imageBuffer.m_Extent
-			};
-			imageCopyRanges[i] = range;
-		}
-		vkCmdCopyBufferToImage(cmdBuffer.commandBuffer, m_Buffer,
-							   imageBuffer.m_Image, imageBuffer.m_Layout,
-							   6, imageCopyRanges.data());
-
-		imageBuffer.TransitionLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		this->RecordImageUpload(cmdBuffer, srcOffset, imageBuffer, imageBuffer.m_Extent, 6);
 	}, QUEUE_GRAPHICS); // TODO: Deal with layout transitions VUID-vkCmdPipelineBarrier-dstStageMask-06462 and switch back to QUEUE_TRANSFER
 	return result == VK_SUCCESS ? 0 : -1;
 }
@@ -949,16 +1186,30 @@ Renderer* Renderer::s_Instance = NULL;
 
 Renderer::Renderer(const RendererSpec& spec, const RendererCapabilities& capabilities)
  : m_Capabilites(capabilities), m_EnableValidationLayers(spec.enableValidationLayers), m_Window(spec.window),
+   m_Headless(spec.headless), m_SwapchainTransferSrc(false), m_FrameNumber(0),
+   m_HostQueryReset(false), m_CalibratedTimestamps(false),
+   m_FrameGpuZone(CEE_INVALID_GPU_ZONE), m_GeometryGpuZone(CEE_INVALID_GPU_ZONE),
+   m_MessageBus(spec.msgBus), m_Statistics({}), m_LastStatistics({}),
+   m_PipelineStatistics(spec.pipelineStatistics),
    m_Instance(VK_NULL_HANDLE), m_PhysicalDevice(VK_NULL_HANDLE), m_PhysicalDeviceProperties({}),
-   m_Device(VK_NULL_HANDLE), m_Surface(VK_NULL_HANDLE), m_Swapchain(VK_NULL_HANDLE),
-   m_DepthImage(ImageBuffer()), m_RenderPass(VK_NULL_HANDLE), m_PipelineLayout(VK_NULL_HANDLE),
-   m_PipelineCache(VK_NULL_HANDLE), m_MainPipeline(VK_NULL_HANDLE),
-   m_LinePipeline(VK_NULL_HANDLE), m_ActivePipeline(m_MainPipeline), m_PresentQueue(VK_NULL_HANDLE),
+   m_Device(VK_NULL_HANDLE), m_Surface(VK_NULL_HANDLE), m_DepthFormat(VK_FORMAT_UNDEFINED), m_Swapchain(VK_NULL_HANDLE),
+   m_DepthImage(ImageBuffer()), m_DescriptorIndexing(false), m_TextureTableSize(0),
+   m_DefaultTexture(CEE_INVALID_TEXTURE_HANDLE), m_NextTextureHandle(0),
+   m_RenderPass(VK_NULL_HANDLE), m_PipelineLayout(VK_NULL_HANDLE),
+   m_PipelineCache(VK_NULL_HANDLE), m_PackedVertices(spec.packedVertices), m_ActivePipeline(VK_NULL_HANDLE),
+   m_DrawIndirectCount(false), m_BuildDepthPyramid(spec.occlusionCulling), m_DepthPyramidValid(false),
+   m_DepthPyramidSampler(VK_NULL_HANDLE),
+   m_EnableShaderHotReload(spec.enableShaderHotReload), m_PipelineRebuild({}), m_PresentQueue(VK_NULL_HANDLE),
    m_GraphicsQueue(VK_NULL_HANDLE), m_TransferQueue(VK_NULL_HANDLE),
    m_GraphicsCmdPool(VK_NULL_HANDLE), m_TransferCmdPool(VK_NULL_HANDLE),
    m_ImageIndex(0), m_FrameIndex(0), m_QueueSubmissionIndex(0), m_DebugMessenger(VK_NULL_HANDLE)
 {
 	m_Running = false;
+	m_PipelineRebuildDone = false;
+	m_HeadlessExtent = { spec.headlessWidth, spec.headlessHeight };
+	if (m_Headless) {
+		m_SwapchainExtent = m_HeadlessExtent;
+	}
 }
 
 Renderer::~Renderer()
@@ -1063,12 +1314,13 @@ int Renderer::Init()
 		const char *const surfaceExtensionName = "VK_KHR_xcb_surface";
 #endif
 		for (uint32_t i = 0; i < extensionPropertiesCount; i++) {
-			if (strcmp(VK_KHR_SURFACE_EXTENSION_NAME, extensionProperties[i].extensionName) == 0) {
+			// Surface extensions may be missing entirely without a display.
+			if (!m_Headless && strcmp(VK_KHR_SURFACE_EXTENSION_NAME, extensionProperties[i].extensionName) == 0) {
 				enabledExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
 				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_DEBUG, "Using Vulkan extension %s.", extensionProperties[i].extensionName);
 				continue;
 			}
-			if (strcmp(surfaceExtensionName, extensionProperties[i].extensionName) == 0) {
+			if (!m_Headless && strcmp(surfaceExtensionName, extensionProperties[i].extensionName) == 0) {
 				enabledExtensions.push_back(surfaceExtensionName);
 				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_DEBUG, "Using Vulkan extension %s.", extensionProperties[i].extensionName);
 				continue;
@@ -1171,7 +1423,7 @@ int Renderer::Init()
 				(m_PhysicalDeviceProperties.apiVersion & 0xFFF));
 
 	}
-	{
+	if (!m_Headless) {
 #if defined(CEE_PLATFORM_WINDOWS)
 		VkWin32SurfaceCreateInfoKHR surfaceCreateInfo = {};
 		surfaceCreateInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
@@ -1224,7 +1476,7 @@ int Renderer::Init()
 			{
 				m_QueueFamilyIndices.transferIndex = i;
 			}
-			if (!m_QueueFamilyIndices.presentIndex.has_value()) {
+			if (!m_Headless && !m_QueueFamilyIndices.presentIndex.has_value()) {
 				if (vkGetPhysicalDeviceSurfaceSupportKHR(m_PhysicalDevice, i, m_Surface, &presentSupport) == VK_SUCCESS)
 				{
 					if (presentSupport)
@@ -1246,6 +1498,10 @@ int Renderer::Init()
 			}
 		}
 		std::free(queueFamilyProperties);
+		// Nothing is presented, the graphics queue stands in so the checks below hold.
+		if (m_Headless) {
+			m_QueueFamilyIndices.presentIndex = m_QueueFamilyIndices.graphicsIndex;
+		}
 
 		if (!(m_QueueFamilyIndices.graphicsIndex.has_value() &&
 			m_QueueFamilyIndices.computeIndex.has_value() &&
@@ -1295,11 +1551,18 @@ int Renderer::Init()
 		}
 
 		for (uint32_t i = 0; i < extensionPropertiesCount; i++) {
-			if (strcmp(VK_KHR_SWAPCHAIN_EXTENSION_NAME, extensionProperties[i].extensionName) == 0) {
+			if (!m_Headless && strcmp(VK_KHR_SWAPCHAIN_EXTENSION_NAME, extensionProperties[i].extensionName) == 0) {
 				enabledExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "Using device extension: %s", extensionProperties[i].extensionName);
 				continue;
 			}
+			// Lines GPU timestamps up with the CPU timeline for the GPU profiler.
+			if (strcmp(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, extensionProperties[i].extensionName) == 0) {
+				enabledExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+				m_CalibratedTimestamps = true;
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "Using device extension: %s", extensionProperties[i].extensionName);
+				continue;
+			}
 		}
 		std::free(extensionProperties);
 
@@ -1321,11 +1584,65 @@ int Renderer::Init()
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		VkPhysicalDeviceFeatures supportedFeatures = {};
+		vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.fillModeNonSolid = VK_TRUE;
+		deviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+		if (m_PipelineStatistics && !supportedFeatures.pipelineStatisticsQuery) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Pipeline statistics queries unsupported, pipeline statistics disabled.");
+			m_PipelineStatistics = false;
+		}
+		deviceFeatures.pipelineStatisticsQuery = m_PipelineStatistics;
+
+		// Descriptor indexing is core in Vulkan 1.2 and backs the bindless texture table.
+		VkPhysicalDeviceVulkan12Features supportedFeatures12 = {};
+		supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		supportedFeatures12.pNext = NULL;
+		if (m_PhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+			VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+			supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures2.pNext = &supportedFeatures12;
+			vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supportedFeatures2);
+		}
+		m_DescriptorIndexing = supportedFeatures12.runtimeDescriptorArray &&
+							   supportedFeatures12.descriptorBindingPartiallyBound &&
+							   supportedFeatures12.descriptorBindingSampledImageUpdateAfterBind &&
+							   supportedFeatures12.shaderSampledImageArrayNonUniformIndexing;
+
+		// Lets the GPU profiler reset its queries without a command buffer, which the
+		// transfer queue could not record.
+		m_HostQueryReset = supportedFeatures12.hostQueryReset;
+
+		// GPU driven draws write one indirect command per instance, selected with
+		// firstInstance, and the count from a compute pass.
+		m_DrawIndirectCount = supportedFeatures12.drawIndirectCount &&
+							  supportedFeatures.multiDrawIndirect &&
+							  supportedFeatures.drawIndirectFirstInstance;
+		deviceFeatures.multiDrawIndirect = m_DrawIndirectCount;
+		deviceFeatures.drawIndirectFirstInstance = m_DrawIndirectCount;
+		m_EnabledDeviceFeatures = deviceFeatures;
+
+		VkPhysicalDeviceVulkan12Features deviceFeatures12 = {};
+		deviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		deviceFeatures12.pNext = NULL;
+		deviceFeatures12.runtimeDescriptorArray = m_DescriptorIndexing;
+		deviceFeatures12.descriptorBindingPartiallyBound = m_DescriptorIndexing;
+		deviceFeatures12.descriptorBindingSampledImageUpdateAfterBind = m_DescriptorIndexing;
+		deviceFeatures12.shaderSampledImageArrayNonUniformIndexing = m_DescriptorIndexing;
+		deviceFeatures12.hostQueryReset = m_HostQueryReset;
+		deviceFeatures12.drawIndirectCount = m_DrawIndirectCount;
+		if (!m_DescriptorIndexing) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Descriptor indexing unsupported, falling back to a fixed texture array.");
+		}
+
 		VkDeviceCreateInfo deviceCreateInfo = {};
 		deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-		deviceCreateInfo.pNext = NULL;
+		deviceCreateInfo.pNext = m_DescriptorIndexing || m_HostQueryReset || m_DrawIndirectCount ?
+								 &deviceFeatures12 : NULL;
 		deviceCreateInfo.flags = 0;
 		deviceCreateInfo.queueCreateInfoCount = queueCreateInfos.size();
 		deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -1345,7 +1662,18 @@ int Renderer::Init()
 		vkGetDeviceQueue(m_Device, m_QueueFamilyIndices.graphicsIndex.value(), 0, &m_GraphicsQueue);
 		vkGetDeviceQueue(m_Device, m_QueueFamilyIndices.transferIndex.value(), 0, &m_TransferQueue);
 	}
-	{
+	if (m_Headless) {
+		// One target per frame in flight, so the image index is always the frame index.
+		m_SwapchainImageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+		m_SwapchainImageCount = m_Capabilites.maxFramesInFlight;
+		m_SwapchainTransferSrc = true;
+		if (CreateOffscreenTargets() != 0) {
+			return -1;
+		}
+		m_RecreateSwapchain = false;
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "Rendering headless at %ux%u.",
+										 m_SwapchainExtent.width, m_SwapchainExtent.height);
+	} else {
 		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_PhysicalDevice, m_Surface, &m_SwapcahinSupportInfo.surfaceCapabilities);
 		uint32_t surfaceFormatCount;
 		uint32_t presentModeCount;
@@ -1395,6 +1723,10 @@ int Renderer::Init()
 		swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
 		swapchainCreateInfo.imageArrayLayers = 1;
 		swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		// Lets frames be read back, see RequestFrameReadback().
+		if (m_SwapcahinSupportInfo.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+			swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
 
 		uint32_t queueIndices[] = {
 			m_QueueFamilyIndices.graphicsIndex.value(),
@@ -1418,6 +1750,7 @@ int Renderer::Init()
 
 		m_SwapchainExtent = swapchainCreateInfo.imageExtent;
 		m_SwapchainImageFormat = swapchainCreateInfo.imageFormat;
+		m_SwapchainTransferSrc = (swapchainCreateInfo.imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
 
 		vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &imageCount, NULL);
 		m_SwapchainImages.resize(imageCount);
@@ -1452,7 +1785,8 @@ int Renderer::Init()
 			m_SwapchainImageViews.push_back(imageView);
 		}
 		m_RecreateSwapchain = false;
-
+	}
+	{
 		m_DepthFormat = ChooseDepthFormat(m_PhysicalDevice,
 													   { VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
 													   VK_IMAGE_TILING_OPTIMAL,
@@ -1460,6 +1794,21 @@ int Renderer::Init()
 		m_DepthImage = this->CreateImageBuffer(m_SwapchainExtent.width,
 											   m_SwapchainExtent.height,
 											   IMAGE_FORMAT_DEPTH);
+
+		if (m_BuildDepthPyramid) {
+			// The pyramid samples the depth buffer and is written as a storage image.
+			VkFormatProperties depthFormatProperties;
+			VkFormatProperties pyramidFormatProperties;
+			vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, m_DepthFormat, &depthFormatProperties);
+			vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, VK_FORMAT_R32_SFLOAT, &pyramidFormatProperties);
+			if (!(depthFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) ||
+				!(pyramidFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+			{
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+												 "Depth pyramid formats unsupported, disabling occlusion culling.");
+				m_BuildDepthPyramid = false;
+			}
+		}
 	}
 	{
 
@@ -1472,18 +1821,23 @@ int Renderer::Init()
 		colorAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		// Offscreen targets are left ready to be read back.
+		colorAttachmentDescription.finalLayout = m_Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL :
+															  VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 		VkAttachmentDescription depthAttachmentDescription = {};
 		depthAttachmentDescription.flags = 0;
 		depthAttachmentDescription.format = m_DepthFormat;
 		depthAttachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
 		depthAttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		// Kept for the depth pyramid, which samples it after the render pass.
+		depthAttachmentDescription.storeOp = m_BuildDepthPyramid ? VK_ATTACHMENT_STORE_OP_STORE :
+																   VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachmentDescription.finalLayout = m_BuildDepthPyramid ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL :
+																	   VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference colorAttachmentReference = {};
 		colorAttachmentReference.attachment = 0;
@@ -1505,13 +1859,32 @@ int Renderer::Init()
 		subpassDescription.pPreserveAttachments = NULL;
 		subpassDescription.pResolveAttachments = NULL;
 
-		VkSubpassDependency subpassDependency = {};
-		subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		subpassDependency.dstSubpass = 0;
-		subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		subpassDependency.srcAccessMask = 0;
-		subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		std::vector<VkSubpassDependency> subpassDependencies(m_BuildDepthPyramid ? 3 : 2, VkSubpassDependency{});
+		subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		subpassDependencies[0].dstSubpass = 0;
+		// The depth clear also waits for the previous frame's depth pyramid reads.
+		subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+											  (m_BuildDepthPyramid ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : 0);
+		subpassDependencies[0].srcAccessMask = 0;
+		subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		// Orders frame readback copies after the color writes and the final layout transition.
+		subpassDependencies[1].srcSubpass = 0;
+		subpassDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		subpassDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		subpassDependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		if (m_BuildDepthPyramid) {
+			// Orders the depth pyramid after the depth writes and the final layout transition.
+			subpassDependencies[2].srcSubpass = 0;
+			subpassDependencies[2].dstSubpass = VK_SUBPASS_EXTERNAL;
+			subpassDependencies[2].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+												  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			subpassDependencies[2].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			subpassDependencies[2].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			subpassDependencies[2].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		}
 
 		std::array<VkAttachmentDescription, 2> attachments {
 			colorAttachmentDescription,
@@ -1526,8 +1899,8 @@ int Renderer::Init()
 		renderPassCreateInfo.pAttachments = attachments.data();
 		renderPassCreateInfo.subpassCount = 1;
 		renderPassCreateInfo.pSubpasses = &subpassDescription;
-		renderPassCreateInfo.dependencyCount = 1;
-		renderPassCreateInfo.pDependencies = &subpassDependency;
+		renderPassCreateInfo.dependencyCount = subpassDependencies.size();
+		renderPassCreateInfo.pDependencies = subpassDependencies.data();
 
 		result = vkCreateRenderPass(m_Device, &renderPassCreateInfo, NULL, &m_RenderPass);
 		if (result != VK_SUCCESS) {
@@ -1536,93 +1909,74 @@ int Renderer::Init()
 		}
 	}
 	{
-		VkDescriptorSetLayoutBinding uniformDescriptorSetLayoutBinding {};
-		uniformDescriptorSetLayoutBinding.binding = 0;
-		uniformDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uniformDescriptorSetLayoutBinding.descriptorCount = 1;
-		uniformDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-		uniformDescriptorSetLayoutBinding.pImmutableSamplers = NULL;
-
-		VkDescriptorSetLayoutBinding samplerDescriptorSetLayoutBinding {};
-		samplerDescriptorSetLayoutBinding.binding = 0;
-		samplerDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;;
-		samplerDescriptorSetLayoutBinding.descriptorCount = 1;
-		samplerDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-		samplerDescriptorSetLayoutBinding.pImmutableSamplers = NULL;
-
-		VkDescriptorSetLayoutBinding imageDescriptorSetLayoutBinding {};
-		imageDescriptorSetLayoutBinding.binding = 1;
-		imageDescriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		imageDescriptorSetLayoutBinding.descriptorCount = 32;
-		imageDescriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-		imageDescriptorSetLayoutBinding.pImmutableSamplers = NULL;
-
-		std::array<VkDescriptorSetLayoutBinding, 1> uniformDescriptorSetLayoutBindings = {
-			uniformDescriptorSetLayoutBinding
-		};
-
-		std::array<VkDescriptorSetLayoutBinding, 2> imageDescriptorSetLayoutBindings = {
-			samplerDescriptorSetLayoutBinding,
-			imageDescriptorSetLayoutBinding
-		};
+		// Sizes the texture table, which the fragment shaders declare as a runtime array
+		// with descriptor indexing and as CEE_MAX_TEXTURES elements otherwise.
+		m_TextureTableSize = m_Capabilites.maxTextures != 0 ? m_Capabilites.maxTextures : 32;
+		if (m_DescriptorIndexing) {
+			VkPhysicalDeviceVulkan12Properties properties12 = {};
+			properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+			properties12.pNext = NULL;
+			VkPhysicalDeviceProperties2 properties2 = {};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties2.pNext = &properties12;
+			vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &properties2);
+
+			m_TextureTableSize = std::min({ m_TextureTableSize,
+											properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+											properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+											properties12.maxPerStageUpdateAfterBindResources - 1 });
+		} else {
+			const VkPhysicalDeviceLimits& limits = m_PhysicalDeviceProperties.limits;
+			m_TextureTableSize = std::min({ m_TextureTableSize,
+											limits.maxPerStageDescriptorSampledImages,
+											limits.maxDescriptorSetSampledImages,
+											limits.maxPerStageResources - 1 });
+		}
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "Texture table size: %u", m_TextureTableSize);
 
-		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
-		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		descriptorSetLayoutCreateInfo.pNext = NULL;
-		descriptorSetLayoutCreateInfo.flags = 0;
-		descriptorSetLayoutCreateInfo.bindingCount = uniformDescriptorSetLayoutBindings.size();
-		descriptorSetLayoutCreateInfo.pBindings = uniformDescriptorSetLayoutBindings.data();
-
-		result = vkCreateDescriptorSetLayout(m_Device,
-											 &descriptorSetLayoutCreateInfo,
-											 NULL,
-											 &m_UniformDescriptorSetLayout);
-		if (result != VK_SUCCESS) {
-			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
-											 "Failed to create uniform descriptor set layout.");
+		// The 2D and 3D pipelines share one layout, reflected from all of their shaders.
+		std::vector<std::shared_ptr<ShaderBinary>> mainShaders;
+		for (auto& name : s_MainShaderNames) {
+			mainShaders.push_back(LoadShader(name));
+		}
+		ShaderReflection reflection;
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		if (ReflectMainShaders(mainShaders, &reflection) != 0 ||
+			GetDescriptorSetLayouts(reflection, setLayouts) != 0 || setLayouts.size() != 2)
+		{
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create descriptor set layouts.");
 			return -1;
 		}
+		m_UniformDescriptorSetLayout = setLayouts[0];
+		m_ImageDescriptorSetLayout = setLayouts[1];
+		m_PipelineLayoutReflection = reflection;
 
-		descriptorSetLayoutCreateInfo = {};
-		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		descriptorSetLayoutCreateInfo.pNext = NULL;
-		descriptorSetLayoutCreateInfo.flags = 0;
-		descriptorSetLayoutCreateInfo.bindingCount = imageDescriptorSetLayoutBindings.size();
-		descriptorSetLayoutCreateInfo.pBindings = imageDescriptorSetLayoutBindings.data();
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.pNext = NULL;
+		pipelineLayoutCreateInfo.flags = 0;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = reflection.pushConstants.size();
+		pipelineLayoutCreateInfo.pPushConstantRanges = reflection.pushConstants.data();
+		pipelineLayoutCreateInfo.setLayoutCount = setLayouts.size();
+		pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
 
-		result = vkCreateDescriptorSetLayout(m_Device,
-											 &descriptorSetLayoutCreateInfo,
-											 NULL,
-											 &m_ImageDescriptorSetLayout);
+		result = vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, NULL, &m_PipelineLayout);
 		if (result != VK_SUCCESS) {
-			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
-											 "Failed to create image and sampler descriptor set layout.");
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create pipeline layout.");
 			return -1;
 		}
 
-		VkDescriptorPoolSize uniformDescriptorPoolSize = {};
-		uniformDescriptorPoolSize.descriptorCount = m_Capabilites.maxFramesInFlight;
-		uniformDescriptorPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-
-		VkDescriptorPoolSize samplerDescriptorPoolSize = {};
-		samplerDescriptorPoolSize.descriptorCount = m_Capabilites.maxFramesInFlight;
-		samplerDescriptorPoolSize.type = VK_DESCRIPTOR_TYPE_SAMPLER;
-
-		VkDescriptorPoolSize imageDescriptorPoolSize = {};
-		imageDescriptorPoolSize.descriptorCount = m_Capabilites.maxFramesInFlight * 32;
-		imageDescriptorPoolSize.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-
-		std::array<VkDescriptorPoolSize, 3> descriptorPoolSizes = {
-			uniformDescriptorPoolSize,
-			samplerDescriptorPoolSize,
-			imageDescriptorPoolSize
-		};
+		// One uniform and one image set per frame in flight.
+		std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
+		AddDescriptorPoolSizes(descriptorPoolSizes, reflection.bindings, m_TextureTableSize,
+							   m_Capabilites.maxFramesInFlight);
 
 		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
 		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 		descriptorPoolCreateInfo.pNext = NULL;
-		descriptorPoolCreateInfo.flags = 0;
-		descriptorPoolCreateInfo.maxSets = m_Capabilites.maxFramesInFlight + 32;
+		descriptorPoolCreateInfo.flags = m_DescriptorIndexing && HasRuntimeArray(reflection.bindings) ?
+			VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0;
+		descriptorPoolCreateInfo.maxSets = setLayouts.size() * m_Capabilites.maxFramesInFlight;
 		descriptorPoolCreateInfo.poolSizeCount = descriptorPoolSizes.size();
 		descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
 
@@ -1633,6 +1987,40 @@ int Renderer::Init()
 			return -1;
 		}
 	}
+	{
+		std::array<VkDescriptorPoolSize, 3> computePoolSizes = {{
+			{
+				.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = RENDERER_MAX_DISPATCHES * RENDERER_MAX_DISPATCH_BUFFERS
+			},
+			{
+				.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+				.descriptorCount = RENDERER_MAX_DISPATCHES
+			},
+			{
+				.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.descriptorCount = RENDERER_MAX_DISPATCHES
+			}
+		}};
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.pNext = NULL;
+		descriptorPoolCreateInfo.flags = 0;
+		descriptorPoolCreateInfo.maxSets = RENDERER_MAX_DISPATCHES;
+		descriptorPoolCreateInfo.poolSizeCount = computePoolSizes.size();
+		descriptorPoolCreateInfo.pPoolSizes = computePoolSizes.data();
+
+		m_ComputeDescriptorPools.resize(m_Capabilites.maxFramesInFlight, VK_NULL_HANDLE);
+		for (auto& descriptorPool : m_ComputeDescriptorPools) {
+			result = vkCreateDescriptorPool(m_Device, &descriptorPoolCreateInfo, NULL, &descriptorPool);
+			if (result != VK_SUCCESS) {
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+												 "Failed to create compute descriptor pool.");
+				return -1;
+			}
+		}
+	}
 	{
 		m_UniformDescriptorSets.resize(m_Capabilites.maxFramesInFlight);
 		std::vector<VkDescriptorSetLayout> descriptorLayouts(m_Capabilites.maxFramesInFlight,
@@ -1671,434 +2059,47 @@ int Renderer::Init()
 		}
 	}
 	{
-		VkSamplerCreateInfo samplerCreateInfo = {};
-		samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-		samplerCreateInfo.pNext = NULL;
-		samplerCreateInfo.flags = 0;
-		samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
-		samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.mipLodBias = 0.0f;
-		samplerCreateInfo.anisotropyEnable = VK_FALSE;
-		samplerCreateInfo.maxAnisotropy = 1.0f;
-		samplerCreateInfo.compareEnable = VK_FALSE;
-		samplerCreateInfo.compareOp = VK_COMPARE_OP_GREATER;
-		samplerCreateInfo.minLod = 0.0f;
-		samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
-		samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
-		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
-
-		result = vkCreateSampler(m_Device, &samplerCreateInfo, NULL, &m_Sampler);
-		if (result != VK_SUCCESS) {
-			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
-											 "Failed to create sampler.");
+		SamplerSpec samplerSpec;
+		samplerSpec.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerSpec.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerSpec.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		m_Sampler = GetSampler(samplerSpec);
+		if (m_Sampler == VK_NULL_HANDLE) {
+			return -1;
 		}
 	}
 	{
-		// TODO: Abstract file operations.
-		const char* quad2DVertexShaderFilePath = "shaders/renderer2DQuadVertex.spv";
-		const char* quad2DFragmentShaderFilePath = "shaders/renderer2DQuadFragment.spv";
-		const char* basic3DVertexShaderFilePath = "shaders/renderer3DBasicVertex.spv";
-		const char* basic3DFragmentShaderFilePath = "shaders/renderer3DBasicFragment.spv";
-
-		auto quad2DVertexShaderCode = m_AssetManager.LoadAsset<ShaderBinary>(quad2DVertexShaderFilePath);
-		auto quad2DFragmentShaderCode = m_AssetManager.LoadAsset<ShaderBinary>(quad2DFragmentShaderFilePath);
-		auto basic3DVertexShaderCode = m_AssetManager.LoadAsset<ShaderBinary>(basic3DVertexShaderFilePath);
-		auto basic3DFragmentShaderCode = m_AssetManager.LoadAsset<ShaderBinary>(basic3DFragmentShaderFilePath);
-
-		VkShaderModule quad2DVertexShaderModule = this->CreateShaderModule(m_Device, quad2DVertexShaderCode);
-		VkShaderModule quad2DFragmentShaderModule = this->CreateShaderModule(m_Device, quad2DFragmentShaderCode);
-		VkShaderModule basic3DVertexShaderModule = this->CreateShaderModule(m_Device, basic3DVertexShaderCode);
-		VkShaderModule basic3DFragmentShaderModule = this->CreateShaderModule(m_Device, basic3DFragmentShaderCode);
-
-		quad2DVertexShaderCode.reset();
-		quad2DFragmentShaderCode.reset();
-		basic3DVertexShaderCode.reset();
-		basic3DFragmentShaderCode.reset();
-
-		VkPipelineShaderStageCreateInfo quad2DVertexShaderStageCreateInfo = {};
-		quad2DVertexShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		quad2DVertexShaderStageCreateInfo.pNext = NULL;
-		quad2DVertexShaderStageCreateInfo.flags = 0;
-		quad2DVertexShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		quad2DVertexShaderStageCreateInfo.module = quad2DVertexShaderModule;
-		quad2DVertexShaderStageCreateInfo.pName = "main";
-		quad2DVertexShaderStageCreateInfo.pSpecializationInfo = NULL;
-
-		VkPipelineShaderStageCreateInfo quad2DFragmentShaderStageCreateInfo = {};
-		quad2DFragmentShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		quad2DFragmentShaderStageCreateInfo.pNext = NULL;
-		quad2DFragmentShaderStageCreateInfo.flags = 0;
-		quad2DFragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		quad2DFragmentShaderStageCreateInfo.module = quad2DFragmentShaderModule;
-		quad2DFragmentShaderStageCreateInfo.pName = "main";
-		quad2DFragmentShaderStageCreateInfo.pSpecializationInfo = NULL;
-
-		VkPipelineShaderStageCreateInfo basic3DVertexShaderStageCreateInfo = {};
-		basic3DVertexShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		basic3DVertexShaderStageCreateInfo.pNext = NULL;
-		basic3DVertexShaderStageCreateInfo.flags = 0;
-		basic3DVertexShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		basic3DVertexShaderStageCreateInfo.module = basic3DVertexShaderModule;
-		basic3DVertexShaderStageCreateInfo.pName = "main";
-		basic3DVertexShaderStageCreateInfo.pSpecializationInfo = NULL;
-
-		VkPipelineShaderStageCreateInfo basic3DFragmentShaderStageCreateInfo = {};
-		basic3DFragmentShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		basic3DFragmentShaderStageCreateInfo.pNext = NULL;
-		basic3DFragmentShaderStageCreateInfo.flags = 0;
-		basic3DFragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		basic3DFragmentShaderStageCreateInfo.module = basic3DFragmentShaderModule;
-		basic3DFragmentShaderStageCreateInfo.pName = "main";
-		basic3DFragmentShaderStageCreateInfo.pSpecializationInfo = NULL;
-
-		VkPipelineShaderStageCreateInfo quad2DShaderStageCreateInfos[] = {
-			quad2DVertexShaderStageCreateInfo,
-			quad2DFragmentShaderStageCreateInfo
-		};
-
-		VkPipelineShaderStageCreateInfo basic3DShaderStageCreateInfos[] = {
-			basic3DVertexShaderStageCreateInfo,
-			basic3DFragmentShaderStageCreateInfo
-		};
+		// A cache written by another driver or device is rejected by some implementations
+		// and silently misused by others, so it is checked before being handed over.
+		auto pipelineCacheData = m_AssetManager.LoadAsset<PipelineCache>("cache/pipeline.cache");
+		if (pipelineCacheData != nullptr && !IsPipelineCacheCompatible(pipelineCacheData->data)) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO,
+											 "Pipeline cache was created by another device or driver, discarding it.");
+			pipelineCacheData.reset();
+		}
 
-		std::vector<VkVertexInputAttributeDescription> quad2DVertexInputAttributes;
-		std::vector<VkVertexInputAttributeDescription> basic3DVertexInputAttributes;
-		VkVertexInputAttributeDescription vertexInputAttribute = {};
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertexInputAttribute.location = 0;
-		vertexInputAttribute.offset = 0;
-		quad2DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertexInputAttribute.location = 1;
-		vertexInputAttribute.offset = 16;
-		quad2DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32_SFLOAT;
-		vertexInputAttribute.location = 2;
-		vertexInputAttribute.offset = 32;
-		quad2DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertexInputAttribute.location = 0;
-		vertexInputAttribute.offset = 0;
-		basic3DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertexInputAttribute.location = 1;
-		vertexInputAttribute.offset = 16;
-		basic3DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertexInputAttribute.location = 2;
-		vertexInputAttribute.offset = 28;
-		basic3DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32G32_SFLOAT;
-		vertexInputAttribute.location = 3;
-		vertexInputAttribute.offset = 44;
-		basic3DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		vertexInputAttribute.binding = 0;
-		vertexInputAttribute.format = VK_FORMAT_R32_UINT;
-		vertexInputAttribute.location = 4;
-		vertexInputAttribute.offset = 52;
-		basic3DVertexInputAttributes.push_back(vertexInputAttribute);
-
-		std::vector<VkVertexInputBindingDescription> quad2DVertexInputBindings;
-		std::vector<VkVertexInputBindingDescription> basic3DVertexInputBindings;
-		VkVertexInputBindingDescription vertexInputBinding = {};
-		vertexInputBinding.binding = 0;
-		vertexInputBinding.stride = 40;
-		vertexInputBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-		quad2DVertexInputBindings.push_back(vertexInputBinding);
-
-		vertexInputBinding.binding = 0;
-		vertexInputBinding.stride = 56;
-		vertexInputBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-		basic3DVertexInputBindings.push_back(vertexInputBinding);
-
-		VkPipelineVertexInputStateCreateInfo quad2DVertexInputStateCreateInfo = {};
-		quad2DVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		quad2DVertexInputStateCreateInfo.pNext = NULL;
-		quad2DVertexInputStateCreateInfo.flags = 0;
-		quad2DVertexInputStateCreateInfo.vertexAttributeDescriptionCount = quad2DVertexInputAttributes.size();
-		quad2DVertexInputStateCreateInfo.pVertexAttributeDescriptions = quad2DVertexInputAttributes.data();
-		quad2DVertexInputStateCreateInfo.vertexBindingDescriptionCount = quad2DVertexInputBindings.size();
-		quad2DVertexInputStateCreateInfo.pVertexBindingDescriptions = quad2DVertexInputBindings.data();
-
-		VkPipelineVertexInputStateCreateInfo basic3DVertexInputStateCreateInfo = {};
-		basic3DVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		basic3DVertexInputStateCreateInfo.pNext = NULL;
-		basic3DVertexInputStateCreateInfo.flags = 0;
-		basic3DVertexInputStateCreateInfo.vertexAttributeDescriptionCount = basic3DVertexInputAttributes.size();
-		basic3DVertexInputStateCreateInfo.pVertexAttributeDescriptions = basic3DVertexInputAttributes.data();
-		basic3DVertexInputStateCreateInfo.vertexBindingDescriptionCount = basic3DVertexInputBindings.size();
-		basic3DVertexInputStateCreateInfo.pVertexBindingDescriptions = basic3DVertexInputBindings.data();
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {};
-		inputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssemblyStateCreateInfo.pNext = NULL;
-		inputAssemblyStateCreateInfo.flags = 0;
-		inputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-		std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
+		VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		pipelineCacheCreateInfo.pNext = NULL;
+		pipelineCacheCreateInfo.flags = 0;
+		pipelineCacheCreateInfo.initialDataSize = pipelineCacheData != nullptr ? pipelineCacheData->data.size() : 0;
+		pipelineCacheCreateInfo.pInitialData = pipelineCacheData != nullptr ? pipelineCacheData->data.data() : NULL;
 
-		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {};
-		dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicStateCreateInfo.pNext = NULL;
-		dynamicStateCreateInfo.flags = 0;
-		dynamicStateCreateInfo.dynamicStateCount = dynamicStates.size();
-		dynamicStateCreateInfo.pDynamicStates = dynamicStates.data();
-
-		VkViewport viewport;
-		viewport.x = 0;
-		viewport.y = 0;
-		viewport.width = m_SwapchainExtent.width;
-		viewport.height = m_SwapchainExtent.height;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-		VkRect2D scissor;
-		scissor.extent = m_SwapchainExtent;
-		scissor.offset = { 0, 0 };
-
-		VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {};
-		viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportStateCreateInfo.pNext = NULL;
-		viewportStateCreateInfo.flags = 0;
-		viewportStateCreateInfo.viewportCount = 1;
-		viewportStateCreateInfo.pViewports = &viewport;
-		viewportStateCreateInfo.scissorCount = 1;
-		viewportStateCreateInfo.pScissors = &scissor;
-
-		VkPipelineRasterizationStateCreateInfo mainRasterizationStateCreateInfo = {};
-		mainRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		mainRasterizationStateCreateInfo.pNext = NULL;
-		mainRasterizationStateCreateInfo.flags = 0;
-		mainRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		mainRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-		mainRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-		mainRasterizationStateCreateInfo.lineWidth = 1.0f;
-		mainRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-		mainRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
-		mainRasterizationStateCreateInfo.depthBiasClamp = 0.0f;
-		mainRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f;
-		mainRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f;
-
-		VkPipelineRasterizationStateCreateInfo lineRasterizationStateCreateInfo = {};
-		lineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		lineRasterizationStateCreateInfo.pNext = NULL;
-		lineRasterizationStateCreateInfo.flags = 0;
-		lineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		lineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
-		lineRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_LINE;
-		lineRasterizationStateCreateInfo.lineWidth = 1.0f;
-		lineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-		lineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
-		lineRasterizationStateCreateInfo.depthBiasClamp = 0.0f;
-		lineRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f;
-		lineRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f;
-
-		VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {};
-		multisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampleStateCreateInfo.pNext = NULL;
-		multisampleStateCreateInfo.flags = 0;
-		multisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		multisampleStateCreateInfo.alphaToOneEnable = VK_FALSE;
-		multisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
-		multisampleStateCreateInfo.minSampleShading = 1.0f;
-		multisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
-		multisampleStateCreateInfo.pSampleMask = NULL;
-
-		VkPipelineColorBlendAttachmentState colorBlendState;
-		colorBlendState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendState.blendEnable = VK_FALSE;
-		colorBlendState.colorBlendOp = VK_BLEND_OP_ADD;
-		colorBlendState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colorBlendState.alphaBlendOp = VK_BLEND_OP_ADD;
-		colorBlendState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {};
-		colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendStateCreateInfo.pNext = NULL;
-		colorBlendStateCreateInfo.flags = 0;
-		colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-		colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-		colorBlendStateCreateInfo.attachmentCount = 1;
-		colorBlendStateCreateInfo.pAttachments = &colorBlendState;
-		colorBlendStateCreateInfo.blendConstants[0] = 0.0f;
-		colorBlendStateCreateInfo.blendConstants[1] = 0.0f;
-		colorBlendStateCreateInfo.blendConstants[2] = 0.0f;
-		colorBlendStateCreateInfo.blendConstants[3] = 0.0f;
-
-		VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = {};
-		pipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		pipelineDepthStencilStateCreateInfo.pNext = NULL;
-		pipelineDepthStencilStateCreateInfo.flags = 0;
-		pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
-		pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-		pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-		pipelineDepthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
-		pipelineDepthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
-		pipelineDepthStencilStateCreateInfo.front = {};
-		pipelineDepthStencilStateCreateInfo.back = {};
-		pipelineDepthStencilStateCreateInfo.minDepthBounds = 0.0f;
-		pipelineDepthStencilStateCreateInfo.maxDepthBounds = 1.0f;
-
-		std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts = {
-			m_UniformDescriptorSetLayout,
-			m_ImageDescriptorSetLayout
-		};
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
-		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutCreateInfo.pNext = NULL;
-		pipelineLayoutCreateInfo.flags = 0;
-		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-		pipelineLayoutCreateInfo.pPushConstantRanges = NULL;
-		pipelineLayoutCreateInfo.setLayoutCount = descriptorSetLayouts.size();
-		pipelineLayoutCreateInfo.pSetLayouts = descriptorSetLayouts.data();
-
-		result = vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, NULL, &m_PipelineLayout);
-		if (result != VK_SUCCESS) {
-			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create pipeline layout.");
-			return -1;
-
-		}
-
-		VkGraphicsPipelineCreateInfo quad2DPipelineCreateInfo = {};
-		quad2DPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		quad2DPipelineCreateInfo.pNext = NULL;
-		quad2DPipelineCreateInfo.flags = 0;
-		quad2DPipelineCreateInfo.layout = m_PipelineLayout;
-		quad2DPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
-		quad2DPipelineCreateInfo.basePipelineIndex = 0;
-		quad2DPipelineCreateInfo.renderPass = m_RenderPass;
-		quad2DPipelineCreateInfo.subpass = 0;
-		quad2DPipelineCreateInfo.stageCount = 2;
-		quad2DPipelineCreateInfo.pStages = quad2DShaderStageCreateInfos;
-		quad2DPipelineCreateInfo.pVertexInputState = &quad2DVertexInputStateCreateInfo;
-		quad2DPipelineCreateInfo.pInputAssemblyState = &inputAssemblyStateCreateInfo;
-		quad2DPipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
-		quad2DPipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
-		quad2DPipelineCreateInfo.pRasterizationState = &mainRasterizationStateCreateInfo;
-		quad2DPipelineCreateInfo.pMultisampleState = &multisampleStateCreateInfo;
-		quad2DPipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-		quad2DPipelineCreateInfo.pDepthStencilState = &pipelineDepthStencilStateCreateInfo;
-		quad2DPipelineCreateInfo.pTessellationState = NULL;
-
-		VkGraphicsPipelineCreateInfo basic3DPipelineCreateInfo = quad2DPipelineCreateInfo;
-		basic3DPipelineCreateInfo.pStages = basic3DShaderStageCreateInfos;
-		basic3DPipelineCreateInfo.pVertexInputState = &basic3DVertexInputStateCreateInfo;
-
-		VkGraphicsPipelineCreateInfo lineQuad2DPipelineCreateInfo = quad2DPipelineCreateInfo;
-		lineQuad2DPipelineCreateInfo.pRasterizationState = &lineRasterizationStateCreateInfo;
-
-		VkGraphicsPipelineCreateInfo lineBasic3DPipelineCreateInfo = basic3DPipelineCreateInfo;
-		lineBasic3DPipelineCreateInfo.pRasterizationState = &lineRasterizationStateCreateInfo;
-
-		auto pipelineCacheData = m_AssetManager.LoadAsset<PipelineCache>("cache/pipeline.cache");
-
-		VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-		pipelineCacheCreateInfo.pNext = NULL;
-		pipelineCacheCreateInfo.flags = 0;
-		pipelineCacheCreateInfo.initialDataSize = pipelineCacheData->data.size();
-		pipelineCacheCreateInfo.pInitialData = pipelineCacheData->data.data();
-
-		vkCreatePipelineCache(m_Device, &pipelineCacheCreateInfo, NULL, &m_PipelineCache);
-
-		VkGraphicsPipelineCreateInfo pipelineCreateInfos[] = {
-			quad2DPipelineCreateInfo,
-			basic3DPipelineCreateInfo,
-			lineQuad2DPipelineCreateInfo,
-			lineBasic3DPipelineCreateInfo
-		};
-		VkPipeline pipelines[4] = {
-			VK_NULL_HANDLE,
-			VK_NULL_HANDLE,
-			VK_NULL_HANDLE,
-			VK_NULL_HANDLE
-		};
-		result = vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 4, pipelineCreateInfos, NULL, pipelines);
-		if (result != VK_SUCCESS) {
-			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to graphics create pipelines.");
-			return -1;
-		}
-		m_MainPipeline = pipelines[0];
-		m_LinePipeline = pipelines[1];
-		PipelineFlags pipelineFlags = 0;
-		m_PipelineMap[pipelineFlags] = pipelines[0];
-		pipelineFlags = RENDERER_PIPELINE_FLAG_3D;
-		m_PipelineMap[pipelineFlags] = pipelines[1];
-		pipelineFlags = RENDERER_PIPELINE_FILL;
-		m_PipelineMap[pipelineFlags] = pipelines[2];
-		pipelineFlags = RENDERER_PIPELINE_FILL | RENDERER_PIPELINE_FLAG_3D;
-		m_PipelineMap[pipelineFlags] = pipelines[3];
-		pipelineFlags = 0;
-		m_ActivePipeline = m_PipelineMap[pipelineFlags];
-
-		size_t pipelineCacheDataSize;
-		vkGetPipelineCacheData(m_Device, m_PipelineCache, &pipelineCacheDataSize, NULL);
-		pipelineCacheData->data.resize(pipelineCacheDataSize);
-		vkGetPipelineCacheData(m_Device, m_PipelineCache, &pipelineCacheDataSize, pipelineCacheData->data.data());
-
-		m_AssetManager.SaveAsset("cache/pipeline.cache", pipelineCacheData);
-
-		vkDestroyShaderModule(m_Device, quad2DVertexShaderModule, NULL);
-		vkDestroyShaderModule(m_Device, quad2DFragmentShaderModule, NULL);
-		vkDestroyShaderModule(m_Device, basic3DVertexShaderModule, NULL);
-		vkDestroyShaderModule(m_Device, basic3DFragmentShaderModule, NULL);
-	}
-	{
-		for (uint32_t i = 0; i < m_SwapchainImageCount; i ++) {
-			VkImageView attachments[] = {
-				m_SwapchainImageViews[i],
-				m_DepthImage.m_ImageView
-			};
-			VkFramebufferCreateInfo framebufferCreateInfo = {};
-			framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferCreateInfo.pNext = NULL;
-			framebufferCreateInfo.flags = 0;
-			framebufferCreateInfo.renderPass = m_RenderPass;
-			framebufferCreateInfo.layers = 1;
-			framebufferCreateInfo.attachmentCount = 2;
-			framebufferCreateInfo.pAttachments = attachments;
-			framebufferCreateInfo.width = m_SwapchainExtent.width;
-			framebufferCreateInfo.height = m_SwapchainExtent.height;
-
-			VkFramebuffer framebuffer;
-			result = vkCreateFramebuffer(m_Device, &framebufferCreateInfo, NULL, &framebuffer);
-			if (result != VK_SUCCESS) {
-				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create framebuffer %u.", i);
-				return -1;
-			}
-			m_Framebuffers.push_back(framebuffer);
-		}
-	}
-	{
-		VkCommandPoolCreateInfo cmdPoolCreateInfo = {};
-		cmdPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		cmdPoolCreateInfo.pNext = NULL;
-		cmdPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		cmdPoolCreateInfo.queueFamilyIndex = m_QueueFamilyIndices.graphicsIndex.value();
+		result = vkCreatePipelineCache(m_Device, &pipelineCacheCreateInfo, NULL, &m_PipelineCache);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create pipeline cache.");
+			return -1;
+		}
+	}
+	if (CreateFramebuffers() != 0) {
+		return -1;
+	}
+	{
+		VkCommandPoolCreateInfo cmdPoolCreateInfo = {};
+		cmdPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolCreateInfo.pNext = NULL;
+		cmdPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		cmdPoolCreateInfo.queueFamilyIndex = m_QueueFamilyIndices.graphicsIndex.value();
 
 		result = vkCreateCommandPool(m_Device, &cmdPoolCreateInfo, NULL, &m_GraphicsCmdPool);
 		if (result != VK_SUCCESS) {
@@ -2190,20 +2191,64 @@ int Renderer::Init()
 			}
 			m_TransferQueueFences.push_back(transferQueueFence);
 		}
+		m_FrameReadbackSlots.resize(m_Capabilites.maxFramesInFlight, FrameReadbackSlot{});
+	}
+	{
+		GpuProfilerSpec profilerSpec = {};
+		profilerSpec.instance = m_Instance;
+		profilerSpec.physicalDevice = m_PhysicalDevice;
+		profilerSpec.device = m_Device;
+		profilerSpec.framesInFlight = m_Capabilites.maxFramesInFlight;
+		profilerSpec.queueFamilyIndices[GPU_QUEUE_GRAPHICS] = m_QueueFamilyIndices.graphicsIndex.value();
+		profilerSpec.queueFamilyIndices[GPU_QUEUE_TRANSFER] = m_QueueFamilyIndices.transferIndex.value();
+		profilerSpec.queues[GPU_QUEUE_GRAPHICS] = m_GraphicsQueue;
+		profilerSpec.queues[GPU_QUEUE_TRANSFER] = m_TransferQueue;
+		profilerSpec.hostQueryReset = m_HostQueryReset;
+		profilerSpec.calibratedTimestamps = m_CalibratedTimestamps;
+		if (m_GpuProfiler.Init(profilerSpec) != 0) {
+			return -1;
+		}
+	}
+	if (m_PipelineStatistics) {
+		VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+		queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.pNext = NULL;
+		queryPoolCreateInfo.flags = 0;
+		queryPoolCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		queryPoolCreateInfo.queryCount = RENDERER_PASS_COUNT;
+		// Results are written in bit order, matching the members of PipelineStatistics.
+		queryPoolCreateInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+												 VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+												 VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+												 VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+												 VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+												 VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+		m_PipelineStatisticsQueryPools.resize(m_Capabilites.maxFramesInFlight, VK_NULL_HANDLE);
+		m_PipelineStatisticsFrames.resize(m_Capabilites.maxFramesInFlight);
+		for (auto& queryPool : m_PipelineStatisticsQueryPools) {
+			result = vkCreateQueryPool(m_Device, &queryPoolCreateInfo, NULL, &queryPool);
+			if (result != VK_SUCCESS) {
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create pipeline statistics query pool.");
+				return -1;
+			}
+		}
 	}
 	{
 		auto image = m_AssetManager.LoadAsset<Image>("textures/SVT-ECG.jpg");
 		if (image == nullptr) {
 			return -1;
 		}
-		StagingBuffer stagingBuffer = this->CreateStagingBuffer(
-			image->width * image->height * 4);
-
 		m_ImageBuffer = this->CreateImageBuffer(image->width,
 												image->height,
-												IMAGE_FORMAT_R8G8B8A8_SRGB);
+												IMAGE_FORMAT_R8G8B8A8_SRGB,
+												true);
+
+		StagingBuffer stagingBuffer = this->CreateStagingBuffer(
+			CalculateMipChainSize(image->width, image->height,
+								  m_ImageBuffer.m_HostMipmaps ? m_ImageBuffer.m_MipLevels : 1, 1));
 
-		stagingBuffer.SetData(image->width * image->height * 4, 0, image->pixels);
+		stagingBuffer.SetImageData(m_ImageBuffer, 0, image->pixels);
 
 		stagingBuffer.TransferDataImmediate(m_ImageBuffer, 0, 0, image->width, image->height);
 		free(image->pixels);
@@ -2250,45 +2295,30 @@ int Renderer::Init()
 		skyboxStagingBuffer = StagingBuffer();
 
 
-		std::array<VkDescriptorSetLayoutBinding, 2> skyboxDescriptorSetLayoutBidnings;
-		skyboxDescriptorSetLayoutBidnings[0].binding = 0;
-		skyboxDescriptorSetLayoutBidnings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		skyboxDescriptorSetLayoutBidnings[0].descriptorCount = 1;
-		skyboxDescriptorSetLayoutBidnings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-		skyboxDescriptorSetLayoutBidnings[0].pImmutableSamplers = NULL;
-		skyboxDescriptorSetLayoutBidnings[1].binding = 1;
-		skyboxDescriptorSetLayoutBidnings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		skyboxDescriptorSetLayoutBidnings[1].descriptorCount = 1;
-		skyboxDescriptorSetLayoutBidnings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-		skyboxDescriptorSetLayoutBidnings[1].pImmutableSamplers = NULL;
-
-		VkDescriptorSetLayoutCreateInfo skyboxDescriptorSetLayoutCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.bindingCount = 2,
-			.pBindings = skyboxDescriptorSetLayoutBidnings.data(),
-		};
-
-		result = vkCreateDescriptorSetLayout(m_Device,
-											 &skyboxDescriptorSetLayoutCreateInfo,
-											 NULL,
-											 &m_SkyboxDescriptorSetLayout);
-		CEE_VERIFY(result == VK_SUCCESS, "Failed to create skybox descriptor set layout.");
-
-		std::array<VkDescriptorPoolSize, 2> skyboxDescriptorPoolSizes;
-		skyboxDescriptorPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		skyboxDescriptorPoolSizes[0].descriptorCount = m_Capabilites.maxFramesInFlight;
-		skyboxDescriptorPoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		skyboxDescriptorPoolSizes[1].descriptorCount = m_Capabilites.maxFramesInFlight;
+		std::vector<std::shared_ptr<ShaderBinary>> skyboxShaders;
+		for (auto& name : s_SkyboxShaderNames) {
+			skyboxShaders.push_back(LoadShader(name));
+		}
+		ShaderReflection skyboxReflection;
+		std::vector<VkDescriptorSetLayout> skyboxSetLayouts;
+		if (ReflectShaders(skyboxShaders, &skyboxReflection) != 0 ||
+			GetDescriptorSetLayouts(skyboxReflection, skyboxSetLayouts) != 0 || skyboxSetLayouts.size() != 1)
+		{
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to reflect skybox shaders.");
+			return -1;
+		}
+		m_SkyboxDescriptorSetLayout = skyboxSetLayouts[0];
 
+		std::vector<VkDescriptorPoolSize> skyboxDescriptorPoolSizes;
+		AddDescriptorPoolSizes(skyboxDescriptorPoolSizes, skyboxReflection.bindings, m_TextureTableSize,
+							   m_Capabilites.maxFramesInFlight);
 
 		VkDescriptorPoolCreateInfo skyboxDescriptorPoolCreateInfo = {
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
 			.pNext = NULL,
 			.flags = 0,
-			.maxSets = 2 * m_Capabilites.maxFramesInFlight,
-			.poolSizeCount = skyboxDescriptorPoolSizes.size(),
+			.maxSets = m_Capabilites.maxFramesInFlight,
+			.poolSizeCount = static_cast<uint32_t>(skyboxDescriptorPoolSizes.size()),
 			.pPoolSizes = skyboxDescriptorPoolSizes.data()
 		};
 
@@ -2311,28 +2341,12 @@ int Renderer::Init()
 										  m_SkyboxDescriptorSets.data());
 		CEE_VERIFY(result == VK_SUCCESS, "Failed to allocate skybox descriptor sets.");
 
-		VkSamplerCreateInfo skyboxSamplerCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.magFilter = VK_FILTER_LINEAR,
-			.minFilter = VK_FILTER_LINEAR,
-			.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
-			.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-			.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-			.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-			.mipLodBias = 0.0f,
-			.anisotropyEnable = VK_FALSE,
-			.maxAnisotropy = 0.0f,
-			.compareEnable = VK_FALSE,
-			.compareOp = VK_COMPARE_OP_NEVER,
-			.minLod = 1.0f,
-			.maxLod = 1.0f,
-			.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
-			.unnormalizedCoordinates = VK_FALSE
-		};
-		result = vkCreateSampler(m_Device, &skyboxSamplerCreateInfo, NULL, &m_SkyboxSampler);
-		CEE_VERIFY(result == VK_SUCCESS, "Failed to create sampler for skybox.");
+		SamplerSpec skyboxSamplerSpec;
+		skyboxSamplerSpec.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		skyboxSamplerSpec.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		skyboxSamplerSpec.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		m_SkyboxSampler = GetSampler(skyboxSamplerSpec);
+		CEE_VERIFY(m_SkyboxSampler != VK_NULL_HANDLE, "Failed to create sampler for skybox.");
 
 		VkPipelineLayoutCreateInfo skyboxPipelineLayoutCreateInfo = {
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
@@ -2340,8 +2354,8 @@ int Renderer::Init()
 			.flags = 0,
 			.setLayoutCount = 1,
 			.pSetLayouts = &m_SkyboxDescriptorSetLayout,
-			.pushConstantRangeCount = 0,
-			.pPushConstantRanges = NULL
+			.pushConstantRangeCount = static_cast<uint32_t>(skyboxReflection.pushConstants.size()),
+			.pPushConstantRanges = skyboxReflection.pushConstants.data()
 		};
 
 		result = vkCreatePipelineLayout(m_Device,
@@ -2350,201 +2364,6 @@ int Renderer::Init()
 										&m_SkyboxPipelineLayout);
 		CEE_VERIFY(result == VK_SUCCESS, "Failed to create pipeline layout for skybox");
 
-		VkShaderModule vertexShaderModule = VK_NULL_HANDLE, fragmentShaderModule = VK_NULL_HANDLE;
-		std::string skyboxVertexShaderFilePath = "shaders/renderer3DSkyboxVertex.spv";
-		std::string skyboxFragmentShaderFilePath = "shaders/renderer3DSkyboxFragment.spv";
-
-		auto skyboxVertexShaderCode = m_AssetManager.LoadAsset<ShaderBinary>(skyboxVertexShaderFilePath);
-		auto skyboxFragmentShaderCode = m_AssetManager.LoadAsset<ShaderBinary>(skyboxFragmentShaderFilePath);
-
-		vertexShaderModule = CreateShaderModule(m_Device, skyboxVertexShaderCode);
-		fragmentShaderModule = CreateShaderModule(m_Device, skyboxFragmentShaderCode);
-
-		skyboxVertexShaderCode.reset();
-		skyboxFragmentShaderCode.reset();
-
-		std::vector<VkPipelineShaderStageCreateInfo> skyboxPipelineShaderStageCrateInfos;
-		skyboxPipelineShaderStageCrateInfos.push_back({
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.stage = VK_SHADER_STAGE_VERTEX_BIT,
-			.module = vertexShaderModule,
-			.pName = "main",
-			.pSpecializationInfo = NULL
-		});
-		skyboxPipelineShaderStageCrateInfos.push_back({
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-			.module = fragmentShaderModule,
-			.pName = "main",
-			.pSpecializationInfo = NULL
-		});
-
-		VkVertexInputBindingDescription skyboxVertexBindingDescription = {
-			.binding = 0,
-			.stride = 12,
-			.inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-		};
-
-		VkVertexInputAttributeDescription skyboxVertexInputDescription = {
-			.location = 0,
-			.binding = 0,
-			.format = VK_FORMAT_R32G32B32_SFLOAT,
-			.offset = 0
-		};
-
-		VkPipelineVertexInputStateCreateInfo skyboxVertexInputStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.vertexBindingDescriptionCount = 1,
-			.pVertexBindingDescriptions = &skyboxVertexBindingDescription,
-			.vertexAttributeDescriptionCount = 1,
-			.pVertexAttributeDescriptions = &skyboxVertexInputDescription
-		};
-
-		VkPipelineInputAssemblyStateCreateInfo skyboxInputAssemblyStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-			.primitiveRestartEnable = VK_FALSE
-		};
-
-		VkViewport viewport = {
-			.x = 0.0f,
-			.y = 0.0f,
-			.width = static_cast<float>(m_SwapchainExtent.width),
-			.height = static_cast<float>(m_SwapchainExtent.height),
-			.minDepth = 0.0f,
-			.maxDepth = 1.0f
-		};
-		VkRect2D scissor = {
-			.offset = { 0u, 0u },
-			.extent = m_SwapchainExtent
-		};
-
-		VkPipelineViewportStateCreateInfo skyboxViewportStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.viewportCount = 1,
-			.pViewports = &viewport,
-			.scissorCount = 1,
-			.pScissors = &scissor
-		};
-
-		VkPipelineRasterizationStateCreateInfo skyboxRasterizationStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.depthClampEnable = VK_FALSE,
-			.rasterizerDiscardEnable = VK_FALSE,
-			.polygonMode = VK_POLYGON_MODE_FILL,
-			.cullMode = VK_CULL_MODE_NONE,
-			.frontFace = VK_FRONT_FACE_CLOCKWISE,
-			.depthBiasEnable = VK_FALSE,
-			.depthBiasConstantFactor = 0.0f,
-			.depthBiasClamp = 0.0f,
-			.depthBiasSlopeFactor = 0.0f,
-			.lineWidth = 1.0f
-		};
-
-		VkPipelineMultisampleStateCreateInfo skyboxMultisampleStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-			.sampleShadingEnable = VK_FALSE,
-			.minSampleShading = 1.0f,
-			.pSampleMask = NULL,
-			.alphaToCoverageEnable = VK_FALSE,
-			.alphaToOneEnable = VK_FALSE
-		};
-
-		VkPipelineDepthStencilStateCreateInfo skyboxDepthStencilStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.depthTestEnable = VK_TRUE,
-			.depthWriteEnable = VK_TRUE,
-			.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
-			.depthBoundsTestEnable = VK_FALSE,
-			.stencilTestEnable = VK_FALSE,
-			.front = {},
-			.back = {},
-			.minDepthBounds = 0.0f,
-			.maxDepthBounds = 0.0f
-		};
-
-		VkPipelineColorBlendAttachmentState skyboxColorBlendAttachmentState;
-		skyboxColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		skyboxColorBlendAttachmentState.blendEnable = VK_FALSE;
-		skyboxColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-		skyboxColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-		skyboxColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-		skyboxColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-		skyboxColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		skyboxColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-
-		VkPipelineColorBlendStateCreateInfo skyboxColorBlendStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.logicOpEnable = VK_FALSE,
-			.logicOp = VK_LOGIC_OP_COPY,
-			.attachmentCount = 1,
-			.pAttachments = &skyboxColorBlendAttachmentState,
-			.blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
-		};
-
-
-		VkDynamicState dynamicStates[] = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-
-		VkPipelineDynamicStateCreateInfo skyboxDynamicStateCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.dynamicStateCount = 2,
-			.pDynamicStates = dynamicStates
-		};
-
-		VkGraphicsPipelineCreateInfo skyboxPipelineCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-			.pNext = NULL,
-			.flags = 0,
-			.stageCount = static_cast<uint32_t>(skyboxPipelineShaderStageCrateInfos.size()),
-			.pStages = skyboxPipelineShaderStageCrateInfos.data(),
-			.pVertexInputState = &skyboxVertexInputStateCreateInfo,
-			.pInputAssemblyState = &skyboxInputAssemblyStateCreateInfo,
-			.pTessellationState = NULL,
-			.pViewportState = &skyboxViewportStateCreateInfo,
-			.pRasterizationState = &skyboxRasterizationStateCreateInfo,
-			.pMultisampleState = &skyboxMultisampleStateCreateInfo,
-			.pDepthStencilState = &skyboxDepthStencilStateCreateInfo,
-			.pColorBlendState = &skyboxColorBlendStateCreateInfo,
-			.pDynamicState = &skyboxDynamicStateCreateInfo,
-			.layout = m_SkyboxPipelineLayout,
-			.renderPass = m_RenderPass,
-			.subpass = 0,
-			.basePipelineHandle = NULL,
-			.basePipelineIndex = 0
-		};
-		result = vkCreateGraphicsPipelines(m_Device,
-										   m_PipelineCache,
-										   1,
-										   &skyboxPipelineCreateInfo,
-										   NULL,
-										   &m_SkyboxPipeline);
-		CEE_VERIFY(result == VK_SUCCESS, "Failed to create pipeline for skybox.");
-
 		VkDescriptorBufferInfo uniformDescriptor = {
 			.buffer = m_SkyboxUniformBuffer.m_Buffer,
 			.offset = 0,
@@ -2583,8 +2402,6 @@ int Renderer::Init()
 			};
 			vkUpdateDescriptorSets(m_Device, 2, writeDescriptorSets, 0, NULL);
 		}
-		vkDestroyShaderModule(m_Device, vertexShaderModule, NULL);
-		vkDestroyShaderModule(m_Device, fragmentShaderModule, NULL);
 
 		VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
 			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -2599,6 +2416,50 @@ int Renderer::Init()
 										  m_SkyboxDrawCommandBuffers.data());
 		CEE_VERIFY(result == VK_SUCCESS, "Failed to allocate skybox command buffers.");
 	}
+	{
+		// Compiling pipelines dominates startup on a cold cache. The skybox pipeline is
+		// built alongside the main pipeline variants, which are spread over worker threads too.
+		m_MainPipelineDescription = {};
+		if (m_Capabilites.rendererMode == RENDERER_MODE_2D) {
+			m_MainPipelineDescription.vertexShader = "renderer2DQuadVertex";
+			m_MainPipelineDescription.fragmentShader = "renderer2DQuadFragment";
+			if (m_PackedVertices) {
+				m_MainPipelineDescription.vertexFormats = s_Packed2DVertexFormats;
+			}
+		} else {
+			m_MainPipelineDescription.vertexShader = m_PackedVertices ? "renderer3DBasicPackedVertex" : "renderer3DBasicVertex";
+			m_MainPipelineDescription.fragmentShader = "renderer3DBasicFragment";
+			if (m_PackedVertices) {
+				m_MainPipelineDescription.vertexFormats = s_Packed3DVertexFormats;
+			}
+		}
+		PipelineDescription wireframePipelineDescription = m_MainPipelineDescription;
+		wireframePipelineDescription.polygonMode = VK_POLYGON_MODE_LINE;
+		wireframePipelineDescription.cullMode = VK_CULL_MODE_NONE;
+
+		int skyboxResult = -1;
+		std::thread skyboxThread([&]() {
+			skyboxResult = CreateSkyboxPipeline(m_SwapchainExtent, &m_SkyboxPipeline);
+		});
+		int mainResult = PrecompilePipelines({ m_MainPipelineDescription, wireframePipelineDescription });
+		skyboxThread.join();
+		if (mainResult != 0 || skyboxResult != 0) {
+			return -1;
+		}
+		m_ActivePipeline = GetPipeline(m_MainPipelineDescription);
+		if (m_ActivePipeline == VK_NULL_HANDLE) {
+			return -1;
+		}
+	}
+	if (m_BuildDepthPyramid) {
+		if (PrecompileComputePipeline("rendererDepthPyramidCompute") != 0) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Failed to build the depth pyramid pipeline, disabling occlusion culling.");
+			m_BuildDepthPyramid = false;
+		} else if (CreateDepthPyramid() != 0) {
+			return -1;
+		}
+	}
 	{
 		VkDescriptorBufferInfo bufferInfo = {};
 		bufferInfo.buffer = m_UniformBuffer.m_Buffer;
@@ -2606,49 +2467,14 @@ int Renderer::Init()
 		bufferInfo.range = VK_WHOLE_SIZE;
 
 
-		VkDescriptorImageInfo SVTImageInfo = {};
-		SVTImageInfo.sampler = VK_NULL_HANDLE;
-		SVTImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		SVTImageInfo.imageView = m_ImageBuffer.m_ImageView;
-
-		VkDescriptorImageInfo defImageInfo = {};
-		defImageInfo.sampler = VK_NULL_HANDLE;
-		defImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		defImageInfo.imageView = m_ImageBuffer.m_ImageView;
-
-		std::array<VkDescriptorImageInfo, 32> imageInfos;
-		imageInfos[0] = SVTImageInfo;
-		imageInfos[1] = defImageInfo;
-		imageInfos[2] = defImageInfo;
-		imageInfos[3] = defImageInfo;
-		imageInfos[4] = defImageInfo;
-		imageInfos[5] = defImageInfo;
-		imageInfos[6] = defImageInfo;
-		imageInfos[7] = defImageInfo;
-		imageInfos[8] = defImageInfo;
-		imageInfos[9] = defImageInfo;
-		imageInfos[10] = defImageInfo;
-		imageInfos[11] = defImageInfo;
-		imageInfos[12] = defImageInfo;
-		imageInfos[13] = defImageInfo;
-		imageInfos[14] = defImageInfo;
-		imageInfos[15] = defImageInfo;
-		imageInfos[16] = defImageInfo;
-		imageInfos[17] = defImageInfo;
-		imageInfos[18] = defImageInfo;
-		imageInfos[19] = defImageInfo;
-		imageInfos[20] = defImageInfo;
-		imageInfos[21] = defImageInfo;
-		imageInfos[22] = defImageInfo;
-		imageInfos[23] = defImageInfo;
-		imageInfos[24] = defImageInfo;
-		imageInfos[25] = defImageInfo;
-		imageInfos[26] = defImageInfo;
-		imageInfos[27] = defImageInfo;
-		imageInfos[28] = defImageInfo;
-		imageInfos[29] = defImageInfo;
-		imageInfos[30] = defImageInfo;
-		imageInfos[31] = defImageInfo;
+		VkDescriptorImageInfo defaultImageInfo = {};
+		defaultImageInfo.sampler = VK_NULL_HANDLE;
+		defaultImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		defaultImageInfo.imageView = m_ImageBuffer.m_ImageView;
+		std::vector<VkDescriptorImageInfo> defaultImageInfos;
+		if (!m_DescriptorIndexing) {
+			defaultImageInfos.resize(m_TextureTableSize, defaultImageInfo);
+		}
 
 		VkDescriptorImageInfo samplerInfo = {};
 		samplerInfo.sampler = m_Sampler;
@@ -2684,39 +2510,81 @@ int Renderer::Init()
 			writeDescriptorSet.pBufferInfo = NULL;
 			writeDescriptorSet.pTexelBufferView = NULL;
 			writeDescriptorSets.push_back(writeDescriptorSet);
-			writeDescriptorSet.descriptorCount = imageInfos.size();
-			writeDescriptorSet.dstArrayElement = 0;
-			writeDescriptorSet.dstBinding = 1;
-			writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			writeDescriptorSet.pImageInfo = imageInfos.data();
-			writeDescriptorSets.push_back(writeDescriptorSet);
+			// Without partially bound descriptors every slot has to be valid.
+			if (!m_DescriptorIndexing) {
+				writeDescriptorSet.descriptorCount = defaultImageInfos.size();
+				writeDescriptorSet.dstArrayElement = 0;
+				writeDescriptorSet.dstBinding = 1;
+				writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				writeDescriptorSet.pImageInfo = defaultImageInfos.data();
+				writeDescriptorSets.push_back(writeDescriptorSet);
+			}
 
 			vkUpdateDescriptorSets(m_Device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, NULL);
 			writeDescriptorSets.clear();
 		}
+
+		m_TextureTableWrites.resize(m_Capabilites.maxFramesInFlight);
+		m_ReleasedTextureHandles.resize(m_Capabilites.maxFramesInFlight);
+		m_DefaultTexture = RegisterTexture(m_ImageBuffer);
 		{
 			m_QueuedSubmits.resize(3);
 		}
 	}
+	if (m_EnableShaderHotReload) {
+		if (!ShaderCompiler::IsAvailable()) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Shader hot reload requires runtime shader compilation, disabling it.");
+		} else if (m_ShaderWatcher.Watch(m_AssetManager.GetAssetRoot() / "shaders/src") != 0) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to watch shader sources, disabling hot reload.");
+		}
+	}
 
 	return 0;
 }
 
 void Renderer::Shutdown()
 {
+	if (m_PipelineRebuildThread.joinable()) {
+		m_PipelineRebuildThread.join();
+		for (auto& pipeline : m_PipelineRebuild.pipelines) {
+			vkDestroyPipeline(m_Device, pipeline, NULL);
+		}
+		vkDestroyPipeline(m_Device, m_PipelineRebuild.skyboxPipeline, NULL);
+	}
+	for (auto& retired : m_RetiredPipelines) {
+		vkDestroyPipeline(m_Device, retired.pipeline, NULL);
+	}
+	m_RetiredPipelines.clear();
 	m_ImageBuffer = ImageBuffer();
 	m_UniformStagingBuffer = StagingBuffer();
 	m_UniformBuffer = UniformBuffer();
 	m_Skybox = CubeMapBuffer();
 	m_SkyboxUniformBuffer = UniformBuffer();
 	m_SkyboxVertexBuffer = VertexBuffer();
-	vkDestroySampler(m_Device, m_SkyboxSampler, NULL);
 	vkDestroyPipeline(m_Device, m_SkyboxPipeline, NULL);
 	vkDestroyPipelineLayout(m_Device, m_SkyboxPipelineLayout, NULL);
 	vkDestroyDescriptorPool(m_Device, m_SkyboxDesriptorPool, NULL);
-	vkDestroyDescriptorSetLayout(m_Device, m_SkyboxDescriptorSetLayout, NULL);
 	vkFreeCommandBuffers(m_Device, m_GraphicsCmdPool, m_SkyboxDrawCommandBuffers.size(), m_SkyboxDrawCommandBuffers.data());
 	m_Running.store(false, std::memory_order_relaxed);
+	vkDeviceWaitIdle(m_Device);
+	m_GpuProfiler.Shutdown();
+	for (auto& queryPool : m_PipelineStatisticsQueryPools) {
+		vkDestroyQueryPool(m_Device, queryPool, NULL);
+	}
+	m_PipelineStatisticsQueryPools.clear();
+	m_PipelineStatisticsFrames.clear();
+	for (uint32_t i = 0; i < m_FrameReadbackSlots.size(); i++) {
+		// A frame that was recorded but never submitted has nothing to deliver.
+		if (vkGetFenceStatus(m_Device, m_InFlightFences[i]) == VK_SUCCESS) {
+			DeliverFrameReadback(i);
+		}
+		if (m_FrameReadbackSlots[i].buffer != VK_NULL_HANDLE) {
+			vkDestroyBuffer(m_Device, m_FrameReadbackSlots[i].buffer, NULL);
+			vkFreeMemory(m_Device, m_FrameReadbackSlots[i].memory, NULL);
+		}
+	}
+	m_FrameReadbackSlots.clear();
 	for (auto& fence : m_TransferQueueFences) {
 		vkDestroyFence(m_Device, fence, NULL);
 	}
@@ -2738,22 +2606,46 @@ void Renderer::Shutdown()
 	for (auto& framebuffer : m_Framebuffers) {
 		vkDestroyFramebuffer(m_Device, framebuffer, NULL);
 	}
-	for (auto& pipeline : m_PipelineMap) {
+	for (auto& pipeline : m_Pipelines) {
 		vkDestroyPipeline(m_Device, pipeline.second, NULL);
 	}
+	m_Pipelines.clear();
+	SavePipelineCache();
 	vkDestroyPipelineCache(m_Device, m_PipelineCache, NULL);
 	vkDestroyPipelineLayout(m_Device, m_PipelineLayout, NULL);
-	vkDestroySampler(m_Device, m_Sampler, NULL);
+	for (auto& computePipeline : m_ComputePipelines) {
+		vkDestroyPipeline(m_Device, computePipeline.second.pipeline, NULL);
+		vkDestroyPipelineLayout(m_Device, computePipeline.second.layout, NULL);
+	}
+	m_ComputePipelines.clear();
+	for (auto& descriptorPool : m_ComputeDescriptorPools) {
+		vkDestroyDescriptorPool(m_Device, descriptorPool, NULL);
+	}
+	m_ComputeDescriptorPools.clear();
+	for (auto& sampler : m_SamplerCache) {
+		vkDestroySampler(m_Device, sampler.second, NULL);
+	}
+	m_SamplerCache.clear();
 	vkDestroyDescriptorPool(m_Device, m_DescriptorPool, NULL);
-	vkDestroyDescriptorSetLayout(m_Device, m_ImageDescriptorSetLayout, NULL);
-	vkDestroyDescriptorSetLayout(m_Device, m_UniformDescriptorSetLayout, NULL);
-	vkDestroyRenderPass(m_Device, m_RenderPass, NULL);
-	for (auto& imageView : m_SwapchainImageViews) {
-		vkDestroyImageView(m_Device, imageView, NULL);
+	for (auto& descriptorSetLayout : m_DescriptorSetLayoutCache) {
+		vkDestroyDescriptorSetLayout(m_Device, descriptorSetLayout.second, NULL);
 	}
+	m_DescriptorSetLayoutCache.clear();
+	vkDestroyRenderPass(m_Device, m_RenderPass, NULL);
+	DestroyDepthPyramid();
 	m_DepthImage = ImageBuffer();
-	vkDestroySwapchainKHR(m_Device, m_Swapchain, NULL);
-	vkDestroySurfaceKHR(m_Instance, m_Surface, NULL);
+	if (m_Headless) {
+		// The offscreen targets own the images and views.
+		m_OffscreenTargets.clear();
+	} else {
+		for (auto& imageView : m_SwapchainImageViews) {
+			vkDestroyImageView(m_Device, imageView, NULL);
+		}
+		vkDestroySwapchainKHR(m_Device, m_Swapchain, NULL);
+		vkDestroySurfaceKHR(m_Instance, m_Surface, NULL);
+	}
+	m_SwapchainImageViews.clear();
+	m_SwapchainImages.clear();
 	vkDestroyDevice(m_Device, NULL);
 #ifndef NDEBUG
 	PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerEXTfn =
@@ -2776,33 +2668,46 @@ int Renderer::StartFrame() {
 		InvalidateSwapchain();
 	}
 
-	try {
-		m_ActivePipeline = m_PipelineMap.at(RENDERER_PIPELINE_FLAG_3D);
-	} catch (std::out_of_range& e) {
-		m_ActivePipeline = m_PipelineMap[0];
+	UpdateShaderHotReload();
+
+	// Picks up the pipeline rebuilt by a shader reload. If the main description fails to
+	// build, the last valid pipeline stays bound, GetPipeline() has reported the failure.
+	VkPipeline mainPipeline = GetPipeline(m_MainPipelineDescription);
+	if (mainPipeline != VK_NULL_HANDLE) {
+		m_ActivePipeline = mainPipeline;
 	}
 
 	VkFence waitFences[] = {
 		m_InFlightFences[m_FrameIndex]
 	};
 	vkWaitForFences(m_Device, 1, waitFences, VK_TRUE, UINT64_MAX);
+	vkResetDescriptorPool(m_Device, m_ComputeDescriptorPools[m_FrameIndex], 0);
+	FlushTextureTableWrites();
+	DestroyRetiredPipelines();
+	DeliverFrameReadback(m_FrameIndex);
+	m_GpuProfiler.BeginFrame(m_FrameIndex, m_FrameNumber);
+	ResolvePipelineStatistics(m_FrameIndex);
+	if (m_Headless) {
+		m_ImageIndex = m_FrameIndex;
+	} else {
 retryAqurireNextImage:
-	result = vkAcquireNextImageKHR(m_Device,
-								   m_Swapchain,
-								   UINT64_MAX,
-								   m_ImageAvailableSemaphores[m_FrameIndex],
-								   VK_NULL_HANDLE,
-								   &m_ImageIndex);
-	if (result == VK_SUBOPTIMAL_KHR) {
-		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO,
-										 "Suboptimal KHR... Will recreate swapchain before next frame.");
-		m_RecreateSwapchain = true;
-	} else if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-		InvalidateSwapchain();
-		goto retryAqurireNextImage;
-	} else if (result != VK_SUCCESS) {
-		m_RecreateSwapchain = true;
-		return -1;
+		result = vkAcquireNextImageKHR(m_Device,
+									   m_Swapchain,
+									   UINT64_MAX,
+									   m_ImageAvailableSemaphores[m_FrameIndex],
+									   VK_NULL_HANDLE,
+									   &m_ImageIndex);
+		if (result == VK_SUBOPTIMAL_KHR) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO,
+											 "Suboptimal KHR... Will recreate swapchain before next frame.");
+			m_RecreateSwapchain = true;
+		} else if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			InvalidateSwapchain();
+			goto retryAqurireNextImage;
+		} else if (result != VK_SUCCESS) {
+			m_RecreateSwapchain = true;
+			return -1;
+		}
 	}
 
 	vkResetFences(m_Device, 1, waitFences);
@@ -2831,9 +2736,17 @@ retryAqurireNextImage:
 			result = vkBeginCommandBuffer(m_SkyboxDrawCommandBuffers[m_FrameIndex], &beginInfo);
 			CEE_VERIFY(result == VK_SUCCESS, "Failed to begin command buffer for drawing skybox.");
 
+			GpuZone skyboxZone = m_GpuProfiler.BeginZone(m_SkyboxDrawCommandBuffers[m_FrameIndex],
+														GPU_QUEUE_GRAPHICS, "Skybox");
+			if (m_PipelineStatistics) {
+				vkCmdBeginQuery(m_SkyboxDrawCommandBuffers[m_FrameIndex], m_PipelineStatisticsQueryPools[m_FrameIndex],
+								RENDERER_PASS_SKYBOX, 0);
+			}
+
 			vkCmdBindPipeline(m_SkyboxDrawCommandBuffers[m_FrameIndex],
 							  VK_PIPELINE_BIND_POINT_GRAPHICS,
 							  m_SkyboxPipeline);
+			m_Statistics.pipelineBinds++;
 
 			VkViewport viewport = {
 				.x = 0,
@@ -2870,6 +2783,16 @@ retryAqurireNextImage:
 
 			vkCmdDraw(m_SkyboxDrawCommandBuffers[m_FrameIndex],
 					  6, 1, 0, 0);
+			m_Statistics.drawCalls++;
+			m_Statistics.instances++;
+			m_Statistics.vertices += 6;
+			m_Statistics.triangles += 2;
+
+			if (m_PipelineStatistics) {
+				vkCmdEndQuery(m_SkyboxDrawCommandBuffers[m_FrameIndex], m_PipelineStatisticsQueryPools[m_FrameIndex],
+							  RENDERER_PASS_SKYBOX);
+			}
+			m_GpuProfiler.EndZone(skyboxZone);
 
 			result = vkEndCommandBuffer(m_SkyboxDrawCommandBuffers[m_FrameIndex]);
 			CEE_VERIFY(result == VK_SUCCESS, "Failed to record command buffer for skybox");
@@ -2899,6 +2822,14 @@ retryAqurireNextImage:
 			result = vkBeginCommandBuffer(m_GeomertyDrawCmdBuffers[m_FrameIndex], &beginInfo);
 			CEE_VERIFY(result == VK_SUCCESS, "Failed to begin command buffer for drawing skybox.");
 
+		// Ended in EndFrame() once every draw has been recorded.
+		m_GeometryGpuZone = m_GpuProfiler.BeginZone(m_GeomertyDrawCmdBuffers[m_FrameIndex],
+													 GPU_QUEUE_GRAPHICS, "Geometry");
+		if (m_PipelineStatistics) {
+			vkCmdBeginQuery(m_GeomertyDrawCmdBuffers[m_FrameIndex], m_PipelineStatisticsQueryPools[m_FrameIndex],
+							RENDERER_PASS_GEOMETRY, 0);
+		}
+
 		std::array<VkDescriptorSet, 2> descriptorSets = {
 			m_UniformDescriptorSets[m_FrameIndex],
 			m_ImageDescriptorSets[m_FrameIndex]
@@ -2910,7 +2841,10 @@ retryAqurireNextImage:
 								descriptorSets.size(),
 								descriptorSets.data(),
 								0, NULL);
-		vkCmdBindPipeline(m_GeomertyDrawCmdBuffers[m_FrameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline);
+		if (m_ActivePipeline != VK_NULL_HANDLE) {
+			vkCmdBindPipeline(m_GeomertyDrawCmdBuffers[m_FrameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline);
+			m_Statistics.pipelineBinds++;
+		}
 
 		VkViewport viewport = {};
 		viewport.x = 0;
@@ -2943,30 +2877,15 @@ retryAqurireNextImage:
 		return -1;
 	}
 
-	std::array<VkClearValue, 2> clearValues;
-	memcpy(clearValues[0].color.float32, glm::value_ptr(m_ClearColor), sizeof(glm::vec4));
-	clearValues[1].depthStencil = { 1.0f, 0 };
-
-	VkRenderPassBeginInfo renderPassBeginInfo = {};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.pNext = NULL;
-	renderPassBeginInfo.framebuffer = m_Framebuffers[m_ImageIndex];
-	renderPassBeginInfo.renderPass = m_RenderPass;
-	renderPassBeginInfo.renderArea.offset = { 0, 0 };
-	renderPassBeginInfo.renderArea.extent = m_SwapchainExtent;
-	renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-	renderPassBeginInfo.pClearValues = clearValues.data();
-	vkCmdBeginRenderPass(m_DrawCmdBuffers[m_FrameIndex],
-						 &renderPassBeginInfo,
-						 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
-
-	std::array<VkCommandBuffer, 1> SecondaryCommandBuffers = {
-		m_SkyboxDrawCommandBuffers[m_FrameIndex]
-	};
-	vkCmdExecuteCommands(m_DrawCmdBuffers[m_FrameIndex],
-						SecondaryCommandBuffers.size(),
-						SecondaryCommandBuffers.data());
-
+	// Tracy's queries are reset here, outside the render pass.
+	m_GpuProfiler.CollectTracyZones(m_DrawCmdBuffers[m_FrameIndex]);
+	m_FrameGpuZone = m_GpuProfiler.BeginZone(m_DrawCmdBuffers[m_FrameIndex], GPU_QUEUE_GRAPHICS, "Frame");
+	if (m_PipelineStatistics) {
+		// Reset before the render pass whose secondaries write the queries.
+		vkCmdResetQueryPool(m_DrawCmdBuffers[m_FrameIndex], m_PipelineStatisticsQueryPools[m_FrameIndex],
+							0, RENDERER_PASS_COUNT);
+		m_PipelineStatisticsFrames[m_FrameIndex] = m_FrameNumber;
+	}
 
 	return 0;
 }
@@ -2978,6 +2897,38 @@ int Renderer::EndFrame() {
 	FlushQueuedSubmits();
 
 	{
+		// Begun here rather than in StartFrame() so the fills and dispatches recorded
+		// during the frame land ahead of it in the primary command buffer.
+		std::array<VkClearValue, 2> clearValues;
+		memcpy(clearValues[0].color.float32, glm::value_ptr(m_ClearColor), sizeof(glm::vec4));
+		clearValues[1].depthStencil = { 1.0f, 0 };
+
+		VkRenderPassBeginInfo renderPassBeginInfo = {};
+		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.pNext = NULL;
+		renderPassBeginInfo.framebuffer = m_Framebuffers[m_ImageIndex];
+		renderPassBeginInfo.renderPass = m_RenderPass;
+		renderPassBeginInfo.renderArea.offset = { 0, 0 };
+		renderPassBeginInfo.renderArea.extent = m_SwapchainExtent;
+		renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+		renderPassBeginInfo.pClearValues = clearValues.data();
+		vkCmdBeginRenderPass(m_DrawCmdBuffers[m_FrameIndex],
+							 &renderPassBeginInfo,
+							 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		std::array<VkCommandBuffer, 1> SecondaryCommandBuffers = {
+			m_SkyboxDrawCommandBuffers[m_FrameIndex]
+		};
+		vkCmdExecuteCommands(m_DrawCmdBuffers[m_FrameIndex],
+							SecondaryCommandBuffers.size(),
+							SecondaryCommandBuffers.data());
+	}
+	{
+		if (m_PipelineStatistics) {
+			vkCmdEndQuery(m_GeomertyDrawCmdBuffers[m_FrameIndex], m_PipelineStatisticsQueryPools[m_FrameIndex],
+						  RENDERER_PASS_GEOMETRY);
+		}
+		m_GpuProfiler.EndZone(m_GeometryGpuZone);
 		vkEndCommandBuffer(m_GeomertyDrawCmdBuffers[m_FrameIndex]);
 
 		std::array<VkCommandBuffer, 1> SecondaryCommandBuffers = {
@@ -2991,6 +2942,13 @@ int Renderer::EndFrame() {
 		ZoneScoped;
 		ZoneNamed(EndFrameResources, true);
 		vkCmdEndRenderPass(m_DrawCmdBuffers[m_FrameIndex]);
+		if (m_BuildDepthPyramid) {
+			RecordDepthPyramid(m_DrawCmdBuffers[m_FrameIndex]);
+		}
+		m_GpuProfiler.EndZone(m_FrameGpuZone);
+		if (m_RequestedFrameReadback) {
+			RecordFrameReadback(m_DrawCmdBuffers[m_FrameIndex]);
+		}
 
 		vkEndCommandBuffer(m_DrawCmdBuffers[m_FrameIndex]);
 	}
@@ -3021,14 +2979,20 @@ int Renderer::EndFrame() {
 		commandBufferSubmitInfo.waitSemaphoreCount = sizeof(commandBufferWaitSemaphores)/sizeof(commandBufferWaitSemaphores[0]);
 		commandBufferSubmitInfo.pWaitSemaphores = commandBufferWaitSemaphores;
 		commandBufferSubmitInfo.pWaitDstStageMask = commandBufferWaitStages;
+		if (m_Headless) {
+			// Nothing acquires or presents, the in flight fence is all that is waited on.
+			commandBufferSubmitInfo.signalSemaphoreCount = 0;
+			commandBufferSubmitInfo.waitSemaphoreCount = 0;
+		}
 
 		result = vkQueueSubmit(m_GraphicsQueue, 1, &commandBufferSubmitInfo, m_InFlightFences[m_FrameIndex]);
 		if (result != VK_SUCCESS) {
 			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
 											"Failed to submit geometry command buffer to graphics queue.");
 		}
+		m_LastImageIndex = m_ImageIndex;
 	}
-	{
+	if (!m_Headless) {
 		ZoneScoped;
 		ZoneNamed(PresentSubmit, true);
 		VkSemaphore presentWaitSemaphores[] = {
@@ -3056,34 +3020,607 @@ int Renderer::EndFrame() {
 		}
 	}
 
+	PublishStatistics();
+
 	if (++m_FrameIndex >= m_Capabilites.maxFramesInFlight)
 		m_FrameIndex = 0;
+	m_FrameNumber++;
 
 	FrameMark;
 
 	return 0;
 }
 
-int Renderer::Draw(const IndexBuffer& indexBuffer, const VertexBuffer& vertexBuffer, uint32_t indexCount) {
+int Renderer::ReadbackFrame(std::vector<uint8_t>& pixels, VkExtent2D* extent) {
 	ZoneScoped;
+	if (!m_Headless) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Frames can only be read back in headless mode.");
+		return -1;
+	}
+	if (!m_LastImageIndex.has_value()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "No frame to read back.");
+		return -1;
+	}
+	uint32_t imageIndex = m_LastImageIndex.value();
+	VkExtent2D frameExtent = m_SwapchainExtent;
+	VkDeviceSize size = (VkDeviceSize)frameExtent.width * frameExtent.height * 4;
 
-	vkCmdBindIndexBuffer(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexBuffer.m_Buffer, 0, VK_INDEX_TYPE_UINT32);
-	size_t offset = 0;
-	vkCmdBindVertexBuffers(m_GeomertyDrawCmdBuffers[m_FrameIndex], 0, 1, &vertexBuffer.m_Buffer, &offset);
+	// The frame's fence is not reset until its slot is reused, so it is safe to wait on here.
+	VkResult result = vkWaitForFences(m_Device, 1, &m_InFlightFences[imageIndex], VK_TRUE, UINT64_MAX);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to wait for frame to read back.");
+		return -1;
+	}
 
-	vkCmdDrawIndexed(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexCount, 1, 0, 0, 0);
+	VkBuffer readbackBuffer;
+	VkDeviceMemory readbackMemory;
+	if (CreateCommonBuffer(readbackBuffer, readbackMemory,
+						   VK_BUFFER_USAGE_TRANSFER_DST_BIT, size,
+						   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		return -1;
+	}
+
+	VkImage image = m_SwapchainImages[imageIndex];
+	result = ImmediateSubmit([image, frameExtent, readbackBuffer](RawCommandBuffer& cmdBuffer){
+		// The render pass left the image in TRANSFER_SRC_OPTIMAL, only the color writes
+		// of the frame need to be made visible to the copy.
+		VkImageMemoryBarrier imageBarrier = {};
+		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarrier.pNext = NULL;
+		imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.image = image;
+		imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCmdPipelineBarrier(cmdBuffer.commandBuffer,
+							 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+
+		VkBufferImageCopy region = {};
+		region.bufferOffset = 0;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { frameExtent.width, frameExtent.height, 1 };
+		vkCmdCopyImageToBuffer(cmdBuffer.commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							   readbackBuffer, 1, &region);
+
+		VkBufferMemoryBarrier bufferBarrier = {};
+		bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		bufferBarrier.pNext = NULL;
+		bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.buffer = readbackBuffer;
+		bufferBarrier.offset = 0;
+		bufferBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(cmdBuffer.commandBuffer,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_HOST_BIT,
+							 0, 0, NULL, 1, &bufferBarrier, 0, NULL);
+	}, QUEUE_GRAPHICS);
+
+	void* mappedMemory = NULL;
+	if (result == VK_SUCCESS) {
+		result = vkMapMemory(m_Device, readbackMemory, 0, size, 0, &mappedMemory);
+	}
+	if (result == VK_SUCCESS) {
+		pixels.resize(size);
+		memcpy(pixels.data(), mappedMemory, size);
+		vkUnmapMemory(m_Device, readbackMemory);
+		if (extent != NULL) {
+			*extent = frameExtent;
+		}
+	} else {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to read back frame.");
+	}
+
+	vkDestroyBuffer(m_Device, readbackBuffer, NULL);
+	vkFreeMemory(m_Device, readbackMemory, NULL);
 
+	return result == VK_SUCCESS ? 0 : -1;
+}
+
+int Renderer::RequestFrameReadback(FrameReadbackCallback callback) {
+	if (!m_SwapchainTransferSrc) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Swapchain images cannot be copied from, frame readback unavailable.");
+		return -1;
+	}
+	if (m_RequestedFrameReadback) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Frame readback already requested for this frame.");
+		return -1;
+	}
+	m_RequestedFrameReadback = std::move(callback);
 	return 0;
 }
 
-int Renderer::UpdateCamera(Camera& camera) {
+void Renderer::RecordFrameReadback(VkCommandBuffer commandBuffer) {
 	ZoneScoped;
+	FrameReadbackSlot& slot = m_FrameReadbackSlots[m_FrameIndex];
+	VkDeviceSize size = (VkDeviceSize)m_SwapchainExtent.width * m_SwapchainExtent.height * 4;
+
+	if (slot.buffer != VK_NULL_HANDLE && slot.size < size) {
+		// The swapchain grew since the slot was last used.
+		vkDestroyBuffer(m_Device, slot.buffer, NULL);
+		vkFreeMemory(m_Device, slot.memory, NULL);
+		slot.buffer = VK_NULL_HANDLE;
+	}
+	if (slot.buffer == VK_NULL_HANDLE) {
+		// Reading uncached memory on the CPU is several times slower, prefer cached memory
+		// and invalidate it before reading since it may not be coherent.
+		VkMemoryPropertyFlags cachedFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		bool cached = false;
+		for (uint32_t i = 0; i < m_PhysicalDeviceMemoryProperties.memoryTypeCount; i++) {
+			if ((m_PhysicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & cachedFlags) == cachedFlags) {
+				cached = true;
+				break;
+			}
+		}
+		VkMemoryPropertyFlags memoryPropertyFlags = cached ? cachedFlags :
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-	VkFence WaitFences[] = { m_InFlightFences[m_FrameIndex] };
-	vkWaitForFences(m_Device, 1, WaitFences, VK_TRUE, UINT64_MAX);
+		if (CreateCommonBuffer(slot.buffer, slot.memory, VK_BUFFER_USAGE_TRANSFER_DST_BIT, size, memoryPropertyFlags)) {
+			slot.buffer = VK_NULL_HANDLE;
+			m_RequestedFrameReadback = nullptr;
+			return;
+		}
+		if (vkMapMemory(m_Device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mappedMemory) != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to map frame readback buffer.");
+			vkDestroyBuffer(m_Device, slot.buffer, NULL);
+			vkFreeMemory(m_Device, slot.memory, NULL);
+			slot.buffer = VK_NULL_HANDLE;
+			m_RequestedFrameReadback = nullptr;
+			return;
+		}
+		slot.size = size;
+		slot.hostCoherent = !cached;
+	}
 
-	m_UniformStagingBuffer.SetData(sizeof(glm::mat4), 0, glm::value_ptr(camera.GetTransform()));
-	m_UniformStagingBuffer.SetData(sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(camera.GetProjection()));
+	VkImage image = m_SwapchainImages[m_ImageIndex];
+	VkImageSubresourceRange subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	// The render pass leaves offscreen targets in TRANSFER_SRC_OPTIMAL already.
+	if (!m_Headless) {
+		VkImageMemoryBarrier imageBarrier = {};
+		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarrier.pNext = NULL;
+		imageBarrier.srcAccessMask = 0;
+		imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.image = image;
+		imageBarrier.subresourceRange = subresourceRange;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+	}
+
+	VkBufferImageCopy region = {};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { m_SwapchainExtent.width, m_SwapchainExtent.height, 1 };
+	vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+	if (!m_Headless) {
+		VkImageMemoryBarrier imageBarrier = {};
+		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarrier.pNext = NULL;
+		imageBarrier.srcAccessMask = 0;
+		imageBarrier.dstAccessMask = 0;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.image = image;
+		imageBarrier.subresourceRange = subresourceRange;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+							 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+	}
+
+	VkBufferMemoryBarrier bufferBarrier = {};
+	bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	bufferBarrier.pNext = NULL;
+	bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.buffer = slot.buffer;
+	bufferBarrier.offset = 0;
+	bufferBarrier.size = size;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+						 0, 0, NULL, 1, &bufferBarrier, 0, NULL);
+
+	slot.callback = std::move(m_RequestedFrameReadback);
+	m_RequestedFrameReadback = nullptr;
+	slot.frameNumber = m_FrameNumber;
+	slot.extent = m_SwapchainExtent;
+	slot.format = m_SwapchainImageFormat;
+}
+
+void Renderer::DeliverFrameReadback(uint32_t frameIndex) {
+	FrameReadbackSlot& slot = m_FrameReadbackSlots[frameIndex];
+	if (!slot.callback) {
+		return;
+	}
+	ZoneScoped;
+
+	VkDeviceSize size = (VkDeviceSize)slot.extent.width * slot.extent.height * 4;
+	if (!slot.hostCoherent) {
+		VkMappedMemoryRange range = {};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.pNext = NULL;
+		range.memory = slot.memory;
+		range.offset = 0;
+		range.size = VK_WHOLE_SIZE;
+		vkInvalidateMappedMemoryRanges(m_Device, 1, &range);
+	}
+
+	FrameReadback readback = {};
+	readback.frameNumber = slot.frameNumber;
+	readback.extent = slot.extent;
+	readback.format = slot.format;
+	readback.pixels = static_cast<const uint8_t*>(slot.mappedMemory);
+	readback.size = size;
+
+	// Cleared first so the callback can request another readback.
+	FrameReadbackCallback callback = std::move(slot.callback);
+	slot.callback = nullptr;
+	callback(readback);
+}
+
+void Renderer::ResolvePipelineStatistics(uint32_t frameIndex) {
+	if (!m_PipelineStatistics || !m_PipelineStatisticsFrames[frameIndex].has_value()) {
+		return;
+	}
+	ZoneScoped;
+	// Six counters followed by the availability of each query.
+	const uint32_t stride = 7;
+	std::array<uint64_t, RENDERER_PASS_COUNT * stride> results = {};
+	VkResult result = vkGetQueryPoolResults(m_Device, m_PipelineStatisticsQueryPools[frameIndex],
+											0, RENDERER_PASS_COUNT,
+											sizeof(results), results.data(), stride * sizeof(uint64_t),
+											VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	// VK_NOT_READY if the frame was recorded but never submitted.
+	if (result != VK_SUCCESS) {
+		return;
+	}
+	for (uint32_t pass = 0; pass < RENDERER_PASS_COUNT; pass++) {
+		const uint64_t* values = &results[pass * stride];
+		PipelineStatistics& statistics = m_Statistics.passes[pass];
+		statistics.inputAssemblyVertices = values[0];
+		statistics.inputAssemblyPrimitives = values[1];
+		statistics.vertexShaderInvocations = values[2];
+		statistics.clippingInvocations = values[3];
+		statistics.clippingPrimitives = values[4];
+		statistics.fragmentShaderInvocations = values[5];
+	}
+	m_Statistics.hasPipelineStatistics = true;
+	m_Statistics.pipelineStatisticsFrameNumber = m_PipelineStatisticsFrames[frameIndex].value();
+}
+
+void Renderer::PublishStatistics() {
+	ZoneScoped;
+	m_Statistics.frameNumber = m_FrameNumber;
+	m_LastStatistics = m_Statistics;
+	m_Statistics = {};
+
+	const RendererStatistics& statistics = m_LastStatistics;
+	TracyPlot("Draw calls", (int64_t)statistics.drawCalls);
+	TracyPlot("Instances", (int64_t)statistics.instances);
+	TracyPlot("Triangles", (int64_t)statistics.triangles);
+	TracyPlot("Triangles per draw", statistics.drawCalls == 0 ? 0.0 : (double)statistics.triangles / statistics.drawCalls);
+	TracyPlot("Uploaded bytes", (int64_t)statistics.uploadedBytes);
+	TracyPlot("Command buffers allocated", (int64_t)statistics.commandBuffersAllocated);
+	TracyPlot("Descriptor writes", (int64_t)statistics.descriptorWrites);
+	TracyPlot("Pipeline binds", (int64_t)statistics.pipelineBinds);
+	TracyPlot("Visible objects", (int64_t)statistics.visibleObjects);
+	TracyPlot("Culled objects", (int64_t)statistics.culledObjects);
+	if (statistics.hasPipelineStatistics) {
+		const PipelineStatistics& geometry = statistics.passes[RENDERER_PASS_GEOMETRY];
+		TracyPlot("Vertex shader invocations", (int64_t)geometry.vertexShaderInvocations);
+		TracyPlot("Clipping primitives", (int64_t)geometry.clippingPrimitives);
+		TracyPlot("Fragment shader invocations", (int64_t)geometry.fragmentShaderInvocations);
+	}
+
+	if (m_MessageBus != NULL) {
+		m_MessageBus->PostMessage(new RendererStatisticsEvent(statistics));
+	}
+}
+
+int Renderer::Draw(const IndexBuffer& indexBuffer, const VertexBuffer& vertexBuffer, uint32_t indexCount) {
+	ZoneScoped;
+	// No main pipeline has built yet, see StartFrame().
+	if (m_ActivePipeline == VK_NULL_HANDLE) {
+		return -1;
+	}
+
+	vkCmdBindIndexBuffer(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexBuffer.m_Buffer, 0, VK_INDEX_TYPE_UINT32);
+	size_t offset = 0;
+	vkCmdBindVertexBuffers(m_GeomertyDrawCmdBuffers[m_FrameIndex], 0, 1, &vertexBuffer.m_Buffer, &offset);
+
+	vkCmdDrawIndexed(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexCount, 1, 0, 0, 0);
+	m_Statistics.drawCalls++;
+	m_Statistics.instances++;
+	m_Statistics.vertices += indexCount;
+	m_Statistics.triangles += indexCount / 3;
+
+	return 0;
+}
+
+int Renderer::DrawInstanced(const IndexBuffer& indexBuffer, VkIndexType indexType,
+							const VertexBuffer& vertexBuffer, const StorageBuffer& instanceBuffer,
+							uint32_t firstIndex, uint32_t indexCount,
+							uint32_t firstInstance, uint32_t instanceCount)
+{
+	ZoneScoped;
+
+	vkCmdBindIndexBuffer(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexBuffer.m_Buffer, 0, indexType);
+	std::array<VkBuffer, 2> buffers = { vertexBuffer.m_Buffer, instanceBuffer.m_Buffer };
+	std::array<VkDeviceSize, 2> offsets = { 0, 0 };
+	vkCmdBindVertexBuffers(m_GeomertyDrawCmdBuffers[m_FrameIndex], 0, buffers.size(), buffers.data(), offsets.data());
+
+	vkCmdDrawIndexed(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexCount, instanceCount, firstIndex, 0, firstInstance);
+	m_Statistics.drawCalls++;
+	m_Statistics.instances += instanceCount;
+	m_Statistics.vertices += (uint64_t)indexCount * instanceCount;
+	m_Statistics.triangles += (uint64_t)(indexCount / 3) * instanceCount;
+
+	return 0;
+}
+
+int Renderer::BindPipeline(const PipelineDescription& description) {
+	VkPipeline pipeline = GetPipeline(description);
+	if (pipeline == VK_NULL_HANDLE) {
+		return -1;
+	}
+	vkCmdBindPipeline(m_GeomertyDrawCmdBuffers[m_FrameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	m_Statistics.pipelineBinds++;
+	return 0;
+}
+
+void Renderer::BindMainPipeline() {
+	if (m_ActivePipeline == VK_NULL_HANDLE) {
+		return;
+	}
+	vkCmdBindPipeline(m_GeomertyDrawCmdBuffers[m_FrameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline);
+	m_Statistics.pipelineBinds++;
+}
+
+int Renderer::FillBuffer(StorageBuffer& buffer, size_t offset, size_t size, uint32_t value) {
+	if (!buffer.m_Initialized) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Trying to fill an uninitialized buffer.");
+		return -1;
+	}
+	if (offset + size > buffer.m_Size || offset % 4 != 0 || size % 4 != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Fill of %zu bytes at %zu out of bounds or unaligned for a buffer of %zu bytes.",
+										 size, offset, buffer.m_Size);
+		return -1;
+	}
+
+	vkCmdFillBuffer(m_DrawCmdBuffers[m_FrameIndex], buffer.m_Buffer, offset, size, value);
+	return 0;
+}
+
+int Renderer::CopyBuffer(const StagingBuffer& src, size_t srcOffset, StorageBuffer& dst, size_t dstOffset, size_t size) {
+	if (!src.m_Initialized || !dst.m_Initialized) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Trying to copy data using an uninitialized buffer.");
+		return -1;
+	}
+	if (srcOffset + size > src.m_Size || dstOffset + size > dst.m_Size) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Copy of %zu bytes out of bounds, %zu byte source at %zu, %zu byte destination at %zu.",
+										 size, src.m_Size, srcOffset, dst.m_Size, dstOffset);
+		return -1;
+	}
+	if (size == 0) {
+		return 0;
+	}
+
+	VkCommandBuffer commandBuffer = m_DrawCmdBuffers[m_FrameIndex];
+	// The previous frame may still be reading the destination.
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+						 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 0, 0, NULL, 0, NULL, 0, NULL);
+
+	VkBufferCopy copyRegion = { srcOffset, dstOffset, size };
+	vkCmdCopyBuffer(commandBuffer, src.m_Buffer, dst.m_Buffer, 1, &copyRegion);
+	m_Statistics.uploadedBytes += size;
+
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.pNext = NULL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+							VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+						 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+						 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 0, 1, &barrier, 0, NULL, 0, NULL);
+	return 0;
+}
+
+int Renderer::PrecompileComputePipeline(const std::string& shader, const ShaderDefines& defines) {
+	VkPipelineLayout layout;
+	VkDescriptorSetLayout setLayout;
+	return GetComputePipeline(shader, defines, &layout, &setLayout) != VK_NULL_HANDLE ? 0 : -1;
+}
+
+int Renderer::Dispatch(const std::string& shader, const std::vector<const StorageBuffer*>& buffers,
+					   const void* pushConstants, uint32_t pushConstantSize, uint32_t groupCountX,
+					   const ShaderDefines& defines, bool bindDepthPyramid)
+{
+	ZoneScoped;
+	VkPipelineLayout layout;
+	VkDescriptorSetLayout setLayout;
+	VkPipeline pipeline = GetComputePipeline(shader, defines, &layout, &setLayout);
+	if (pipeline == VK_NULL_HANDLE) {
+		return -1;
+	}
+	if (buffers.size() > RENDERER_MAX_DISPATCH_BUFFERS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Dispatch of \"%s\" binds %zu buffers, at most %u are supported.",
+										 shader.c_str(), buffers.size(), RENDERER_MAX_DISPATCH_BUFFERS);
+		return -1;
+	}
+	if (bindDepthPyramid && !HasDepthPyramid()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Dispatch of \"%s\" binds the depth pyramid before it was built.",
+										 shader.c_str());
+		return -1;
+	}
+
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	if (setLayout != VK_NULL_HANDLE) {
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.pNext = NULL;
+		descriptorSetAllocateInfo.descriptorPool = m_ComputeDescriptorPools[m_FrameIndex];
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &setLayout;
+
+		VkResult result = vkAllocateDescriptorSets(m_Device, &descriptorSetAllocateInfo, &descriptorSet);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "Failed to allocate descriptor set for \"%s\", more than %u dispatches this frame?",
+											 shader.c_str(), RENDERER_MAX_DISPATCHES);
+			return -1;
+		}
+
+		std::vector<VkDescriptorBufferInfo> bufferInfos(buffers.size());
+		std::vector<VkWriteDescriptorSet> descriptorWrites(buffers.size());
+		for (uint32_t i = 0; i < buffers.size(); i++) {
+			bufferInfos[i].buffer = buffers[i]->m_Buffer;
+			bufferInfos[i].offset = 0;
+			bufferInfos[i].range = VK_WHOLE_SIZE;
+
+			descriptorWrites[i] = {};
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].pNext = NULL;
+			descriptorWrites[i].dstSet = descriptorSet;
+			descriptorWrites[i].dstBinding = i;
+			descriptorWrites[i].dstArrayElement = 0;
+			descriptorWrites[i].descriptorCount = 1;
+			descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+		}
+
+		VkDescriptorImageInfo pyramidInfo = {};
+		if (bindDepthPyramid) {
+			pyramidInfo.sampler = m_DepthPyramidSampler;
+			pyramidInfo.imageView = m_DepthPyramid.m_ImageView;
+			pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkWriteDescriptorSet descriptorWrite = {};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.pNext = NULL;
+			descriptorWrite.dstSet = descriptorSet;
+			descriptorWrite.dstBinding = buffers.size();
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorWrite.pImageInfo = &pyramidInfo;
+			descriptorWrites.push_back(descriptorWrite);
+		}
+		vkUpdateDescriptorSets(m_Device, descriptorWrites.size(), descriptorWrites.data(), 0, NULL);
+	}
+
+	VkCommandBuffer commandBuffer = m_DrawCmdBuffers[m_FrameIndex];
+	// Stable for the lifetime of the renderer, unlike shader.
+	const char* zoneName = m_ComputePipelines.find(ComputePipelineKey(shader, defines))->first.c_str();
+	GpuZone zone = m_GpuProfiler.BeginZone(commandBuffer, GPU_QUEUE_GRAPHICS, zoneName);
+
+	// Fills and earlier dispatches are visible to this one.
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.pNext = NULL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 0, 1, &barrier, 0, NULL, 0, NULL);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	if (descriptorSet != VK_NULL_HANDLE) {
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout,
+								0, 1, &descriptorSet, 0, NULL);
+	}
+	if (pushConstantSize > 0) {
+		vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pushConstants);
+	}
+	vkCmdDispatch(commandBuffer, groupCountX, 1, 1);
+
+	// The render pass reads the results as draw commands, instance data or in shaders.
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+							VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+						 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 0, 1, &barrier, 0, NULL, 0, NULL);
+	m_GpuProfiler.EndZone(zone);
+
+	return 0;
+}
+
+int Renderer::DrawIndexedIndirectCount(const IndexBuffer& indexBuffer, VkIndexType indexType,
+									   const VertexBuffer& vertexBuffer, const StorageBuffer& instanceBuffer,
+									   const StorageBuffer& commandBuffer, size_t commandOffset,
+									   const StorageBuffer& countBuffer, size_t countOffset,
+									   uint32_t maxDrawCount)
+{
+	ZoneScoped;
+	if (!m_DrawIndirectCount) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Indirect count draws are not supported by the device.");
+		return -1;
+	}
+
+	vkCmdBindIndexBuffer(m_GeomertyDrawCmdBuffers[m_FrameIndex], indexBuffer.m_Buffer, 0, indexType);
+	std::array<VkBuffer, 2> buffers = { vertexBuffer.m_Buffer, instanceBuffer.m_Buffer };
+	std::array<VkDeviceSize, 2> offsets = { 0, 0 };
+	vkCmdBindVertexBuffers(m_GeomertyDrawCmdBuffers[m_FrameIndex], 0, buffers.size(), buffers.data(), offsets.data());
+
+	vkCmdDrawIndexedIndirectCount(m_GeomertyDrawCmdBuffers[m_FrameIndex],
+								  commandBuffer.m_Buffer, commandOffset,
+								  countBuffer.m_Buffer, countOffset,
+								  maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+	// The instances and triangles are only known on the device, the pipeline
+	// statistics count them.
+	m_Statistics.drawCalls++;
+
+	return 0;
+}
+
+int Renderer::UpdateCamera(Camera& camera) {
+	ZoneScoped;
+
+	VkFence WaitFences[] = { m_InFlightFences[m_FrameIndex] };
+	vkWaitForFences(m_Device, 1, WaitFences, VK_TRUE, UINT64_MAX);
+
+	m_UniformStagingBuffer.SetData(sizeof(glm::mat4), 0, glm::value_ptr(camera.GetTransform()));
+	m_UniformStagingBuffer.SetData(sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(camera.GetProjection()));
 	m_UniformStagingBuffer.TransferData(m_UniformBuffer, 0, 0, sizeof(glm::mat4) * 2);
 	m_UniformStagingBuffer.TransferData(m_SkyboxUniformBuffer, 0, 0, sizeof(glm::mat4) * 2);
 
@@ -3127,6 +3664,7 @@ int Renderer::UpdateCamera(Camera& camera) {
 	};
 
 	vkUpdateDescriptorSets(m_Device, 2, writeDescriptorSets, 0, NULL);
+	m_Statistics.descriptorWrites += 2;
 
 	return 0;
 }
@@ -3158,6 +3696,7 @@ void Renderer::UpdateSkybox(CubeMapBuffer& newSkybox) {
 		};
 
 		vkUpdateDescriptorSets(m_Device, 1, &writeDescriptorSet, 0, NULL);
+		m_Statistics.descriptorWrites++;
 
 		if (++i >= m_Capabilites.maxFramesInFlight)
 			i = 0;
@@ -3180,8 +3719,670 @@ uint32_t Renderer::GetQueueFamilyIndex(CommandQueueType queueType) const {
 	}
 }
 
-void Renderer::InvalidateSwapchain() {
-	ZoneScoped;
+VkPipeline Renderer::GetPipeline(const PipelineDescription& description) {
+	auto cached = m_Pipelines.find(description);
+	if (cached != m_Pipelines.end()) {
+		return cached->second;
+	}
+
+	ZoneScopedN("Renderer::GetPipeline (create)");
+	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+									 "Pipeline for \"%s\" and \"%s\" was not precompiled, building it on the render thread.",
+									 description.vertexShader.c_str(), description.fragmentShader.c_str());
+	// Failures are not cached, so the pipeline is retried once its shaders are fixed.
+	std::vector<VkPipeline> pipelines;
+	if (CreatePipelines(m_SwapchainExtent, { description }, pipelines) != 0 || pipelines[0] == VK_NULL_HANDLE) {
+		return VK_NULL_HANDLE;
+	}
+	m_Pipelines[description] = pipelines[0];
+	return pipelines[0];
+}
+
+VkPipeline Renderer::GetComputePipeline(const std::string& shader, const ShaderDefines& defines,
+										VkPipelineLayout* layout, VkDescriptorSetLayout* setLayout)
+{
+	std::string key = ComputePipelineKey(shader, defines);
+	auto cached = m_ComputePipelines.find(key);
+	if (cached != m_ComputePipelines.end()) {
+		*layout = cached->second.layout;
+		*setLayout = cached->second.setLayout;
+		return cached->second.pipeline;
+	}
+
+	ZoneScopedN("Renderer::GetComputePipeline (create)");
+	// Cached even if it fails, so a broken shader is reported once.
+	ComputePipeline& computePipeline = m_ComputePipelines[key];
+	computePipeline = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+	*layout = VK_NULL_HANDLE;
+	*setLayout = VK_NULL_HANDLE;
+
+	auto shaderCode = LoadShader(shader, defines);
+	ShaderReflection reflection;
+	std::vector<VkDescriptorSetLayout> setLayouts;
+	if (shaderCode == nullptr || ReflectShader(*shaderCode, &reflection) != 0 ||
+		reflection.stages != VK_SHADER_STAGE_COMPUTE_BIT ||
+		GetDescriptorSetLayouts(reflection, setLayouts) != 0 || setLayouts.size() > 1)
+	{
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to load compute shader \"%s\", expected at most one set.",
+										 shader.c_str());
+		return VK_NULL_HANDLE;
+	}
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.pNext = NULL;
+	pipelineLayoutCreateInfo.flags = 0;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = reflection.pushConstants.size();
+	pipelineLayoutCreateInfo.pPushConstantRanges = reflection.pushConstants.data();
+	pipelineLayoutCreateInfo.setLayoutCount = setLayouts.size();
+	pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	VkResult result = vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, NULL, &pipelineLayout);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create compute pipeline layout.");
+		return VK_NULL_HANDLE;
+	}
+
+	VkShaderModule shaderModule = CreateShaderModule(m_Device, shaderCode);
+	if (shaderModule == VK_NULL_HANDLE) {
+		vkDestroyPipelineLayout(m_Device, pipelineLayout, NULL);
+		return VK_NULL_HANDLE;
+	}
+
+	VkComputePipelineCreateInfo pipelineCreateInfo = {};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.pNext = NULL;
+	pipelineCreateInfo.flags = 0;
+	pipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineCreateInfo.stage.pNext = NULL;
+	pipelineCreateInfo.stage.flags = 0;
+	pipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineCreateInfo.stage.module = shaderModule;
+	pipelineCreateInfo.stage.pName = "main";
+	pipelineCreateInfo.stage.pSpecializationInfo = NULL;
+	pipelineCreateInfo.layout = pipelineLayout;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	result = vkCreateComputePipelines(m_Device, m_PipelineCache, 1, &pipelineCreateInfo, NULL, &pipeline);
+	vkDestroyShaderModule(m_Device, shaderModule, NULL);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to create compute pipeline \"%s\".", shader.c_str());
+		vkDestroyPipelineLayout(m_Device, pipelineLayout, NULL);
+		return VK_NULL_HANDLE;
+	}
+
+	computePipeline.pipeline = pipeline;
+	computePipeline.layout = pipelineLayout;
+	computePipeline.setLayout = setLayouts.empty() ? VK_NULL_HANDLE : setLayouts[0];
+	*layout = computePipeline.layout;
+	*setLayout = computePipeline.setLayout;
+	return pipeline;
+}
+
+int Renderer::CreateDepthPyramid() {
+	ZoneScoped;
+	DestroyDepthPyramid();
+
+	// Power of two levels halve exactly, so every texel of a level covers a 2x2
+	// footprint of the level below it.
+	uint32_t width = PreviousPowerOfTwo(m_SwapchainExtent.width);
+	uint32_t height = PreviousPowerOfTwo(m_SwapchainExtent.height);
+	uint32_t mipLevels = CalculateMipLevels(width, height);
+
+	ImageBuffer pyramid;
+	pyramid.m_Device = m_Device;
+	pyramid.m_CommandPool = m_TransferCmdPool;
+	pyramid.m_TransferQueue = m_TransferQueue;
+	pyramid.m_Extent = { width, height, 1u };
+	pyramid.m_Format = VK_FORMAT_R32_SFLOAT;
+	pyramid.m_MipLevels = mipLevels;
+
+	VkResult result = CreateImageObjects(&pyramid.m_Image,
+										 &pyramid.m_DeviceMemory,
+										 &pyramid.m_ImageView,
+										 VK_FORMAT_R32_SFLOAT,
+										 VK_IMAGE_USAGE_STORAGE_BIT |
+										 VK_IMAGE_USAGE_SAMPLED_BIT,
+										 &width,
+										 &height,
+										 &pyramid.m_Size,
+										 mipLevels, 1);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create depth pyramid.");
+		return -1;
+	}
+	pyramid.m_Initialized = true;
+	pyramid.m_Layout = VK_IMAGE_LAYOUT_GENERAL;
+
+	VkImageViewCreateInfo imageViewCreateInfo = {};
+	imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	imageViewCreateInfo.pNext = NULL;
+	imageViewCreateInfo.flags = 0;
+	imageViewCreateInfo.image = pyramid.m_Image;
+	imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	imageViewCreateInfo.format = VK_FORMAT_R32_SFLOAT;
+	imageViewCreateInfo.components = {
+		.r = VK_COMPONENT_SWIZZLE_R,
+		.g = VK_COMPONENT_SWIZZLE_G,
+		.b = VK_COMPONENT_SWIZZLE_B,
+		.a = VK_COMPONENT_SWIZZLE_A
+	};
+	for (uint32_t level = 0; level < mipLevels; level++) {
+		imageViewCreateInfo.subresourceRange = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = level,
+			.levelCount = 1,
+			.baseArrayLayer = 0,
+			.layerCount = 1
+		};
+
+		VkImageView imageView;
+		result = vkCreateImageView(m_Device, &imageViewCreateInfo, NULL, &imageView);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create depth pyramid level views.");
+			for (auto& levelView : m_DepthPyramidLevelViews) {
+				vkDestroyImageView(m_Device, levelView, NULL);
+			}
+			m_DepthPyramidLevelViews.clear();
+			return -1;
+		}
+		m_DepthPyramidLevelViews.push_back(imageView);
+	}
+	m_DepthPyramid = std::move(pyramid);
+
+	// Read with texelFetch, the sampler only has to be valid.
+	SamplerSpec samplerSpec = {};
+	samplerSpec.magFilter = VK_FILTER_NEAREST;
+	samplerSpec.minFilter = VK_FILTER_NEAREST;
+	samplerSpec.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerSpec.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerSpec.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerSpec.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerSpec.maxAnisotropy = 1.0f;
+	m_DepthPyramidSampler = GetSampler(samplerSpec);
+	return 0;
+}
+
+void Renderer::DestroyDepthPyramid() {
+	for (auto& levelView : m_DepthPyramidLevelViews) {
+		vkDestroyImageView(m_Device, levelView, NULL);
+	}
+	m_DepthPyramidLevelViews.clear();
+	m_DepthPyramid = ImageBuffer();
+	m_DepthPyramidValid = false;
+}
+
+void Renderer::RecordDepthPyramid(VkCommandBuffer commandBuffer) {
+	ZoneScoped;
+	m_DepthPyramidValid = false;
+	if (m_DepthPyramidLevelViews.empty()) {
+		return;
+	}
+	VkPipelineLayout layout;
+	VkDescriptorSetLayout setLayout;
+	VkPipeline pipeline = GetComputePipeline("rendererDepthPyramidCompute", {}, &layout, &setLayout);
+	if (pipeline == VK_NULL_HANDLE || setLayout == VK_NULL_HANDLE) {
+		return;
+	}
+
+	uint32_t levelCount = m_DepthPyramidLevelViews.size();
+	std::vector<VkDescriptorSetLayout> setLayouts(levelCount, setLayout);
+	std::vector<VkDescriptorSet> descriptorSets(levelCount, VK_NULL_HANDLE);
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.pNext = NULL;
+	descriptorSetAllocateInfo.descriptorPool = m_ComputeDescriptorPools[m_FrameIndex];
+	descriptorSetAllocateInfo.descriptorSetCount = levelCount;
+	descriptorSetAllocateInfo.pSetLayouts = setLayouts.data();
+
+	VkResult result = vkAllocateDescriptorSets(m_Device, &descriptorSetAllocateInfo, descriptorSets.data());
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to allocate the depth pyramid descriptor sets.");
+		return;
+	}
+
+	// Level 0 reads the depth buffer, every other level the one before it.
+	std::vector<VkDescriptorImageInfo> imageInfos(2 * levelCount);
+	std::vector<VkWriteDescriptorSet> descriptorWrites(2 * levelCount);
+	for (uint32_t level = 0; level < levelCount; level++) {
+		VkDescriptorImageInfo& sourceInfo = imageInfos[2 * level];
+		sourceInfo.sampler = m_DepthPyramidSampler;
+		sourceInfo.imageView = level == 0 ? m_DepthImage.m_ImageView : m_DepthPyramidLevelViews[level - 1];
+		sourceInfo.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL :
+											  VK_IMAGE_LAYOUT_GENERAL;
+
+		VkDescriptorImageInfo& destinationInfo = imageInfos[2 * level + 1];
+		destinationInfo.sampler = VK_NULL_HANDLE;
+		destinationInfo.imageView = m_DepthPyramidLevelViews[level];
+		destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		for (uint32_t binding = 0; binding < 2; binding++) {
+			VkWriteDescriptorSet& descriptorWrite = descriptorWrites[2 * level + binding];
+			descriptorWrite = {};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.pNext = NULL;
+			descriptorWrite.dstSet = descriptorSets[level];
+			descriptorWrite.dstBinding = binding;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.descriptorType = binding == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER :
+															VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			descriptorWrite.pImageInfo = &imageInfos[2 * level + binding];
+		}
+	}
+	vkUpdateDescriptorSets(m_Device, descriptorWrites.size(), descriptorWrites.data(), 0, NULL);
+
+	GpuZone zone = m_GpuProfiler.BeginZone(commandBuffer, GPU_QUEUE_GRAPHICS, "Depth pyramid");
+
+	// The previous pyramid is discarded once this frame's culling has read it.
+	VkImageMemoryBarrier imageBarrier = {};
+	imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageBarrier.pNext = NULL;
+	imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.image = m_DepthPyramid.m_Image;
+	imageBarrier.subresourceRange = {
+		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		.baseMipLevel = 0,
+		.levelCount = levelCount,
+		.baseArrayLayer = 0,
+		.layerCount = 1
+	};
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.pNext = NULL;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	uint32_t sourceSize[2] = { m_SwapchainExtent.width, m_SwapchainExtent.height };
+	for (uint32_t level = 0; level < levelCount; level++) {
+		uint32_t pushConstants[4] = {
+			sourceSize[0], sourceSize[1],
+			std::max(m_DepthPyramid.m_Extent.width >> level, 1u),
+			std::max(m_DepthPyramid.m_Extent.height >> level, 1u)
+		};
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout,
+								0, 1, &descriptorSets[level], 0, NULL);
+		vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), pushConstants);
+		vkCmdDispatch(commandBuffer,
+					  (pushConstants[2] + RENDERER_DEPTH_PYRAMID_GROUP_SIZE - 1) / RENDERER_DEPTH_PYRAMID_GROUP_SIZE,
+					  (pushConstants[3] + RENDERER_DEPTH_PYRAMID_GROUP_SIZE - 1) / RENDERER_DEPTH_PYRAMID_GROUP_SIZE,
+					  1);
+		// Visible to the next level and to the next frame's culling.
+		vkCmdPipelineBarrier(commandBuffer,
+							 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+							 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+							 0, 1, &barrier, 0, NULL, 0, NULL);
+		sourceSize[0] = pushConstants[2];
+		sourceSize[1] = pushConstants[3];
+	}
+	m_GpuProfiler.EndZone(zone);
+	m_DepthPyramidValid = true;
+}
+
+int Renderer::PrecompilePipelines(const std::vector<PipelineDescription>& descriptions) {
+	ZoneScoped;
+	std::vector<PipelineDescription> missing;
+	for (auto& description : descriptions) {
+		if (m_Pipelines.find(description) == m_Pipelines.end() &&
+			std::find(missing.begin(), missing.end(), description) == missing.end())
+		{
+			missing.push_back(description);
+		}
+	}
+
+	std::vector<VkPipeline> pipelines;
+	int result = CreatePipelines(m_SwapchainExtent, missing, pipelines);
+	for (size_t i = 0; i < missing.size(); i++) {
+		if (pipelines[i] != VK_NULL_HANDLE) {
+			m_Pipelines[missing[i]] = pipelines[i];
+		}
+	}
+	return result;
+}
+
+VkSampler Renderer::GetSampler(const SamplerSpec& spec) {
+	auto cached = m_SamplerCache.find(spec);
+	if (cached != m_SamplerCache.end()) {
+		return cached->second;
+	}
+
+	float maxAnisotropy = std::min(spec.maxAnisotropy, m_PhysicalDeviceProperties.limits.maxSamplerAnisotropy);
+	bool enableAnisotropy = m_EnabledDeviceFeatures.samplerAnisotropy && maxAnisotropy > 1.0f;
+
+	VkSamplerCreateInfo samplerCreateInfo = {};
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.pNext = NULL;
+	samplerCreateInfo.flags = 0;
+	samplerCreateInfo.magFilter = spec.magFilter;
+	samplerCreateInfo.minFilter = spec.minFilter;
+	samplerCreateInfo.mipmapMode = spec.mipmapMode;
+	samplerCreateInfo.addressModeU = spec.addressModeU;
+	samplerCreateInfo.addressModeV = spec.addressModeV;
+	samplerCreateInfo.addressModeW = spec.addressModeW;
+	samplerCreateInfo.mipLodBias = 0.0f;
+	samplerCreateInfo.anisotropyEnable = enableAnisotropy ? VK_TRUE : VK_FALSE;
+	samplerCreateInfo.maxAnisotropy = enableAnisotropy ? maxAnisotropy : 1.0f;
+	samplerCreateInfo.compareEnable = VK_FALSE;
+	samplerCreateInfo.compareOp = VK_COMPARE_OP_NEVER;
+	samplerCreateInfo.minLod = 0.0f;
+	samplerCreateInfo.maxLod = spec.maxLod;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+	samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+
+	VkSampler sampler = VK_NULL_HANDLE;
+	VkResult result = vkCreateSampler(m_Device, &samplerCreateInfo, NULL, &sampler);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to create sampler.");
+		return VK_NULL_HANDLE;
+	}
+
+	m_SamplerCache[spec] = sampler;
+	return sampler;
+}
+
+VkDescriptorSetLayout Renderer::GetDescriptorSetLayout(const std::vector<ShaderResourceBinding>& bindings) {
+	std::vector<ShaderResourceBinding> key = bindings;
+	for (auto& binding : key) {
+		binding.set = 0;
+	}
+
+	std::lock_guard<std::mutex> lock(m_DescriptorSetLayoutMutex);
+	auto cached = m_DescriptorSetLayoutCache.find(key);
+	if (cached != m_DescriptorSetLayoutCache.end()) {
+		return cached->second;
+	}
+
+	bool updateAfterBind = m_DescriptorIndexing && HasRuntimeArray(key);
+	std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+	std::vector<VkDescriptorBindingFlags> bindingFlags;
+	for (auto& binding : key) {
+		VkDescriptorSetLayoutBinding layoutBinding = {};
+		layoutBinding.binding = binding.binding;
+		layoutBinding.descriptorType = binding.type;
+		layoutBinding.descriptorCount = binding.count == CEE_RUNTIME_DESCRIPTOR_COUNT ? m_TextureTableSize : binding.count;
+		layoutBinding.stageFlags = binding.stages;
+		layoutBinding.pImmutableSamplers = NULL;
+		layoutBindings.push_back(layoutBinding);
+
+		// Runtime arrays are only partially filled and written while other frames are in flight.
+		bindingFlags.push_back(binding.count == CEE_RUNTIME_DESCRIPTOR_COUNT ?
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT : 0);
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {};
+	bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsCreateInfo.pNext = NULL;
+	bindingFlagsCreateInfo.bindingCount = bindingFlags.size();
+	bindingFlagsCreateInfo.pBindingFlags = bindingFlags.data();
+
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptorSetLayoutCreateInfo.pNext = updateAfterBind ? &bindingFlagsCreateInfo : NULL;
+	descriptorSetLayoutCreateInfo.flags = updateAfterBind ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0;
+	descriptorSetLayoutCreateInfo.bindingCount = layoutBindings.size();
+	descriptorSetLayoutCreateInfo.pBindings = layoutBindings.data();
+
+	VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+	VkResult result = vkCreateDescriptorSetLayout(m_Device, &descriptorSetLayoutCreateInfo, NULL, &descriptorSetLayout);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to create descriptor set layout.");
+		return VK_NULL_HANDLE;
+	}
+
+	m_DescriptorSetLayoutCache[key] = descriptorSetLayout;
+	return descriptorSetLayout;
+}
+
+int Renderer::GetDescriptorSetLayouts(const ShaderReflection& reflection,
+									  std::vector<VkDescriptorSetLayout>& setLayouts)
+{
+	setLayouts.clear();
+	for (uint32_t set = 0; set < reflection.GetSetCount(); set++) {
+		VkDescriptorSetLayout setLayout = GetDescriptorSetLayout(reflection.GetSetBindings(set));
+		if (setLayout == VK_NULL_HANDLE) {
+			return -1;
+		}
+		setLayouts.push_back(setLayout);
+	}
+	return 0;
+}
+
+int Renderer::ReflectMainShaders(const std::vector<std::shared_ptr<ShaderBinary>>& shaders,
+								 ShaderReflection* reflection)
+{
+	ZoneScoped;
+	if (ReflectShaders(shaders, reflection) != 0) {
+		return -1;
+	}
+
+	for (auto& binding : reflection->bindings) {
+		if (binding.set == 1 && binding.binding == 1 && binding.count != CEE_RUNTIME_DESCRIPTOR_COUNT) {
+			if (m_DescriptorIndexing || binding.count != m_TextureTableSize) {
+				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+												 "Texture table declared with %u elements, expected %s.", binding.count,
+												 m_DescriptorIndexing ? "a runtime array" : "CEE_MAX_TEXTURES");
+			}
+			binding.count = CEE_RUNTIME_DESCRIPTOR_COUNT;
+		}
+	}
+	return 0;
+}
+
+bool Renderer::SupportsBlitMipmaps(VkFormat format) const {
+	// Software rasterizers blit on the CPU anyway, DownsampleSRGBA8 is faster.
+	if (m_PhysicalDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) {
+		return false;
+	}
+
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &formatProperties);
+	VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+									VK_FORMAT_FEATURE_BLIT_DST_BIT |
+									VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (formatProperties.optimalTilingFeatures & required) == required;
+}
+
+void Renderer::RecordMipmapBlits(VkCommandBuffer commandBuffer, VkImage image, VkExtent3D extent,
+								 uint32_t mipLevels, uint32_t layers)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.pNext = NULL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = layers;
+
+	int32_t width = extent.width;
+	int32_t height = extent.height;
+	for (uint32_t level = 1; level < mipLevels; level++) {
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+							 0, NULL, 0, NULL, 1, &barrier);
+
+		int32_t nextWidth = std::max(width / 2, 1);
+		int32_t nextHeight = std::max(height / 2, 1);
+		VkImageBlit blit = {};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, layers };
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { width, height, 1 };
+		blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, layers };
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		vkCmdBlitImage(commandBuffer,
+					   image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					   image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					   1, &blit, VK_FILTER_LINEAR);
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+							 0, NULL, 0, NULL, 1, &barrier);
+
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+						 0, NULL, 0, NULL, 1, &barrier);
+}
+
+TextureHandle Renderer::RegisterTexture(VkImageView imageView) {
+	TextureHandle handle;
+	if (!m_FreeTextureHandles.empty()) {
+		handle = m_FreeTextureHandles.back();
+		m_FreeTextureHandles.pop_back();
+	} else if (m_NextTextureHandle < m_TextureTableSize) {
+		handle = m_NextTextureHandle++;
+	} else {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Texture table is full (%u textures).", m_TextureTableSize);
+		return CEE_INVALID_TEXTURE_HANDLE;
+	}
+
+	UpdateTexture(handle, imageView);
+	return handle;
+}
+
+TextureHandle Renderer::RegisterTexture(const ImageBuffer& imageBuffer) {
+	return RegisterTexture(imageBuffer.m_ImageView);
+}
+
+void Renderer::UpdateTexture(TextureHandle handle, VkImageView imageView) {
+	if (handle >= m_TextureTableSize) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Updating invalid texture handle %u.", handle);
+		return;
+	}
+
+	if (imageView == VK_NULL_HANDLE) {
+		imageView = m_ImageBuffer.m_ImageView;
+	}
+	for (auto& writes : m_TextureTableWrites) {
+		writes.push_back({ handle, imageView });
+	}
+}
+
+void Renderer::ReleaseTexture(TextureHandle handle) {
+	if (handle >= m_TextureTableSize || handle == m_DefaultTexture) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Releasing invalid texture handle %u.", handle);
+		return;
+	}
+
+	// Point the slot back at the default texture so nothing samples a destroyed view.
+	UpdateTexture(handle, VK_NULL_HANDLE);
+	m_ReleasedTextureHandles[m_FrameIndex].push_back(handle);
+}
+
+void Renderer::FlushTextureTableWrites() {
+	ZoneScoped;
+	// Handles released the last time this frame index was recorded are no longer
+	// referenced by any frame in flight.
+	auto& released = m_ReleasedTextureHandles[m_FrameIndex];
+	m_FreeTextureHandles.insert(m_FreeTextureHandles.end(), released.begin(), released.end());
+	released.clear();
+
+	auto& writes = m_TextureTableWrites[m_FrameIndex];
+	if (writes.empty()) {
+		return;
+	}
+
+	std::vector<VkDescriptorImageInfo> imageInfos(writes.size());
+	std::vector<VkWriteDescriptorSet> writeDescriptorSets(writes.size());
+	for (size_t i = 0; i < writes.size(); i++) {
+		imageInfos[i].sampler = VK_NULL_HANDLE;
+		imageInfos[i].imageView = writes[i].second;
+		imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptorSets[i].pNext = NULL;
+		writeDescriptorSets[i].dstSet = m_ImageDescriptorSets[m_FrameIndex];
+		writeDescriptorSets[i].dstBinding = 1;
+		writeDescriptorSets[i].dstArrayElement = writes[i].first;
+		writeDescriptorSets[i].descriptorCount = 1;
+		writeDescriptorSets[i].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		writeDescriptorSets[i].pImageInfo = &imageInfos[i];
+		writeDescriptorSets[i].pBufferInfo = NULL;
+		writeDescriptorSets[i].pTexelBufferView = NULL;
+	}
+	// Later writes to the same slot win, descriptor writes are applied in order.
+	vkUpdateDescriptorSets(m_Device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, NULL);
+	m_Statistics.descriptorWrites += writeDescriptorSets.size();
+	writes.clear();
+}
+
+void Renderer::InvalidateSwapchain() {
+	ZoneScoped;
+	if (m_Headless) {
+		m_RecreateSwapchain = false;
+		if (m_HeadlessExtent.width == m_SwapchainExtent.width &&
+			m_HeadlessExtent.height == m_SwapchainExtent.height)
+		{
+			return;
+		}
+		VkResult result = vkWaitForFences(m_Device,
+										  m_InFlightFences.size(),
+										  m_InFlightFences.data(),
+										  VK_TRUE, UINT64_MAX);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to wait for fences before resizing offscreen targets.");
+		}
+
+		for (auto& framebuffer : m_Framebuffers) {
+			vkDestroyFramebuffer(m_Device, framebuffer, NULL);
+		}
+		m_SwapchainImages.clear();
+		m_SwapchainImageViews.clear();
+		m_OffscreenTargets.clear();
+		// The last frame's target is gone, there is nothing left to read back.
+		m_LastImageIndex.reset();
+
+		m_SwapchainExtent = m_HeadlessExtent;
+		if (CreateOffscreenTargets() != 0) {
+			return;
+		}
+		m_DepthImage = this->CreateImageBuffer(m_SwapchainExtent.width,
+											   m_SwapchainExtent.height,
+											   IMAGE_FORMAT_DEPTH);
+		if (m_BuildDepthPyramid) {
+			CreateDepthPyramid();
+		}
+		CreateFramebuffers();
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "Resized offscreen targets to %ux%u.",
+										 m_SwapchainExtent.width, m_SwapchainExtent.height);
+		return;
+	}
 	VkSwapchainKHR oldSwapchain = m_Swapchain;
 	VkResult result = vkWaitForFences(m_Device,
 									  m_InFlightFences.size(),
@@ -3247,6 +4448,10 @@ void Renderer::InvalidateSwapchain() {
 		swapchainCreateInfo.oldSwapchain = oldSwapchain;
 		swapchainCreateInfo.imageArrayLayers = 1;
 		swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		// Lets frames be read back, see RequestFrameReadback().
+		if (m_SwapcahinSupportInfo.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+			swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
 
 		uint32_t queueIndices[] = {
 			m_QueueFamilyIndices.graphicsIndex.value(),
@@ -3273,6 +4478,7 @@ void Renderer::InvalidateSwapchain() {
 
 		m_SwapchainExtent = swapchainCreateInfo.imageExtent;
 		m_SwapchainImageFormat = swapchainCreateInfo.imageFormat;
+		m_SwapchainTransferSrc = (swapchainCreateInfo.imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
 
 		vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &imageCount, NULL);
 		m_SwapchainImages.resize(imageCount);
@@ -3311,39 +4517,744 @@ void Renderer::InvalidateSwapchain() {
 		m_DepthImage = this->CreateImageBuffer(m_SwapchainExtent.width,
 											   m_SwapchainExtent.height,
 											   IMAGE_FORMAT_DEPTH);
+		if (m_BuildDepthPyramid) {
+			CreateDepthPyramid();
+		}
 
-		m_Framebuffers.clear();
-		for (uint32_t i = 0; i < m_SwapchainImageCount; i++) {
-			VkImageView attachments[] = {
-				m_SwapchainImageViews[i],
-				m_DepthImage.m_ImageView
-			};
-			VkFramebufferCreateInfo framebufferCreateInfo = {};
-			framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferCreateInfo.pNext = NULL;
-			framebufferCreateInfo.flags = 0;
-			framebufferCreateInfo.renderPass = m_RenderPass;
-			framebufferCreateInfo.layers = 1;
-			framebufferCreateInfo.attachmentCount = 2;
-			framebufferCreateInfo.pAttachments = attachments;
-			framebufferCreateInfo.width = m_SwapchainExtent.width;
-			framebufferCreateInfo.height = m_SwapchainExtent.height;
-
-			VkFramebuffer framebuffer = VK_NULL_HANDLE;
-			result = vkCreateFramebuffer(m_Device, &framebufferCreateInfo, NULL, &framebuffer);
-			if (result != VK_SUCCESS) {
-				DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create framebuffer %u.", i);
-				return;
-			}
-			m_Framebuffers.push_back(framebuffer);
+		if (CreateFramebuffers() != 0) {
+			return;
 		}
 
 		vkDestroySwapchainKHR(m_Device, oldSwapchain, NULL);
 		m_RecreateSwapchain = false;
 }
 
+void Renderer::Resize(uint32_t width, uint32_t height) {
+	if (width == 0 || height == 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Ignoring resize to %ux%u.", width, height);
+		return;
+	}
+	if (m_Headless) {
+		m_HeadlessExtent = { width, height };
+		m_RecreateSwapchain = true;
+	} else {
+		m_Window->SetSize(width, height);
+	}
+}
+
+int Renderer::CreateOffscreenTargets() {
+	for (uint32_t i = 0; i < m_SwapchainImageCount; i++) {
+		ImageBuffer target = CreateRenderTarget(m_SwapchainExtent.width,
+												m_SwapchainExtent.height,
+												m_SwapchainImageFormat);
+		if (!target.m_Initialized) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create offscreen render targets.");
+			return -1;
+		}
+		m_SwapchainImages.push_back(target.m_Image);
+		m_SwapchainImageViews.push_back(target.m_ImageView);
+		m_OffscreenTargets.push_back(std::move(target));
+	}
+	return 0;
+}
+
+int Renderer::CreateFramebuffers() {
+	m_Framebuffers.clear();
+	for (uint32_t i = 0; i < m_SwapchainImageCount; i++) {
+		VkImageView attachments[] = {
+			m_SwapchainImageViews[i],
+			m_DepthImage.m_ImageView
+		};
+		VkFramebufferCreateInfo framebufferCreateInfo = {};
+		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.pNext = NULL;
+		framebufferCreateInfo.flags = 0;
+		framebufferCreateInfo.renderPass = m_RenderPass;
+		framebufferCreateInfo.layers = 1;
+		framebufferCreateInfo.attachmentCount = 2;
+		framebufferCreateInfo.pAttachments = attachments;
+		framebufferCreateInfo.width = m_SwapchainExtent.width;
+		framebufferCreateInfo.height = m_SwapchainExtent.height;
+
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		VkResult result = vkCreateFramebuffer(m_Device, &framebufferCreateInfo, NULL, &framebuffer);
+		if (result != VK_SUCCESS) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create framebuffer %u.", i);
+			return -1;
+		}
+		m_Framebuffers.push_back(framebuffer);
+	}
+	return 0;
+}
+
 void Renderer::InvalidatePipeline() {
+	ZoneScoped;
+	if (m_PipelineRebuildThread.joinable()) {
+		// Picked up by the next rebuild once this one has been swapped in.
+		return;
+	}
+
+	std::vector<std::string> shaders(m_ChangedShaders.begin(), m_ChangedShaders.end());
+	m_ChangedShaders.clear();
+
+	auto isChanged = [&](const std::string& shader) {
+		return shaders.empty() || std::find(shaders.begin(), shaders.end(), shader) != shaders.end();
+	};
+
+	m_PipelineRebuild = {};
+	for (auto& pipeline : m_Pipelines) {
+		if (isChanged(pipeline.first.vertexShader) || isChanged(pipeline.first.fragmentShader)) {
+			m_PipelineRebuild.descriptions.push_back(pipeline.first);
+		}
+	}
+	m_PipelineRebuild.skybox = std::any_of(s_SkyboxShaderNames.begin(), s_SkyboxShaderNames.end(), isChanged);
+	if (m_PipelineRebuild.descriptions.empty() && !m_PipelineRebuild.skybox) {
+		return;
+	}
+
+	m_PipelineRebuildDone.store(false, std::memory_order_relaxed);
+	m_PipelineRebuildThread = std::thread(&Renderer::PipelineRebuildThread, this, std::move(shaders), m_SwapchainExtent);
+}
+
+void Renderer::UpdateShaderHotReload() {
+	ZoneScoped;
+	if (m_PipelineRebuildThread.joinable() && m_PipelineRebuildDone.load(std::memory_order_acquire)) {
+		m_PipelineRebuildThread.join();
+
+		if (m_PipelineRebuild.failed) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Shader reload failed, keeping the current pipelines.");
+			for (auto& pipeline : m_PipelineRebuild.pipelines) {
+				vkDestroyPipeline(m_Device, pipeline, NULL);
+			}
+			vkDestroyPipeline(m_Device, m_PipelineRebuild.skyboxPipeline, NULL);
+		} else {
+			// Frames still in flight keep using the old pipelines, so they are only retired here.
+			for (size_t i = 0; i < m_PipelineRebuild.descriptions.size(); i++) {
+				VkPipeline& pipeline = m_Pipelines[m_PipelineRebuild.descriptions[i]];
+				if (pipeline != VK_NULL_HANDLE) {
+					m_RetiredPipelines.push_back({ pipeline, m_Capabilites.maxFramesInFlight });
+				}
+				pipeline = m_PipelineRebuild.pipelines[i];
+			}
+			if (m_PipelineRebuild.skybox) {
+				m_RetiredPipelines.push_back({ m_SkyboxPipeline, m_Capabilites.maxFramesInFlight });
+				m_SkyboxPipeline = m_PipelineRebuild.skyboxPipeline;
+			}
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_INFO, "Reloaded shaders.");
+		}
+		m_PipelineRebuild = {};
+	}
+
+	if (m_ShaderWatcher.IsWatching()) {
+		std::vector<std::filesystem::path> changedFiles;
+		m_ShaderWatcher.Poll(changedFiles);
+		for (auto& file : changedFiles) {
+			if (file.extension() == ".glsl") {
+				m_ChangedShaders.insert(file.stem().string());
+			}
+		}
+		if (!m_ChangedShaders.empty()) {
+			InvalidatePipeline();
+		}
+	}
+}
+
+void Renderer::DestroyRetiredPipelines() {
+	// Called once per frame after waiting on that frame's fence, after
+	// maxFramesInFlight waits every frame that could bind the pipeline has completed.
+	for (size_t i = 0; i < m_RetiredPipelines.size();) {
+		if (--m_RetiredPipelines[i].framesLeft == 0) {
+			vkDestroyPipeline(m_Device, m_RetiredPipelines[i].pipeline, NULL);
+			m_RetiredPipelines[i] = m_RetiredPipelines.back();
+			m_RetiredPipelines.pop_back();
+		} else {
+			i++;
+		}
+	}
+}
+
+void Renderer::PipelineRebuildThread(std::vector<std::string> shaders, VkExtent2D extent) {
+	ZoneScoped;
+	// Compile the changed sources up front. LoadShader falls back to the precompiled
+	// binaries, which would silently replace a shader that fails to compile.
+	for (auto& shader : shaders) {
+		if (CompileShader(shader) == nullptr) {
+			m_PipelineRebuild.failed = true;
+		}
+	}
+
+	if (!m_PipelineRebuild.failed && !m_PipelineRebuild.descriptions.empty()) {
+		m_PipelineRebuild.failed = CreatePipelines(extent, m_PipelineRebuild.descriptions, m_PipelineRebuild.pipelines) != 0;
+	}
+	if (!m_PipelineRebuild.failed && m_PipelineRebuild.skybox) {
+		m_PipelineRebuild.failed = CreateSkyboxPipeline(extent, &m_PipelineRebuild.skyboxPipeline) != 0;
+	}
+
+	m_PipelineRebuildDone.store(true, std::memory_order_release);
+}
+
+VkResult Renderer::CreateGraphicsPipelines(uint32_t count, const VkGraphicsPipelineCreateInfo* createInfos,
+											VkPipeline* pipelines)
+{
+	ZoneScoped;
+	// Drivers compile the pipelines of a single vkCreateGraphicsPipelines() call one
+	// after another, so each worker creates one pipeline at a time instead.
+	uint32_t workerCount = std::min(count, std::max(std::thread::hardware_concurrency(), 1u));
+	if (workerCount <= 1) {
+		return vkCreateGraphicsPipelines(m_Device, m_PipelineCache, count, createInfos, NULL, pipelines);
+	}
+
+	std::atomic<uint32_t> nextPipeline(0);
+	std::vector<VkResult> results(count, VK_SUCCESS);
+	auto worker = [&]() {
+		for (uint32_t i = nextPipeline.fetch_add(1); i < count; i = nextPipeline.fetch_add(1)) {
+			pipelines[i] = VK_NULL_HANDLE;
+			results[i] = vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1, &createInfos[i], NULL, &pipelines[i]);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 1; i < workerCount; i++) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : workers) {
+		thread.join();
+	}
+
+	for (auto& workerResult : results) {
+		if (workerResult != VK_SUCCESS) {
+			return workerResult;
+		}
+	}
+	return VK_SUCCESS;
+}
+
+bool Renderer::IsPipelineCacheCompatible(const std::vector<uint8_t>& cacheData) const {
+	VkPipelineCacheHeaderVersionOne header;
+	if (cacheData.size() < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, cacheData.data(), sizeof(header));
+
+	return header.headerSize >= sizeof(header) && header.headerSize <= cacheData.size() &&
+		   header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		   header.vendorID == m_PhysicalDeviceProperties.vendorID &&
+		   header.deviceID == m_PhysicalDeviceProperties.deviceID &&
+		   memcmp(header.pipelineCacheUUID, m_PhysicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void Renderer::SavePipelineCache() {
+	ZoneScoped;
+	if (m_PipelineCache == VK_NULL_HANDLE) {
+		return;
+	}
+
+	auto pipelineCacheData = std::make_shared<PipelineCache>();
+	size_t pipelineCacheDataSize = 0;
+	VkResult result = vkGetPipelineCacheData(m_Device, m_PipelineCache, &pipelineCacheDataSize, NULL);
+	if (result != VK_SUCCESS || pipelineCacheDataSize == 0) {
+		return;
+	}
+	pipelineCacheData->data.resize(pipelineCacheDataSize);
+	result = vkGetPipelineCacheData(m_Device, m_PipelineCache, &pipelineCacheDataSize, pipelineCacheData->data.data());
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Failed to read back pipeline cache.");
+		return;
+	}
+	pipelineCacheData->data.resize(pipelineCacheDataSize);
+
+	m_AssetManager.SaveAsset("cache/pipeline.cache", pipelineCacheData);
+}
+
+int Renderer::CreatePipelines(VkExtent2D extent, const std::vector<PipelineDescription>& descriptions,
+							  std::vector<VkPipeline>& pipelines)
+{
+	ZoneScoped;
+	pipelines.assign(descriptions.size(), VK_NULL_HANDLE);
+
+	// Variants share shaders, so each one is loaded, reflected and turned into a module once.
+	struct ShaderModule {
+		VkShaderModule module;
+		ShaderReflection reflection;
+	};
+	std::unordered_map<std::string, ShaderModule> shaderModules;
+	auto getShaderModule = [&](const std::string& name) -> const ShaderModule* {
+		auto it = shaderModules.find(name);
+		if (it != shaderModules.end()) {
+			return it->second.module != VK_NULL_HANDLE ? &it->second : NULL;
+		}
+
+		ShaderModule& shaderModule = shaderModules[name];
+		shaderModule.module = VK_NULL_HANDLE;
+		auto shaderCode = LoadShader(name);
+		if (shaderCode == nullptr || ReflectShader(*shaderCode, &shaderModule.reflection) != 0) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to load shader \"%s\".", name.c_str());
+			return NULL;
+		}
+		shaderModule.module = CreateShaderModule(m_Device, shaderCode);
+		return shaderModule.module != VK_NULL_HANDLE ? &shaderModule : NULL;
+	};
+
+	// Per pipeline state, sized up front so the create infos can point into it.
+	struct PipelineState {
+		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+		std::vector<VkSpecializationMapEntry> specializationEntries;
+		std::vector<uint32_t> specializationData;
+		VkSpecializationInfo specializationInfo;
+		std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+		std::vector<VkVertexInputBindingDescription> vertexInputBindings;
+		VkPipelineVertexInputStateCreateInfo vertexInputState;
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState;
+		VkPipelineRasterizationStateCreateInfo rasterizationState;
+		VkPipelineDepthStencilStateCreateInfo depthStencilState;
+		VkPipelineColorBlendAttachmentState colorBlendAttachmentState;
+		VkPipelineColorBlendStateCreateInfo colorBlendState;
+	};
+	std::vector<PipelineState> states(descriptions.size());
+
+	std::vector<VkDynamicState> dynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {};
+	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicStateCreateInfo.pNext = NULL;
+	dynamicStateCreateInfo.flags = 0;
+	dynamicStateCreateInfo.dynamicStateCount = dynamicStates.size();
+	dynamicStateCreateInfo.pDynamicStates = dynamicStates.data();
+
+	VkViewport viewport;
+	viewport.x = 0;
+	viewport.y = 0;
+	viewport.width = extent.width;
+	viewport.height = extent.height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	VkRect2D scissor;
+	scissor.extent = extent;
+	scissor.offset = { 0, 0 };
+
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {};
+	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportStateCreateInfo.pNext = NULL;
+	viewportStateCreateInfo.flags = 0;
+	viewportStateCreateInfo.viewportCount = 1;
+	viewportStateCreateInfo.pViewports = &viewport;
+	viewportStateCreateInfo.scissorCount = 1;
+	viewportStateCreateInfo.pScissors = &scissor;
+
+	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {};
+	multisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampleStateCreateInfo.pNext = NULL;
+	multisampleStateCreateInfo.flags = 0;
+	multisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisampleStateCreateInfo.alphaToOneEnable = VK_FALSE;
+	multisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
+	multisampleStateCreateInfo.minSampleShading = 1.0f;
+	multisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
+	multisampleStateCreateInfo.pSampleMask = NULL;
+
+	std::vector<VkGraphicsPipelineCreateInfo> pipelineCreateInfos;
+	// Index into descriptions of each entry of pipelineCreateInfos.
+	std::vector<size_t> pipelineIndices;
+	for (size_t i = 0; i < descriptions.size(); i++) {
+		const PipelineDescription& description = descriptions[i];
+		PipelineState& state = states[i];
+
+		const ShaderModule* vertexShader = getShaderModule(description.vertexShader);
+		const ShaderModule* fragmentShader = getShaderModule(description.fragmentShader);
+		if (vertexShader == NULL || fragmentShader == NULL) {
+			continue;
+		}
 
+		// The layout is created once in Init(), reloaded shaders have to keep fitting it.
+		ShaderReflection reflection = vertexShader->reflection;
+		if (MergeShaderReflection(reflection, fragmentShader->reflection) != 0 ||
+			!IsLayoutCompatible(m_PipelineLayoutReflection, reflection))
+		{
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "Resources of \"%s\" and \"%s\" do not match the pipeline layout, restart to apply.",
+											 description.vertexShader.c_str(), description.fragmentShader.c_str());
+			continue;
+		}
+
+		if (!description.vertexFormats.empty() &&
+			description.vertexFormats.size() != vertexShader->reflection.vertexInputs.size())
+		{
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "\"%s\" has %zu vertex inputs but %zu vertex formats were given.",
+											 description.vertexShader.c_str(), vertexShader->reflection.vertexInputs.size(),
+											 description.vertexFormats.size());
+			continue;
+		}
+
+		for (auto& constant : description.specializationConstants) {
+			VkSpecializationMapEntry specializationEntry = {};
+			specializationEntry.constantID = constant.id;
+			specializationEntry.offset = state.specializationData.size() * sizeof(uint32_t);
+			specializationEntry.size = sizeof(uint32_t);
+			state.specializationEntries.push_back(specializationEntry);
+			state.specializationData.push_back(constant.value);
+		}
+		state.specializationInfo.mapEntryCount = state.specializationEntries.size();
+		state.specializationInfo.pMapEntries = state.specializationEntries.data();
+		state.specializationInfo.dataSize = state.specializationData.size() * sizeof(uint32_t);
+		state.specializationInfo.pData = state.specializationData.data();
+
+		VkPipelineShaderStageCreateInfo shaderStageCreateInfo = {};
+		shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageCreateInfo.pNext = NULL;
+		shaderStageCreateInfo.flags = 0;
+		shaderStageCreateInfo.pName = "main";
+		shaderStageCreateInfo.pSpecializationInfo =
+			state.specializationEntries.empty() ? NULL : &state.specializationInfo;
+		shaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		shaderStageCreateInfo.module = vertexShader->module;
+		state.shaderStages[0] = shaderStageCreateInfo;
+		shaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		shaderStageCreateInfo.module = fragmentShader->module;
+		state.shaderStages[1] = shaderStageCreateInfo;
+
+		BuildVertexInputLayout(vertexShader->reflection, description.vertexFormats, description.instanceLocation,
+							   state.vertexInputAttributes, state.vertexInputBindings);
+
+		state.vertexInputState = {};
+		state.vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		state.vertexInputState.pNext = NULL;
+		state.vertexInputState.flags = 0;
+		state.vertexInputState.vertexAttributeDescriptionCount = state.vertexInputAttributes.size();
+		state.vertexInputState.pVertexAttributeDescriptions = state.vertexInputAttributes.data();
+		// Shaders generating their vertices, such as fullscreen passes, take no buffer.
+		state.vertexInputState.vertexBindingDescriptionCount = state.vertexInputBindings.size();
+		state.vertexInputState.pVertexBindingDescriptions = state.vertexInputBindings.data();
+
+		state.inputAssemblyState = {};
+		state.inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		state.inputAssemblyState.pNext = NULL;
+		state.inputAssemblyState.flags = 0;
+		state.inputAssemblyState.topology = description.topology;
+		state.inputAssemblyState.primitiveRestartEnable = VK_FALSE;
+
+		state.rasterizationState = {};
+		state.rasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		state.rasterizationState.pNext = NULL;
+		state.rasterizationState.flags = 0;
+		state.rasterizationState.frontFace = description.frontFace;
+		state.rasterizationState.cullMode = description.cullMode;
+		state.rasterizationState.polygonMode = description.polygonMode;
+		state.rasterizationState.lineWidth = 1.0f;
+		state.rasterizationState.rasterizerDiscardEnable = VK_FALSE;
+		state.rasterizationState.depthBiasEnable = VK_FALSE;
+		state.rasterizationState.depthBiasClamp = 0.0f;
+		state.rasterizationState.depthBiasSlopeFactor = 0.0f;
+		state.rasterizationState.depthBiasConstantFactor = 0.0f;
+
+		state.depthStencilState = {};
+		state.depthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		state.depthStencilState.pNext = NULL;
+		state.depthStencilState.flags = 0;
+		state.depthStencilState.depthTestEnable = description.depthTest ? VK_TRUE : VK_FALSE;
+		state.depthStencilState.depthWriteEnable = description.depthWrite ? VK_TRUE : VK_FALSE;
+		state.depthStencilState.depthCompareOp = description.depthCompareOp;
+		state.depthStencilState.depthBoundsTestEnable = VK_FALSE;
+		state.depthStencilState.stencilTestEnable = VK_FALSE;
+		state.depthStencilState.front = {};
+		state.depthStencilState.back = {};
+		state.depthStencilState.minDepthBounds = 0.0f;
+		state.depthStencilState.maxDepthBounds = 1.0f;
+
+		state.colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		state.colorBlendAttachmentState.blendEnable = description.blend ? VK_TRUE : VK_FALSE;
+		state.colorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+		state.colorBlendAttachmentState.srcColorBlendFactor =
+			description.blend ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+		state.colorBlendAttachmentState.dstColorBlendFactor =
+			description.blend ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO;
+		state.colorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+		state.colorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		state.colorBlendAttachmentState.dstAlphaBlendFactor =
+			description.blend ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO;
+
+		state.colorBlendState = {};
+		state.colorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		state.colorBlendState.pNext = NULL;
+		state.colorBlendState.flags = 0;
+		state.colorBlendState.logicOpEnable = VK_FALSE;
+		state.colorBlendState.logicOp = VK_LOGIC_OP_COPY;
+		state.colorBlendState.attachmentCount = 1;
+		state.colorBlendState.pAttachments = &state.colorBlendAttachmentState;
+		state.colorBlendState.blendConstants[0] = 0.0f;
+		state.colorBlendState.blendConstants[1] = 0.0f;
+		state.colorBlendState.blendConstants[2] = 0.0f;
+		state.colorBlendState.blendConstants[3] = 0.0f;
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
+		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineCreateInfo.pNext = NULL;
+		pipelineCreateInfo.flags = 0;
+		pipelineCreateInfo.layout = m_PipelineLayout;
+		pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineCreateInfo.basePipelineIndex = 0;
+		pipelineCreateInfo.renderPass = m_RenderPass;
+		pipelineCreateInfo.subpass = 0;
+		pipelineCreateInfo.stageCount = state.shaderStages.size();
+		pipelineCreateInfo.pStages = state.shaderStages.data();
+		pipelineCreateInfo.pVertexInputState = &state.vertexInputState;
+		pipelineCreateInfo.pInputAssemblyState = &state.inputAssemblyState;
+		pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+		pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+		pipelineCreateInfo.pRasterizationState = &state.rasterizationState;
+		pipelineCreateInfo.pMultisampleState = &multisampleStateCreateInfo;
+		pipelineCreateInfo.pColorBlendState = &state.colorBlendState;
+		pipelineCreateInfo.pDepthStencilState = &state.depthStencilState;
+		pipelineCreateInfo.pTessellationState = NULL;
+		pipelineCreateInfos.push_back(pipelineCreateInfo);
+		pipelineIndices.push_back(i);
+	}
+
+	std::vector<VkPipeline> createdPipelines(pipelineCreateInfos.size(), VK_NULL_HANDLE);
+	VkResult result = VK_SUCCESS;
+	if (!pipelineCreateInfos.empty()) {
+		result = CreateGraphicsPipelines(pipelineCreateInfos.size(), pipelineCreateInfos.data(),
+										 createdPipelines.data());
+	}
+	for (size_t i = 0; i < createdPipelines.size(); i++) {
+		pipelines[pipelineIndices[i]] = createdPipelines[i];
+	}
+
+	for (auto& shaderModule : shaderModules) {
+		vkDestroyShaderModule(m_Device, shaderModule.second.module, NULL);
+	}
+
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create graphics pipelines.");
+	}
+	if (result != VK_SUCCESS || pipelineCreateInfos.size() != descriptions.size()) {
+		return -1;
+	}
+	return 0;
+}
+
+int Renderer::CreateSkyboxPipeline(VkExtent2D extent, VkPipeline* pipeline) {
+	ZoneScoped;
+	VkResult result;
+
+	VkShaderModule vertexShaderModule = VK_NULL_HANDLE, fragmentShaderModule = VK_NULL_HANDLE;
+	auto skyboxVertexShaderCode = LoadShader(s_SkyboxShaderNames[0]);
+	auto skyboxFragmentShaderCode = LoadShader(s_SkyboxShaderNames[1]);
+	if (skyboxVertexShaderCode == nullptr || skyboxFragmentShaderCode == nullptr) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to load skybox shaders.");
+		return -1;
+	}
+
+	ShaderReflection reflection, vertexReflection;
+	std::vector<VkDescriptorSetLayout> setLayouts;
+	if (ReflectShaders({ skyboxVertexShaderCode, skyboxFragmentShaderCode }, &reflection) != 0 ||
+		ReflectShader(*skyboxVertexShaderCode, &vertexReflection) != 0 ||
+		GetDescriptorSetLayouts(reflection, setLayouts) != 0)
+	{
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to reflect skybox shaders.");
+		return -1;
+	}
+	if (setLayouts != std::vector<VkDescriptorSetLayout>{ m_SkyboxDescriptorSetLayout }) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Skybox shader resources no longer match the pipeline layout, restart to apply.");
+		return -1;
+	}
+
+	vertexShaderModule = CreateShaderModule(m_Device, skyboxVertexShaderCode);
+	fragmentShaderModule = CreateShaderModule(m_Device, skyboxFragmentShaderCode);
+
+	skyboxVertexShaderCode.reset();
+	skyboxFragmentShaderCode.reset();
+
+	std::vector<VkPipelineShaderStageCreateInfo> skyboxPipelineShaderStageCrateInfos;
+	skyboxPipelineShaderStageCrateInfos.push_back({
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.stage = VK_SHADER_STAGE_VERTEX_BIT,
+		.module = vertexShaderModule,
+		.pName = "main",
+		.pSpecializationInfo = NULL
+	});
+	skyboxPipelineShaderStageCrateInfos.push_back({
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+		.module = fragmentShaderModule,
+		.pName = "main",
+		.pSpecializationInfo = NULL
+	});
+
+	std::vector<VkVertexInputAttributeDescription> skyboxVertexInputDescriptions;
+	VkVertexInputBindingDescription skyboxVertexBindingDescription = {
+		.binding = 0,
+		.stride = BuildVertexInputLayout(vertexReflection, {}, skyboxVertexInputDescriptions),
+		.inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+	};
+
+	VkPipelineVertexInputStateCreateInfo skyboxVertexInputStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.vertexBindingDescriptionCount = 1,
+		.pVertexBindingDescriptions = &skyboxVertexBindingDescription,
+		.vertexAttributeDescriptionCount = static_cast<uint32_t>(skyboxVertexInputDescriptions.size()),
+		.pVertexAttributeDescriptions = skyboxVertexInputDescriptions.data()
+	};
+
+	VkPipelineInputAssemblyStateCreateInfo skyboxInputAssemblyStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+		.primitiveRestartEnable = VK_FALSE
+	};
+
+	VkViewport viewport = {
+		.x = 0.0f,
+		.y = 0.0f,
+		.width = static_cast<float>(extent.width),
+		.height = static_cast<float>(extent.height),
+		.minDepth = 0.0f,
+		.maxDepth = 1.0f
+	};
+	VkRect2D scissor = {
+		.offset = { 0u, 0u },
+		.extent = extent
+	};
+
+	VkPipelineViewportStateCreateInfo skyboxViewportStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.viewportCount = 1,
+		.pViewports = &viewport,
+		.scissorCount = 1,
+		.pScissors = &scissor
+	};
+
+	VkPipelineRasterizationStateCreateInfo skyboxRasterizationStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.depthClampEnable = VK_FALSE,
+		.rasterizerDiscardEnable = VK_FALSE,
+		.polygonMode = VK_POLYGON_MODE_FILL,
+		.cullMode = VK_CULL_MODE_NONE,
+		.frontFace = VK_FRONT_FACE_CLOCKWISE,
+		.depthBiasEnable = VK_FALSE,
+		.depthBiasConstantFactor = 0.0f,
+		.depthBiasClamp = 0.0f,
+		.depthBiasSlopeFactor = 0.0f,
+		.lineWidth = 1.0f
+	};
+
+	VkPipelineMultisampleStateCreateInfo skyboxMultisampleStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+		.sampleShadingEnable = VK_FALSE,
+		.minSampleShading = 1.0f,
+		.pSampleMask = NULL,
+		.alphaToCoverageEnable = VK_FALSE,
+		.alphaToOneEnable = VK_FALSE
+	};
+
+	VkPipelineDepthStencilStateCreateInfo skyboxDepthStencilStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.depthTestEnable = VK_TRUE,
+		.depthWriteEnable = VK_TRUE,
+		.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
+		.depthBoundsTestEnable = VK_FALSE,
+		.stencilTestEnable = VK_FALSE,
+		.front = {},
+		.back = {},
+		.minDepthBounds = 0.0f,
+		.maxDepthBounds = 0.0f
+	};
+
+	VkPipelineColorBlendAttachmentState skyboxColorBlendAttachmentState;
+	skyboxColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+	VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	skyboxColorBlendAttachmentState.blendEnable = VK_FALSE;
+	skyboxColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+	skyboxColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	skyboxColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+	skyboxColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+	skyboxColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	skyboxColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+
+	VkPipelineColorBlendStateCreateInfo skyboxColorBlendStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.logicOpEnable = VK_FALSE,
+		.logicOp = VK_LOGIC_OP_COPY,
+		.attachmentCount = 1,
+		.pAttachments = &skyboxColorBlendAttachmentState,
+		.blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
+	};
+
+
+	VkDynamicState dynamicStates[] = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo skyboxDynamicStateCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.dynamicStateCount = 2,
+		.pDynamicStates = dynamicStates
+	};
+
+	VkGraphicsPipelineCreateInfo skyboxPipelineCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.stageCount = static_cast<uint32_t>(skyboxPipelineShaderStageCrateInfos.size()),
+		.pStages = skyboxPipelineShaderStageCrateInfos.data(),
+		.pVertexInputState = &skyboxVertexInputStateCreateInfo,
+		.pInputAssemblyState = &skyboxInputAssemblyStateCreateInfo,
+		.pTessellationState = NULL,
+		.pViewportState = &skyboxViewportStateCreateInfo,
+		.pRasterizationState = &skyboxRasterizationStateCreateInfo,
+		.pMultisampleState = &skyboxMultisampleStateCreateInfo,
+		.pDepthStencilState = &skyboxDepthStencilStateCreateInfo,
+		.pColorBlendState = &skyboxColorBlendStateCreateInfo,
+		.pDynamicState = &skyboxDynamicStateCreateInfo,
+		.layout = m_SkyboxPipelineLayout,
+		.renderPass = m_RenderPass,
+		.subpass = 0,
+		.basePipelineHandle = NULL,
+		.basePipelineIndex = 0
+	};
+	result = vkCreateGraphicsPipelines(m_Device,
+									   m_PipelineCache,
+									   1,
+									   &skyboxPipelineCreateInfo,
+									   NULL,
+									   pipeline);
+
+	vkDestroyShaderModule(m_Device, vertexShaderModule, NULL);
+	vkDestroyShaderModule(m_Device, fragmentShaderModule, NULL);
+
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create pipeline for skybox.");
+		return -1;
+	}
+
+	return 0;
 }
 
 VkResult Renderer::ImmediateSubmit(std::function<void(RawCommandBuffer&)> fn, CommandQueueType queueType) {
@@ -3377,6 +5288,7 @@ VkResult Renderer::ImmediateSubmit(std::function<void(RawCommandBuffer&)> fn, Co
 										 "Failed to allocate command buffer for immedate submission.");
 		return result;
 	}
+	m_Statistics.commandBuffersAllocated++;
 
 	result = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
 	if (result != VK_SUCCESS) {
@@ -3465,6 +5377,7 @@ VkResult Renderer::QueueSubmit(std::function<void(RawCommandBuffer&)> fn, Comman
 										 "Failed to allocate command buffer for immedate submission.");
 		return result;
 	}
+	m_Statistics.commandBuffersAllocated++;
 
 	result = vkBeginCommandBuffer(bakedCommandBuffer.commandBuffer, &commandBufferBeginInfo);
 	if (result != VK_SUCCESS) {
@@ -3520,11 +5433,22 @@ VkResult Renderer::FlushQueuedSubmits() {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to reset fences for submission queue.");
 	}
 
+	// The timestamp command buffers belong to the profiler and must not reach the
+	// deletion queue, so the batches are timed on copies.
+	std::vector<VkCommandBuffer> transferSubmission = transferCommandBuffers;
+	std::vector<VkCommandBuffer> graphicsSubmission = graphicsCommandBuffers;
+	if (!transferSubmission.empty()) {
+		m_GpuProfiler.WrapSubmission(GPU_QUEUE_TRANSFER, "Transfer batch", transferSubmission);
+	}
+	if (!graphicsSubmission.empty()) {
+		m_GpuProfiler.WrapSubmission(GPU_QUEUE_GRAPHICS, "Graphics batch", graphicsSubmission);
+	}
+
 	VkSubmitInfo transferCommandBufferSubmitInfo = {};
 	transferCommandBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	transferCommandBufferSubmitInfo.pNext = NULL;
-	transferCommandBufferSubmitInfo.commandBufferCount = transferCommandBuffers.size();
-	transferCommandBufferSubmitInfo.pCommandBuffers = transferCommandBuffers.data();
+	transferCommandBufferSubmitInfo.commandBufferCount = transferSubmission.size();
+	transferCommandBufferSubmitInfo.pCommandBuffers = transferSubmission.data();
 	transferCommandBufferSubmitInfo.signalSemaphoreCount = 0;
 	transferCommandBufferSubmitInfo.pSignalSemaphores = NULL;
 	transferCommandBufferSubmitInfo.waitSemaphoreCount = 0;
@@ -3541,8 +5465,8 @@ VkResult Renderer::FlushQueuedSubmits() {
 	VkSubmitInfo graphicsCommandBufferSubmitInfo = {};
 	graphicsCommandBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	graphicsCommandBufferSubmitInfo.pNext = NULL;
-	graphicsCommandBufferSubmitInfo.commandBufferCount = graphicsCommandBuffers.size();
-	graphicsCommandBufferSubmitInfo.pCommandBuffers = graphicsCommandBuffers.data();
+	graphicsCommandBufferSubmitInfo.commandBufferCount = graphicsSubmission.size();
+	graphicsCommandBufferSubmitInfo.pCommandBuffers = graphicsSubmission.data();
 	graphicsCommandBufferSubmitInfo.signalSemaphoreCount = 0;
 	graphicsCommandBufferSubmitInfo.pSignalSemaphores = NULL;
 	graphicsCommandBufferSubmitInfo.waitSemaphoreCount = 0;
@@ -3624,6 +5548,7 @@ VkCommandBuffer Renderer::StartCommandBuffer(CommandQueueType queueType) {
 										 "Failed to allocate command buffer for immedate submission.");
 		return VK_NULL_HANDLE;
 	}
+	m_Statistics.commandBuffersAllocated++;
 
 	result = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
 	if (result != VK_SUCCESS) {
@@ -3807,24 +5732,48 @@ VkShaderModule Renderer::CreateShaderModule(VkDevice device, std::shared_ptr<Sha
 }
 
 VkShaderModule Renderer::CreateShaderModule(VkDevice device, std::shared_ptr<ShaderCode> code) {
-	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "NOT YET IMPLEMENTED!");
-	raise(SIGINT);
-	
-	VkShaderModuleCreateInfo shaderModuleCreateInfo;
-	shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	shaderModuleCreateInfo.pNext = NULL;
-	shaderModuleCreateInfo.flags = 0;
-	shaderModuleCreateInfo.codeSize = code->glslCode.size();
-	shaderModuleCreateInfo.pCode = reinterpret_cast<uint32_t*>(code->glslCode.data());
+	ShaderCompiler compiler;
+	auto binary = compiler.Compile(*code);
+	if (binary == nullptr) {
+		return VK_NULL_HANDLE;
+	}
+	return CreateShaderModule(device, binary);
+}
 
-	VkShaderModule shader;
+std::shared_ptr<ShaderBinary> Renderer::LoadShader(const std::string& name, const ShaderDefines& defines) {
+	ZoneScoped;
+	auto binary = CompileShader(name, defines);
+	if (binary != nullptr) {
+		return binary;
+	}
 
-	VkResult result = vkCreateShaderModule(device, &shaderModuleCreateInfo, NULL, &shader);
-	if (result != VK_SUCCESS) {
-		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create shader module.");
-		return VK_NULL_HANDLE;
+	if (!defines.empty()) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Shader permutation of \"%s\" requires compiling from source.", name.c_str());
+		return nullptr;
 	}
-	return shader;
+	return m_AssetManager.LoadAsset<ShaderBinary>("shaders/" + name + ".spv");
+}
+
+std::shared_ptr<ShaderBinary> Renderer::CompileShader(const std::string& name, const ShaderDefines& defines) {
+	ZoneScoped;
+	std::filesystem::path sourcePath = "shaders/src/" + name + ".glsl";
+	if (!ShaderCompiler::IsAvailable() || !m_AssetManager.Exists(m_AssetManager.GetAssetRoot() / sourcePath)) {
+		return nullptr;
+	}
+	auto code = m_AssetManager.LoadAsset<ShaderCode>(sourcePath);
+	if (code == nullptr) {
+		return nullptr;
+	}
+
+	// The texture table declaration depends on the device, see the fragment shaders.
+	ShaderDefines rendererDefines;
+	rendererDefines.emplace_back("CEE_MAX_TEXTURES", std::to_string(m_TextureTableSize));
+	if (m_DescriptorIndexing) {
+		rendererDefines.emplace_back("CEE_DESCRIPTOR_INDEXING", "1");
+	}
+	rendererDefines.insert(rendererDefines.end(), defines.begin(), defines.end());
+	return m_ShaderCompiler.Compile(*code, rendererDefines);
 }
 
 VkFormat Renderer::ChooseDepthFormat(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tilingMode, VkFormatFeatureFlags features) {
@@ -3905,7 +5854,7 @@ VkResult Renderer::CreateImageObjects(VkImage* image, VkDeviceMemory* deviceMemo
 	imageViewCreateInfo.subresourceRange = {
 		.aspectMask = format == m_DepthFormat ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT,
 		.baseMipLevel = 0,
-		.levelCount = 1,
+		.levelCount = mipLevels,
 		.baseArrayLayer = 0,
 		.layerCount = layers
 	};
@@ -3989,7 +5938,8 @@ int Renderer::TransitionImageLayout(VkImage image,
 int Renderer::CreateCommonBuffer(VkBuffer& buffer,
 								  VkDeviceMemory& memory,
 								  VkBufferUsageFlags usage,
-								  size_t size)
+								  size_t size,
+								  VkMemoryPropertyFlags memoryPropertyFlags)
 {
 	VkBufferCreateInfo bufferCreateInfo = {};
 	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -4012,11 +5962,12 @@ int Renderer::CreateCommonBuffer(VkBuffer& buffer,
 	VkPhysicalDeviceMemoryProperties memoryProperties = {};
 	vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &memoryProperties);
 
-	VkMemoryPropertyFlags memoryPropertyFlags;
-	if (usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) {
-		memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-	} else {
-		memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	if (memoryPropertyFlags == 0) {
+		if (usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) {
+			memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		} else {
+			memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		}
 	}
 
 	VkMemoryAllocateInfo memoryAllocateInfo = {};
@@ -4102,15 +6053,35 @@ UniformBuffer Renderer::CreateUniformBuffer(size_t size) {
 	return buffer;
 }
 
-ImageBuffer Renderer::CreateImageBuffer(size_t width, size_t height, ImageFormat format) {
+StorageBuffer Renderer::CreateStorageBuffer(size_t size, VkBufferUsageFlags usage) {
+	StorageBuffer buffer;
+	buffer.m_Device = m_Device;
+
+	if (CreateCommonBuffer(buffer.m_Buffer,
+		buffer.m_DeviceMemory,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | usage,
+		size))
+	{
+		return StorageBuffer();
+	}
+
+	buffer.m_Size = size;
+	buffer.m_Initialized = true;
+
+	return buffer;
+}
+
+ImageBuffer Renderer::CreateImageBuffer(size_t width, size_t height, ImageFormat format, bool generateMipmaps) {
 	ImageBuffer buffer;
 	buffer.m_Device = m_Device;
 	buffer.m_CommandPool = m_TransferCmdPool;
 	buffer.m_TransferQueue = m_TransferQueue;
+	buffer.m_Extent = { (uint32_t)width, (uint32_t)height, 1u };
 
 	VkResult result = VK_SUCCESS;
 
 	if (format == IMAGE_FORMAT_DEPTH) {
+		buffer.m_Format = m_DepthFormat;
 		result = Renderer::Get()->CreateImageObjects(&buffer.m_Image,
 													 &buffer.m_DeviceMemory,
 													 &buffer.m_ImageView,
@@ -4122,16 +6093,22 @@ ImageBuffer Renderer::CreateImageBuffer(size_t width, size_t height, ImageFormat
 													 &buffer.m_Size,
 													 1, 1);
 	} else {
+		buffer.m_Format = CeeFormatToVkFormat(format);
+		if (generateMipmaps) {
+			buffer.m_MipLevels = CalculateMipLevels(buffer.m_Extent.width, buffer.m_Extent.height);
+			buffer.m_HostMipmaps = !SupportsBlitMipmaps(buffer.m_Format);
+		}
 		result = Renderer::Get()->CreateImageObjects(&buffer.m_Image,
 													 &buffer.m_DeviceMemory,
 													 &buffer.m_ImageView,
-													 CeeFormatToVkFormat(format),
+													 buffer.m_Format,
+													 VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
 													 VK_IMAGE_USAGE_TRANSFER_DST_BIT |
 													 VK_IMAGE_USAGE_SAMPLED_BIT,
 													 (uint32_t*)&width,
 													 (uint32_t*)&height,
 													 &buffer.m_Size,
-													 1, 1);
+													 buffer.m_MipLevels, 1);
 	}
 	CEE_VERIFY(result == VK_SUCCESS, "Failed to create image buffer.");
 
@@ -4140,6 +6117,34 @@ ImageBuffer Renderer::CreateImageBuffer(size_t width, size_t height, ImageFormat
 	return buffer;
 }
 
+ImageBuffer Renderer::CreateRenderTarget(uint32_t width, uint32_t height, VkFormat format) {
+	ImageBuffer buffer;
+	buffer.m_Device = m_Device;
+	buffer.m_CommandPool = m_TransferCmdPool;
+	buffer.m_TransferQueue = m_TransferQueue;
+	buffer.m_Extent = { width, height, 1u };
+	buffer.m_Format = format;
+
+	VkResult result = CreateImageObjects(&buffer.m_Image,
+										 &buffer.m_DeviceMemory,
+										 &buffer.m_ImageView,
+										 format,
+										 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+										 VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+										 &width,
+										 &height,
+										 &buffer.m_Size,
+										 1, 1);
+	if (result != VK_SUCCESS) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to create render target.");
+		return ImageBuffer();
+	}
+
+	buffer.m_Initialized = true;
+
+	return buffer;
+}
+
 StagingBuffer Renderer::CreateStagingBuffer(size_t size) {
 	StagingBuffer buffer;
 	buffer.m_Device = m_Device;
@@ -2,6 +2,11 @@
 
 #include <CeeEngine/debugMessenger.h>
 
+#include <algorithm>
+
+// Quads DrawQuads() builds in cache before streaming them to the staging buffer.
+#define RENDERER_2D_QUAD_CHUNK_SIZE 64
+
 namespace cee {
 RendererCapabilities Renderer2D::s_RendererCapabilities = {};
 
@@ -9,19 +14,24 @@ VertexBuffer Renderer2D::s_VertexBuffer;
 IndexBuffer Renderer2D::s_IndexBuffer;
 
 StagingBuffer Renderer2D::s_StagingBuffer;
+Vertex2D* Renderer2D::s_Vertices = NULL;
+Vertex2DPacked* Renderer2D::s_PackedVertices = NULL;
+size_t Renderer2D::s_VertexSize = sizeof(Vertex2D);
 
 size_t Renderer2D::s_VertexOffset = 0;
 size_t Renderer2D::s_Index= 0;
+uint32_t Renderer2D::s_DroppedQuads = 0;
 
 bool Renderer2D::s_Initialized = false;
 MessageBus* Renderer2D::s_MessageBus = NULL;;
 std::shared_ptr<Renderer> Renderer2D::s_Renderer = NULL;
+std::unique_ptr<TextureAtlas> Renderer2D::s_TextureAtlas;
 
-void Renderer2D::Init(const RendererSpec& spec) {
+int32_t Renderer2D::Init(const RendererSpec& spec) {
 	if (s_Initialized == true) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
 										 "Renderer2D::Init called more than once.");
-		return;
+		return -1;
 	}
 
 	s_MessageBus = spec.msgBus;
@@ -31,7 +41,8 @@ void Renderer2D::Init(const RendererSpec& spec) {
 	rendererCapabilities.applicationName = "CeeEngine Application";
 	rendererCapabilities.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	rendererCapabilities.maxFramesInFlight = 3;
-	rendererCapabilities.maxIndices = 10000;
+	rendererCapabilities.maxIndices = spec.maxIndices != 0 ? spec.maxIndices : 10000;
+	rendererCapabilities.maxTextures = 4096;
 	rendererCapabilities.rendererMode = RENDERER_MODE_2D;
 	s_RendererCapabilities = rendererCapabilities;
 
@@ -39,54 +50,71 @@ void Renderer2D::Init(const RendererSpec& spec) {
 	if (s_Renderer->Init() != 0) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
 										 "Failed to initialize renderer framework for Renderer2D.");
-		return;
+		return -1;
 	}
 
+	// The renderer clamps the batch size.
+	s_RendererCapabilities.maxIndices = s_Renderer->GetMaxIndices();
 	s_VertexOffset = 0;
 
-	size_t maxVertices = (6 * s_RendererCapabilities.maxIndices) / 4;
-	s_StagingBuffer = s_Renderer->CreateStagingBuffer(sizeof(Vertex2D) * maxVertices);
+	size_t maxVertices = (s_RendererCapabilities.maxIndices / CEE_QUAD_INDEX_COUNT) * CEE_QUAD_VERTEX_COUNT;
+	s_VertexSize = spec.packedVertices ? sizeof(Vertex2DPacked) : sizeof(Vertex2D);
+	s_StagingBuffer = s_Renderer->CreateStagingBuffer(s_VertexSize * maxVertices);
 	s_IndexBuffer = s_Renderer->CreateIndexBuffer(sizeof(uint32_t) * s_RendererCapabilities.maxIndices);
-	s_VertexBuffer = s_Renderer->CreateVertexBuffer(sizeof(Vertex2D) * maxVertices);
-
-	uint32_t* indices = new uint32_t[s_RendererCapabilities.maxIndices];
-	size_t offset = 0, index = 0;
-	for (; offset < s_RendererCapabilities.maxIndices; offset += 6) {
-		indices[offset + 0] = index + 0;
-		indices[offset + 1] = index + 1;
-		indices[offset + 2] = index + 2;
-		indices[offset + 3] = index + 2;
-		indices[offset + 4] = index + 3;
-		indices[offset + 5] = index + 0;
-
-		index += 4;
-	}
+	s_VertexBuffer = s_Renderer->CreateVertexBuffer(s_VertexSize * maxVertices);
+
+	// Indices past the last whole quad are never drawn.
+	uint32_t* indices = new uint32_t[s_RendererCapabilities.maxIndices]();
+	BuildQuadIndices(s_RendererCapabilities.maxIndices / CEE_QUAD_INDEX_COUNT, indices);
 
 	s_StagingBuffer.SetData(sizeof(uint32_t) * s_RendererCapabilities.maxIndices, 0, indices);
 	s_StagingBuffer.TransferData(s_IndexBuffer, 0, 0, sizeof(uint32_t) * s_RendererCapabilities.maxIndices);
 
 	delete[] indices;
 
+	if (spec.packedVertices) {
+		s_PackedVertices = s_StagingBuffer.Reserve<Vertex2DPacked>(0, maxVertices);
+	} else {
+		s_Vertices = s_StagingBuffer.Reserve<Vertex2D>(0, maxVertices);
+	}
+	if (s_Vertices == NULL && s_PackedVertices == NULL) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to reserve the Renderer2D batch.");
+		return -1;
+	}
+
+	s_TextureAtlas = std::make_unique<TextureAtlas>();
+
 	s_Initialized = true;
+	return 0;
 }
 
 void Renderer2D::Shutdown() {
 	s_VertexBuffer = VertexBuffer();
+	s_Vertices = NULL;
+	s_PackedVertices = NULL;
 	s_StagingBuffer = StagingBuffer();
 	s_IndexBuffer = IndexBuffer();
+	s_TextureAtlas.reset();
 	s_Renderer.reset();
 }
 
 void Renderer2D::BeginFrame() {
+	s_TextureAtlas->Upload();
 	s_Renderer->Clear({ 0.0f, 0.0f, 0.0f, 1.0f });
 	s_Renderer->StartFrame();
 }
 
 void Renderer2D::Flush() {
-	s_StagingBuffer.TransferData(s_VertexBuffer, 0, 0, s_VertexOffset * sizeof(Vertex2D));
+	s_StagingBuffer.Commit();
+	s_StagingBuffer.TransferData(s_VertexBuffer, 0, 0, s_VertexOffset * s_VertexSize);
 	s_Renderer->Draw(s_IndexBuffer, s_VertexBuffer, s_Index);
 	s_VertexOffset = 0;
 	s_Index = 0;
+	if (s_DroppedQuads != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Renderer2D batch full, dropped %u quads.", s_DroppedQuads);
+		s_DroppedQuads = 0;
+	}
 }
 
 void Renderer2D::EndFrame() {
@@ -98,38 +126,65 @@ void Renderer2D::DrawQuad(const glm::vec3& translation,
 						  float rotationAngle,
 						  const glm::vec3& scale,
 						  const glm::vec4& color) {
-	static const glm::vec4 positions[] = {
-		{ -0.5f,  0.5f, 0.0f, 1.0f },
-		{  0.5f,  0.5f, 0.0f, 1.0f },
-		{  0.5f, -0.5f, 0.0f, 1.0f },
-		{ -0.5f, -0.5f, 0.0f, 1.0f }
-	};
-	static const glm::vec2 uv[] = {
-		{ 0.0f, 1.0f },
-		{ 1.0f, 1.0f },
-		{ 1.0f, 0.0f },
-		{ 0.0f, 0.0f }
-	};
-
-	glm::mat4 transform = ConstructTransformMatrix2D(translation, rotationAngle, scale);
-
-	Vertex2D vertices[4];
-	vertices[0].position = transform * positions[0];
-	vertices[0].color = color;
-	vertices[0].texCoords = uv[0];
-	vertices[1].position = transform * positions[1];
-	vertices[1].color = color;
-	vertices[1].texCoords = uv[1];
-	vertices[2].position = transform * positions[2];
-	vertices[2].color = color;
-	vertices[2].texCoords = uv[2];
-	vertices[3].position = transform * positions[3];
-	vertices[3].color = color;
-	vertices[3].texCoords = uv[3];
-
-	s_StagingBuffer.SetData(sizeof(vertices), s_VertexOffset * sizeof(Vertex2D), vertices);
-	s_VertexOffset += 4;
-	s_Index += 6;
+	DrawQuad(translation, rotationAngle, scale, color, CEE_INVALID_SUB_TEXTURE);
+}
+
+void Renderer2D::DrawQuad(const glm::vec3& translation,
+						  float rotationAngle,
+						  const glm::vec3& scale,
+						  const glm::vec4& color,
+						  SubTextureHandle subTexture) {
+	// The buffers are only drawn once per frame, flushing early would overwrite them
+	// before the first draw reads them.
+	if (s_Index + CEE_QUAD_INDEX_COUNT > s_RendererCapabilities.maxIndices) {
+		s_DroppedQuads++;
+		return;
+	}
+
+	// Untextured quads sample the default texture, invalid handles resolve to it too.
+	const SubTexture& region = s_TextureAtlas->Get(subTexture);
+	TextureHandle texIndex = region.texIndex != CEE_INVALID_TEXTURE_HANDLE ?
+		region.texIndex : s_Renderer->GetDefaultTexture();
+
+	if (s_PackedVertices != NULL) {
+		Vertex2D vertices[CEE_QUAD_VERTEX_COUNT];
+		BuildQuadVertices(translation, rotationAngle, scale, color, region.uvMin, region.uvMax, texIndex, vertices);
+		PackVertices(vertices, CEE_QUAD_VERTEX_COUNT, s_PackedVertices + s_VertexOffset);
+	} else {
+		BuildQuadVertices(translation, rotationAngle, scale, color, region.uvMin, region.uvMax, texIndex,
+						  s_Vertices + s_VertexOffset);
+	}
+	s_VertexOffset += CEE_QUAD_VERTEX_COUNT;
+	s_Index += CEE_QUAD_INDEX_COUNT;
+}
+
+void Renderer2D::DrawQuads(const QuadInstances& quads,
+						   SubTextureHandle subTexture) {
+	size_t capacity = (s_RendererCapabilities.maxIndices - s_Index) / CEE_QUAD_INDEX_COUNT;
+	size_t count = std::min(quads.count, capacity);
+	s_DroppedQuads += (uint32_t)(quads.count - count);
+
+	const SubTexture& region = s_TextureAtlas->Get(subTexture);
+	TextureHandle texIndex = region.texIndex != CEE_INVALID_TEXTURE_HANDLE ?
+		region.texIndex : s_Renderer->GetDefaultTexture();
+
+	// The kernel stores one corner of several quads at a time, scattered over a few
+	// hundred bytes. Straight to write combined memory that would flush partial lines.
+	Vertex2D vertices[RENDERER_2D_QUAD_CHUNK_SIZE * CEE_QUAD_VERTEX_COUNT];
+	Vertex2DPacked packedVertices[RENDERER_2D_QUAD_CHUNK_SIZE * CEE_QUAD_VERTEX_COUNT];
+	for (size_t first = 0; first < count; first += RENDERER_2D_QUAD_CHUNK_SIZE) {
+		size_t chunk = std::min<size_t>(count - first, RENDERER_2D_QUAD_CHUNK_SIZE);
+		BuildQuadVertexBatch(quads, first, chunk, region.uvMin, region.uvMax, texIndex, vertices);
+		if (s_PackedVertices != NULL) {
+			PackVertices(vertices, chunk * CEE_QUAD_VERTEX_COUNT, packedVertices);
+			StreamCopy(s_PackedVertices + s_VertexOffset, packedVertices,
+					   chunk * CEE_QUAD_VERTEX_COUNT * sizeof(Vertex2DPacked));
+		} else {
+			StreamCopy(s_Vertices + s_VertexOffset, vertices, chunk * CEE_QUAD_VERTEX_COUNT * sizeof(Vertex2D));
+		}
+		s_VertexOffset += chunk * CEE_QUAD_VERTEX_COUNT;
+		s_Index += chunk * CEE_QUAD_INDEX_COUNT;
+	}
 }
 
 int Renderer2D::UpdateCamera(Camera& camera) {
@@ -3,124 +3,49 @@
 
 #include <CeeEngine/debugMessenger.h>
 
-#include <random>
-
-static constexpr glm::vec4 CubeVertexPositions[] = {
-	{ -1.0f,  1.0f, -1.0f, 1.0f },    /////////////////
-	{  1.0f,  1.0f, -1.0f, 1.0f },    /// Top face ////
-	{  1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
-	{ -1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
-
-	{ -1.0f,  1.0f, -1.0f, 1.0f },    /////////////////
-	{ -1.0f,  1.0f,  1.0f, 1.0f },    /// Left face ///
-	{ -1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
-	{ -1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
-
-	{ -1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
-	{  1.0f,  1.0f,  1.0f, 1.0f },    // Front face ///
-	{  1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
-	{ -1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
-
-	{  1.0f,  1.0f,  1.0f, 1.0f },    /////////////////
-	{  1.0f,  1.0f, -1.0f, 1.0f },    // Right face ///
-	{  1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
-	{  1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
-
-	{  1.0f,  1.0f, -1.0f, 1.0f },    /////////////////
-	{ -1.0f,  1.0f, -1.0f, 1.0f },    /// Back face ///
-	{ -1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
-	{  1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
-
-	{  1.0f, -1.0f, -1.0f, 1.0f },    /////////////////
-	{ -1.0f, -1.0f, -1.0f, 1.0f },    // Bottom face //
-	{ -1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
-	{  1.0f, -1.0f,  1.0f, 1.0f },    /////////////////
-};
+#include <Tracy.hpp>
 
-static constexpr glm::vec3 CubeNormalVectors[] = {
-	{  0.0f,  1.0f,  0.0f },         /////////////////
-	{  0.0f,  1.0f,  0.0f },         //  Top face   //
-	{  0.0f,  1.0f,  0.0f },         /////////////////
-	{  0.0f,  1.0f,  0.0f },         /////////////////
-
-	{ -1.0f,  0.0f,  0.0f },         /////////////////
-	{ -1.0f,  0.0f,  0.0f },         //  Left face  //
-	{ -1.0f,  0.0f,  0.0f },         /////////////////
-	{ -1.0f,  0.0f,  0.0f },         /////////////////
-
-	{  0.0f,  0.0f,  1.0f },         /////////////////
-	{  0.0f,  0.0f,  1.0f },         // Front face  //
-	{  0.0f,  0.0f,  1.0f },         /////////////////
-	{  0.0f,  0.0f,  1.0f },         /////////////////
-
-	{  1.0f,  0.0f,  0.0f },         /////////////////
-	{  1.0f,  0.0f,  0.0f },         // Right face  //
-	{  1.0f,  0.0f,  0.0f },         /////////////////
-	{  1.0f,  0.0f,  0.0f },         /////////////////
-
-	{  0.0f,  0.0f, -1.0f },         /////////////////
-	{  0.0f,  0.0f, -1.0f },         //  Back face  //
-	{  0.0f,  0.0f, -1.0f },         /////////////////
-	{  0.0f,  0.0f, -1.0f },         /////////////////
-
-	{  0.0f, -1.0f,  0.0f },         /////////////////
-	{  0.0f, -1.0f,  0.0f },         // Bottom face //
-	{  0.0f, -1.0f,  0.0f },         /////////////////
-	{  0.0f, -1.0f,  0.0f }          /////////////////
-};
+#include <algorithm>
+#include <cmath>
 
-static constexpr uint32_t CubeIndices[] = {
-	 0,  1,  2,  2,  3,  0,          //  Top Face   //
-	 4,  5,  6,  6,  7,  4,          //  Left Face  //
-	 8,  9, 10, 10, 11,  8,          // Front Face  //
-	12, 13, 14, 14, 15, 12,          // Right Face  //
-	16, 17, 18, 18, 19, 16,          //  Back Face  //
-	20, 21, 22, 22, 23, 20           // Bottom Face //
-};
+// Fraction of the LOD threshold the projected error has to move past it before an
+// object with a MeshLodState changes level.
+#define CEE_LOD_HYSTERESIS 0.25f
+// Instances each invocation group of renderer3DCullCompute culls.
+#define CEE_CULL_GROUP_SIZE 64
 
-static constexpr glm::vec2 CubeTexCoords[] {
-	{ 0.0f, 0.0f },
-	{ 1.0f, 0.0f },
-	{ 1.0f, 1.0f },
-	{ 0.0f, 1.0f },
-
-	{ 0.0f, 0.0f },
-	{ 1.0f, 0.0f },
-	{ 1.0f, 1.0f },
-	{ 0.0f, 1.0f },
-
-	{ 0.0f, 0.0f },
-	{ 1.0f, 0.0f },
-	{ 1.0f, 1.0f },
-	{ 0.0f, 1.0f },
-
-	{ 0.0f, 0.0f },
-	{ 1.0f, 0.0f },
-	{ 1.0f, 1.0f },
-	{ 0.0f, 1.0f },
-
-	{ 0.0f, 0.0f },
-	{ 1.0f, 0.0f },
-	{ 1.0f, 1.0f },
-	{ 0.0f, 1.0f },
-
-	{ 0.0f, 0.0f },
-	{ 1.0f, 0.0f },
-	{ 1.0f, 1.0f },
-	{ 0.0f, 1.0f }
+namespace cee {
+// renderer3DCullCompute testing against the depth pyramid.
+static const ShaderDefines s_OcclusionCullingDefines = { { "OCCLUSION_CULLING", "1" } };
+
+// std430 CullGroup of renderer3DCullCompute, one per mesh with instances this frame.
+struct CullGroup {
+	glm::vec4 center;
+	glm::vec4 extents;
+	float lodErrors[CEE_MESH_MAX_LODS];
+	uint32_t lodCount;
+	uint32_t submeshCount;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+	// Into the index range table, lodCount levels of submeshCount ranges.
+	uint32_t firstRange;
+	// Into the draw commands, instanceCount * submeshCount are reserved.
+	uint32_t firstCommand;
+	uint32_t padding;
 };
-
-uint32_t CubeTexIndices[] {
-	0, 0, 0, 0,
-	1, 1, 1, 1,
-	2, 2, 2, 2,
-	3, 3, 3, 3,
-	4, 4, 4, 4,
-	5, 5, 5, 5
+static_assert(sizeof(CullGroup) == 80, "CullGroup must match its std430 layout.");
+
+// Push constants of renderer3DCullCompute, the guaranteed 128 bytes.
+struct CullConstants {
+	glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+	glm::vec4 depthRow;
+	float lodScale;
+	float lodThreshold;
+	uint32_t instanceCount;
+	uint32_t groupCount;
 };
+static_assert(sizeof(CullConstants) == 128, "CullConstants must fit the push constant limit.");
 
-
-namespace cee {
 RendererCapabilities Renderer3D::s_RendererCapabilities = {};
 
 VertexBuffer Renderer3D::s_VertexBuffer;
@@ -128,13 +53,49 @@ IndexBuffer Renderer3D::s_IndexBuffer;
 
 StagingBuffer Renderer3D::s_VertexStagingBuffer;
 StagingBuffer Renderer3D::s_IndexStagingBuffer;
+Vertex3D* Renderer3D::s_Vertices = NULL;
+Vertex3DPacked* Renderer3D::s_PackedVertices = NULL;
+size_t Renderer3D::s_VertexSize = sizeof(Vertex3D);
+uint32_t* Renderer3D::s_Indices = NULL;
 
 size_t Renderer3D::s_VertexOffset = 0;
 size_t Renderer3D::s_IndexOffset= 0;
+uint32_t Renderer3D::s_DroppedCubes = 0;
+
+std::vector<Renderer3D::ResidentMesh> Renderer3D::s_Meshes;
+std::vector<MeshHandle> Renderer3D::s_FreeMeshHandles;
+std::vector<Renderer3D::RetiredMesh> Renderer3D::s_RetiredMeshes;
+std::vector<Renderer3D::RetiredCullBuffer> Renderer3D::s_RetiredCullBuffers;
+PipelineDescription Renderer3D::s_MeshPipelineDescription;
+StorageBuffer Renderer3D::s_InstanceBuffer;
+StagingBuffer Renderer3D::s_InstanceStagingBuffer;
+MeshInstance* Renderer3D::s_Instances = NULL;
+uint32_t Renderer3D::s_InstanceCount = 0;
+uint32_t Renderer3D::s_MaxInstances = CEE_MAX_MESH_INSTANCES;
+uint32_t Renderer3D::s_DroppedInstances = 0;
+glm::mat4 Renderer3D::s_View = glm::mat4(1.0f);
+glm::mat4 Renderer3D::s_Projection = glm::mat4(1.0f);
+float Renderer3D::s_LodThreshold = 1.0f;
+Frustum Renderer3D::s_Frustum;
+bool Renderer3D::s_FrustumCulling = true;
+uint32_t Renderer3D::s_VisibleObjects = 0;
+uint32_t Renderer3D::s_CulledObjects = 0;
+bool Renderer3D::s_GpuCulling = false;
+StorageBuffer Renderer3D::s_CullInstanceBuffer;
+StorageBuffer Renderer3D::s_CullGroupBuffer;
+StorageBuffer Renderer3D::s_IndexRangeBuffer;
+StorageBuffer Renderer3D::s_DrawCommandBuffer;
+StorageBuffer Renderer3D::s_DrawCountBuffer;
+StagingBuffer Renderer3D::s_CullStagingBuffer;
+bool Renderer3D::s_OcclusionCulling = false;
+glm::mat4 Renderer3D::s_PreviousViewProjection = glm::mat4(1.0f);
+StorageBuffer Renderer3D::s_OcclusionViewBuffer;
+StagingBuffer Renderer3D::s_OcclusionStagingBuffer;
 
 bool Renderer3D::s_Initialized = false;
 MessageBus* Renderer3D::s_MessageBus = NULL;;
 std::shared_ptr<Renderer> Renderer3D::s_Renderer = NULL;
+std::unique_ptr<TextureStreamer> Renderer3D::s_TextureStreamer;
 
 int32_t Renderer3D::Init(const RendererSpec& spec) {
 	if (s_Initialized == true) {
@@ -150,11 +111,15 @@ int32_t Renderer3D::Init(const RendererSpec& spec) {
 	rendererCapabilities.applicationName = "CeeEngine Application";
 	rendererCapabilities.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	rendererCapabilities.maxFramesInFlight = 3;
-	rendererCapabilities.maxIndices = 10000;
+	rendererCapabilities.maxIndices = spec.maxIndices != 0 ? spec.maxIndices : 10000;
+	rendererCapabilities.maxTextures = 4096;
 	rendererCapabilities.rendererMode = RENDERER_MODE_3D;
 	s_RendererCapabilities = rendererCapabilities;
 
-	s_Renderer = std::make_shared<Renderer>(spec, rendererCapabilities);
+	// The depth pyramid is only of use to the GPU culling pass.
+	RendererSpec rendererSpec = spec;
+	rendererSpec.occlusionCulling = spec.occlusionCulling && spec.gpuCulling;
+	s_Renderer = std::make_shared<Renderer>(rendererSpec, rendererCapabilities);
 	int32_t ret = s_Renderer->Init();
 	if (ret != 0) {
 		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
@@ -162,13 +127,87 @@ int32_t Renderer3D::Init(const RendererSpec& spec) {
 		return ret;
 	}
 
+	// The renderer clamps the batch size.
+	s_RendererCapabilities.maxIndices = s_Renderer->GetMaxIndices();
 	s_VertexOffset = 0;
 
 	size_t maxVertices = (6 * s_RendererCapabilities.maxIndices) / 4;
-	s_VertexStagingBuffer = s_Renderer->CreateStagingBuffer(sizeof(Vertex3D) * maxVertices);
+	s_VertexSize = spec.packedVertices ? sizeof(Vertex3DPacked) : sizeof(Vertex3D);
+	s_VertexStagingBuffer = s_Renderer->CreateStagingBuffer(s_VertexSize * maxVertices);
 	s_IndexStagingBuffer = s_Renderer->CreateStagingBuffer(sizeof(uint32_t) * maxVertices);
 	s_IndexBuffer = s_Renderer->CreateIndexBuffer(sizeof(uint32_t) * s_RendererCapabilities.maxIndices);
-	s_VertexBuffer = s_Renderer->CreateVertexBuffer(sizeof(Vertex3D) * maxVertices);
+	s_VertexBuffer = s_Renderer->CreateVertexBuffer(s_VertexSize * maxVertices);
+
+	if (spec.packedVertices) {
+		s_PackedVertices = s_VertexStagingBuffer.Reserve<Vertex3DPacked>(0, maxVertices);
+	} else {
+		s_Vertices = s_VertexStagingBuffer.Reserve<Vertex3D>(0, maxVertices);
+	}
+	s_Indices = s_IndexStagingBuffer.Reserve<uint32_t>(0, s_RendererCapabilities.maxIndices);
+	if ((s_Vertices == NULL && s_PackedVertices == NULL) || s_Indices == NULL) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to reserve the Renderer3D batch.");
+		return -1;
+	}
+
+	s_GpuCulling = false;
+	if (spec.gpuCulling) {
+		if (!s_Renderer->SupportsDrawIndirectCount()) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Indirect count draws unsupported, meshes are culled on the host.");
+		} else if (s_Renderer->PrecompileComputePipeline("renderer3DCullCompute") != 0) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Failed to build the cull pipeline, meshes are culled on the host.");
+		} else {
+			s_GpuCulling = true;
+		}
+	}
+
+	s_OcclusionCulling = false;
+	if (spec.occlusionCulling) {
+		if (!s_GpuCulling || !s_Renderer->BuildsDepthPyramid()) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Occlusion culling requires GPU culling and a depth pyramid, disabling it.");
+		} else if (s_Renderer->PrecompileComputePipeline("renderer3DCullCompute", s_OcclusionCullingDefines) != 0) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+											 "Failed to build the occlusion cull pipeline, disabling occlusion culling.");
+		} else {
+			s_OcclusionViewBuffer = s_Renderer->CreateStorageBuffer(sizeof(glm::mat4));
+			s_OcclusionStagingBuffer = s_Renderer->CreateStagingBuffer(sizeof(glm::mat4) *
+																	   s_Renderer->GetMaxFramesInFlight());
+			s_OcclusionCulling = true;
+		}
+	}
+
+	s_MaxInstances = spec.maxMeshInstances != 0 ? spec.maxMeshInstances : CEE_MAX_MESH_INSTANCES;
+	size_t stagedInstances = (size_t)s_MaxInstances * s_Renderer->GetMaxFramesInFlight();
+	s_InstanceStagingBuffer = s_Renderer->CreateStagingBuffer(sizeof(MeshInstance) * stagedInstances);
+	if (s_GpuCulling) {
+		s_CullInstanceBuffer = s_Renderer->CreateStorageBuffer(sizeof(MeshInstance) * s_MaxInstances,
+															   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+	} else {
+		s_InstanceBuffer = s_Renderer->CreateStorageBuffer(sizeof(MeshInstance) * s_MaxInstances,
+														   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+	}
+	s_Instances = s_InstanceStagingBuffer.Reserve<MeshInstance>(0, stagedInstances);
+	if (s_Instances == NULL) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to reserve the Renderer3D mesh instances.");
+		return -1;
+	}
+
+	// Meshes share the batch's fragment shader and pipeline layout, their transform
+	// and material are read per instance.
+	s_MeshPipelineDescription = {};
+	s_MeshPipelineDescription.vertexShader = "renderer3DMeshVertex";
+	s_MeshPipelineDescription.fragmentShader = "renderer3DBasicFragment";
+	s_MeshPipelineDescription.instanceLocation = 3;
+	if (s_Renderer->PrecompilePipelines({ s_MeshPipelineDescription }) != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING,
+										 "Failed to build the mesh pipeline, meshes will not be drawn.");
+	}
+
+	s_TextureStreamer = std::make_unique<TextureStreamer>();
 
 	AssetManager assetManager;
 
@@ -193,28 +232,271 @@ int32_t Renderer3D::Init(const RendererSpec& spec) {
 }
 
 void Renderer3D::Shutdown() {
+	s_Meshes.clear();
+	s_FreeMeshHandles.clear();
+	DestroyRetiredBuffers(true);
+	s_Instances = NULL;
+	s_InstanceCount = 0;
+	s_InstanceBuffer = StorageBuffer();
+	s_InstanceStagingBuffer = StagingBuffer();
+	s_CullInstanceBuffer = StorageBuffer();
+	s_CullGroupBuffer = StorageBuffer();
+	s_IndexRangeBuffer = StorageBuffer();
+	s_DrawCommandBuffer = StorageBuffer();
+	s_DrawCountBuffer = StorageBuffer();
+	s_CullStagingBuffer = StagingBuffer();
+	s_OcclusionViewBuffer = StorageBuffer();
+	s_OcclusionStagingBuffer = StagingBuffer();
 	s_VertexBuffer = VertexBuffer();
+	s_Vertices = NULL;
+	s_PackedVertices = NULL;
+	s_Indices = NULL;
 	s_VertexStagingBuffer = StagingBuffer();
 	s_IndexStagingBuffer = StagingBuffer();
 	s_IndexBuffer = IndexBuffer();
+	s_TextureStreamer.reset();
 	s_Renderer.reset();
 }
 
 void Renderer3D::BeginFrame() {
 	s_Renderer->Clear({ 0.0f, 0.0f, 0.0f, 1.0f });
 	s_Renderer->StartFrame();
+	DestroyRetiredBuffers(false);
+	s_TextureStreamer->Update();
 }
 
 void Renderer3D::Flush() {
-	s_VertexStagingBuffer.TransferData(s_VertexBuffer, 0, 0, s_VertexOffset * sizeof(Vertex3D));
+	s_VertexStagingBuffer.Commit();
+	s_IndexStagingBuffer.Commit();
+	s_VertexStagingBuffer.TransferData(s_VertexBuffer, 0, 0, s_VertexOffset * s_VertexSize);
 	s_IndexStagingBuffer.TransferData(s_IndexBuffer, 0, 0, s_IndexOffset * sizeof(uint32_t));
 	s_Renderer->Draw(s_IndexBuffer, s_VertexBuffer, s_IndexOffset);
 	s_VertexOffset = 0;
 	s_IndexOffset = 0;
+	if (s_DroppedCubes != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Renderer3D batch full, dropped %u cubes.", s_DroppedCubes);
+		s_DroppedCubes = 0;
+	}
+	s_Renderer->CountCulledObjects(s_VisibleObjects, s_CulledObjects);
+	s_VisibleObjects = 0;
+	s_CulledObjects = 0;
+	FlushMeshes();
+}
+
+void Renderer3D::FlushMeshes() {
+	if (s_InstanceCount == 0) {
+		return;
+	}
+	if (s_DroppedInstances != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Renderer3D mesh instances full, dropped %u instances.",
+										 s_DroppedInstances);
+		s_DroppedInstances = 0;
+	}
+
+	if (s_GpuCulling) {
+		FlushMeshesIndirect();
+	} else {
+		// Instances of each mesh and level are laid out contiguously so every submesh is
+		// one draw per level.
+		size_t stagingOffset = (size_t)s_Renderer->GetFrameIndex() * s_MaxInstances;
+		uint32_t instanceOffset = 0;
+		for (auto& mesh : s_Meshes) {
+			for (auto& instances : mesh.instances) {
+				if (!instances.empty()) {
+					StreamCopy(s_Instances + stagingOffset + instanceOffset, instances.data(),
+							   instances.size() * sizeof(MeshInstance));
+					instanceOffset += instances.size();
+				}
+			}
+		}
+		s_InstanceStagingBuffer.Commit();
+
+		if (s_Renderer->CopyBuffer(s_InstanceStagingBuffer, stagingOffset * sizeof(MeshInstance), s_InstanceBuffer, 0,
+								   s_InstanceCount * sizeof(MeshInstance)) == 0 &&
+			s_Renderer->BindPipeline(s_MeshPipelineDescription) == 0)
+		{
+			instanceOffset = 0;
+			for (auto& mesh : s_Meshes) {
+				for (uint32_t lod = 0; lod < CEE_MESH_MAX_LODS; lod++) {
+					const std::vector<MeshInstance>& instances = mesh.instances[lod];
+					if (instances.empty()) {
+						continue;
+					}
+					for (auto& submesh : mesh.submeshes) {
+						IndexRange range = submesh.GetLod(lod);
+						if (range.indexCount == 0) {
+							continue;
+						}
+						s_Renderer->DrawInstanced(mesh.indexBuffer, mesh.indexType, mesh.vertexBuffer, s_InstanceBuffer,
+												  range.firstIndex, range.indexCount,
+												  instanceOffset, instances.size());
+					}
+					instanceOffset += instances.size();
+				}
+			}
+			s_Renderer->BindMainPipeline();
+		}
+	}
+
+	for (auto& mesh : s_Meshes) {
+		for (auto& instances : mesh.instances) {
+			instances.clear();
+		}
+	}
+	s_InstanceCount = 0;
+}
+
+void Renderer3D::FlushMeshesIndirect() {
+	ZoneScoped;
+	// One group per mesh, its instances contiguous in mesh order like the host path.
+	size_t stagingOffset = (size_t)s_Renderer->GetFrameIndex() * s_MaxInstances;
+	std::vector<CullGroup> groups;
+	std::vector<const ResidentMesh*> groupMeshes;
+	std::vector<IndexRange> ranges;
+	uint32_t instanceOffset = 0;
+	uint32_t commandCount = 0;
+	for (auto& mesh : s_Meshes) {
+		const std::vector<MeshInstance>& instances = mesh.instances[0];
+		if (instances.empty()) {
+			continue;
+		}
+		StreamCopy(s_Instances + stagingOffset + instanceOffset, instances.data(),
+				   instances.size() * sizeof(MeshInstance));
+
+		CullGroup group = {};
+		group.center = glm::vec4(mesh.center, 1.0f);
+		group.extents = glm::vec4(mesh.extents, 0.0f);
+		std::copy(mesh.lodErrors, mesh.lodErrors + CEE_MESH_MAX_LODS, group.lodErrors);
+		group.lodCount = mesh.lodCount;
+		group.submeshCount = mesh.submeshes.size();
+		group.firstInstance = instanceOffset;
+		group.instanceCount = instances.size();
+		group.firstRange = ranges.size();
+		group.firstCommand = commandCount;
+		for (uint32_t lod = 0; lod < mesh.lodCount; lod++) {
+			for (auto& submesh : mesh.submeshes) {
+				ranges.push_back(submesh.GetLod(lod));
+			}
+		}
+		groups.push_back(group);
+		groupMeshes.push_back(&mesh);
+		instanceOffset += group.instanceCount;
+		commandCount += group.instanceCount * group.submeshCount;
+	}
+	s_InstanceStagingBuffer.Commit();
+	if (commandCount == 0) {
+		return;
+	}
+
+	size_t groupSize = groups.size() * sizeof(CullGroup);
+	size_t rangeSize = ranges.size() * sizeof(IndexRange);
+	size_t tableSize = s_CullGroupBuffer.GetSize() + s_IndexRangeBuffer.GetSize();
+	if (ReserveStorageBuffer(s_CullGroupBuffer, groupSize, 0) != 0 ||
+		ReserveStorageBuffer(s_IndexRangeBuffer, rangeSize, 0) != 0 ||
+		ReserveStorageBuffer(s_DrawCommandBuffer, commandCount * sizeof(VkDrawIndexedIndirectCommand),
+							 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) != 0 ||
+		ReserveStorageBuffer(s_DrawCountBuffer, groups.size() * sizeof(uint32_t),
+							 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) != 0)
+	{
+		return;
+	}
+	if (s_CullGroupBuffer.GetSize() + s_IndexRangeBuffer.GetSize() != tableSize) {
+		if (tableSize != 0) {
+			s_RetiredCullBuffers.push_back({ StorageBuffer(), std::move(s_CullStagingBuffer),
+											 s_Renderer->GetMaxFramesInFlight() });
+		}
+		tableSize = s_CullGroupBuffer.GetSize() + s_IndexRangeBuffer.GetSize();
+		s_CullStagingBuffer = s_Renderer->CreateStagingBuffer(tableSize * s_Renderer->GetMaxFramesInFlight());
+	}
+	// Copied on the frame's command buffer ahead of the dispatch, from the frame's own
+	// region of the staging buffers so earlier frames still copying are not overwritten.
+	size_t groupOffset = s_Renderer->GetFrameIndex() * tableSize;
+	size_t rangeOffset = groupOffset + s_CullGroupBuffer.GetSize();
+	if (s_CullStagingBuffer.SetData(groupSize, groupOffset, groups.data()) != 0 ||
+		s_CullStagingBuffer.SetData(rangeSize, rangeOffset, ranges.data()) != 0 ||
+		s_Renderer->CopyBuffer(s_CullStagingBuffer, groupOffset, s_CullGroupBuffer, 0, groupSize) != 0 ||
+		s_Renderer->CopyBuffer(s_CullStagingBuffer, rangeOffset, s_IndexRangeBuffer, 0, rangeSize) != 0 ||
+		s_Renderer->CopyBuffer(s_InstanceStagingBuffer, stagingOffset * sizeof(MeshInstance), s_CullInstanceBuffer, 0,
+							   s_InstanceCount * sizeof(MeshInstance)) != 0)
+	{
+		return;
+	}
+
+	CullConstants constants = {};
+	Frustum frustum = s_FrustumCulling ? s_Frustum : Frustum();
+	for (uint32_t i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+		constants.planes[i] = frustum.GetPlane(static_cast<FrustumPlane>(i));
+	}
+	glm::mat4 viewProjection = s_Projection * s_View;
+	constants.depthRow = glm::vec4(viewProjection[0][3], viewProjection[1][3],
+								   viewProjection[2][3], viewProjection[3][3]);
+	constants.lodScale = std::fabs(s_Projection[1][1]) * 0.5f * s_Renderer->GetSwapchainExtent().height;
+	constants.lodThreshold = s_LodThreshold;
+	constants.instanceCount = s_InstanceCount;
+	constants.groupCount = groups.size();
+
+	std::vector<const StorageBuffer*> buffers = {
+		&s_CullInstanceBuffer, &s_CullGroupBuffer, &s_IndexRangeBuffer, &s_DrawCommandBuffer, &s_DrawCountBuffer
+	};
+	// Until the renderer has a pyramid, e.g. in the first frame after a resize, every
+	// instance in the frustum is drawn.
+	bool occlusionCulling = s_OcclusionCulling && s_FrustumCulling && s_Renderer->HasDepthPyramid();
+	if (occlusionCulling) {
+		size_t viewOffset = s_Renderer->GetFrameIndex() * sizeof(glm::mat4);
+		if (s_OcclusionStagingBuffer.SetData(sizeof(glm::mat4), viewOffset, &s_PreviousViewProjection) != 0 ||
+			s_Renderer->CopyBuffer(s_OcclusionStagingBuffer, viewOffset, s_OcclusionViewBuffer, 0, sizeof(glm::mat4)) != 0)
+		{
+			occlusionCulling = false;
+		} else {
+			buffers.push_back(&s_OcclusionViewBuffer);
+		}
+	}
+
+	if (s_Renderer->FillBuffer(s_DrawCountBuffer, 0, groups.size() * sizeof(uint32_t), 0) != 0 ||
+		s_Renderer->Dispatch("renderer3DCullCompute", buffers, &constants, sizeof(constants),
+							 (s_InstanceCount + CEE_CULL_GROUP_SIZE - 1) / CEE_CULL_GROUP_SIZE,
+							 occlusionCulling ? s_OcclusionCullingDefines : ShaderDefines(),
+							 occlusionCulling) != 0)
+	{
+		return;
+	}
+
+	if (s_Renderer->BindPipeline(s_MeshPipelineDescription) == 0) {
+		for (uint32_t i = 0; i < groups.size(); i++) {
+			const ResidentMesh& mesh = *groupMeshes[i];
+			s_Renderer->DrawIndexedIndirectCount(mesh.indexBuffer, mesh.indexType, mesh.vertexBuffer,
+												 s_CullInstanceBuffer,
+												 s_DrawCommandBuffer,
+												 groups[i].firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+												 s_DrawCountBuffer, i * sizeof(uint32_t),
+												 groups[i].instanceCount * groups[i].submeshCount);
+		}
+		s_Renderer->BindMainPipeline();
+	}
+}
+
+int Renderer3D::ReserveStorageBuffer(StorageBuffer& buffer, size_t size, VkBufferUsageFlags usage) {
+	if (buffer.GetSize() >= size) {
+		return 0;
+	}
+	// Frames still in flight may read the old buffer.
+	size_t oldSize = buffer.GetSize();
+	if (oldSize != 0) {
+		s_RetiredCullBuffers.push_back({ std::move(buffer), StagingBuffer(), s_Renderer->GetMaxFramesInFlight() });
+	}
+	buffer = s_Renderer->CreateStorageBuffer(std::max(size, 2 * oldSize), usage);
+	if (buffer.GetSize() < size) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Failed to grow a Renderer3D cull buffer to %zu bytes.", size);
+		return -1;
+	}
+	return 0;
 }
 
 void Renderer3D::EndFrame() {
 	Flush();
+	// The depth pyramid the renderer builds from this frame is tested with its camera.
+	s_PreviousViewProjection = s_Projection * s_View;
 	s_Renderer->EndFrame();
 }
 
@@ -222,34 +504,202 @@ void Renderer3D::DrawCube(const glm::vec3& translation,
 						  float rotationAngle,
 						  const glm::vec3& rotationAxis,
 						  const glm::vec3& scale,
-						  const glm::vec4& color) {
-	glm::mat4 transform = ConstructTransformMatrix3D(translation, rotationAngle, rotationAxis, scale);
-
-	std::random_device rd;
-	std::mt19937 gen(rd());
-
-	std::array<Vertex3D, 24> vertices;
-	for (size_t i = 0 ; i < vertices.size(); i++) {
-		vertices[i].position = transform * CubeVertexPositions[i];
-		vertices[i].normal = CubeNormalVectors[i];
-		if (rotationAngle != 0.0f) {
-			glm::mat4 nrm = glm::identity<glm::mat3>();
-			nrm = glm::rotate(nrm, rotationAngle, rotationAxis);
-			vertices[i].normal = glm::vec4(vertices[i].normal, 0.0f) * nrm;
+						  const glm::vec4& color,
+						  TextureHandle texture) {
+	// The cube spans -1 to 1 before scaling, its corners are length(scale) from the center.
+	if (s_FrustumCulling && !s_Frustum.IntersectsSphere(translation, glm::length(scale))) {
+		s_CulledObjects++;
+		return;
+	}
+	s_VisibleObjects++;
+	// The buffers are only drawn once per frame, flushing early would overwrite them
+	// before the first draw reads them.
+	if (s_IndexOffset + CEE_CUBE_INDEX_COUNT > s_RendererCapabilities.maxIndices) {
+		s_DroppedCubes++;
+		return;
+	}
+	if (texture == CEE_INVALID_TEXTURE_HANDLE) {
+		texture = s_Renderer->GetDefaultTexture();
+	}
+
+	if (s_PackedVertices != NULL) {
+		Vertex3D vertices[CEE_CUBE_VERTEX_COUNT];
+		BuildCubeVertices(translation, rotationAngle, rotationAxis, scale, color, texture,
+						  s_VertexOffset, vertices, s_Indices + s_IndexOffset);
+		PackVertices(vertices, CEE_CUBE_VERTEX_COUNT, s_PackedVertices + s_VertexOffset);
+	} else {
+		BuildCubeVertices(translation, rotationAngle, rotationAxis, scale, color, texture,
+						  s_VertexOffset, s_Vertices + s_VertexOffset, s_Indices + s_IndexOffset);
+	}
+	s_VertexOffset += CEE_CUBE_VERTEX_COUNT;
+	s_IndexOffset += CEE_CUBE_INDEX_COUNT;
+}
+
+MeshHandle Renderer3D::CreateMesh(const Mesh& mesh) {
+	ZoneScoped;
+	if (mesh.vertices.empty() || mesh.indices.empty() || mesh.Validate() != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Cannot create an empty or invalid mesh.");
+		return CEE_INVALID_MESH_HANDLE;
+	}
+
+	ResidentMesh resident;
+	size_t vertexSize = mesh.vertices.size() * sizeof(MeshVertex);
+	size_t indexSize = mesh.indices.size();
+	resident.vertexBuffer = s_Renderer->CreateVertexBuffer(vertexSize);
+	resident.indexBuffer = s_Renderer->CreateIndexBuffer(indexSize);
+	resident.indexType = mesh.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	resident.submeshes = mesh.submeshes;
+	resident.lodCount = mesh.lodCount;
+	std::copy(mesh.lodErrors, mesh.lodErrors + CEE_MESH_MAX_LODS, resident.lodErrors);
+	resident.center = (mesh.bounds.min + mesh.bounds.max) * 0.5f;
+	resident.extents = (mesh.bounds.max - mesh.bounds.min) * 0.5f;
+	resident.resident = true;
+
+	// Uploaded once, the staging memory is released as soon as the copy completes.
+	StagingBuffer stagingBuffer = s_Renderer->CreateStagingBuffer(vertexSize + indexSize);
+	if (stagingBuffer.SetData(vertexSize, 0, mesh.vertices.data()) != 0 ||
+		stagingBuffer.SetData(indexSize, vertexSize, mesh.indices.data()) != 0 ||
+		stagingBuffer.TransferDataImmediate(resident.vertexBuffer, 0, 0, vertexSize) != 0 ||
+		stagingBuffer.TransferDataImmediate(resident.indexBuffer, vertexSize, 0, indexSize) != 0)
+	{
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to upload mesh.");
+		return CEE_INVALID_MESH_HANDLE;
+	}
+
+	MeshHandle handle;
+	if (!s_FreeMeshHandles.empty()) {
+		handle = s_FreeMeshHandles.back();
+		s_FreeMeshHandles.pop_back();
+		s_Meshes[handle] = std::move(resident);
+	} else {
+		handle = s_Meshes.size();
+		s_Meshes.push_back(std::move(resident));
+	}
+	return handle;
+}
+
+MeshHandle Renderer3D::LoadMesh(const std::filesystem::path& filePath) {
+	AssetManager assetManager;
+	std::shared_ptr<Mesh> mesh = assetManager.LoadAsset<Mesh>(filePath);
+	if (mesh == nullptr) {
+		return CEE_INVALID_MESH_HANDLE;
+	}
+	return CreateMesh(*mesh);
+}
+
+void Renderer3D::DestroyMesh(MeshHandle mesh) {
+	if (mesh >= s_Meshes.size() || !s_Meshes[mesh].resident) {
+		return;
+	}
+	ResidentMesh& resident = s_Meshes[mesh];
+	// Instances collected this frame are dropped with it.
+	for (auto& instances : resident.instances) {
+		s_InstanceCount -= instances.size();
+	}
+	s_RetiredMeshes.push_back({ std::move(resident.vertexBuffer), std::move(resident.indexBuffer),
+								s_Renderer->GetMaxFramesInFlight() });
+	resident = ResidentMesh();
+	s_FreeMeshHandles.push_back(mesh);
+}
+
+template<typename T>
+static void DestroyRetired(std::vector<T>& retired, bool force) {
+	for (size_t i = 0; i < retired.size();) {
+		if (force || --retired[i].framesLeft == 0) {
+			retired.erase(retired.begin() + i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void Renderer3D::DestroyRetiredBuffers(bool force) {
+	// Called once per frame after StartFrame() waited on that frame's fence, after
+	// maxFramesInFlight waits every frame that could use the buffers has completed.
+	DestroyRetired(s_RetiredMeshes, force);
+	DestroyRetired(s_RetiredCullBuffers, force);
+}
+
+void Renderer3D::DrawMesh(MeshHandle mesh,
+						  const glm::mat4& transform,
+						  const glm::vec4& color,
+						  TextureHandle texture,
+						  MeshLodState* lodState) {
+	if (mesh >= s_Meshes.size() || !s_Meshes[mesh].resident) {
+		return;
+	}
+	const ResidentMesh& resident = s_Meshes[mesh];
+	// With GPU culling every instance is uploaded and culled on the device.
+	if (!s_GpuCulling) {
+		if (s_FrustumCulling) {
+			// World space box around the transformed bounds (Arvo).
+			glm::vec3 center = glm::vec3(transform * glm::vec4(resident.center, 1.0f));
+			glm::vec3 extents = glm::abs(glm::vec3(transform[0])) * resident.extents.x +
+								glm::abs(glm::vec3(transform[1])) * resident.extents.y +
+								glm::abs(glm::vec3(transform[2])) * resident.extents.z;
+			if (!s_Frustum.IntersectsBox(center, extents)) {
+				s_CulledObjects++;
+				return;
+			}
 		}
-		vertices[i].color = color;
-		vertices[i].texCoords = CubeTexCoords[i];
-		vertices[i].texIndex = CubeTexIndices[i];
+		s_VisibleObjects++;
+	}
+	if (s_InstanceCount == s_MaxInstances) {
+		s_DroppedInstances++;
+		return;
+	}
+	if (texture == CEE_INVALID_TEXTURE_HANDLE) {
+		texture = s_Renderer->GetDefaultTexture();
 	}
 
-	s_VertexStagingBuffer.SetData(vertices.size() * sizeof(Vertex3D), s_VertexOffset * sizeof(Vertex3D), vertices.data());
-	s_IndexStagingBuffer.SetData(36 * sizeof(uint32_t), s_IndexOffset * sizeof(uint32_t), CubeIndices);
-	s_VertexOffset += 24;
-	s_IndexOffset += 36;
+	if (s_GpuCulling) {
+		// The level is selected by renderer3DCullCompute.
+		s_Meshes[mesh].instances[0].push_back({ transform, color, texture });
+		s_InstanceCount++;
+		return;
+	}
+	uint32_t lod = SelectLod(resident, transform, lodState);
+	if (lodState != NULL) {
+		lodState->lod = lod;
+	}
+	s_Meshes[mesh].instances[lod].push_back({ transform, color, texture });
+	s_InstanceCount++;
+}
+
+uint32_t Renderer3D::SelectLod(const ResidentMesh& mesh, const glm::mat4& transform, const MeshLodState* lodState) {
+	if (mesh.lodCount == 1) {
+		return 0;
+	}
+
+	// Pixels covered by one unit of the mesh at its center. The clip space w is the
+	// view depth for perspective projections and 1 for orthographic ones.
+	glm::vec4 clip = s_Projection * s_View * transform * glm::vec4(mesh.center, 1.0f);
+	float scale = std::max({ glm::length(glm::vec3(transform[0])),
+							 glm::length(glm::vec3(transform[1])),
+							 glm::length(glm::vec3(transform[2])) });
+	float pixelsPerUnit = scale * std::fabs(s_Projection[1][1]) * 0.5f * s_Renderer->GetSwapchainExtent().height /
+						  std::max(clip.w, 1e-4f);
+
+	auto coarsestLod = [&](float threshold) {
+		uint32_t lod = 0;
+		while (lod + 1 < mesh.lodCount && mesh.lodErrors[lod + 1] * pixelsPerUnit <= threshold) {
+			lod++;
+		}
+		return lod;
+	};
+	if (lodState == NULL) {
+		return coarsestLod(s_LodThreshold);
+	}
+	uint32_t finest = coarsestLod(s_LodThreshold * (1.0f - CEE_LOD_HYSTERESIS));
+	uint32_t coarsest = coarsestLod(s_LodThreshold * (1.0f + CEE_LOD_HYSTERESIS));
+	return std::clamp(lodState->lod, finest, coarsest);
 }
 
 int Renderer3D::UpdateCamera(Camera& camera) {
 	s_Renderer->UpdateCamera(camera);
+	s_View = camera.GetTransform();
+	s_Projection = camera.GetProjection();
+	s_Frustum = camera.GetFrustum();
 	return 0;
 }
 
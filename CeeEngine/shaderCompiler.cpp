@@ -0,0 +1,198 @@
+#include <CeeEngine/shaderCompiler.h>
+#include <CeeEngine/debugMessenger.h>
+
+#include <cinttypes>
+#include <cstdio>
+
+#if defined(CEE_HAS_SHADERC)
+#include <shaderc/shaderc.h>
+
+#if !defined(CEE_SHADERC_VERSION)
+#define CEE_SHADERC_VERSION "unknown"
+#endif
+#endif
+
+#include <Tracy.hpp>
+
+namespace cee {
+static void HashBytes(uint64_t& hash, const void* data, size_t size) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+}
+
+// Everything besides the source and defines that changes the generated SPIR-V, part
+// of the cache key so an option change invalidates old entries. The SPIR-V version
+// only changes with major compiler releases, the library version recorded at
+// configure time (CEE_SHADERC_VERSION) is hashed alongside it.
+#if defined(CEE_HAS_SHADERC)
+struct CompileSettings {
+	uint32_t spvVersion;
+	uint32_t spvRevision;
+	uint32_t targetEnvVersion;
+	uint32_t optimizationLevel;
+	uint32_t generateDebugInfo;
+};
+
+static const CompileSettings& GetCompileSettings() {
+	static const CompileSettings settings = [] {
+		CompileSettings settings = {};
+		unsigned int version, revision;
+		shaderc_get_spv_version(&version, &revision);
+		settings.spvVersion = version;
+		settings.spvRevision = revision;
+		settings.targetEnvVersion = shaderc_env_version_vulkan_1_2;
+		settings.optimizationLevel = shaderc_optimization_level_performance;
+#ifndef NDEBUG
+		settings.generateDebugInfo = 1;
+#endif
+		return settings;
+	}();
+	return settings;
+}
+#endif
+
+ShaderCompiler::ShaderCompiler(std::filesystem::path assetRoot)
+: m_AssetManager(assetRoot), m_Compiler(NULL)
+{
+#if defined(CEE_HAS_SHADERC)
+	m_Compiler = shaderc_compiler_initialize();
+	if (m_Compiler == NULL) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to initialize shader compiler.");
+	}
+#endif
+}
+
+ShaderCompiler::~ShaderCompiler() {
+#if defined(CEE_HAS_SHADERC)
+	if (m_Compiler != NULL) {
+		shaderc_compiler_release(static_cast<shaderc_compiler_t>(m_Compiler));
+	}
+#endif
+}
+
+bool ShaderCompiler::IsAvailable() {
+#if defined(CEE_HAS_SHADERC)
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64_t ShaderCompiler::Hash(const ShaderCode& code, const ShaderDefines& defines) {
+	// FNV-1a, stable across runs so it can name files on disk.
+	uint64_t hash = 0xcbf29ce484222325ull;
+#if defined(CEE_HAS_SHADERC)
+	HashBytes(hash, &GetCompileSettings(), sizeof(CompileSettings));
+	HashBytes(hash, CEE_SHADERC_VERSION, sizeof(CEE_SHADERC_VERSION) - 1);
+#endif
+	uint32_t stage = code.stage;
+	HashBytes(hash, &stage, sizeof(stage));
+	for (auto& define : defines) {
+		HashBytes(hash, define.first.data(), define.first.size());
+		HashBytes(hash, "=", 1);
+		HashBytes(hash, define.second.data(), define.second.size());
+		HashBytes(hash, "\n", 1);
+	}
+	HashBytes(hash, code.glslCode.data(), code.glslCode.size());
+	return hash;
+}
+
+std::shared_ptr<ShaderBinary> ShaderCompiler::Compile(const ShaderCode& code, const ShaderDefines& defines) {
+	ZoneScoped;
+	if (!IsAvailable()) {
+		// Cache entries are keyed by the compiler version, none of them can be matched
+		// without a compiler.
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_DEBUG,
+										 "Built without shaderc, cannot compile shader \"%s\".", code.name.c_str());
+		return nullptr;
+	}
+
+	char hashString[17];
+	snprintf(hashString, sizeof(hashString), "%016" PRIx64, Hash(code, defines));
+	std::filesystem::path cachePath = "cache/shaders/" + code.name + "-" + hashString + ".spv";
+
+	if (m_AssetManager.Exists(m_AssetManager.GetAssetRoot() / cachePath)) {
+		auto binary = m_AssetManager.LoadAsset<ShaderBinary>(cachePath);
+		if (binary != nullptr && !binary->spvCode.empty() && binary->spvCode.size() % 4 == 0) {
+			return binary;
+		}
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Discarding corrupt shader cache entry \"%s\".",
+										 cachePath.c_str());
+	}
+
+	auto binary = CompileInternal(code, defines);
+	if (binary != nullptr) {
+		m_AssetManager.SaveAsset(cachePath, binary);
+	}
+	return binary;
+}
+
+std::shared_ptr<ShaderBinary> ShaderCompiler::CompileInternal(const ShaderCode& code, const ShaderDefines& defines) {
+#if defined(CEE_HAS_SHADERC)
+	if (m_Compiler == NULL) {
+		return nullptr;
+	}
+
+	shaderc_shader_kind kind;
+	switch (code.stage) {
+		case SHADER_STAGE_VERTEX:
+			kind = shaderc_glsl_vertex_shader;
+			break;
+		case SHADER_STAGE_FRAGMENT:
+			kind = shaderc_glsl_fragment_shader;
+			break;
+		case SHADER_STAGE_COMPUTE:
+			kind = shaderc_glsl_compute_shader;
+			break;
+		default:
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Unknown stage for shader \"%s\".", code.name.c_str());
+			return nullptr;
+	}
+
+	const CompileSettings& settings = GetCompileSettings();
+	shaderc_compile_options_t options = shaderc_compile_options_initialize();
+	shaderc_compile_options_set_target_env(options, shaderc_target_env_vulkan, settings.targetEnvVersion);
+	shaderc_compile_options_set_optimization_level(options,
+												   static_cast<shaderc_optimization_level>(settings.optimizationLevel));
+	if (settings.generateDebugInfo) {
+		shaderc_compile_options_set_generate_debug_info(options);
+	}
+	for (auto& define : defines) {
+		shaderc_compile_options_add_macro_definition(options,
+													 define.first.data(), define.first.size(),
+													 define.second.data(), define.second.size());
+	}
+
+	shaderc_compilation_result_t result;
+	{
+		std::lock_guard<std::mutex> lock(m_CompilerMutex);
+		result = shaderc_compile_into_spv(static_cast<shaderc_compiler_t>(m_Compiler),
+										  code.glslCode.data(), code.glslCode.size(),
+										  kind, code.name.c_str(), "main", options);
+	}
+	shaderc_compile_options_release(options);
+
+	if (shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to compile shader \"%s\":\n%s",
+										 code.name.c_str(), shaderc_result_get_error_message(result));
+		shaderc_result_release(result);
+		return nullptr;
+	}
+
+	auto binary = std::make_shared<ShaderBinary>();
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(shaderc_result_get_bytes(result));
+	binary->spvCode.assign(bytes, bytes + shaderc_result_get_length(result));
+	shaderc_result_release(result);
+
+	DebugMessenger::PostDebugMessage(ERROR_SEVERITY_DEBUG, "Compiled shader \"%s\".", code.name.c_str());
+	return binary;
+#else
+	(void)code;
+	(void)defines;
+	return nullptr;
+#endif
+}
+}
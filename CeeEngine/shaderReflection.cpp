@@ -0,0 +1,611 @@
+#include <CeeEngine/shaderReflection.h>
+#include <CeeEngine/debugMessenger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <Tracy.hpp>
+
+namespace cee {
+// Subset of the SPIR-V specification needed to find a module's interface.
+namespace spv {
+static constexpr uint32_t MagicNumber = 0x07230203;
+
+enum Op : uint16_t {
+	OpEntryPoint = 15,
+	OpTypeInt = 21,
+	OpTypeFloat = 22,
+	OpTypeVector = 23,
+	OpTypeMatrix = 24,
+	OpTypeImage = 25,
+	OpTypeSampler = 26,
+	OpTypeSampledImage = 27,
+	OpTypeArray = 28,
+	OpTypeRuntimeArray = 29,
+	OpTypeStruct = 30,
+	OpTypePointer = 32,
+	OpConstant = 43,
+	OpSpecConstant = 50,
+	OpFunction = 54,
+	OpVariable = 59,
+	OpDecorate = 71,
+	OpMemberDecorate = 72
+};
+
+enum Decoration : uint32_t {
+	DecorationBlock = 2,
+	DecorationBufferBlock = 3,
+	DecorationArrayStride = 6,
+	DecorationMatrixStride = 7,
+	DecorationBuiltIn = 11,
+	DecorationLocation = 30,
+	DecorationBinding = 33,
+	DecorationDescriptorSet = 34,
+	DecorationOffset = 35
+};
+
+enum StorageClass : uint32_t {
+	StorageClassUniformConstant = 0,
+	StorageClassInput = 1,
+	StorageClassUniform = 2,
+	StorageClassPushConstant = 9,
+	StorageClassStorageBuffer = 12
+};
+
+enum Dim : uint32_t {
+	DimBuffer = 5,
+	DimSubpassData = 6
+};
+}
+
+namespace {
+constexpr uint32_t InvalidDecoration = std::numeric_limits<uint32_t>::max();
+
+struct SpirvId {
+	uint16_t opcode = 0;
+	// Result type of constants and variables.
+	uint32_t typeId = 0;
+	// Words following the result id.
+	std::vector<uint32_t> operands;
+
+	uint32_t set = InvalidDecoration;
+	uint32_t binding = InvalidDecoration;
+	uint32_t location = InvalidDecoration;
+	uint32_t arrayStride = 0;
+	bool builtIn = false;
+	bool block = false;
+	bool bufferBlock = false;
+	std::vector<uint32_t> memberOffsets;
+	std::vector<uint32_t> memberMatrixStrides;
+};
+
+class SpirvModule {
+public:
+	int Parse(const std::vector<uint8_t>& spvCode);
+
+	VkShaderStageFlagBits GetStage() const { return m_Stage; }
+	const std::vector<uint32_t>& GetVariables() const { return m_Variables; }
+	const SpirvId& operator[](uint32_t id) const { return id < m_Ids.size() ? m_Ids[id] : m_InvalidId; }
+
+	uint32_t GetTypeSize(uint32_t typeId) const;
+	VkFormat GetVertexFormat(uint32_t typeId) const;
+	uint32_t GetConstant(uint32_t id) const;
+
+private:
+	SpirvId* GetId(uint32_t id) { return id < m_Ids.size() ? &m_Ids[id] : NULL; }
+
+private:
+	VkShaderStageFlagBits m_Stage = (VkShaderStageFlagBits)0;
+	std::vector<SpirvId> m_Ids;
+	std::vector<uint32_t> m_Variables;
+	SpirvId m_InvalidId;
+};
+
+// Operands following the result id that the reflection reads.
+uint32_t GetRequiredOperandCount(uint16_t opcode) {
+	switch (opcode) {
+		case spv::OpTypeFloat:
+		case spv::OpTypeSampledImage:
+		case spv::OpTypeRuntimeArray:
+			return 1;
+		case spv::OpTypeInt:
+		case spv::OpTypeVector:
+		case spv::OpTypeMatrix:
+		case spv::OpTypeArray:
+		case spv::OpTypePointer:
+			return 2;
+		case spv::OpTypeImage:
+			return 6;
+		default:
+			return 0;
+	}
+}
+
+int SpirvModule::Parse(const std::vector<uint8_t>& spvCode) {
+	if (spvCode.size() % 4 != 0 || spvCode.size() < 5 * sizeof(uint32_t)) {
+		return -1;
+	}
+	std::vector<uint32_t> words(spvCode.size() / 4);
+	memcpy(words.data(), spvCode.data(), spvCode.size());
+	if (words[0] != spv::MagicNumber) {
+		return -1;
+	}
+	m_Ids.resize(words[3]);
+
+	for (size_t i = 5; i < words.size();) {
+		uint16_t opcode = words[i] & 0xffff;
+		uint32_t wordCount = words[i] >> 16;
+		if (wordCount == 0 || i + wordCount > words.size()) {
+			return -1;
+		}
+		const uint32_t* operands = &words[i + 1];
+		uint32_t operandCount = wordCount - 1;
+		i += wordCount;
+
+		switch (opcode) {
+			case spv::OpEntryPoint: {
+				if (operandCount < 2 || m_Stage != 0) {
+					break;
+				}
+				switch (operands[0]) {
+					case 0: m_Stage = VK_SHADER_STAGE_VERTEX_BIT; break;
+					case 1: m_Stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT; break;
+					case 2: m_Stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT; break;
+					case 3: m_Stage = VK_SHADER_STAGE_GEOMETRY_BIT; break;
+					case 4: m_Stage = VK_SHADER_STAGE_FRAGMENT_BIT; break;
+					case 5: m_Stage = VK_SHADER_STAGE_COMPUTE_BIT; break;
+					default: return -1;
+				}
+				break;
+			}
+			case spv::OpDecorate: {
+				SpirvId* target = operandCount >= 2 ? GetId(operands[0]) : NULL;
+				if (target == NULL) {
+					return -1;
+				}
+				uint32_t literal = operandCount >= 3 ? operands[2] : 0;
+				switch (operands[1]) {
+					case spv::DecorationBlock: target->block = true; break;
+					case spv::DecorationBufferBlock: target->bufferBlock = true; break;
+					case spv::DecorationArrayStride: target->arrayStride = literal; break;
+					case spv::DecorationBuiltIn: target->builtIn = true; break;
+					case spv::DecorationLocation: target->location = literal; break;
+					case spv::DecorationBinding: target->binding = literal; break;
+					case spv::DecorationDescriptorSet: target->set = literal; break;
+				}
+				break;
+			}
+			case spv::OpMemberDecorate: {
+				SpirvId* target = operandCount >= 3 ? GetId(operands[0]) : NULL;
+				if (target == NULL) {
+					return -1;
+				}
+				uint32_t member = operands[1];
+				uint32_t literal = operandCount >= 4 ? operands[3] : 0;
+				if (operands[2] == spv::DecorationOffset) {
+					target->memberOffsets.resize(std::max<size_t>(target->memberOffsets.size(), member + 1),
+												 InvalidDecoration);
+					target->memberOffsets[member] = literal;
+				} else if (operands[2] == spv::DecorationMatrixStride) {
+					target->memberMatrixStrides.resize(std::max<size_t>(target->memberMatrixStrides.size(), member + 1), 0);
+					target->memberMatrixStrides[member] = literal;
+				}
+				break;
+			}
+			case spv::OpTypeInt:
+			case spv::OpTypeFloat:
+			case spv::OpTypeVector:
+			case spv::OpTypeMatrix:
+			case spv::OpTypeImage:
+			case spv::OpTypeSampler:
+			case spv::OpTypeSampledImage:
+			case spv::OpTypeArray:
+			case spv::OpTypeRuntimeArray:
+			case spv::OpTypeStruct:
+			case spv::OpTypePointer: {
+				SpirvId* id = operandCount >= 1 ? GetId(operands[0]) : NULL;
+				if (id == NULL) {
+					return -1;
+				}
+				id->opcode = opcode;
+				id->operands.assign(operands + 1, operands + operandCount);
+				if (id->operands.size() < GetRequiredOperandCount(opcode)) {
+					return -1;
+				}
+				break;
+			}
+			case spv::OpConstant:
+			case spv::OpSpecConstant:
+			case spv::OpVariable: {
+				SpirvId* id = operandCount >= 2 ? GetId(operands[1]) : NULL;
+				if (id == NULL) {
+					return -1;
+				}
+				id->opcode = opcode;
+				id->typeId = operands[0];
+				id->operands.assign(operands + 2, operands + operandCount);
+				if (opcode == spv::OpVariable) {
+					m_Variables.push_back(operands[1]);
+				}
+				break;
+			}
+			case spv::OpFunction:
+				// Global declarations all precede the first function.
+				i = words.size();
+				break;
+		}
+	}
+
+	return m_Stage != 0 ? 0 : -1;
+}
+
+uint32_t SpirvModule::GetConstant(uint32_t id) const {
+	const SpirvId& constant = (*this)[id];
+	if (constant.operands.empty() || (constant.opcode != spv::OpConstant && constant.opcode != spv::OpSpecConstant)) {
+		return 0;
+	}
+	return constant.operands[0];
+}
+
+uint32_t SpirvModule::GetTypeSize(uint32_t typeId) const {
+	const SpirvId& type = (*this)[typeId];
+	switch (type.opcode) {
+		case spv::OpTypeInt:
+		case spv::OpTypeFloat:
+			return type.operands[0] / 8;
+		case spv::OpTypeVector:
+		case spv::OpTypeMatrix:
+			return type.operands[1] * GetTypeSize(type.operands[0]);
+		case spv::OpTypeArray: {
+			uint32_t stride = type.arrayStride != 0 ? type.arrayStride : GetTypeSize(type.operands[0]);
+			return GetConstant(type.operands[1]) * stride;
+		}
+		case spv::OpTypeStruct: {
+			uint32_t size = 0, offset = 0;
+			for (uint32_t member = 0; member < type.operands.size(); member++) {
+				if (member < type.memberOffsets.size() && type.memberOffsets[member] != InvalidDecoration) {
+					offset = type.memberOffsets[member];
+				}
+				uint32_t memberSize = GetTypeSize(type.operands[member]);
+				const SpirvId& memberType = (*this)[type.operands[member]];
+				if (memberType.opcode == spv::OpTypeMatrix && member < type.memberMatrixStrides.size() &&
+					type.memberMatrixStrides[member] != 0)
+				{
+					memberSize = memberType.operands[1] * type.memberMatrixStrides[member];
+				}
+				offset += memberSize;
+				size = std::max(size, offset);
+			}
+			return size;
+		}
+		default:
+			return 0;
+	}
+}
+
+VkFormat SpirvModule::GetVertexFormat(uint32_t typeId) const {
+	static const VkFormat floatFormats[] = {
+		VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT
+	};
+	static const VkFormat doubleFormats[] = {
+		VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT
+	};
+	static const VkFormat intFormats[] = {
+		VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT
+	};
+	static const VkFormat uintFormats[] = {
+		VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT
+	};
+
+	uint32_t componentCount = 1;
+	const SpirvId* type = &(*this)[typeId];
+	if (type->opcode == spv::OpTypeVector) {
+		componentCount = type->operands[1];
+		type = &(*this)[type->operands[0]];
+	}
+	if (componentCount < 1 || componentCount > 4) {
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	if (type->opcode == spv::OpTypeFloat && type->operands[0] == 32) {
+		return floatFormats[componentCount - 1];
+	} else if (type->opcode == spv::OpTypeFloat && type->operands[0] == 64) {
+		return doubleFormats[componentCount - 1];
+	} else if (type->opcode == spv::OpTypeInt && type->operands[0] == 32) {
+		return type->operands[1] != 0 ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+uint32_t GetVertexFormatSize(VkFormat format) {
+	switch (format) {
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R32_SINT:
+		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8G8B8A8_UINT:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16_SNORM:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R16G16_UINT:
+			return 4;
+		case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R16G16B16A16_SNORM:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R16G16B16A16_UINT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_R32G32_SINT:
+		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R64_SFLOAT:
+			return 8;
+		case VK_FORMAT_R32G32B32_SFLOAT:
+		case VK_FORMAT_R32G32B32_SINT:
+		case VK_FORMAT_R32G32B32_UINT:
+			return 12;
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+		case VK_FORMAT_R32G32B32A32_SINT:
+		case VK_FORMAT_R32G32B32A32_UINT:
+		case VK_FORMAT_R64G64_SFLOAT:
+			return 16;
+		case VK_FORMAT_R64G64B64_SFLOAT:
+			return 24;
+		case VK_FORMAT_R64G64B64A64_SFLOAT:
+			return 32;
+		default:
+			return 0;
+	}
+}
+
+int ReflectResource(const SpirvModule& module, const SpirvId& variable, uint32_t storageClass,
+					ShaderResourceBinding* binding)
+{
+	uint32_t typeId = module[variable.typeId].operands[1];
+	binding->set = variable.set != InvalidDecoration ? variable.set : 0;
+	binding->binding = variable.binding;
+	binding->count = 1;
+	binding->stages = module.GetStage();
+
+	while (module[typeId].opcode == spv::OpTypeArray || module[typeId].opcode == spv::OpTypeRuntimeArray) {
+		if (module[typeId].opcode == spv::OpTypeRuntimeArray) {
+			binding->count = CEE_RUNTIME_DESCRIPTOR_COUNT;
+		} else if (binding->count != CEE_RUNTIME_DESCRIPTOR_COUNT) {
+			binding->count *= module.GetConstant(module[typeId].operands[1]);
+		}
+		typeId = module[typeId].operands[0];
+	}
+
+	const SpirvId& type = module[typeId];
+	switch (type.opcode) {
+		case spv::OpTypeSampler:
+			binding->type = VK_DESCRIPTOR_TYPE_SAMPLER;
+			return 0;
+		case spv::OpTypeSampledImage: {
+			const SpirvId& image = module[type.operands[0]];
+			if (image.opcode != spv::OpTypeImage) {
+				return -1;
+			}
+			binding->type = image.operands[1] == spv::DimBuffer ?
+				VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			return 0;
+		}
+		case spv::OpTypeImage: {
+			// Operands: sampled type, dim, depth, arrayed, multisampled, sampled.
+			bool storage = type.operands[5] == 2;
+			if (type.operands[1] == spv::DimBuffer) {
+				binding->type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+			} else if (type.operands[1] == spv::DimSubpassData) {
+				binding->type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			} else {
+				binding->type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			}
+			return 0;
+		}
+		case spv::OpTypeStruct:
+			if (storageClass == spv::StorageClassStorageBuffer || type.bufferBlock) {
+				binding->type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			} else {
+				binding->type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			}
+			return 0;
+		default:
+			return -1;
+	}
+}
+}
+
+uint32_t ShaderReflection::GetSetCount() const {
+	return bindings.empty() ? 0 : bindings.back().set + 1;
+}
+
+std::vector<ShaderResourceBinding> ShaderReflection::GetSetBindings(uint32_t set) const {
+	std::vector<ShaderResourceBinding> setBindings;
+	for (auto& binding : bindings) {
+		if (binding.set == set) {
+			setBindings.push_back(binding);
+		}
+	}
+	return setBindings;
+}
+
+int ReflectShader(const ShaderBinary& binary, ShaderReflection* reflection) {
+	ZoneScoped;
+	SpirvModule module;
+	if (module.Parse(binary.spvCode) != 0) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to parse SPIR-V module.");
+		return -1;
+	}
+
+	*reflection = {};
+	reflection->stages = module.GetStage();
+
+	for (uint32_t variableId : module.GetVariables()) {
+		const SpirvId& variable = module[variableId];
+		const SpirvId& pointer = module[variable.typeId];
+		if (pointer.opcode != spv::OpTypePointer || variable.operands.empty()) {
+			continue;
+		}
+		uint32_t storageClass = variable.operands[0];
+
+		switch (storageClass) {
+			case spv::StorageClassUniformConstant:
+			case spv::StorageClassUniform:
+			case spv::StorageClassStorageBuffer: {
+				if (variable.binding == InvalidDecoration) {
+					break;
+				}
+				ShaderResourceBinding binding;
+				if (ReflectResource(module, variable, storageClass, &binding) != 0) {
+					DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+													 "Unsupported resource type at set %u binding %u.",
+													 variable.set, variable.binding);
+					return -1;
+				}
+				reflection->bindings.push_back(binding);
+				break;
+			}
+			case spv::StorageClassPushConstant: {
+				const SpirvId& block = module[pointer.operands[1]];
+				uint32_t offset = std::numeric_limits<uint32_t>::max();
+				for (uint32_t memberOffset : block.memberOffsets) {
+					offset = std::min(offset, memberOffset);
+				}
+				if (offset == std::numeric_limits<uint32_t>::max()) {
+					offset = 0;
+				}
+				VkPushConstantRange range;
+				range.stageFlags = module.GetStage();
+				range.offset = offset;
+				range.size = module.GetTypeSize(pointer.operands[1]) - offset;
+				reflection->pushConstants.push_back(range);
+				break;
+			}
+			case spv::StorageClassInput: {
+				if (module.GetStage() != VK_SHADER_STAGE_VERTEX_BIT || variable.builtIn ||
+					variable.location == InvalidDecoration)
+				{
+					break;
+				}
+				// Matrices take one location per column.
+				uint32_t typeId = pointer.operands[1];
+				uint32_t locations = 1;
+				if (module[typeId].opcode == spv::OpTypeMatrix) {
+					locations = module[typeId].operands[1];
+					typeId = module[typeId].operands[0];
+				}
+				VkFormat format = module.GetVertexFormat(typeId);
+				if (format == VK_FORMAT_UNDEFINED) {
+					DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+													 "Unsupported vertex input type at location %u.", variable.location);
+					return -1;
+				}
+				for (uint32_t i = 0; i < locations; i++) {
+					reflection->vertexInputs.push_back({ variable.location + i, format });
+				}
+				break;
+			}
+		}
+	}
+
+	std::sort(reflection->bindings.begin(), reflection->bindings.end(),
+			  [](const ShaderResourceBinding& a, const ShaderResourceBinding& b) {
+				  return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+			  });
+	std::sort(reflection->vertexInputs.begin(), reflection->vertexInputs.end(),
+			  [](const ShaderVertexInput& a, const ShaderVertexInput& b) { return a.location < b.location; });
+
+	return 0;
+}
+
+int MergeShaderReflection(ShaderReflection& dst, const ShaderReflection& src) {
+	for (auto& binding : src.bindings) {
+		auto it = std::find_if(dst.bindings.begin(), dst.bindings.end(), [&binding](const ShaderResourceBinding& b) {
+			return b.set == binding.set && b.binding == binding.binding;
+		});
+		if (it == dst.bindings.end()) {
+			dst.bindings.push_back(binding);
+		} else if (it->type != binding.type) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "Shaders disagree on the type of the resource at set %u binding %u.",
+											 binding.set, binding.binding);
+			return -1;
+		} else {
+			// A layout may declare more descriptors than a shader indexes.
+			if (it->count != CEE_RUNTIME_DESCRIPTOR_COUNT &&
+				(binding.count == CEE_RUNTIME_DESCRIPTOR_COUNT || binding.count > it->count))
+			{
+				it->count = binding.count;
+			}
+			it->stages |= binding.stages;
+		}
+	}
+
+	for (auto& range : src.pushConstants) {
+		auto it = std::find_if(dst.pushConstants.begin(), dst.pushConstants.end(), [&range](const VkPushConstantRange& r) {
+			return r.offset == range.offset && r.size == range.size;
+		});
+		if (it == dst.pushConstants.end()) {
+			dst.pushConstants.push_back(range);
+		} else {
+			it->stageFlags |= range.stageFlags;
+		}
+	}
+
+	dst.stages |= src.stages;
+	std::sort(dst.bindings.begin(), dst.bindings.end(),
+			  [](const ShaderResourceBinding& a, const ShaderResourceBinding& b) {
+				  return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+			  });
+	return 0;
+}
+
+int ReflectShaders(const std::vector<std::shared_ptr<ShaderBinary>>& shaders, ShaderReflection* reflection) {
+	*reflection = {};
+	for (auto& shader : shaders) {
+		ShaderReflection stageReflection;
+		if (shader == nullptr || ReflectShader(*shader, &stageReflection) != 0 ||
+			MergeShaderReflection(*reflection, stageReflection) != 0)
+		{
+			return -1;
+		}
+	}
+	return 0;
+}
+
+uint32_t BuildVertexInputLayout(const ShaderReflection& reflection,
+								const std::vector<VkFormat>& formats,
+								std::vector<VkVertexInputAttributeDescription>& attributes)
+{
+	std::vector<VkVertexInputBindingDescription> bindings;
+	BuildVertexInputLayout(reflection, formats, UINT32_MAX, attributes, bindings);
+	return bindings.empty() ? 0 : bindings[0].stride;
+}
+
+void BuildVertexInputLayout(const ShaderReflection& reflection,
+							const std::vector<VkFormat>& formats,
+							uint32_t instanceLocation,
+							std::vector<VkVertexInputAttributeDescription>& attributes,
+							std::vector<VkVertexInputBindingDescription>& bindings)
+{
+	uint32_t offsets[2] = { 0, 0 };
+	attributes.clear();
+	bindings.clear();
+	for (size_t i = 0; i < reflection.vertexInputs.size(); i++) {
+		const ShaderVertexInput& input = reflection.vertexInputs[i];
+		VkVertexInputAttributeDescription attribute;
+		attribute.location = input.location;
+		attribute.binding = input.location >= instanceLocation ? 1 : 0;
+		attribute.format = formats.empty() ? input.format : formats[i];
+		attribute.offset = offsets[attribute.binding];
+		attributes.push_back(attribute);
+		offsets[attribute.binding] += GetVertexFormatSize(attribute.format);
+	}
+	for (uint32_t binding = 0; binding < 2; binding++) {
+		if (offsets[binding] != 0) {
+			VkVertexInputRate inputRate = binding == 0 ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE;
+			bindings.push_back({ binding, offsets[binding], inputRate });
+		}
+	}
+}
+}
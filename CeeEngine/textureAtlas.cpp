@@ -0,0 +1,221 @@
+#include <CeeEngine/textureAtlas.h>
+#include <CeeEngine/debugMessenger.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <Tracy.hpp>
+
+namespace cee {
+TextureAtlas::TextureAtlas(const TextureAtlasSpec& spec)
+: m_Spec(spec)
+{
+	m_StagingBuffer = Renderer::Get()->CreateStagingBuffer((size_t)m_Spec.pageSize * m_Spec.pageSize * 4);
+}
+
+TextureAtlas::~TextureAtlas() {
+	vkDeviceWaitIdle(Renderer::Get()->GetDevice());
+	for (auto& page : m_Pages) {
+		Renderer::Get()->ReleaseTexture(page.texIndex);
+	}
+}
+
+SubTextureHandle TextureAtlas::Add(const uint8_t* pixels, uint32_t width, uint32_t height) {
+	ZoneScoped;
+	uint32_t paddedWidth = width + 2 * m_Spec.padding;
+	uint32_t paddedHeight = height + 2 * m_Spec.padding;
+	if (width == 0 || height == 0 || paddedWidth > m_Spec.pageSize || paddedHeight > m_Spec.pageSize) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+										 "Sub texture of %ux%u does not fit in a %u atlas page.",
+										 width, height, m_Spec.pageSize);
+		return CEE_INVALID_SUB_TEXTURE;
+	}
+
+	uint32_t x, y;
+	size_t nodeIndex;
+	size_t pageIndex = 0;
+	for (; pageIndex < m_Pages.size(); pageIndex++) {
+		if (FindPosition(m_Pages[pageIndex], paddedWidth, paddedHeight, &x, &y, &nodeIndex)) {
+			break;
+		}
+	}
+	if (pageIndex == m_Pages.size()) {
+		if (m_Pages.size() >= m_Spec.maxPages) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "Texture atlas is full (%u pages).", m_Spec.maxPages);
+			return CEE_INVALID_SUB_TEXTURE;
+		}
+		if (AddPage() != 0) {
+			return CEE_INVALID_SUB_TEXTURE;
+		}
+		FindPosition(m_Pages[pageIndex], paddedWidth, paddedHeight, &x, &y, &nodeIndex);
+	}
+
+	Page& page = m_Pages[pageIndex];
+	InsertSkylineNode(page, nodeIndex, x, y, paddedWidth, paddedHeight);
+	CopyPadded(page, pixels, x, y, width, height);
+	page.dirty = true;
+
+	float pageSize = (float)m_Spec.pageSize;
+	SubTexture subTexture;
+	subTexture.texIndex = page.texIndex;
+	subTexture.uvMin = glm::vec2(x + m_Spec.padding, y + m_Spec.padding) / pageSize;
+	subTexture.uvMax = glm::vec2(x + m_Spec.padding + width, y + m_Spec.padding + height) / pageSize;
+	subTexture.page = pageIndex;
+	m_SubTextures.push_back(subTexture);
+
+	return m_SubTextures.size() - 1;
+}
+
+SubTextureHandle TextureAtlas::Load(const std::filesystem::path& filePath) {
+	auto image = m_AssetManager.LoadAsset<Image>(filePath);
+	if (image == nullptr) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to load sprite \"%s\".", filePath.c_str());
+		return CEE_INVALID_SUB_TEXTURE;
+	}
+
+	SubTextureHandle handle = Add(image->pixels, image->width, image->height);
+	free(image->pixels);
+	return handle;
+}
+
+const SubTexture& TextureAtlas::Get(SubTextureHandle handle) const {
+	if (handle >= m_SubTextures.size()) {
+		return m_InvalidSubTexture;
+	}
+	return m_SubTextures[handle];
+}
+
+int TextureAtlas::Upload() {
+	ZoneScoped;
+	for (auto& page : m_Pages) {
+		if (!page.dirty) {
+			continue;
+		}
+
+		if (m_StagingBuffer.SetData(page.pixels.size(), 0, page.pixels.data()) != 0 ||
+			m_StagingBuffer.TransferDataImmediate(page.image, 0, 0, m_Spec.pageSize, m_Spec.pageSize) != 0)
+		{
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to upload texture atlas page.");
+			return -1;
+		}
+		page.dirty = false;
+	}
+
+	return 0;
+}
+
+int TextureAtlas::AddPage() {
+	Page page;
+	page.skyline.push_back({ 0, 0, m_Spec.pageSize });
+	page.pixels.resize((size_t)m_Spec.pageSize * m_Spec.pageSize * 4, 0);
+	page.image = Renderer::Get()->CreateImageBuffer(m_Spec.pageSize, m_Spec.pageSize, IMAGE_FORMAT_R8G8B8A8_SRGB);
+	// Clear the page right away, which also leaves it in SHADER_READ_ONLY_OPTIMAL, since
+	// it can be bound before the next Upload().
+	if (m_StagingBuffer.SetData(page.pixels.size(), 0, page.pixels.data()) != 0 ||
+		m_StagingBuffer.TransferDataImmediate(page.image, 0, 0, m_Spec.pageSize, m_Spec.pageSize) != 0)
+	{
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to clear texture atlas page.");
+		return -1;
+	}
+	page.texIndex = Renderer::Get()->RegisterTexture(page.image);
+	if (page.texIndex == CEE_INVALID_TEXTURE_HANDLE) {
+		return -1;
+	}
+	page.dirty = false;
+
+	m_Pages.push_back(std::move(page));
+	return 0;
+}
+
+bool TextureAtlas::FindPosition(const Page& page, uint32_t width, uint32_t height,
+								uint32_t* x, uint32_t* y, size_t* nodeIndex) const
+{
+	uint32_t bestY = std::numeric_limits<uint32_t>::max();
+	uint32_t bestWidth = std::numeric_limits<uint32_t>::max();
+
+	for (size_t i = 0; i < page.skyline.size(); i++) {
+		const SkylineNode& node = page.skyline[i];
+		if (node.x + width > m_Spec.pageSize) {
+			break;
+		}
+
+		// The rectangle rests on the highest node it spans.
+		uint32_t top = 0;
+		uint32_t remaining = width;
+		for (size_t j = i; remaining > 0; j++) {
+			top = std::max(top, page.skyline[j].y);
+			remaining -= std::min(remaining, page.skyline[j].width);
+		}
+		if (top + height > m_Spec.pageSize) {
+			continue;
+		}
+
+		if (top < bestY || (top == bestY && node.width < bestWidth)) {
+			bestY = top;
+			bestWidth = node.width;
+			*x = node.x;
+			*y = top;
+			*nodeIndex = i;
+		}
+	}
+
+	return bestY != std::numeric_limits<uint32_t>::max();
+}
+
+void TextureAtlas::InsertSkylineNode(Page& page, size_t nodeIndex, uint32_t x, uint32_t y,
+									 uint32_t width, uint32_t height)
+{
+	auto& skyline = page.skyline;
+	skyline.insert(skyline.begin() + nodeIndex, { x, y + height, width });
+
+	// Trim the nodes now covered by the new one.
+	for (size_t i = nodeIndex + 1; i < skyline.size();) {
+		uint32_t previousEnd = skyline[i - 1].x + skyline[i - 1].width;
+		if (skyline[i].x >= previousEnd) {
+			break;
+		}
+
+		uint32_t overlap = previousEnd - skyline[i].x;
+		if (overlap >= skyline[i].width) {
+			skyline.erase(skyline.begin() + i);
+			continue;
+		}
+		skyline[i].x += overlap;
+		skyline[i].width -= overlap;
+		break;
+	}
+
+	for (size_t i = 0; i + 1 < skyline.size();) {
+		if (skyline[i].y == skyline[i + 1].y) {
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		} else {
+			i++;
+		}
+	}
+}
+
+void TextureAtlas::CopyPadded(Page& page, const uint8_t* pixels, uint32_t x, uint32_t y,
+							  uint32_t width, uint32_t height)
+{
+	uint32_t padding = m_Spec.padding;
+	size_t pageStride = (size_t)m_Spec.pageSize * 4;
+	size_t srcStride = (size_t)width * 4;
+
+	for (uint32_t row = 0; row < height + 2 * padding; row++) {
+		// Rows in the padding repeat the nearest edge row.
+		uint32_t srcRow = std::min(row > padding ? row - padding : 0, height - 1);
+		const uint8_t* src = pixels + srcRow * srcStride;
+		uint8_t* dst = page.pixels.data() + (y + row) * pageStride + (size_t)x * 4;
+
+		for (uint32_t i = 0; i < padding; i++) {
+			memcpy(dst + i * 4, src, 4);
+			memcpy(dst + (padding + width + i) * 4, src + srcStride - 4, 4);
+		}
+		memcpy(dst + padding * 4, src, srcStride);
+	}
+}
+}
@@ -0,0 +1,697 @@
+#include <CeeEngine/textureStreamer.h>
+#include <CeeEngine/debugMessenger.h>
+#include <CeeEngine/mipmap.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <Tracy.hpp>
+
+namespace cee {
+// Longest wait in frames before a promotion blocked by the residency budget decodes
+// its chain again, the wait doubles with every consecutive failure up to this.
+#define CEE_TEXTURE_STREAMER_MAX_BACKOFF 64
+
+static void RecordImageBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, uint32_t layers,
+							   VkImageLayout oldLayout, VkImageLayout newLayout,
+							   VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+							   VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.pNext = NULL;
+	barrier.srcAccessMask = srcAccess;
+	barrier.dstAccessMask = dstAccess;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, layers };
+
+	vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+// Copies every level the two images share from src to dst, then makes dst sampleable.
+// dst must already be in TRANSFER_DST_OPTIMAL.
+static void RecordLevelCopy(VkCommandBuffer commandBuffer,
+							VkImage src, uint32_t srcBaseLevel, VkImage dst, uint32_t dstBaseLevel,
+							uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers)
+{
+	// Waits for earlier frames sampling src before it changes layout.
+	RecordImageBarrier(commandBuffer, src, mipLevels - srcBaseLevel, layers,
+					   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+					   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	std::vector<VkImageCopy> copies;
+	for (uint32_t level = std::max(srcBaseLevel, dstBaseLevel); level < mipLevels; level++) {
+		VkImageCopy copy = {};
+		copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - srcBaseLevel, 0, layers };
+		copy.srcOffset = { 0, 0, 0 };
+		copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - dstBaseLevel, 0, layers };
+		copy.dstOffset = { 0, 0, 0 };
+		copy.extent = { std::max(width >> level, 1u), std::max(height >> level, 1u), 1 };
+		copies.push_back(copy);
+	}
+	vkCmdCopyImage(commandBuffer,
+				   src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				   dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				   copies.size(), copies.data());
+
+	// Frames whose descriptor sets still reference src keep sampling it until it retires.
+	RecordImageBarrier(commandBuffer, src, mipLevels - srcBaseLevel, layers,
+					   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					   VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+					   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	RecordImageBarrier(commandBuffer, dst, mipLevels - dstBaseLevel, layers,
+					   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+					   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
+TextureStreamer::TextureStreamer(const TextureStreamerSpec& spec)
+: m_Spec(spec), m_ResidentSize(0), m_FrameCounter(0), m_StagingRegionCount(0),
+  m_StagingRegionOffset(0), m_StagingRegionUsed(0), m_StopDecoding(false), m_HostChainCount(0)
+{
+	// A region is rewritten maxFramesInFlight + 1 frames after it was last used, by which
+	// point the frame that consumed it has had its fence waited on in StartFrame().
+	m_StagingRegionCount = Renderer::Get()->GetMaxFramesInFlight() + 1;
+	m_StagingBuffer = Renderer::Get()->CreateStagingBuffer(m_Spec.uploadBudgetPerFrame * m_StagingRegionCount);
+
+	m_DecodeThread = std::thread(&TextureStreamer::DecodeThread, this);
+}
+
+TextureStreamer::~TextureStreamer() {
+	{
+		std::lock_guard<std::mutex> lock(m_DecodeMutex);
+		m_StopDecoding = true;
+	}
+	m_DecodeCondition.notify_all();
+	m_DecodeThread.join();
+
+	vkDeviceWaitIdle(Renderer::Get()->GetDevice());
+	for (auto& texture : m_Textures) {
+		if (texture.inUse) {
+			Renderer::Get()->ReleaseTexture(texture.tableIndex);
+		}
+		RetireImage(texture.image);
+		RetireImage(texture.pending);
+	}
+	DestroyRetiredImages(true);
+}
+
+StreamedTextureHandle TextureStreamer::Load(const std::filesystem::path& filePath) {
+	return AllocateTexture({ filePath });
+}
+
+StreamedTextureHandle TextureStreamer::LoadCubeMap(const std::array<std::filesystem::path, 6>& facePaths) {
+	return AllocateTexture(std::vector<std::filesystem::path>(facePaths.begin(), facePaths.end()));
+}
+
+void TextureStreamer::Release(StreamedTextureHandle handle) {
+	if (handle >= m_Textures.size() || !m_Textures[handle].inUse) {
+		DebugMessenger::PostDebugMessage(ERROR_SEVERITY_WARNING, "Releasing invalid streamed texture %u.", handle);
+		return;
+	}
+
+	StreamedTexture& texture = m_Textures[handle];
+	Renderer::Get()->ReleaseTexture(texture.tableIndex);
+	RetireImage(texture.image);
+	RetireImage(texture.pending);
+	if (texture.hostChain) {
+		texture.hostChain.reset();
+		m_HostChainCount--;
+	}
+	// An in flight decode is discarded by the generation check when it completes.
+	texture.inUse = false;
+	texture.generation++;
+	m_FreeHandles.push_back(handle);
+}
+
+void TextureStreamer::RequestScreenSize(StreamedTextureHandle handle, uint32_t pixels) {
+	if (handle < m_Textures.size() && m_Textures[handle].inUse) {
+		m_Textures[handle].requestedSize = pixels;
+	}
+}
+
+void TextureStreamer::SetPriority(StreamedTextureHandle handle, float priority) {
+	if (handle < m_Textures.size() && m_Textures[handle].inUse) {
+		m_Textures[handle].priority = std::max(priority, 0.0f);
+	}
+}
+
+VkImageView TextureStreamer::GetImageView(StreamedTextureHandle handle) const {
+	if (handle >= m_Textures.size() || !m_Textures[handle].inUse) {
+		return VK_NULL_HANDLE;
+	}
+	return m_Textures[handle].image.view;
+}
+
+TextureHandle TextureStreamer::GetTextureIndex(StreamedTextureHandle handle) const {
+	if (handle >= m_Textures.size() || !m_Textures[handle].inUse) {
+		return CEE_INVALID_TEXTURE_HANDLE;
+	}
+	return m_Textures[handle].tableIndex;
+}
+
+uint32_t TextureStreamer::GetResidentLevel(StreamedTextureHandle handle) const {
+	if (handle >= m_Textures.size() || !m_Textures[handle].inUse ||
+		m_Textures[handle].image.view == VK_NULL_HANDLE) {
+		return UINT32_MAX;
+	}
+	return m_Textures[handle].image.baseLevel;
+}
+
+void TextureStreamer::Update() {
+	ZoneScoped;
+	m_FrameCounter++;
+	m_StagingRegionOffset = (m_FrameCounter % m_StagingRegionCount) * m_Spec.uploadBudgetPerFrame;
+	m_StagingRegionUsed = 0;
+
+	DestroyRetiredImages(false);
+	CollectDecodedTextures();
+
+	if (m_ResidentSize > m_Spec.residencyBudget) {
+		Evict(m_Spec.residencyBudget, std::numeric_limits<float>::max(), CEE_INVALID_STREAMED_TEXTURE);
+	}
+
+	std::vector<StreamedTextureHandle> promotions;
+	for (StreamedTextureHandle handle = 0; handle < m_Textures.size(); handle++) {
+		StreamedTexture& texture = m_Textures[handle];
+		if (!texture.inUse || texture.failed) {
+			continue;
+		}
+		if (texture.mipLevels == 0) {
+			QueueDecode(handle);
+			continue;
+		}
+		// Tails are tiny and always go first so every texture has something to sample.
+		if (texture.image.view == VK_NULL_HANDLE) {
+			if (texture.hostChain) {
+				LoadTail(texture);
+			} else {
+				QueueDecode(handle);
+			}
+			continue;
+		}
+		if (texture.pending.view != VK_NULL_HANDLE || ResidentLevel(texture) > DesiredLevel(texture)) {
+			promotions.push_back(handle);
+		} else if (texture.hostChain) {
+			texture.hostChain.reset();
+			m_HostChainCount--;
+		}
+	}
+
+	// Finish promotions already under way before starting new ones.
+	std::sort(promotions.begin(), promotions.end(), [this](StreamedTextureHandle a, StreamedTextureHandle b) {
+		bool aPending = m_Textures[a].pending.view != VK_NULL_HANDLE;
+		bool bPending = m_Textures[b].pending.view != VK_NULL_HANDLE;
+		if (aPending != bPending) {
+			return aPending;
+		}
+		return Score(m_Textures[a]) > Score(m_Textures[b]);
+	});
+
+	for (StreamedTextureHandle handle : promotions) {
+		StreamedTexture& texture = m_Textures[handle];
+		if (!texture.hostChain) {
+			if (m_FrameCounter >= texture.budgetRetryFrame) {
+				QueueDecode(handle);
+			}
+			continue;
+		}
+
+		if (texture.pending.view == VK_NULL_HANDLE) {
+			uint32_t level = ResidentLevel(texture) - 1;
+			uint32_t width = std::max(texture.width >> level, 1u);
+			uint32_t height = std::max(texture.height >> level, 1u);
+
+			size_t required = CalculateMipChainSize(width, height, texture.mipLevels - level, texture.layers);
+			if (m_ResidentSize + required > m_Spec.residencyBudget) {
+				size_t target = required < m_Spec.residencyBudget ? m_Spec.residencyBudget - required : 0;
+				if (!Evict(target, Score(texture), handle)) {
+					// Nothing less important to evict, stop holding the decoded chain so
+					// other textures can decode, and back off before decoding it again.
+					texture.hostChain.reset();
+					m_HostChainCount--;
+					texture.budgetBackoff = std::min(std::max(texture.budgetBackoff * 2, 1u),
+													 (uint32_t)CEE_TEXTURE_STREAMER_MAX_BACKOFF);
+					texture.budgetRetryFrame = m_FrameCounter + texture.budgetBackoff;
+				}
+				// Promote once the evicted images have been replaced.
+				continue;
+			}
+
+			texture.pending = CreateResidentImage(texture, level);
+			texture.budgetBackoff = 0;
+			texture.pendingLayer = 0;
+			texture.pendingRow = 0;
+			VkImage image = texture.pending.image;
+			uint32_t levels = texture.mipLevels - level;
+			uint32_t layers = texture.layers;
+			m_FrameCommands.push_back([image, levels, layers](VkCommandBuffer commandBuffer) {
+				RecordImageBarrier(commandBuffer, image, levels, layers,
+								   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+								   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+								   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+			});
+		}
+
+		if (!ContinuePromotion(texture)) {
+			break;
+		}
+	}
+
+	if (!m_FrameCommands.empty()) {
+		Renderer::Get()->QueueSubmit([this](RawCommandBuffer& cmdBuffer) {
+			for (auto& command : m_FrameCommands) {
+				command(cmdBuffer.commandBuffer);
+			}
+		}, QUEUE_GRAPHICS);
+		m_FrameCommands.clear();
+	}
+
+	TracyPlot("Streamed texture memory", (int64_t)m_ResidentSize);
+}
+
+StreamedTextureHandle TextureStreamer::AllocateTexture(std::vector<std::filesystem::path> filePaths) {
+	StreamedTextureHandle handle;
+	if (!m_FreeHandles.empty()) {
+		handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+	} else {
+		handle = m_Textures.size();
+		m_Textures.emplace_back();
+	}
+
+	StreamedTexture& texture = m_Textures[handle];
+	uint32_t generation = texture.generation;
+	texture = StreamedTexture();
+	texture.generation = generation;
+	texture.inUse = true;
+	texture.layers = filePaths.size();
+	texture.filePaths = std::move(filePaths);
+	// Samples the default texture until the mip tail is resident.
+	texture.tableIndex = Renderer::Get()->RegisterTexture(VK_NULL_HANDLE);
+
+	QueueDecode(handle);
+	return handle;
+}
+
+uint32_t TextureStreamer::ResidentLevel(const StreamedTexture& texture) const {
+	return texture.image.view != VK_NULL_HANDLE ? texture.image.baseLevel : texture.mipLevels;
+}
+
+uint32_t TextureStreamer::TailLevel(const StreamedTexture& texture) const {
+	uint32_t level = 0;
+	while (level + 1 < texture.mipLevels &&
+		   std::max(texture.width >> level, texture.height >> level) > m_Spec.tailSize)
+	{
+		level++;
+	}
+	return level;
+}
+
+uint32_t TextureStreamer::DesiredLevel(const StreamedTexture& texture) const {
+	uint32_t tail = TailLevel(texture);
+	uint32_t level = 0;
+	// Uploads are split by rows, so a single row has to fit in one frame's region.
+	while (level < tail && (size_t)std::max(texture.width >> level, 1u) * 4 > m_Spec.uploadBudgetPerFrame) {
+		level++;
+	}
+	if (texture.requestedSize == 0) {
+		return level;
+	}
+
+	// Smallest level that still covers the requested size.
+	while (level < tail &&
+		   std::max(texture.width >> (level + 1), texture.height >> (level + 1)) >= texture.requestedSize)
+	{
+		level++;
+	}
+	return level;
+}
+
+float TextureStreamer::Score(const StreamedTexture& texture) const {
+	int32_t missingLevels = (int32_t)ResidentLevel(texture) - (int32_t)DesiredLevel(texture);
+	return texture.priority * (float)(missingLevels + 1);
+}
+
+void TextureStreamer::CollectDecodedTextures() {
+	std::vector<DecodeResult> results;
+	{
+		std::lock_guard<std::mutex> lock(m_DecodeMutex);
+		results.swap(m_DecodeResults);
+	}
+
+	for (auto& result : results) {
+		StreamedTexture& texture = m_Textures[result.handle];
+		if (!texture.inUse || texture.generation != result.generation) {
+			m_HostChainCount--;
+			continue;
+		}
+		texture.decodeQueued = false;
+
+		if (result.chain == nullptr ||
+			(texture.mipLevels != 0 && (result.chain->width != texture.width || result.chain->height != texture.height)))
+		{
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Failed to stream texture \"%s\".",
+											 texture.filePaths[0].c_str());
+			texture.failed = true;
+			m_HostChainCount--;
+			continue;
+		}
+
+		texture.width = result.chain->width;
+		texture.height = result.chain->height;
+		texture.mipLevels = result.chain->mipLevels;
+		texture.hostChain = std::move(result.chain);
+
+		size_t tailSize = CalculateMipChainSize(texture.width, texture.height, texture.mipLevels, texture.layers) -
+						  CalculateMipLevelOffset(texture.width, texture.height, TailLevel(texture), texture.layers);
+		if (tailSize > m_Spec.uploadBudgetPerFrame) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR,
+											 "Mip tail of \"%s\" does not fit in the per frame upload budget.",
+											 texture.filePaths[0].c_str());
+			texture.failed = true;
+			texture.hostChain.reset();
+			m_HostChainCount--;
+		}
+	}
+}
+
+void TextureStreamer::QueueDecode(StreamedTextureHandle handle) {
+	StreamedTexture& texture = m_Textures[handle];
+	if (texture.decodeQueued || texture.hostChain || texture.failed || m_HostChainCount >= m_Spec.maxHostChains) {
+		return;
+	}
+
+	m_HostChainCount++;
+	texture.decodeQueued = true;
+	{
+		std::lock_guard<std::mutex> lock(m_DecodeMutex);
+		m_DecodeRequests.push_back({ handle, texture.generation, texture.filePaths });
+	}
+	m_DecodeCondition.notify_one();
+}
+
+void TextureStreamer::DecodeThread() {
+	while (true) {
+		DecodeRequest request;
+		{
+			std::unique_lock<std::mutex> lock(m_DecodeMutex);
+			m_DecodeCondition.wait(lock, [this]() { return m_StopDecoding || !m_DecodeRequests.empty(); });
+			if (m_StopDecoding) {
+				return;
+			}
+			request = std::move(m_DecodeRequests.front());
+			m_DecodeRequests.pop_front();
+		}
+
+		DecodeResult result = { request.handle, request.generation, DecodeTexture(request.filePaths) };
+
+		std::lock_guard<std::mutex> lock(m_DecodeMutex);
+		m_DecodeResults.push_back(std::move(result));
+	}
+}
+
+std::shared_ptr<TextureStreamer::HostMipChain> TextureStreamer::DecodeTexture(const std::vector<std::filesystem::path>& filePaths) {
+	ZoneScoped;
+	auto chain = std::make_shared<HostMipChain>();
+	chain->layers = filePaths.size();
+
+	for (uint32_t layer = 0; layer < chain->layers; layer++) {
+		auto image = m_AssetManager.LoadAsset<Image>(filePaths[layer]);
+		if (image == nullptr) {
+			return nullptr;
+		}
+
+		if (layer == 0) {
+			chain->width = image->width;
+			chain->height = image->height;
+			chain->mipLevels = CalculateMipLevels(chain->width, chain->height);
+			chain->pixels.resize(CalculateMipChainSize(chain->width, chain->height, chain->mipLevels, chain->layers));
+		} else if ((uint32_t)image->width != chain->width || (uint32_t)image->height != chain->height) {
+			DebugMessenger::PostDebugMessage(ERROR_SEVERITY_ERROR, "Cube map face \"%s\" does not match the other faces.",
+											 filePaths[layer].c_str());
+			free(image->pixels);
+			return nullptr;
+		}
+
+		size_t levelSize = (size_t)chain->width * chain->height * 4;
+		memcpy(chain->pixels.data() + layer * levelSize, image->pixels, levelSize);
+		free(image->pixels);
+
+		for (uint32_t level = 1; level < chain->mipLevels; level++) {
+			uint32_t srcWidth = std::max(chain->width >> (level - 1), 1u);
+			uint32_t srcHeight = std::max(chain->height >> (level - 1), 1u);
+			size_t srcSize = (size_t)srcWidth * srcHeight * 4;
+			size_t dstSize = (size_t)std::max(srcWidth >> 1, 1u) * std::max(srcHeight >> 1, 1u) * 4;
+			const uint8_t* src = chain->pixels.data() +
+				CalculateMipLevelOffset(chain->width, chain->height, level - 1, chain->layers) + layer * srcSize;
+			uint8_t* dst = chain->pixels.data() +
+				CalculateMipLevelOffset(chain->width, chain->height, level, chain->layers) + layer * dstSize;
+			DownsampleSRGBA8(src, srcWidth, srcHeight, dst);
+		}
+	}
+
+	return chain;
+}
+
+TextureStreamer::ResidentImage TextureStreamer::CreateResidentImage(const StreamedTexture& texture, uint32_t baseLevel) {
+	ResidentImage image;
+	image.baseLevel = baseLevel;
+
+	uint32_t width = std::max(texture.width >> baseLevel, 1u);
+	uint32_t height = std::max(texture.height >> baseLevel, 1u);
+	Renderer::Get()->CreateImageObjects(&image.image, &image.memory, &image.view,
+										VK_FORMAT_R8G8B8A8_SRGB,
+										VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+										VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+										VK_IMAGE_USAGE_SAMPLED_BIT,
+										&width, &height, &image.size,
+										texture.mipLevels - baseLevel, texture.layers);
+	m_ResidentSize += image.size;
+
+	return image;
+}
+
+void TextureStreamer::RetireImage(ResidentImage& image) {
+	if (image.image == VK_NULL_HANDLE) {
+		return;
+	}
+
+	m_ResidentSize -= image.size;
+	m_RetiredImages.push_back({ image, m_FrameCounter });
+	image = ResidentImage();
+}
+
+void TextureStreamer::DestroyRetiredImages(bool force) {
+	VkDevice device = Renderer::Get()->GetDevice();
+	auto end = std::remove_if(m_RetiredImages.begin(), m_RetiredImages.end(), [this, force, device](RetiredImage& retired) {
+		// Texture table writes reach the last frame's descriptor set one full cycle of
+		// frames after the swap, and that frame then has to complete.
+		if (!force && m_FrameCounter - retired.retireFrame <= 2 * m_StagingRegionCount) {
+			return false;
+		}
+		vkDestroyImageView(device, retired.image.view, NULL);
+		vkDestroyImage(device, retired.image.image, NULL);
+		vkFreeMemory(device, retired.image.memory, NULL);
+		return true;
+	});
+	m_RetiredImages.erase(end, m_RetiredImages.end());
+}
+
+bool TextureStreamer::StageUpload(const void* data, size_t size, size_t* bufferOffset) {
+	if (m_StagingRegionUsed + size > m_Spec.uploadBudgetPerFrame) {
+		return false;
+	}
+
+	*bufferOffset = m_StagingRegionOffset + m_StagingRegionUsed;
+	if (m_StagingBuffer.SetData(size, *bufferOffset, data) != 0) {
+		return false;
+	}
+	m_StagingRegionUsed += size;
+	return true;
+}
+
+bool TextureStreamer::LoadTail(StreamedTexture& texture) {
+	uint32_t tail = TailLevel(texture);
+	size_t tailOffset = CalculateMipLevelOffset(texture.width, texture.height, tail, texture.layers);
+	size_t tailSize = CalculateMipChainSize(texture.width, texture.height, texture.mipLevels, texture.layers) - tailOffset;
+
+	size_t bufferOffset;
+	if (!StageUpload(texture.hostChain->pixels.data() + tailOffset, tailSize, &bufferOffset)) {
+		return false;
+	}
+
+	texture.image = CreateResidentImage(texture, tail);
+	Renderer::Get()->UpdateTexture(texture.tableIndex, texture.image.view);
+
+	std::vector<VkBufferImageCopy> copies;
+	for (uint32_t level = tail; level < texture.mipLevels; level++) {
+		VkBufferImageCopy copy = {};
+		copy.bufferOffset = bufferOffset +
+			CalculateMipLevelOffset(texture.width, texture.height, level, texture.layers) - tailOffset;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - tail, 0, texture.layers };
+		copy.imageOffset = { 0, 0, 0 };
+		copy.imageExtent = { std::max(texture.width >> level, 1u), std::max(texture.height >> level, 1u), 1 };
+		copies.push_back(copy);
+	}
+
+	VkBuffer buffer = m_StagingBuffer.m_Buffer;
+	VkImage image = texture.image.image;
+	uint32_t levels = texture.mipLevels - tail;
+	uint32_t layers = texture.layers;
+	m_FrameCommands.push_back([buffer, image, levels, layers, copies](VkCommandBuffer commandBuffer) {
+		RecordImageBarrier(commandBuffer, image, levels, layers,
+						   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+						   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							   copies.size(), copies.data());
+		RecordImageBarrier(commandBuffer, image, levels, layers,
+						   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+						   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+						   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	});
+
+	return true;
+}
+
+bool TextureStreamer::ContinuePromotion(StreamedTexture& texture) {
+	uint32_t level = texture.pending.baseLevel;
+	uint32_t width = std::max(texture.width >> level, 1u);
+	uint32_t height = std::max(texture.height >> level, 1u);
+	size_t rowSize = (size_t)width * 4;
+	size_t levelSize = rowSize * height;
+	const uint8_t* levelData = texture.hostChain->pixels.data() +
+		CalculateMipLevelOffset(texture.width, texture.height, level, texture.layers);
+
+	VkBuffer buffer = m_StagingBuffer.m_Buffer;
+	VkImage image = texture.pending.image;
+	// Uploads the level in row slices so a large level is spread over several frames.
+	while (texture.pendingLayer < texture.layers) {
+		size_t available = m_Spec.uploadBudgetPerFrame - m_StagingRegionUsed;
+		uint32_t rows = (uint32_t)std::min<size_t>(height - texture.pendingRow, available / rowSize);
+		if (rows == 0) {
+			return false;
+		}
+
+		size_t bufferOffset;
+		StageUpload(levelData + texture.pendingLayer * levelSize + texture.pendingRow * rowSize,
+					rows * rowSize, &bufferOffset);
+
+		VkBufferImageCopy copy = {};
+		copy.bufferOffset = bufferOffset;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.pendingLayer, 1 };
+		copy.imageOffset = { 0, (int32_t)texture.pendingRow, 0 };
+		copy.imageExtent = { width, rows, 1 };
+		m_FrameCommands.push_back([buffer, image, copy](VkCommandBuffer commandBuffer) {
+			vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+		});
+
+		texture.pendingRow += rows;
+		if (texture.pendingRow == height) {
+			texture.pendingRow = 0;
+			texture.pendingLayer++;
+		}
+	}
+
+	FinishPromotion(texture);
+	return true;
+}
+
+void TextureStreamer::FinishPromotion(StreamedTexture& texture) {
+	VkImage src = texture.image.image;
+	VkImage dst = texture.pending.image;
+	uint32_t srcBaseLevel = texture.image.baseLevel;
+	uint32_t dstBaseLevel = texture.pending.baseLevel;
+	uint32_t width = texture.width;
+	uint32_t height = texture.height;
+	uint32_t mipLevels = texture.mipLevels;
+	uint32_t layers = texture.layers;
+	m_FrameCommands.push_back([=](VkCommandBuffer commandBuffer) {
+		RecordLevelCopy(commandBuffer, src, srcBaseLevel, dst, dstBaseLevel, width, height, mipLevels, layers);
+	});
+
+	RetireImage(texture.image);
+	texture.image = texture.pending;
+	texture.pending = ResidentImage();
+	Renderer::Get()->UpdateTexture(texture.tableIndex, texture.image.view);
+	texture.pendingLayer = 0;
+	texture.pendingRow = 0;
+}
+
+void TextureStreamer::Demote(StreamedTexture& texture, uint32_t newLevel) {
+	ResidentImage demoted = CreateResidentImage(texture, newLevel);
+
+	VkImage src = texture.image.image;
+	VkImage dst = demoted.image;
+	uint32_t srcBaseLevel = texture.image.baseLevel;
+	uint32_t width = texture.width;
+	uint32_t height = texture.height;
+	uint32_t mipLevels = texture.mipLevels;
+	uint32_t layers = texture.layers;
+	m_FrameCommands.push_back([=](VkCommandBuffer commandBuffer) {
+		RecordImageBarrier(commandBuffer, dst, mipLevels - newLevel, layers,
+						   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+						   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		RecordLevelCopy(commandBuffer, src, srcBaseLevel, dst, newLevel, width, height, mipLevels, layers);
+	});
+
+	RetireImage(texture.image);
+	texture.image = demoted;
+	Renderer::Get()->UpdateTexture(texture.tableIndex, texture.image.view);
+}
+
+bool TextureStreamer::Evict(size_t targetSize, float belowScore, StreamedTextureHandle exclude) {
+	ZoneScoped;
+	std::vector<StreamedTextureHandle> victims;
+	for (StreamedTextureHandle handle = 0; handle < m_Textures.size(); handle++) {
+		const StreamedTexture& texture = m_Textures[handle];
+		if (handle != exclude && texture.inUse && texture.image.view != VK_NULL_HANDLE &&
+			texture.pending.view == VK_NULL_HANDLE && ResidentLevel(texture) < TailLevel(texture))
+		{
+			victims.push_back(handle);
+		}
+	}
+	std::sort(victims.begin(), victims.end(), [this](StreamedTextureHandle a, StreamedTextureHandle b) {
+		return Score(m_Textures[a]) < Score(m_Textures[b]);
+	});
+
+	size_t residentSize = m_ResidentSize;
+	for (StreamedTextureHandle handle : victims) {
+		if (residentSize <= targetSize) {
+			break;
+		}
+
+		StreamedTexture& texture = m_Textures[handle];
+		// Only evict if the victim would still rank below the texture asking for memory,
+		// otherwise two textures of equal importance would trade levels every frame.
+		if (Score(texture) + texture.priority >= belowScore) {
+			break;
+		}
+
+		uint32_t level = ResidentLevel(texture);
+		uint32_t newLevel = std::max(level + 1, std::min(DesiredLevel(texture), TailLevel(texture)));
+		size_t oldSize = CalculateMipChainSize(std::max(texture.width >> level, 1u), std::max(texture.height >> level, 1u),
+											   texture.mipLevels - level, texture.layers);
+		size_t newSize = CalculateMipChainSize(std::max(texture.width >> newLevel, 1u), std::max(texture.height >> newLevel, 1u),
+											   texture.mipLevels - newLevel, texture.layers);
+		Demote(texture, newLevel);
+		residentSize -= std::min(residentSize, oldSize - newSize);
+	}
+
+	return residentSize <= targetSize;
+}
+}
@@ -137,6 +137,7 @@ void Window::SetSize(uint32_t width, uint32_t height)
 {
 	xcb_configure_window(s_Connection, m_Wnd, XCB_CONFIG_WINDOW_WIDTH, &width);
 	xcb_configure_window(s_Connection, m_Wnd, XCB_CONFIG_WINDOW_HEIGHT, &height);
+	xcb_flush(s_Connection);
 }
 
 NativeWindowConnection* Window::GetNativeConnection() const
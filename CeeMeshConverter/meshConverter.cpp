@@ -0,0 +1,194 @@
+#include <CeeEngine/assetManager.h>
+#include <CeeEngine/debugMessenger.h>
+#include <CeeEngine/mesh.h>
+#include <CeeEngine/meshImporter.h>
+#include <CeeEngine/meshOptimizer.h>
+#include <CeeEngine/meshSimplifier.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <getopt.h>
+#include <memory>
+
+static bool s_Verbose = false;
+
+static void PrintUsage(const char* command) {
+	fprintf(stdout, "Usage: %s [OPTION]... INPUT.obj OUTPUT.cmesh\n"
+		 "\n"
+		 "Converts a Wavefront OBJ into the binary mesh format loaded by\n"
+		 "AssetManager::LoadAsset<Mesh>() and Renderer3D::LoadMesh().\n"
+		 "\n"
+		 "Up to %d levels of detail are generated by simplifying each level into the next,\n"
+		 "their triangle counts and errors are printed. The triangles are reordered for the post transform cache and for less overdraw,\n"
+		 "then the vertices for linear fetches. The ACMR (cache misses per triangle) before\n"
+		 "and after is printed.\n"
+		 "\n"
+		 "-h, --help       help\n"
+		 "-v, --verbose    show all messages and print the mesh statistics\n"
+		 "    --no-optimize keep the triangle and vertex order of the input\n"
+		 "    --no-overdraw only optimize for the vertex cache and fetches\n"
+		 "    --overdraw-threshold=X largest ACMR growth accepted for less overdraw (default 1.05)\n"
+		 "    --meshlets   print the meshlets the mesh splits into\n"
+		 "    --no-lods    only keep the full mesh\n"
+		 "    --lod-error=X largest error of any level of detail, relative to the bounds diagonal (default 0.05)\n",
+		 command, CEE_MESH_MAX_LODS);
+}
+
+enum {
+	OPT_NO_OPTIMIZE = 1,
+	OPT_NO_OVERDRAW,
+	OPT_OVERDRAW_THRESHOLD,
+	OPT_MESHLETS,
+	OPT_NO_LODS,
+	OPT_LOD_ERROR
+};
+
+static const char shortOptions[] = "hv";
+static const option longOptions[] = {
+	{ "help", 0, 0, 'h' },
+	{ "verbose", 0, 0, 'v' },
+	{ "no-optimize", 0, 0, OPT_NO_OPTIMIZE },
+	{ "no-overdraw", 0, 0, OPT_NO_OVERDRAW },
+	{ "overdraw-threshold", 1, 0, OPT_OVERDRAW_THRESHOLD },
+	{ "meshlets", 0, 0, OPT_MESHLETS },
+	{ "no-lods", 0, 0, OPT_NO_LODS },
+	{ "lod-error", 1, 0, OPT_LOD_ERROR },
+	{ 0, 0, 0, 0 }
+};
+
+static void MessageSink(cee::CeeErrorSeverity severity, const char* message, void*) {
+	const char* label = "DEBUG";
+	switch (severity) {
+	case cee::ERROR_SEVERITY_ERROR: label = "ERROR"; break;
+	case cee::ERROR_SEVERITY_WARNING: label = "WARN"; break;
+	case cee::ERROR_SEVERITY_INFO: label = "INFO"; break;
+	default: break;
+	}
+	fprintf(stderr, "[%s] %s\n", label, message);
+}
+
+int main(int argc, char** argv) {
+	bool optimize = true;
+	bool meshlets = false;
+	cee::MeshOptimizationSpec optimizationSpec;
+	cee::MeshLodSpec lodSpec;
+
+	int c;
+	int32_t optionIndex;
+	while ((c = getopt_long(argc, argv, shortOptions, longOptions, &optionIndex)) != -1) {
+		switch (c) {
+		case 'h':
+			PrintUsage(argv[0]);
+			exit(EXIT_SUCCESS);
+			break;
+
+		case 'v':
+			s_Verbose = true;
+			break;
+
+		case OPT_NO_OPTIMIZE:
+			optimize = false;
+			break;
+
+		case OPT_NO_OVERDRAW:
+			optimizationSpec.overdraw = false;
+			break;
+
+		case OPT_OVERDRAW_THRESHOLD:
+			optimizationSpec.overdrawThreshold = strtof(optarg, NULL);
+			if (optimizationSpec.overdrawThreshold < 1.0f) {
+				fprintf(stderr, "%s: --overdraw-threshold must be at least 1\n", argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+		case OPT_MESHLETS:
+			meshlets = true;
+			break;
+
+		case OPT_NO_LODS:
+			lodSpec.maxLods = 1;
+			break;
+
+		case OPT_LOD_ERROR:
+			lodSpec.maxError = strtof(optarg, NULL);
+			if (lodSpec.maxError <= 0.0f) {
+				fprintf(stderr, "%s: --lod-error must be positive\n", argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+		default:
+			PrintUsage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (argc - optind != 2) {
+		PrintUsage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	std::filesystem::path input = argv[optind];
+	std::filesystem::path output = argv[optind + 1];
+
+	int messageLevels = cee::ERROR_SEVERITY_WARNING | cee::ERROR_SEVERITY_ERROR;
+	if (s_Verbose) {
+		messageLevels |= cee::ERROR_SEVERITY_DEBUG | cee::ERROR_SEVERITY_INFO;
+	}
+	cee::DebugMessenger::RegisterDebugMessenger((cee::CeeErrorSeverity)messageLevels, NULL, MessageSink);
+
+	auto mesh = std::make_shared<cee::Mesh>();
+	if (cee::ImportObj(input, mesh.get()) != 0) {
+		fprintf(stderr, "%s: failed to import \"%s\"\n", argv[0], input.c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	cee::GenerateLods(mesh.get(), lodSpec);
+	for (uint32_t lod = 0; lod < mesh->lodCount; lod++) {
+		size_t triangleCount = 0;
+		for (auto& submesh : mesh->submeshes) {
+			triangleCount += submesh.GetLod(lod).indexCount / 3;
+		}
+		fprintf(stdout, "LOD %u: %zu triangles, error %g\n", lod, triangleCount, mesh->lodErrors[lod]);
+	}
+
+	if (optimize) {
+		cee::MeshOptimizationStats stats;
+		cee::OptimizeMesh(mesh.get(), optimizationSpec, &stats);
+		fprintf(stdout, "ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%u vertex FIFO)\n",
+				stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr,
+				CEE_MESH_STATS_CACHE_SIZE);
+		if (stats.unusedVertices != 0) {
+			fprintf(stdout, "dropped %u unused vertices\n", stats.unusedVertices);
+		}
+	}
+	if (meshlets) {
+		cee::MeshletData meshletData;
+		cee::BuildMeshlets(*mesh, &meshletData);
+		size_t triangleCount = meshletData.triangles.size() / 3;
+		size_t meshletCount = meshletData.meshlets.size();
+		fprintf(stdout, "%zu meshlets of up to %u vertices and %u triangles, %.1f vertices and %.1f triangles on average\n",
+				meshletCount, CEE_MESHLET_MAX_VERTICES, CEE_MESHLET_MAX_TRIANGLES,
+				(double)meshletData.vertices.size() / meshletCount, (double)triangleCount / meshletCount);
+	}
+
+	// Read back through the loader, so a file the engine would reject is never left behind.
+	cee::AssetManager assetManager(std::filesystem::current_path());
+	assetManager.SaveAsset<cee::Mesh>(output, mesh);
+	if (assetManager.LoadAsset<cee::Mesh>(output) == nullptr) {
+		fprintf(stderr, "%s: failed to write \"%s\"\n", argv[0], output.c_str());
+		std::error_code error;
+		std::filesystem::remove(assetManager.GetAssetRoot() / output, error);
+		exit(EXIT_FAILURE);
+	}
+
+	if (s_Verbose) {
+		fprintf(stdout, "%s: %zu vertices, %u indices of %u bytes, %zu submeshes\n", output.c_str(),
+				mesh->vertices.size(), mesh->GetIndexCount(), mesh->indexSize, mesh->submeshes.size());
+		fprintf(stdout, "bounds (%g, %g, %g) to (%g, %g, %g)\n",
+				mesh->bounds.min.x, mesh->bounds.min.y, mesh->bounds.min.z,
+				mesh->bounds.max.x, mesh->bounds.max.y, mesh->bounds.max.z);
+	}
+
+	return EXIT_SUCCESS;
+}